@@ -19,6 +19,7 @@
 #include <TH1F.h>
 #include <cmath>
 #include <array>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -74,12 +75,16 @@ struct DecayVertexBuilder2Prong {
     // stop iterations if chi2 improves by less that this factor
     df.setMinRelChi2Change(0.9);
 
+    df.setUseAbsDCA(true);
+
     hvtxp_x_out->Fill(collision.posX());
     hvtxp_y_out->Fill(collision.posY());
     hvtxp_z_out->Fill(collision.posZ());
-    for (auto it0 = tracks.begin(); it0 != tracks.end(); ++it0) {
-      auto& track_0 = *it0;
-
+    // selected tracks and the table info needed for the output
+    std::vector<o2::track::TrackParCov> selTracks;
+    std::vector<std::array<int, 2>> selIndices; // collision and track global indices
+    std::vector<float> selY;
+    for (auto& track_0 : tracks) {
       UChar_t clustermap_0 = track_0.itsClusterMap();
       //fill track distribution before selection
       hitsmap_nocuts->Fill(clustermap_0);
@@ -104,57 +109,47 @@ struct DecayVertexBuilder2Prong {
                                        track_0.cTglSnp(), track_0.cTglTgl(),
                                        track_0.c1PtY(), track_0.c1PtZ(), track_0.c1PtSnp(),
                                        track_0.c1PtTgl(), track_0.c1Pt21Pt2()};
-      o2::track::TrackParCov trackparvar0(x0_, alpha0_, arraypar0, covpar0);
-      for (auto it1 = it0 + 1; it1 != tracks.end(); ++it1) {
-        auto& track_1 = *it1;
-        UChar_t clustermap_1 = track_1.itsClusterMap();
-        bool isselected_1 = track_1.tpcNClsFound() > 70 && track_1.flags() & 0x4;
-        isselected_1 = isselected_1 && (TESTBIT(clustermap_1, 0) || TESTBIT(clustermap_1, 1));
-        if (!isselected_1)
-          continue;
-        if (track_0.signed1Pt() * track_1.signed1Pt() > 0)
-          continue;
-        float x1_ = track_1.x();
-        float alpha1_ = track_1.alpha();
-        std::array<float, 5> arraypar1 = {track_1.y(), track_1.z(), track_1.snp(),
-                                          track_1.tgl(), track_1.signed1Pt()};
-        std::array<float, 15> covpar1 = {track_1.cYY(), track_1.cZY(), track_1.cZZ(),
-                                         track_1.cSnpY(), track_1.cSnpZ(),
-                                         track_1.cSnpSnp(), track_1.cTglY(), track_1.cTglZ(),
-                                         track_1.cTglSnp(), track_1.cTglTgl(),
-                                         track_1.c1PtY(), track_1.c1PtZ(), track_1.c1PtSnp(),
-                                         track_1.c1PtTgl(), track_1.c1Pt21Pt2()};
-        o2::track::TrackParCov trackparvar1(x1_, alpha1_, arraypar1, covpar1);
-        df.setUseAbsDCA(true);
-        int nCand = df.process(trackparvar0, trackparvar1);
-        if (nCand == 0)
+      selTracks.emplace_back(x0_, alpha0_, arraypar0, covpar0);
+      selIndices.push_back({track_0.collisionId(), track_0.globalIndex()});
+      selY.push_back(track_0.y());
+    }
+    // opposite sign pairs, fitted in one batch
+    std::vector<o2::vertexing::DCAFitterN<2>::TrackIDs> pairs;
+    int nSel = selTracks.size();
+    for (int i0 = 0; i0 < nSel; i0++) {
+      for (int i1 = i0 + 1; i1 < nSel; i1++) {
+        if (selTracks[i0].getQ2Pt() * selTracks[i1].getQ2Pt() > 0)
           continue;
-        const auto& vtx = df.getPCACandidate();
-        LOGF(info, "vertex x %f", vtx[0]);
-        hvtx_x_out->Fill(vtx[0]);
-        hvtx_y_out->Fill(vtx[1]);
-        hvtx_z_out->Fill(vtx[2]);
-        o2::track::TrackParCov trackdec0 = df.getTrack(0);
-        o2::track::TrackParCov trackdec1 = df.getTrack(1);
-        std::array<float, 3> pvec0;
-        std::array<float, 3> pvec1;
-        trackdec0.getPxPyPzGlo(pvec0);
-        trackdec1.getPxPyPzGlo(pvec1);
-        float masspion = 0.140;
-        float masskaon = 0.494;
-        float mass_ = invmass2prongs(pvec0[0], pvec0[1], pvec0[2], masspion,
-                                     pvec1[0], pvec1[1], pvec1[2], masskaon);
-        float masssw_ = invmass2prongs(pvec0[0], pvec0[1], pvec0[2], masskaon,
-                                       pvec1[0], pvec1[1], pvec1[2], masspion);
-        secvtx2prong(track_0.collisionId(),
-                     collision.posX(), collision.posY(), collision.posZ(),
-                     vtx[0], vtx[1], vtx[2], track_0.globalIndex(),
-                     pvec0[0], pvec0[1], pvec0[2], track_0.y(),
-                     track_1.globalIndex(), pvec1[0], pvec1[1], pvec1[2], track_1.y(),
-                     mass_, masssw_);
-        hchi2dca->Fill(df.getChi2AtPCACandidate());
+        pairs.push_back({i0, i1});
       }
     }
+    df.processBatch(selTracks, pairs, [&](int ipair) {
+      int i0 = pairs[ipair][0], i1 = pairs[ipair][1];
+      const auto& vtx = df.getPCACandidate();
+      LOGF(info, "vertex x %f", vtx[0]);
+      hvtx_x_out->Fill(vtx[0]);
+      hvtx_y_out->Fill(vtx[1]);
+      hvtx_z_out->Fill(vtx[2]);
+      o2::track::TrackParCov trackdec0 = df.getTrack(0);
+      o2::track::TrackParCov trackdec1 = df.getTrack(1);
+      std::array<float, 3> pvec0;
+      std::array<float, 3> pvec1;
+      trackdec0.getPxPyPzGlo(pvec0);
+      trackdec1.getPxPyPzGlo(pvec1);
+      float masspion = 0.140;
+      float masskaon = 0.494;
+      float mass_ = invmass2prongs(pvec0[0], pvec0[1], pvec0[2], masspion,
+                                   pvec1[0], pvec1[1], pvec1[2], masskaon);
+      float masssw_ = invmass2prongs(pvec0[0], pvec0[1], pvec0[2], masskaon,
+                                     pvec1[0], pvec1[1], pvec1[2], masspion);
+      secvtx2prong(selIndices[i0][0],
+                   collision.posX(), collision.posY(), collision.posZ(),
+                   vtx[0], vtx[1], vtx[2], selIndices[i0][1],
+                   pvec0[0], pvec0[1], pvec0[2], selY[i0],
+                   selIndices[i1][1], pvec1[0], pvec1[1], pvec1[2], selY[i1],
+                   mass_, masssw_);
+      hchi2dca->Fill(df.getChi2AtPCACandidate());
+    });
   }
 };
 
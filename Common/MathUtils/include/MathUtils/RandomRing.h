@@ -29,7 +29,9 @@
 #define ALICEO2_MATHUTILS_RANDOMRING_H_
 
 #include "Vc/Vc"
+#include <algorithm>
 #include <array>
+#include <mutex>
 
 #include "TF1.h"
 #include "TRandom.h"
@@ -42,6 +44,13 @@ namespace o2
 namespace math_utils
 {
 
+/// the rings are filled from the global gRandom, which must not be used by several threads at once
+inline std::mutex& randomRingInitializationMutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
 template <size_t N = float_v::size() * 100000>
 class RandomRing
 {
@@ -102,6 +111,25 @@ class RandomRing
     return value;
   }
 
+  /// fill an array with the next random values
+  /// This function copies the values block-wise from the ring buffer
+  /// and increases the buffer position by the number of values
+  /// @param [out] values array to be filled
+  /// @param [in] n number of values
+  void fillNextValues(float* values, size_t n)
+  {
+    while (n > 0) {
+      const size_t nCopy = std::min(n, mRandomNumbers.size() - mRingPosition);
+      std::copy_n(&mRandomNumbers[mRingPosition], nCopy, values);
+      values += nCopy;
+      n -= nCopy;
+      mRingPosition += nCopy;
+      if (mRingPosition >= mRandomNumbers.size()) {
+        mRingPosition = 0;
+      }
+    }
+  }
+
   /// position in the ring buffer
   /// @return position in the ring buffer
   unsigned int getRingPosition() const { return mRingPosition; }
@@ -140,6 +168,7 @@ inline RandomRing<N>::RandomRing(TF1& function)
 template <size_t N>
 inline void RandomRing<N>::initialize(const RandomType randomType)
 {
+  std::lock_guard<std::mutex> lock(randomRingInitializationMutex());
 
   for (auto& v : mRandomNumbers) {
     // TODO: configurable mean and sigma
@@ -164,6 +193,7 @@ inline void RandomRing<N>::initialize(const RandomType randomType)
 template <size_t N>
 inline void RandomRing<N>::initialize(TF1& function)
 {
+  std::lock_guard<std::mutex> lock(randomRingInitializationMutex());
   mRandomType = RandomType::CustomTF1;
   for (auto& v : mRandomNumbers) {
     v = function.GetRandom();
@@ -174,6 +204,7 @@ inline void RandomRing<N>::initialize(TF1& function)
 template <size_t N>
 inline void RandomRing<N>::initialize(std::function<float()> function)
 {
+  std::lock_guard<std::mutex> lock(randomRingInitializationMutex());
   mRandomType = RandomType::CustomLambda;
   for (auto& v : mRandomNumbers) {
     v = function();
@@ -0,0 +1,78 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef ALICEO2_COMMONUTILS_THREADPOOL_H_
+#define ALICEO2_COMMONUTILS_THREADPOOL_H_
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace o2
+{
+namespace utils
+{
+
+/*
+ ThreadPool: a fixed number of persistent worker threads
+
+ Meant for algorithms processing many small work packages per call, where starting
+ threads for every call would cost more than the work itself.
+ Every call to run() executes the task once on each slot: slot 0 on the calling
+ thread, slots 1..N-1 on the workers, which are started by the constructor and
+ kept until the pool is destroyed. The slot index can be used to select per-thread
+ resources, the distribution of the work among the slots is up to the task.
+
+ ```C++
+  ThreadPool pool(nThreads);
+  std::atomic<int> next{0};
+  pool.run([&](int slot) {
+    for (int i = next++; i < n; i = next++) {
+      process(i, resources[slot]);
+    }
+  });
+ ```
+*/
+class ThreadPool
+{
+ public:
+  explicit ThreadPool(int nSlots);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// number of slots, including the calling thread
+  int getNSlots() const { return mThreads.size() + 1; }
+
+  /// run the task on every slot and wait for all of them; the first exception
+  /// thrown by the task is rethrown on the calling thread once all slots are done
+  void run(const std::function<void(int)>& task);
+
+ private:
+  void workerLoop(int slot);
+
+  std::vector<std::thread> mThreads;
+  std::vector<std::exception_ptr> mErrors; // one per slot
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  const std::function<void(int)>* mTask = nullptr;
+  int mRound = 0; // incremented by every call to run()
+  int mNBusy = 0; // workers still running the current round
+  bool mStop = false;
+};
+
+} // namespace utils
+} // namespace o2
+
+#endif
@@ -0,0 +1,90 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "CommonUtils/ThreadPool.h"
+
+using namespace o2::utils;
+
+ThreadPool::ThreadPool(int nSlots) : mErrors(nSlots > 1 ? nSlots : 1)
+{
+  for (int slot = 1; slot < nSlots; slot++) {
+    mThreads.emplace_back(&ThreadPool::workerLoop, this, slot);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondition.notify_all();
+  for (auto& t : mThreads) {
+    t.join();
+  }
+}
+
+void ThreadPool::run(const std::function<void(int)>& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTask = &task;
+    mRound++;
+    mNBusy = mThreads.size();
+  }
+  mCondition.notify_all();
+  try {
+    task(0);
+  } catch (...) {
+    mErrors[0] = std::current_exception();
+  }
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this] { return mNBusy == 0; });
+    mTask = nullptr;
+  }
+  // the workers are idle again: an exception must not leave a worker thread, report it here
+  for (auto& err : mErrors) {
+    if (err) {
+      auto first = err;
+      for (auto& e : mErrors) {
+        e = nullptr;
+      }
+      std::rethrow_exception(first);
+    }
+  }
+}
+
+void ThreadPool::workerLoop(int slot)
+{
+  int done = 0;
+  while (true) {
+    const std::function<void(int)>* task = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this, done] { return mStop || mRound != done; });
+      if (mStop) {
+        return;
+      }
+      done = mRound;
+      task = mTask;
+    }
+    try {
+      (*task)(slot);
+    } catch (...) {
+      mErrors[slot] = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mNBusy--;
+    }
+    mCondition.notify_all();
+  }
+}
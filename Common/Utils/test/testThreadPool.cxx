@@ -0,0 +1,65 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test ThreadPool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "CommonUtils/ThreadPool.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace o2;
+
+BOOST_AUTO_TEST_CASE(ThreadPool_test)
+{
+  const int nSlots = 4, n = 10000;
+  utils::ThreadPool pool(nSlots);
+  BOOST_CHECK_EQUAL(pool.getNSlots(), nSlots);
+
+  // the same workers are reused for many rounds, every item is processed exactly once
+  for (int round = 0; round < 100; round++) {
+    std::vector<int> done(n, 0);
+    std::vector<int> slotCalls(nSlots, 0);
+    std::atomic<int> next{0};
+    pool.run([&](int slot) {
+      slotCalls[slot]++;
+      for (int i = next++; i < n; i = next++) {
+        done[i]++;
+      }
+    });
+    for (int i = 0; i < n; i++) {
+      BOOST_REQUIRE_EQUAL(done[i], 1);
+    }
+    for (int slot = 0; slot < nSlots; slot++) {
+      BOOST_REQUIRE_EQUAL(slotCalls[slot], 1);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ThreadPoolException_test)
+{
+  utils::ThreadPool pool(3);
+  std::atomic<int> nCalls{0};
+  auto throwOnWorker = [&](int slot) {
+    nCalls++;
+    if (slot == 2) {
+      throw std::runtime_error("failure on a worker");
+    }
+  };
+  BOOST_CHECK_THROW(pool.run(throwOnWorker), std::runtime_error);
+  BOOST_CHECK_EQUAL(nCalls, 3);
+
+  // the error is reported once, the pool remains usable
+  nCalls = 0;
+  pool.run([&](int) { nCalls++; });
+  BOOST_CHECK_EQUAL(nCalls, 3);
+}
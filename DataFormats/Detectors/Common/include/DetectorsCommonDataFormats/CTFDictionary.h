@@ -0,0 +1,92 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CTFDictionary.h
+/// \brief External frequency tables for the entropy coding of EncodedBlocks
+
+#ifndef ALICEO2_CTF_DICTIONARY_H
+#define ALICEO2_CTF_DICTIONARY_H
+
+#include <Rtypes.h>
+#include <string>
+#include <vector>
+
+namespace o2
+{
+namespace ctf
+{
+
+/// frequency table for the symbols of a single EncodedBlocks slot, used instead of the dictionary stored with the block.
+/// It is trained by accumulating the histograms of the symbols of many messages and then finalized (rescaled).
+struct FrequencyTable {
+  static constexpr uint8_t MaxProbabilityBits = 25; // limit on the precision (size of decoder lookup tables)
+
+  int32_t min = 0;                   // 1st symbol covered by the finalized table
+  int32_t max = -1;                  // last symbol covered by the finalized table
+  uint8_t probabilityBits = 0;       // precision of the finalized frequencies, 0 if not finalized
+  uint8_t sourceBits = 0;            // largest precision of the accumulated frequencies
+  std::vector<uint32_t> frequencies; // finalized (rescaled) frequencies of symbols [min:max], all non-0
+  int32_t countsMin = 0;             // 1st symbol of the running histogram
+  std::vector<uint64_t> counts;      // running histogram of symbols [countsMin:countsMin+counts.size())
+
+  bool isFinalized() const { return probabilityBits > 0 && !frequencies.empty(); }
+
+  /// check if the finalized table can be used to encode the symbols in the range [smin:smax]
+  bool covers(int32_t smin, int32_t smax) const { return isFinalized() && smin >= min && smax <= max; }
+
+  /// add the histogram of nFreq symbols starting from fmin, with the frequencies in units of 2^fbits for the message of given length
+  void accumulate(const uint32_t* freq, int nFreq, int32_t fmin, size_t messageLength, uint8_t fbits);
+
+  /// rescale the running histogram to the frequencies with given precision, symbols never seen get the minimal frequency.
+  /// The range of the histogram is extended by a margin for the tails not seen in the training, as long as it fits the precision.
+  /// If bits == 0, the precision of the accumulated frequencies is used, increased if needed to accomodate the symbols range
+  bool finalize(uint8_t bits = 0);
+
+  ClassDefNV(FrequencyTable, 1);
+};
+
+/// set of frequency tables for the slots of the EncodedBlocks of given detector, referred by its ID in the ANSHeader
+class CTFDictionary
+{
+ public:
+  CTFDictionary() = default;
+  CTFDictionary(int nSlots) : mTables(nSlots) {}
+
+  uint32_t getID() const { return mID; }
+  int getNSlots() const { return mTables.size(); }
+  int getNUpdates() const { return mNUpdates; }
+
+  /// finalized table for the slot, nullptr if absent
+  const FrequencyTable* getTable(int slot) const { return (slot < getNSlots() && mTables[slot].isFinalized()) ? &mTables[slot] : nullptr; }
+  FrequencyTable& getTableToUpdate(int slot);
+
+  /// count the update of the running histograms by a new set of messages
+  void incrementUpdates() { mNUpdates++; }
+
+  /// finalize all tables to given precision (see FrequencyTable::finalize) and assign the ID (checksum of the finalized frequencies)
+  void finalize(uint8_t probabilityBits = 0);
+
+  void print() const;
+
+  static CTFDictionary* loadFrom(const std::string& fileName, const std::string& name);
+  void writeTo(const std::string& fileName, const std::string& name, const std::string& option = "update") const;
+
+ private:
+  uint32_t mID = 0; // 0 means not finalized
+  int mNUpdates = 0;
+  std::vector<FrequencyTable> mTables;
+
+  ClassDefNV(CTFDictionary, 1);
+};
+
+} // namespace ctf
+} // namespace o2
+
+#endif
@@ -17,11 +17,13 @@
 #define ALICEO2_ENCODED_BLOCKS_H
 
 #include <type_traits>
+#include <functional>
 #include <Rtypes.h>
 #include "rANS/rans.h"
 #include "TTree.h"
 #include "CommonUtils/StringUtils.h"
 #include "Framework/Logger.h"
+#include "DetectorsCommonDataFormats/CTFDictionary.h"
 
 namespace o2
 {
@@ -50,14 +52,23 @@ inline T* relocatePointer(const char* oldBase, char* newBase, const T* ptr)
   return (ptr != nullptr) ? reinterpret_cast<T*>(newBase + (reinterpret_cast<const char*>(ptr) - oldBase)) : nullptr;
 }
 
+/// run the function for every index in [0:n) using up to nThreads threads (serially, with a warning, if compiled w/o OpenMP);
+/// the first exception thrown by the function is rethrown after the loop
+void parallelFor(int n, int nThreads, const std::function<void(int)>& func);
+
 ///>>======================== Auxiliary classes =======================>>
 
 struct ANSHeader {
   uint8_t majorVersion;
   uint8_t minorVersion;
+  uint32_t dictID = 0; // ID of the external CTFDictionary used by the blocks stored w/o dictionary, 0 if none
 
-  void clear() { majorVersion = minorVersion = 0; }
-  ClassDefNV(ANSHeader, 1);
+  void clear()
+  {
+    majorVersion = minorVersion = 0;
+    dictID = 0;
+  }
+  ClassDefNV(ANSHeader, 2);
 };
 
 struct Metadata {
@@ -76,6 +87,10 @@ struct Metadata {
   int32_t max = 0;
   int nDictWords = 0;
   int nDataWords = 0;
+  int nChunks = 0;   // number of independently decodable chunks, 0 (old data) is equivalent to 1
+  int chunkSize = 0; // number of symbols per chunk (the last one may be shorter)
+
+  int getNChunks() const { return nChunks > 1 ? nChunks : 1; }
 
   void clear()
   {
@@ -85,8 +100,9 @@ struct Metadata {
     streamSize = 0;
     probabilityBits = 0;
     nDataWords = nDictWords = 0;
+    nChunks = chunkSize = 0;
   }
-  ClassDefNV(Metadata, 1);
+  ClassDefNV(Metadata, 2);
 };
 
 /// registry struct for the buffer start and offsets of writable space
@@ -125,15 +141,19 @@ struct Block {
 
   Registry* registry = nullptr; //! non-persistent info for in-memory ops
   int nDict = 0;                // dictionary length (if any)
-  int nStored = 0;              // total payload: data + dictionary length
+  int nIndex = 0;               // length of the index of chunk ends (if the data was encoded in chunks)
+  int nStored = 0;              // total payload: data + dictionary + index length
   W* payload = nullptr;         //[nStored];
 
-  W* getData() { return payload + nDict; }
+  W* getData() { return payload + nDict + nIndex; }
   W* getDict() { return nDict ? payload : nullptr; }
-  const W* getData() const { return payload + nDict; }
+  W* getIndex() { return nIndex ? payload + nDict : nullptr; }
+  const W* getData() const { return payload + nDict + nIndex; }
   const W* getDict() const { return nDict ? payload : nullptr; }
-  int getNData() const { return nStored - nDict; }
+  const W* getIndex() const { return nIndex ? payload + nDict : nullptr; }
+  int getNData() const { return nStored - nDict - nIndex; }
   int getNDict() const { return nDict; }
+  int getNIndex() const { return nIndex; }
 
   ~Block()
   {
@@ -145,32 +165,38 @@ struct Block {
   /// clear itself
   void clear()
   {
-    nDict = nStored = 0;
+    nDict = nIndex = nStored = 0;
     payload = nullptr;
   }
 
   /// estimate free size needed to add new block
-  static size_t estimateSize(int _ndict, int _ndata)
+  static size_t estimateSize(int _ndict, int _ndata, int _nindex = 0)
   {
-    return alignSize((_ndict + _ndata) * sizeof(W));
+    return alignSize((_ndict + _nindex + _ndata) * sizeof(W));
   }
 
-  /// store binary blob data (buffer filled from head to tail)
-  void store(int _ndict, int _ndata, const W* _dict, const W* _data)
+  /// store binary blob data (buffer filled from head to tail), layout: dictionary, chunks index, data
+  void store(int _ndict, int _ndata, const W* _dict, const W* _data, int _nindex = 0, const W* _index = nullptr)
   {
-    size_t sz = estimateSize(_ndict, _ndata);
+    size_t sz = estimateSize(_ndict, _ndata, _nindex);
     assert(registry); // this method is valid only for flat version, which has a registry
     assert(sz <= registry->getFreeSize());
     assert((_ndict > 0) == (_dict != nullptr));
     assert((_ndata > 0) == (_data != nullptr));
-    nStored = _ndict + _ndata;
+    assert((_nindex > 0) == (_index != nullptr));
+    nStored = _ndict + _nindex + _ndata;
     nDict = _ndict;
+    nIndex = _nindex;
     if (nStored) {
       auto ptr = payload = reinterpret_cast<W*>(registry->getFreeBlockStart());
       if (_dict) {
         memcpy(ptr, _dict, _ndict * sizeof(W));
         ptr += _ndict;
       }
+      if (_index) {
+        memcpy(ptr, _index, _nindex * sizeof(W));
+        ptr += _nindex;
+      }
       if (_data) {
         memcpy(ptr, _data, _ndata * sizeof(W));
       }
@@ -185,7 +211,7 @@ struct Block {
     registry = relocatePointer(oldHead, newHeadRegistry, registry);
   }
 
-  ClassDefNV(Block, 1);
+  ClassDefNV(Block, 2);
 };
 
 ///<<======================== Auxiliary classes =======================<<
@@ -225,7 +251,7 @@ class EncodedBlocks
   static auto create(VD& v);
 
   /// estimate free size needed to add new block
-  static size_t estimateBlockSize(int _ndict, int _ndata) { return Block<W>::estimateSize(_ndict, _ndata); }
+  static size_t estimateBlockSize(int _ndict, int _ndata, int _nindex = 0) { return Block<W>::estimateSize(_ndict, _ndata, _nindex); }
 
   /// check if empty and valid
   bool empty() const { return (mRegistry.offsFreeStart == alignSize(sizeof(*this))) && (mRegistry.size >= mRegistry.offsFreeStart); }
@@ -268,22 +294,39 @@ class EncodedBlocks
 
   /// encode vector src to bloc at provided slot
   template <typename VE, typename VB>
-  inline void encode(const VE& src, int slot, uint8_t probabilityBits, Metadata::OptStore opt, VB* buffer = nullptr)
+  inline void encode(const VE& src, int slot, uint8_t probabilityBits, Metadata::OptStore opt, VB* buffer = nullptr, const CTFDictionary* dict = nullptr,
+                     int chunkSize = 0, int nThreads = 1)
   {
-    encode(&(*src.begin()), &(*src.end()), slot, probabilityBits, opt, buffer);
+    encode(&(*src.begin()), &(*src.end()), slot, probabilityBits, opt, buffer, dict, chunkSize, nThreads);
   }
 
-  /// encode vector src to bloc at provided slot
+  /// encode vector src to bloc at provided slot. If the external dictionary is provided and its table for this slot
+  /// covers the range of the source symbols, it is used instead of the statistics of the data and is not stored with the block.
+  /// Sources longer than chunkSize (if > 0) are encoded as independently decodable chunks, using up to nThreads threads
   template <typename S, typename VB>
-  void encode(const S* const srcBegin, const S* const srcEnd, int slot, uint8_t probabilityBits, Metadata::OptStore opt, VB* buffer = nullptr);
+  void encode(const S* const srcBegin, const S* const srcEnd, int slot, uint8_t probabilityBits, Metadata::OptStore opt, VB* buffer = nullptr, const CTFDictionary* dict = nullptr,
+              int chunkSize = 0, int nThreads = 1);
 
-  /// decode block at provided slot to destination vector (will be resized as needed)
+  /// decode block at provided slot to destination vector (will be resized as needed), the chunks (if any) are decoded with up to nThreads threads
   template <typename VD>
-  void decode(VD& dest, int slot) const;
+  void decode(VD& dest, int slot, const CTFDictionary* dict = nullptr, int nThreads = 1) const;
 
   /// decode block at provided slot to destination pointer, the needed space assumed to be available
   template <typename D>
-  void decode(D* dest, int slot) const;
+  void decode(D* dest, int slot, const CTFDictionary* dict = nullptr, int nThreads = 1) const;
+
+  /// decode single chunk of the block at provided slot to destination pointer (chunk start), the needed space assumed to be available
+  template <typename D>
+  void decodeChunk(D* dest, int slot, int chunk, const CTFDictionary* dict = nullptr) const;
+
+  /// add the dictionaries stored with the blocks to the running histograms of the external dictionary
+  void updateDictionary(CTFDictionary& dict) const;
+
+  /// number of independently decodable chunks of the block at provided slot
+  int getNChunks(int slot) const { return mMetadata[slot].getNChunks(); }
+
+  /// number of symbols of given chunk of the block at provided slot
+  size_t getChunkLength(int slot, int chunk) const;
 
   /// print itself
   void print() const;
@@ -316,6 +359,9 @@ class EncodedBlocks
   /// Create its own flat copy in the destination empty flat object
   void fillFlatCopy(EncodedBlocks& dest) const;
 
+  /// symbol statistics needed to decode the block at provided slot, from the stored or external dictionary
+  o2::rans::SymbolStatistics getDecoderStatistics(int slot, const CTFDictionary* dict) const;
+
   /// add and fill single branch
   template <typename D>
   static void fillTreeBranch(TTree& tree, const std::string& brname, D& dt, int compLevel, int splitLevel = 99);
@@ -334,7 +380,7 @@ void EncodedBlocks<H, N, W>::readFromTree(TTree& tree, const std::string& name,
 {
   readTreeBranch(tree, o2::utils::concat_string(name, "_wrapper."), *this, ev);
   for (int i = 0; i < N; i++) {
-    readTreeBranch(tree, o2::utils::concat_string(name, "_block.", std::to_string(i), "."), mBlocks[i]);
+    readTreeBranch(tree, o2::utils::concat_string(name, "_block.", std::to_string(i), "."), mBlocks[i], ev);
   }
 }
 
@@ -349,8 +395,8 @@ void EncodedBlocks<H, N, W>::readFromTree(VD& vec, TTree& tree, const std::strin
   tmp = tmp->expand(vec, tmp->estimateSizeFromMetadata());
   for (int i = 0; i < N; i++) {
     Block<W> bl;
-    readTreeBranch(tree, o2::utils::concat_string(name, "_block.", std::to_string(i), "."), bl);
-    tmp->mBlocks[i].store(bl.getNDict(), bl.getNData(), bl.getDict(), bl.getData());
+    readTreeBranch(tree, o2::utils::concat_string(name, "_block.", std::to_string(i), "."), bl, ev);
+    tmp->mBlocks[i].store(bl.getNDict(), bl.getNData(), bl.getDict(), bl.getData(), bl.getNIndex(), bl.getIndex());
   }
 }
 
@@ -381,14 +427,22 @@ inline void EncodedBlocks<H, N, W>::readTreeBranch(TTree& tree, const std::strin
 }
 
 ///_____________________________________________________________________________
-/// add and fill single branch
+/// add and fill single branch, the branch is reused if the tree already has it (several CTFs per tree)
 template <typename H, int N, typename W>
 template <typename D>
 inline void EncodedBlocks<H, N, W>::fillTreeBranch(TTree& tree, const std::string& brname, D& dt, int compLevel, int splitLevel)
 {
-  auto* br = tree.Branch(brname.c_str(), &dt, 512, splitLevel);
-  br->SetCompressionLevel(compLevel);
-  br->Fill();
+  auto* br = tree.GetBranch(brname.c_str());
+  if (br) {
+    auto* ptr = &dt;
+    br->SetAddress(&ptr);
+    br->Fill();
+  } else {
+    br = tree.Branch(brname.c_str(), &dt, 512, splitLevel);
+    br->SetCompressionLevel(compLevel);
+    br->Fill();
+  }
+  br->ResetAddress();
 }
 
 ///_____________________________________________________________________________
@@ -401,7 +455,7 @@ void EncodedBlocks<H, N, W>::fillFlatCopy(EncodedBlocks& dest) const
   dest.mHeader = mHeader;
   dest.mMetadata = mMetadata;
   for (int i = 0; i < N; i++) {
-    dest.mBlocks[i].store(mBlocks[i].getNDict(), mBlocks[i].getNData(), mBlocks[i].getDict(), mBlocks[i].getData());
+    dest.mBlocks[i].store(mBlocks[i].getNDict(), mBlocks[i].getNData(), mBlocks[i].getDict(), mBlocks[i].getData(), mBlocks[i].getNIndex(), mBlocks[i].getIndex());
   }
 }
 
@@ -438,7 +492,8 @@ size_t EncodedBlocks<H, N, W>::estimateSizeFromMetadata() const
 {
   size_t sz = alignSize(sizeof(*this));
   for (int i = 0; i < N; i++) {
-    sz += alignSize((mMetadata[i].nDictWords + mMetadata[i].nDataWords) * sizeof(W));
+    int nIndexWords = mMetadata[i].nChunks > 1 ? mMetadata[i].nChunks : 0;
+    sz += alignSize((mMetadata[i].nDictWords + nIndexWords + mMetadata[i].nDataWords) * sizeof(W));
   }
   return sz;
 }
@@ -549,25 +604,30 @@ void EncodedBlocks<H, N, W>::print() const
 {
   LOG(INFO) << "Container " << N << " blocks, size: " << size() << " bytes, unused: " << getFreeSize();
   for (int i = 0; i < N; i++) {
-    LOG(INFO) << "Block " << i << " NDictWords: " << mBlocks[i].getNDict() << " NDataWords: " << mBlocks[i].getNData();
+    LOG(INFO) << "Block " << i << " NDictWords: " << mBlocks[i].getNDict() << " NDataWords: " << mBlocks[i].getNData()
+              << " NChunks: " << mMetadata[i].getNChunks();
   }
 }
 
 ///_____________________________________________________________________________
 template <typename H, int N, typename W>
 template <typename VD>
-inline void EncodedBlocks<H, N, W>::decode(VD& dest,       // destination container
-                                           int slot) const // slot of the block to decode
+inline void EncodedBlocks<H, N, W>::decode(VD& dest,                        // destination container
+                                           int slot,                        // slot of the block to decode
+                                           const CTFDictionary* dict,       // optional external dictionary
+                                           int nThreads) const              // max number of threads to decode the chunks
 {
   dest.resize(mMetadata[slot].messageLength); // allocate output buffer
-  decode(dest.data(), slot);
+  decode(dest.data(), slot, dict, nThreads);
 }
 
 ///_____________________________________________________________________________
 template <typename H, int N, typename W>
 template <typename D>
-void EncodedBlocks<H, N, W>::decode(D* dest,        // destination pointer
-                                    int slot) const // slot of the block to decode
+void EncodedBlocks<H, N, W>::decode(D* dest,                        // destination pointer
+                                    int slot,                       // slot of the block to decode
+                                    const CTFDictionary* dict,      // optional external dictionary
+                                    int nThreads) const             // max number of threads to decode the chunks
 {
   // get references to the right data
   const auto& block = mBlocks[slot];
@@ -576,16 +636,92 @@ void EncodedBlocks<H, N, W>::decode(D* dest,        // destination pointer
   // decode
   if (block.getNData()) {
     if (md.opt == Metadata::OptStore::EENCODE) {
-      assert(block.getNDict()); // at the moment we expect to have dictionary
-      o2::rans::SymbolStatistics stats(block.getDict(), block.getDict() + block.getNDict(), md.min, md.max, md.messageLength);
+      auto stats = getDecoderStatistics(slot, dict);
       o2::rans::Decoder64<D> decoder(stats, md.probabilityBits);
-      decoder.process(dest, block.getData(), md.messageLength);
+      const int nChunks = md.getNChunks();
+      if (nChunks == 1) {
+        decoder.process(dest, block.getData(), md.messageLength);
+      } else { // chunks share the decoder and are decoded independently
+        const auto* index = block.getIndex();
+        parallelFor(nChunks, nThreads, [&](int ic) {
+          decoder.process(dest + size_t(ic) * md.chunkSize, block.getData() + (ic ? index[ic - 1] : 0), getChunkLength(slot, ic));
+        });
+      }
     } else { // data was stored as is
       std::memcpy(dest, block.payload, md.messageLength * sizeof(D));
     }
   }
 }
 
+///_____________________________________________________________________________
+template <typename H, int N, typename W>
+template <typename D>
+void EncodedBlocks<H, N, W>::decodeChunk(D* dest,                         // destination pointer
+                                         int slot,                        // slot of the block to decode
+                                         int chunk,                       // chunk of the block to decode
+                                         const CTFDictionary* dict) const // optional external dictionary
+{
+  const auto& block = mBlocks[slot];
+  const auto& md = mMetadata[slot];
+  assert(chunk >= 0 && chunk < md.getNChunks());
+
+  if (block.getNData()) {
+    if (md.opt == Metadata::OptStore::EENCODE) {
+      auto stats = getDecoderStatistics(slot, dict);
+      const auto* start = block.getData() + (chunk ? block.getIndex()[chunk - 1] : 0);
+      o2::rans::Decoder64<D> decoder(stats, md.probabilityBits);
+      decoder.process(dest, start, getChunkLength(slot, chunk));
+    } else { // data was stored as is, in a single chunk
+      std::memcpy(dest, block.payload, md.messageLength * sizeof(D));
+    }
+  }
+}
+
+///_____________________________________________________________________________
+template <typename H, int N, typename W>
+o2::rans::SymbolStatistics EncodedBlocks<H, N, W>::getDecoderStatistics(int slot, const CTFDictionary* dict) const
+{
+  const auto& block = mBlocks[slot];
+  const auto& md = mMetadata[slot];
+  if (block.getNDict()) {
+    return o2::rans::SymbolStatistics(block.getDict(), block.getDict() + block.getNDict(), md.min, md.max, md.messageLength);
+  }
+  // block was encoded with external dictionary
+  if (!dict || dict->getID() != mANSHeader.dictID) {
+    throw std::runtime_error(o2::utils::concat_string("block ", slot, " needs external dictionary ", mANSHeader.dictID, ", provided: ", dict ? dict->getID() : 0));
+  }
+  const auto* tbl = dict->getTable(slot);
+  if (!tbl || tbl->min != md.min || tbl->max != md.max || tbl->probabilityBits != md.probabilityBits) {
+    throw std::runtime_error(o2::utils::concat_string("external dictionary ", dict->getID(), " table for block ", slot, " does not match its metadata"));
+  }
+  return o2::rans::SymbolStatistics(tbl->frequencies.begin(), tbl->frequencies.end(), md.min, md.max, md.messageLength);
+}
+
+///_____________________________________________________________________________
+template <typename H, int N, typename W>
+void EncodedBlocks<H, N, W>::updateDictionary(CTFDictionary& dict) const
+{
+  for (int slot = 0; slot < N; slot++) {
+    const auto& block = mBlocks[slot];
+    const auto& md = mMetadata[slot];
+    if (md.opt == Metadata::OptStore::EENCODE && block.getNDict()) {
+      dict.getTableToUpdate(slot).accumulate(block.getDict(), block.getNDict(), md.min, md.messageLength, md.probabilityBits);
+    }
+  }
+  dict.incrementUpdates();
+}
+
+///_____________________________________________________________________________
+template <typename H, int N, typename W>
+size_t EncodedBlocks<H, N, W>::getChunkLength(int slot, int chunk) const
+{
+  const auto& md = mMetadata[slot];
+  if (md.getNChunks() == 1) {
+    return md.messageLength;
+  }
+  return std::min(size_t(md.chunkSize), md.messageLength - size_t(chunk) * md.chunkSize);
+}
+
 ///_____________________________________________________________________________
 template <typename H, int N, typename W>
 template <typename S, typename VB>
@@ -594,7 +730,10 @@ void EncodedBlocks<H, N, W>::encode(const S* const srcBegin, // begin of source
                                     int slot,                // slot in encoded data to fill
                                     uint8_t probabilityBits, // encoding into
                                     Metadata::OptStore opt,  // option for data compression
-                                    VB* buffer)              // optional buffer (vector) providing memory for encoded blocks
+                                    VB* buffer,              // optional buffer (vector) providing memory for encoded blocks
+                                    const CTFDictionary* dict, // optional external dictionary
+                                    int chunkSize,           // max number of symbols per independently decodable chunk, 0: no chunking
+                                    int nThreads)            // max number of threads to encode the chunks
 {
 
   // symbol statistics and encoding
@@ -602,26 +741,72 @@ void EncodedBlocks<H, N, W>::encode(const S* const srcBegin, // begin of source
   mRegistry.nFilledBlocks++;
   using stream_t = typename o2::rans::Encoder64<S>::stream_t;
   if (srcBegin == srcEnd) {
-    mMetadata[slot] = Metadata{0, sizeof(uint64_t), sizeof(stream_t), probabilityBits, Metadata::OptStore::NODATA, 0, 0, 0, 0};
+    mMetadata[slot] = Metadata{0, sizeof(uint64_t), sizeof(stream_t), probabilityBits, Metadata::OptStore::NODATA, 0, 0, 0, 0, 0, 0};
     return;
   }
   std::vector<stream_t> encoderBuffer;
+  std::vector<stream_t> chunksIndex; // end of every chunk of encoded data wrt the data start, in words
   static_assert(std::is_same<W, stream_t>());
   stream_t* encodedMessageStart = nullptr;
   const stream_t* dictStart = nullptr;
-  int dictSize = 0, dataSize = 0;
-  o2::rans::SymbolStatistics stats{srcBegin, srcEnd}; // need to create it, even if not used
+  int dictSize = 0, dataSize = 0, nChunks = 0;
+  const FrequencyTable* extTable = nullptr;
+  if (opt == Metadata::OptStore::EENCODE && dict && (extTable = dict->getTable(slot))) {
+    const auto minmax = std::minmax_element(srcBegin, srcEnd);
+    if (extTable->covers(*minmax.first, *minmax.second)) {
+      if (mANSHeader.dictID && mANSHeader.dictID != dict->getID()) {
+        throw std::runtime_error(o2::utils::concat_string("container already refers to dictionary ", mANSHeader.dictID, ", cannot use ", dict->getID()));
+      }
+      mANSHeader.dictID = dict->getID(); // will be copied on expansion
+      probabilityBits = extTable->probabilityBits;
+    } else { // data symbols are not covered by the dictionary, build statistics from the data
+      extTable = nullptr;
+    }
+  }
+  // statistics are built from the data only if needed (they are used to store the data w/o EEncoding)
+  auto stats = extTable ? o2::rans::SymbolStatistics(extTable->frequencies.begin(), extTable->frequencies.end(), extTable->min, extTable->max, srcEnd - srcBegin)
+                        : o2::rans::SymbolStatistics(srcBegin, srcEnd);
   if (opt == Metadata::OptStore::EENCODE) {
-    stats.rescaleToNBits(probabilityBits);
-    const auto buffSize = o2::rans::calculateMaxBufferSize(stats.getMessageLength(),
+    if (!extTable) {
+      stats.rescaleToNBits(probabilityBits);
+    }
+    const size_t messageLength = stats.getMessageLength();
+    size_t chunkLength = messageLength;
+    if (chunkSize > 0 && messageLength > size_t(chunkSize)) {
+      chunkLength = chunkSize;
+      nChunks = (messageLength + chunkSize - 1) / chunkSize;
+    }
+    const auto buffSize = o2::rans::calculateMaxBufferSize(chunkLength,
                                                            stats.getAlphabetRangeBits(),
                                                            sizeof(S));
-    encoderBuffer.resize(buffSize);
     const o2::rans::Encoder64<S> encoder{stats, probabilityBits};
-    encodedMessageStart = &(*encoder.process(encoderBuffer.begin(), encoderBuffer.end(), srcBegin, srcEnd));
-    dictStart = stats.getFrequencyTable().data();
-    dictSize = stats.getFrequencyTable().size();
-    dataSize = &(*encoderBuffer.end()) - encodedMessageStart; // number of elements to store
+    if (!nChunks) {
+      encoderBuffer.resize(buffSize);
+      encodedMessageStart = &(*encoder.process(encoderBuffer.begin(), encoderBuffer.end(), srcBegin, srcEnd));
+      dataSize = &(*encoderBuffer.end()) - encodedMessageStart; // number of elements to store
+    } else { // the chunks share the encoder and are encoded independently, then concatenated
+      std::vector<std::vector<stream_t>> chunkBuffers(nChunks);
+      std::vector<const stream_t*> chunkStarts(nChunks);
+      parallelFor(nChunks, nThreads, [&](int ic) {
+        auto& buff = chunkBuffers[ic];
+        buff.resize(buffSize);
+        const auto* chunkBegin = srcBegin + size_t(ic) * chunkSize;
+        const auto* chunkEnd = std::min(chunkBegin + chunkSize, srcEnd);
+        chunkStarts[ic] = &(*encoder.process(buff.begin(), buff.end(), chunkBegin, chunkEnd));
+      });
+      chunksIndex.resize(nChunks);
+      for (int ic = 0; ic < nChunks; ic++) {
+        const stream_t* chunkEnd = chunkBuffers[ic].data() + chunkBuffers[ic].size();
+        encoderBuffer.insert(encoderBuffer.end(), chunkStarts[ic], chunkEnd);
+        chunksIndex[ic] = encoderBuffer.size();
+      }
+      dataSize = encoderBuffer.size();
+      encodedMessageStart = encoderBuffer.data();
+    }
+    if (!extTable) {
+      dictStart = stats.getFrequencyTable().data();
+      dictSize = stats.getFrequencyTable().size();
+    }
   } else {                                                    // store original data w/o EEncoding
     auto szb = (srcEnd - srcBegin) * sizeof(S);
     dataSize = szb / sizeof(stream_t) + (sizeof(S) < sizeof(stream_t));
@@ -629,7 +814,7 @@ void EncodedBlocks<H, N, W>::encode(const S* const srcBegin, // begin of source
     memcpy(encoderBuffer.data(), srcBegin, szb);
     encodedMessageStart = &(*encoderBuffer.begin());
   }
-  auto szNeed = estimateBlockSize(dictSize, dataSize); // size in bytes!!!
+  auto szNeed = estimateBlockSize(dictSize, dataSize, chunksIndex.size()); // size in bytes!!!
   auto* bl = &mBlocks[slot];
   auto* meta = &mMetadata[slot];
   if (szNeed >= getFreeSize()) {
@@ -643,8 +828,8 @@ void EncodedBlocks<H, N, W>::encode(const S* const srcBegin, // begin of source
     }
   }
   *meta = Metadata{stats.getMessageLength(), sizeof(uint64_t), sizeof(stream_t), probabilityBits, opt,
-                   stats.getMinSymbol(), stats.getMaxSymbol(), dictSize, dataSize};
-  bl->store(dictSize, dataSize, dictStart, encodedMessageStart);
+                   stats.getMinSymbol(), stats.getMaxSymbol(), dictSize, dataSize, nChunks, nChunks ? chunkSize : 0};
+  bl->store(dictSize, dataSize, dictStart, encodedMessageStart, chunksIndex.size(), chunksIndex.empty() ? nullptr : chunksIndex.data());
 }
 
 } // namespace ctf
@@ -0,0 +1,35 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file EncodedBlocksParam.h
+/// \brief Configurable settings of the entropy coding of EncodedBlocks
+
+#ifndef ALICEO2_ENCODED_BLOCKS_PARAM_H
+#define ALICEO2_ENCODED_BLOCKS_PARAM_H
+
+#include "CommonUtils/ConfigurableParam.h"
+#include "CommonUtils/ConfigurableParamHelper.h"
+
+namespace o2
+{
+namespace ctf
+{
+
+struct EncodedBlocksParam : public o2::conf::ConfigurableParamHelper<EncodedBlocksParam> {
+  int chunkSize = 0; ///< messages longer than this number of symbols are coded as independently decodable chunks, 0: never split
+  int nThreads = 1;  ///< number of threads used to encode/decode the chunks of a message
+
+  O2ParamDef(EncodedBlocksParam, "EncodedBlocks");
+};
+
+} // namespace ctf
+} // namespace o2
+
+#endif
@@ -84,8 +84,14 @@ class NameConf
   // CTF tree name
   static constexpr std::string_view CTFTREENAME = "ctf"; // hardcoded
 
+  // Index of CTFs stored in the CTF file (vector of CTFHeaders, one per tree entry)
+  static constexpr std::string_view CTFINDEXNAME = "ctfIndex"; // hardcoded
+
   // CTF Filename
-  static std::string getCTFFileName(long id, const std::string_view prefix = "o2_ctf");
+  static std::string getCTFFileName(long id, const std::string_view prefix = "o2_ctf", const std::string_view ext = ".root");
+
+  // File with external CTF dictionaries (one object per detector, named by the detector name)
+  static constexpr std::string_view CTFDICTFILENAME = "ctf_dictionary.root"; // hardcoded
 
  private:
   // unmodifiable constants used to construct filenames etc
@@ -0,0 +1,154 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include <algorithm>
+#include <stdexcept>
+#include <TFile.h>
+#include "DetectorsCommonDataFormats/CTFDictionary.h"
+#include "CommonUtils/StringUtils.h"
+#include "rANS/rans.h"
+#include "Framework/Logger.h"
+
+using namespace o2::ctf;
+
+///_____________________________________________________________________________
+void FrequencyTable::accumulate(const uint32_t* freq, int nFreq, int32_t fmin, size_t messageLength, uint8_t fbits)
+{
+  if (!nFreq) {
+    return;
+  }
+  int32_t fmax = fmin + nFreq - 1;
+  if (counts.empty()) {
+    countsMin = fmin;
+    counts.resize(nFreq, 0);
+  } else if (fmin < countsMin || fmax >= countsMin + int32_t(counts.size())) { // extend the range
+    int32_t newMin = std::min(countsMin, fmin), newMax = std::max(countsMin + int32_t(counts.size()) - 1, fmax);
+    std::vector<uint64_t> newCounts(newMax - newMin + 1, 0);
+    std::copy(counts.begin(), counts.end(), newCounts.begin() + (countsMin - newMin));
+    counts.swap(newCounts);
+    countsMin = newMin;
+  }
+  sourceBits = std::max(sourceBits, fbits);
+  auto* cnt = counts.data() + (fmin - countsMin);
+  for (int i = 0; i < nFreq; i++) {
+    if (freq[i]) { // convert the frequency back to the number of occurrences, keeping rare symbols
+      cnt[i] += std::max(uint64_t(1), (uint64_t(freq[i]) * messageLength) >> fbits);
+    }
+  }
+}
+
+///_____________________________________________________________________________
+bool FrequencyTable::finalize(uint8_t bits)
+{
+  probabilityBits = 0;
+  frequencies.clear();
+  if (counts.empty()) {
+    return false;
+  }
+  if (!bits) {
+    bits = sourceBits;
+    while (counts.size() > o2::rans::bitsToRange(bits)) {
+      bits++;
+    }
+  }
+  if (bits > MaxProbabilityBits || counts.size() > o2::rans::bitsToRange(bits)) {
+    LOG(WARNING) << "Range of " << counts.size() << " symbols from " << countsMin << " cannot be represented with " << int(bits) << " bits";
+    return false;
+  }
+  uint64_t total = 0;
+  for (auto c : counts) {
+    total += c;
+  }
+  int margin = std::min((o2::rans::bitsToRange(bits) - counts.size()) / 2, counts.size() / 8);
+  min = countsMin - margin;
+  max = countsMin + int32_t(counts.size()) - 1 + margin;
+  // bring the counts to 32 bits, every symbol of the range must stay encodable
+  uint64_t scale = (total >> 31) + 1;
+  std::vector<uint32_t> tbl(max - min + 1, 1);
+  size_t sum = 2 * margin;
+  for (size_t i = 0; i < counts.size(); i++) {
+    tbl[i + margin] = std::max(uint64_t(1), counts[i] / scale);
+    sum += tbl[i + margin];
+  }
+  o2::rans::SymbolStatistics stats(tbl.begin(), tbl.end(), min, max, sum);
+  stats.rescaleToNBits(bits);
+  frequencies = stats.getFrequencyTable();
+  probabilityBits = bits;
+  return true;
+}
+
+///_____________________________________________________________________________
+FrequencyTable& CTFDictionary::getTableToUpdate(int slot)
+{
+  if (slot >= getNSlots()) {
+    mTables.resize(slot + 1);
+  }
+  return mTables[slot];
+}
+
+///_____________________________________________________________________________
+void CTFDictionary::finalize(uint8_t probabilityBits)
+{
+  // FNV-1a hash of the finalized tables
+  uint32_t hash = 2166136261u;
+  auto add = [&hash](uint32_t v) {
+    hash = (hash ^ v) * 16777619u;
+  };
+  for (auto& tbl : mTables) {
+    if (tbl.finalize(probabilityBits)) {
+      add(tbl.min);
+      add(tbl.probabilityBits);
+      for (auto f : tbl.frequencies) {
+        add(f);
+      }
+    } else {
+      add(0);
+    }
+  }
+  mID = hash ? hash : 1;
+}
+
+///_____________________________________________________________________________
+void CTFDictionary::print() const
+{
+  LOG(INFO) << "CTF dictionary ID " << mID << " for " << getNSlots() << " slots from " << mNUpdates << " updates";
+  for (int i = 0; i < getNSlots(); i++) {
+    const auto& tbl = mTables[i];
+    LOG(INFO) << "Slot " << i << " symbols [" << tbl.min << ':' << tbl.max << "] " << (tbl.isFinalized() ? "finalized" : "not finalized")
+              << ", trained on " << tbl.counts.size() << " symbols from " << tbl.countsMin;
+  }
+}
+
+///_____________________________________________________________________________
+CTFDictionary* CTFDictionary::loadFrom(const std::string& fileName, const std::string& name)
+{
+  TFile fl(fileName.data());
+  if (fl.IsZombie()) {
+    LOG(ERROR) << "Failed to open " << fileName;
+    throw std::runtime_error("Failed to open CTF dictionary file");
+  }
+  auto dict = reinterpret_cast<CTFDictionary*>(fl.GetObjectChecked(name.data(), TClass::GetClass(typeid(CTFDictionary))));
+  if (!dict) {
+    LOG(ERROR) << "Did not find CTF dictionary named " << name << " in " << fileName;
+    throw std::runtime_error("Failed to load CTF dictionary");
+  }
+  return dict;
+}
+
+///_____________________________________________________________________________
+void CTFDictionary::writeTo(const std::string& fileName, const std::string& name, const std::string& option) const
+{
+  TFile fl(fileName.data(), option.data());
+  if (fl.IsZombie()) {
+    throw std::runtime_error(o2::utils::concat_string("Failed to open CTF dictionary file ", fileName));
+  }
+  fl.WriteObjectAny(this, TClass::GetClass(typeid(CTFDictionary)), name.data(), "Overwrite");
+  fl.Close();
+}
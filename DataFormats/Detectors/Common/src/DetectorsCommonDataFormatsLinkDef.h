@@ -26,11 +26,17 @@
 #pragma link C++ class o2::base::NameConf + ;
 
 #pragma link C++ class o2::ctf::CTFHeader + ;
+#pragma link C++ class std::vector < o2::ctf::CTFHeader> + ;
 #pragma link C++ class o2::ctf::Registry + ;
 #pragma link C++ class o2::ctf::Block < uint32_t> + ;
 #pragma link C++ class o2::ctf::Block < uint16_t> + ;
 #pragma link C++ class o2::ctf::Block < uint8_t> + ;
 #pragma link C++ class o2::ctf::Metadata + ;
 #pragma link C++ class o2::ctf::ANSHeader + ;
+#pragma link C++ class o2::ctf::FrequencyTable + ;
+#pragma link C++ class std::vector < o2::ctf::FrequencyTable> + ;
+#pragma link C++ class o2::ctf::CTFDictionary + ;
+#pragma link C++ class o2::ctf::EncodedBlocksParam + ;
+#pragma link C++ class o2::conf::ConfigurableParamHelper < o2::ctf::EncodedBlocksParam> + ;
 
 #endif
@@ -10,4 +10,49 @@
 
 #include "DetectorsCommonDataFormats/EncodedBlocks.h"
 
+#include <exception>
+#include <mutex>
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace o2::ctf;
+
+///_____________________________________________________________________________
+/// run the function for every index in [0:n) using up to nThreads threads,
+/// the first exception thrown by the function is rethrown once all indices are done
+void o2::ctf::parallelFor(int n, int nThreads, const std::function<void(int)>& func)
+{
+  std::exception_ptr error;
+#ifdef WITH_OPENMP
+  std::mutex errorMutex;
+  nThreads = std::max(1, std::min(nThreads, n));
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+  for (int i = 0; i < n; i++) {
+    // an exception must not escape the parallel region
+    try {
+      func(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+#else
+  if (nThreads > 1) {
+    static std::once_flag warned;
+    std::call_once(warned, [nThreads]() { LOG(WARNING) << "Built without OpenMP support, the requested " << nThreads << " threads are ignored and the chunks are processed serially"; });
+  }
+  for (int i = 0; i < n && !error; i++) {
+    try {
+      func(i);
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+#endif
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
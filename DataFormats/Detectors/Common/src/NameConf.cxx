@@ -61,7 +61,7 @@ std::string NameConf::getDictionaryFileName(DId det, const std::string_view pref
   return o2::utils::concat_string(prefix, det.getName(), DICTFILENAME, ext);
 }
 
-std::string NameConf::getCTFFileName(long id, const std::string_view prefix)
+std::string NameConf::getCTFFileName(long id, const std::string_view prefix, const std::string_view ext)
 {
-  return o2::utils::concat_string(prefix, "_", fmt::format("{:010d}", id), ".root");
+  return o2::utils::concat_string(prefix, "_", fmt::format("{:010d}", id), ext);
 }
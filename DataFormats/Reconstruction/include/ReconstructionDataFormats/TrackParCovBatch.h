@@ -0,0 +1,449 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TrackParCovBatch.h
+/// \brief Structure of arrays of W tracks with params and covariance, processed in lanes
+
+#ifndef ALICEO2_BASE_TRACKPARCOVBATCH
+#define ALICEO2_BASE_TRACKPARCOVBATCH
+
+#include "ReconstructionDataFormats/Track.h"
+
+namespace o2
+{
+namespace track
+{
+
+/// W space points with their covariance, to be used with the TrackParCovBatch<W>
+template <int W>
+struct PointBatch {
+  alignas(64) float y[W] = {0.f};
+  alignas(64) float z[W] = {0.f};
+  alignas(64) float sigY2[W] = {0.f};
+  alignas(64) float sigYZ[W] = {0.f};
+  alignas(64) float sigZ2[W] = {0.f};
+
+  void set(int lane, const std::array<float, 2>& p, const std::array<float, 3>& cov)
+  {
+    y[lane] = p[0];
+    z[lane] = p[1];
+    sigY2[lane] = cov[0];
+    sigYZ[lane] = cov[1];
+    sigZ2[lane] = cov[2];
+  }
+
+  template <typename T>
+  void set(int lane, const BaseCluster<T>& p)
+  {
+    set(lane, {p.getY(), p.getZ()}, {p.getSigmaY2(), p.getSigmaYZ(), p.getSigmaZ2()});
+  }
+};
+
+/// W tracks stored as a structure of arrays. The methods apply the operation of the corresponding
+/// TrackParCov method to all the lanes at once, with the branches replaced by per lane selections,
+/// so that the loops over the lanes are vectorized by the compiler. The arithmetic (including the
+/// use of double precision) is the same as in the TrackParCov methods, the results agree within the
+/// float precision. Lanes for which the operation fails are left unchanged and flagged by 0 in the returned mask.
+/// N.B.: the loops are vectorized only if the math functions do not set errno and the FP operations are not
+/// assumed to trap (-fno-math-errno -fno-trapping-math), otherwise they are executed lane by lane.
+template <int W>
+class TrackParCovBatch
+{
+ public:
+  static constexpr int Width = W;
+  using Mask = std::array<int, W>;
+  using Values = std::array<float, W>;
+
+  TrackParCovBatch() = default;
+
+  void set(int lane, const TrackParCov& trc)
+  {
+    mX[lane] = trc.getX();
+    mAlpha[lane] = trc.getAlpha();
+    for (int i = 0; i < kNParams; i++) {
+      mP[i][lane] = trc.getParam(i);
+    }
+    for (int i = 0; i < kCovMatSize; i++) {
+      mC[i][lane] = trc.getCov()[i];
+    }
+  }
+
+  void get(int lane, TrackParCov& trc) const
+  {
+    trc.setX(mX[lane]);
+    trc.setAlpha(mAlpha[lane]);
+    for (int i = 0; i < kNParams; i++) {
+      trc.setParam(mP[i][lane], i);
+    }
+    for (int i = 0; i < kCovMatSize; i++) {
+      trc.setCov(mC[i][lane], i);
+    }
+  }
+
+  TrackParCov get(int lane) const
+  {
+    TrackParCov trc;
+    get(lane, trc);
+    return trc;
+  }
+
+  float getX(int lane) const { return mX[lane]; }
+  float getAlpha(int lane) const { return mAlpha[lane]; }
+  float getParam(int i, int lane) const { return mP[i][lane]; }
+  float getCovarElem(int i, int lane) const { return mC[i][lane]; }
+
+  /// propagate each lane to the plane X=xk[lane] (cm) in the field "b" (kG), see TrackParCov::propagateTo
+  Mask propagateTo(const Values& xk, float b);
+  /// rotate each lane to alpha[lane] frame, see TrackParCov::rotate
+  Mask rotate(const Values& alpha);
+  /// chi2 of each lane wrt the space point in the same lane, see TrackParCov::getPredictedChi2
+  Values getPredictedChi2(const PointBatch<W>& p) const;
+  /// chi2 of each lane wrt the track in the same lane of rhs, which must be defined at the same X,alpha
+  Values getPredictedChi2(const TrackParCovBatch& rhs) const;
+  /// update each lane with the space point in the same lane, see TrackParCov::update
+  Mask update(const PointBatch<W>& p);
+
+ private:
+  void checkCovariance(const Mask& lanes);
+
+  alignas(64) float mX[W] = {0.f};
+  alignas(64) float mAlpha[W] = {0.f};
+  alignas(64) float mP[kNParams][W] = {{0.f}};
+  alignas(64) float mC[kCovMatSize][W] = {{0.f}};
+};
+
+//______________________________________________________________
+template <int W>
+typename TrackParCovBatch<W>::Mask TrackParCovBatch<W>::propagateTo(const Values& xk, float b)
+{
+  using namespace o2::constants::math;
+  Mask ok, moved;
+  float f1s[W], f2s[W], r1s[W], r2s[W], crvs[W];
+  int arc[W];
+  float bc = (fabs(b) < Almost0) ? 0.f : b;
+  for (int i = 0; i < W; i++) {
+    float dx = xk[i] - mX[i];
+    float crv = mP[kQ2Pt][i] * bc * B2C;
+    float x2r = crv * dx;
+    float f1 = mP[kSnp][i], f2 = f1 + x2r;
+    float r1 = sqrtf(fabs((1.f - f1) * (1.f + f1)));
+    float r2 = sqrtf(fabs((1.f - f2) * (1.f + f2)));
+    int valid = (fabs(f1) <= Almost1) & (fabs(f2) <= Almost1) & (fabs(r1) >= Almost0) & (fabs(r2) >= Almost0);
+    int move = fabs(dx) >= Almost0;
+    ok[i] = (move == 0) | valid;
+    int upd = move & valid;
+    moved[i] = upd;
+    // keep the rejected lanes finite
+    r1 = upd ? r1 : 1.f;
+    r2 = upd ? r2 : 1.f;
+    f1s[i] = f1;
+    f2s[i] = f2;
+    r1s[i] = r1;
+    r2s[i] = r2;
+    crvs[i] = crv;
+    arc[i] = upd & (fabs(x2r) >= 0.05f);
+
+    double dy2dx = (f1 + f2) / (r1 + r2);
+    float tgl = mP[kTgl][i];
+    float dY = dx * dy2dx;
+    float dZ = dx * (r2 + f2 * dy2dx) * tgl; // large steps are corrected below
+    float nY = mP[kY][i] + dY, nZ = mP[kZ][i] + dZ, nSnp = mP[kSnp][i] + x2r;
+
+    float c00 = mC[kSigY2][i], c10 = mC[kSigZY][i], c11 = mC[kSigZ2][i], c20 = mC[kSigSnpY][i], c21 = mC[kSigSnpZ][i],
+          c22 = mC[kSigSnp2][i], c30 = mC[kSigTglY][i], c31 = mC[kSigTglZ][i], c32 = mC[kSigTglSnp][i], c33 = mC[kSigTgl2][i],
+          c40 = mC[kSigQ2PtY][i], c41 = mC[kSigQ2PtZ][i], c42 = mC[kSigQ2PtSnp][i], c43 = mC[kSigQ2PtTgl][i],
+          c44 = mC[kSigQ2Pt2][i];
+
+    // evaluate matrix in double prec.
+    double rinv = 1. / r1;
+    double r3inv = rinv * rinv * rinv;
+    double f24 = dx * b * B2C;
+    double f02 = dx * r3inv;
+    double f04 = 0.5 * f24 * f02;
+    double f12 = f02 * tgl * f1;
+    double f14 = 0.5 * f24 * f12;
+    double f13 = dx * rinv;
+
+    // b = C*ft
+    double b00 = f02 * c20 + f04 * c40, b01 = f12 * c20 + f14 * c40 + f13 * c30;
+    double b02 = f24 * c40;
+    double b10 = f02 * c21 + f04 * c41, b11 = f12 * c21 + f14 * c41 + f13 * c31;
+    double b12 = f24 * c41;
+    double b20 = f02 * c22 + f04 * c42, b21 = f12 * c22 + f14 * c42 + f13 * c32;
+    double b22 = f24 * c42;
+    double b40 = f02 * c42 + f04 * c44, b41 = f12 * c42 + f14 * c44 + f13 * c43;
+    double b42 = f24 * c44;
+    double b30 = f02 * c32 + f04 * c43, b31 = f12 * c32 + f14 * c43 + f13 * c33;
+    double b32 = f24 * c43;
+
+    // a = f*b = f*C*ft
+    double a00 = f02 * b20 + f04 * b40, a01 = f02 * b21 + f04 * b41, a02 = f02 * b22 + f04 * b42;
+    double a11 = f12 * b21 + f14 * b41 + f13 * b31, a12 = f12 * b22 + f14 * b42 + f13 * b32;
+    double a22 = f24 * b42;
+
+    mX[i] = upd ? xk[i] : mX[i];
+    mP[kY][i] = upd ? nY : mP[kY][i];
+    mP[kZ][i] = (upd & (arc[i] == 0)) ? nZ : mP[kZ][i];
+    mP[kSnp][i] = upd ? nSnp : mP[kSnp][i];
+
+    // F*C*Ft = C + (b + bt + a)
+    float n00 = c00 + (b00 + b00 + a00), n10 = c10 + (b10 + b01 + a01), n20 = c20 + (b20 + b02 + a02), n30 = c30 + b30,
+          n40 = c40 + b40, n11 = c11 + (b11 + b11 + a11), n21 = c21 + (b21 + b12 + a12), n31 = c31 + b31, n41 = c41 + b41,
+          n22 = c22 + (b22 + b22 + a22), n32 = c32 + b32, n42 = c42 + b42;
+    mC[kSigY2][i] = upd ? n00 : c00;
+    mC[kSigZY][i] = upd ? n10 : c10;
+    mC[kSigSnpY][i] = upd ? n20 : c20;
+    mC[kSigTglY][i] = upd ? n30 : c30;
+    mC[kSigQ2PtY][i] = upd ? n40 : c40;
+    mC[kSigZ2][i] = upd ? n11 : c11;
+    mC[kSigSnpZ][i] = upd ? n21 : c21;
+    mC[kSigTglZ][i] = upd ? n31 : c31;
+    mC[kSigQ2PtZ][i] = upd ? n41 : c41;
+    mC[kSigSnp2][i] = upd ? n22 : c22;
+    mC[kSigTglSnp][i] = upd ? n32 : c32;
+    mC[kSigQ2PtSnp][i] = upd ? n42 : c42;
+  }
+  // the Z of the lanes with large dx/R is obtained from the arc length, as in TrackParCov::propagateTo
+  for (int i = 0; i < W; i++) {
+    if (arc[i]) {
+      float f1 = f1s[i], f2 = f2s[i], r1 = r1s[i], r2 = r2s[i];
+      float rot = asinf(r1 * f2 - r2 * f1);
+      if (f1 * f1 + f2 * f2 > 1.f && f1 * f2 < 0.f) {
+        rot = f2 > 0.f ? PI - rot : -PI - rot;
+      }
+      mP[kZ][i] += mP[kTgl][i] / crvs[i] * rot;
+    }
+  }
+  checkCovariance(moved);
+  return ok;
+}
+
+//______________________________________________________________
+template <int W>
+typename TrackParCovBatch<W>::Mask TrackParCovBatch<W>::rotate(const Values& alpha)
+{
+  using namespace o2::constants::math;
+  Mask ok;
+  float alp[W], sas[W], cas[W];
+  for (int i = 0; i < W; i++) {
+    alp[i] = alpha[i];
+    utils::BringToPMPi(alp[i]);
+    utils::sincosf(alp[i] - mAlpha[i], sas[i], cas[i]);
+  }
+  for (int i = 0; i < W; i++) {
+    float ca = cas[i], sa = sas[i];
+    float snp = mP[kSnp][i], csp = sqrtf(fabs((1.f - snp) * (1.f + snp)));
+    float updSnp = snp * ca - csp * sa;
+    // the rotation must not invalidate the track model, i.e. the local cos(phi) must stay >= 0
+    int upd = (fabs(snp) <= Almost1) & ((csp * ca + snp * sa) >= 0) & (fabs(updSnp) <= Almost1);
+    ok[i] = upd;
+    float xold = mX[i], yold = mP[kY][i];
+    float nX = xold * ca + yold * sa, nY = -xold * sa + yold * ca;
+    mAlpha[i] = upd ? alp[i] : mAlpha[i];
+    mX[i] = upd ? nX : xold;
+    mP[kY][i] = upd ? nY : yold;
+    mP[kSnp][i] = upd ? updSnp : snp;
+
+    csp = fabs(csp) < Almost0 ? Almost0 : csp;
+    float rr = (ca + snp / csp * sa);
+    float ca1 = upd ? ca : 1.f, rr1 = upd ? rr : 1.f;
+
+    mC[kSigY2][i] *= (ca1 * ca1);
+    mC[kSigZY][i] *= ca1;
+    mC[kSigSnpY][i] *= ca1 * rr1;
+    mC[kSigSnpZ][i] *= rr1;
+    mC[kSigSnp2][i] *= rr1 * rr1;
+    mC[kSigTglY][i] *= ca1;
+    mC[kSigTglSnp][i] *= rr1;
+    mC[kSigQ2PtY][i] *= ca1;
+    mC[kSigQ2PtSnp][i] *= rr1;
+  }
+  checkCovariance(ok);
+  return ok;
+}
+
+//______________________________________________________________
+template <int W>
+typename TrackParCovBatch<W>::Values TrackParCovBatch<W>::getPredictedChi2(const PointBatch<W>& p) const
+{
+  using namespace o2::constants::math;
+  Values chi2;
+  for (int i = 0; i < W; i++) {
+    auto sdd = static_cast<double>(mC[kSigY2][i]) + static_cast<double>(p.sigY2[i]);
+    auto sdz = static_cast<double>(mC[kSigZY][i]) + static_cast<double>(p.sigYZ[i]);
+    auto szz = static_cast<double>(mC[kSigZ2][i]) + static_cast<double>(p.sigZ2[i]);
+    auto det = sdd * szz - sdz * sdz;
+    int valid = fabs(det) >= Almost0;
+    det = valid ? det : 1.;
+    float d = mP[kY][i] - p.y[i];
+    float z = mP[kZ][i] - p.z[i];
+    float res = (d * (szz * d - sdz * z) + z * (sdd * z - d * sdz)) / det;
+    chi2[i] = valid ? res : VeryBig;
+  }
+  return chi2;
+}
+
+//______________________________________________________________
+template <int W>
+typename TrackParCovBatch<W>::Values TrackParCovBatch<W>::getPredictedChi2(const TrackParCovBatch& rhs) const
+{
+  // the combined cov.matrix is inverted in double precision via its Cholesky decomposition L*Lt,
+  // chi2 = |y|^2 with L*y = diff
+  Values chi2;
+  int valid[W];
+  double l[kNParams][kNParams][W], y[kNParams][W], s[W];
+  for (int i = 0; i < W; i++) {
+    valid[i] = (std::abs(mAlpha[i] - rhs.mAlpha[i]) <= FLT_EPSILON) & (std::abs(mX[i] - rhs.mX[i]) <= FLT_EPSILON);
+  }
+  for (int r = 0; r < kNParams; r++) {
+    for (int c = 0; c <= r; c++) {
+      for (int i = 0; i < W; i++) {
+        s[i] = static_cast<double>(mC[CovarMap[r][c]][i]) + static_cast<double>(rhs.mC[CovarMap[r][c]][i]);
+      }
+      for (int k = 0; k < c; k++) {
+        for (int i = 0; i < W; i++) {
+          s[i] -= l[r][k][i] * l[c][k][i];
+        }
+      }
+      if (r == c) {
+        for (int i = 0; i < W; i++) {
+          valid[i] &= (s[i] > 0.);
+          l[r][r][i] = std::sqrt(valid[i] ? s[i] : 1.);
+        }
+      } else {
+        for (int i = 0; i < W; i++) {
+          l[r][c][i] = s[i] / l[c][c][i];
+        }
+      }
+    }
+  }
+  for (int i = 0; i < W; i++) {
+    s[i] = 0.;
+  }
+  for (int r = 0; r < kNParams; r++) {
+    for (int i = 0; i < W; i++) {
+      y[r][i] = double(mP[r][i] - rhs.mP[r][i]);
+    }
+    for (int k = 0; k < r; k++) {
+      for (int i = 0; i < W; i++) {
+        y[r][i] -= l[r][k][i] * y[k][i];
+      }
+    }
+    for (int i = 0; i < W; i++) {
+      y[r][i] /= l[r][r][i];
+      s[i] += y[r][i] * y[r][i];
+    }
+  }
+  for (int i = 0; i < W; i++) {
+    chi2[i] = valid[i] ? float(s[i]) : 2.f * HugeF;
+  }
+  return chi2;
+}
+
+//______________________________________________________________
+template <int W>
+typename TrackParCovBatch<W>::Mask TrackParCovBatch<W>::update(const PointBatch<W>& pts)
+{
+  using namespace o2::constants::math;
+  Mask ok;
+  const PointBatch<W> p = pts; // local copy, so that the compiler does not need to check the aliasing with the tracks
+  for (int i = 0; i < W; i++) {
+    float cm00 = mC[kSigY2][i], cm10 = mC[kSigZY][i], cm11 = mC[kSigZ2][i], cm20 = mC[kSigSnpY][i], cm21 = mC[kSigSnpZ][i],
+          cm22 = mC[kSigSnp2][i], cm30 = mC[kSigTglY][i], cm31 = mC[kSigTglZ][i], cm32 = mC[kSigTglSnp][i], cm33 = mC[kSigTgl2][i],
+          cm40 = mC[kSigQ2PtY][i], cm41 = mC[kSigQ2PtZ][i], cm42 = mC[kSigQ2PtSnp][i], cm43 = mC[kSigQ2PtTgl][i],
+          cm44 = mC[kSigQ2Pt2][i];
+
+    double r00 = static_cast<double>(p.sigY2[i]) + static_cast<double>(cm00);
+    double r01 = static_cast<double>(p.sigYZ[i]) + static_cast<double>(cm10);
+    double r11 = static_cast<double>(p.sigZ2[i]) + static_cast<double>(cm11);
+    double det = r00 * r11 - r01 * r01;
+    int valid = fabs(det) >= Almost0;
+    double detI = 1. / (valid ? det : 1.);
+    double tmp = r00;
+    r00 = r11 * detI;
+    r11 = tmp * detI;
+    r01 = -r01 * detI;
+
+    double k00 = cm00 * r00 + cm10 * r01, k01 = cm00 * r01 + cm10 * r11;
+    double k10 = cm10 * r00 + cm11 * r01, k11 = cm10 * r01 + cm11 * r11;
+    double k20 = cm20 * r00 + cm21 * r01, k21 = cm20 * r01 + cm21 * r11;
+    double k30 = cm30 * r00 + cm31 * r01, k31 = cm30 * r01 + cm31 * r11;
+    double k40 = cm40 * r00 + cm41 * r01, k41 = cm40 * r01 + cm41 * r11;
+
+    float dy = p.y[i] - mP[kY][i], dz = p.z[i] - mP[kZ][i];
+    float dsnp = k20 * dy + k21 * dz;
+    int upd = valid & (fabs(mP[kSnp][i] + dsnp) <= Almost1);
+    ok[i] = upd;
+
+    float nY = mP[kY][i] + float(k00 * dy + k01 * dz), nZ = mP[kZ][i] + float(k10 * dy + k11 * dz);
+    float nSnp = mP[kSnp][i] + dsnp, nTgl = mP[kTgl][i] + float(k30 * dy + k31 * dz), nQ2Pt = mP[kQ2Pt][i] + float(k40 * dy + k41 * dz);
+    mP[kY][i] = upd ? nY : mP[kY][i];
+    mP[kZ][i] = upd ? nZ : mP[kZ][i];
+    mP[kSnp][i] = upd ? nSnp : mP[kSnp][i];
+    mP[kTgl][i] = upd ? nTgl : mP[kTgl][i];
+    mP[kQ2Pt][i] = upd ? nQ2Pt : mP[kQ2Pt][i];
+
+    double c01 = cm10, c02 = cm20, c03 = cm30, c04 = cm40;
+    double c12 = cm21, c13 = cm31, c14 = cm41;
+
+    float n00 = cm00 - (k00 * cm00 + k01 * cm10), n10 = cm10 - (k00 * c01 + k01 * cm11), n20 = cm20 - (k00 * c02 + k01 * c12),
+          n30 = cm30 - (k00 * c03 + k01 * c13), n40 = cm40 - (k00 * c04 + k01 * c14);
+    float n11 = cm11 - (k10 * c01 + k11 * cm11), n21 = cm21 - (k10 * c02 + k11 * c12), n31 = cm31 - (k10 * c03 + k11 * c13),
+          n41 = cm41 - (k10 * c04 + k11 * c14);
+    float n22 = cm22 - (k20 * c02 + k21 * c12), n32 = cm32 - (k20 * c03 + k21 * c13), n42 = cm42 - (k20 * c04 + k21 * c14);
+    float n33 = cm33 - (k30 * c03 + k31 * c13), n43 = cm43 - (k30 * c04 + k31 * c14);
+    float n44 = cm44 - (k40 * c04 + k41 * c14);
+
+    mC[kSigY2][i] = upd ? n00 : cm00;
+    mC[kSigZY][i] = upd ? n10 : cm10;
+    mC[kSigSnpY][i] = upd ? n20 : cm20;
+    mC[kSigTglY][i] = upd ? n30 : cm30;
+    mC[kSigQ2PtY][i] = upd ? n40 : cm40;
+    mC[kSigZ2][i] = upd ? n11 : cm11;
+    mC[kSigSnpZ][i] = upd ? n21 : cm21;
+    mC[kSigTglZ][i] = upd ? n31 : cm31;
+    mC[kSigQ2PtZ][i] = upd ? n41 : cm41;
+    mC[kSigSnp2][i] = upd ? n22 : cm22;
+    mC[kSigTglSnp][i] = upd ? n32 : cm32;
+    mC[kSigQ2PtSnp][i] = upd ? n42 : cm42;
+    mC[kSigTgl2][i] = upd ? n33 : cm33;
+    mC[kSigQ2PtTgl][i] = upd ? n43 : cm43;
+    mC[kSigQ2Pt2][i] = upd ? n44 : cm44;
+  }
+  checkCovariance(ok);
+  return ok;
+}
+
+//______________________________________________________________
+template <int W>
+void TrackParCovBatch<W>::checkCovariance(const Mask& lanes)
+{
+  // same as TrackParCov::checkCovariance, for the selected lanes
+  constexpr int diag[kNParams] = {kSigY2, kSigZ2, kSigSnp2, kSigTgl2, kSigQ2Pt2};
+  constexpr float maxDiag[kNParams] = {kCY2max, kCZ2max, kCSnp2max, kCTgl2max, kC1Pt2max};
+  for (int d = 0; d < kNParams; d++) {
+    for (int i = 0; i < W; i++) {
+      float c = fabs(mC[diag[d]][i]);
+      float scl = sqrtf(maxDiag[d] / std::max(c, maxDiag[d])); // 1 unless clipped
+      scl = lanes[i] ? scl : 1.f;
+      mC[diag[d]][i] = lanes[i] ? std::min(c, maxDiag[d]) : mC[diag[d]][i];
+      for (int j = 0; j < kNParams; j++) {
+        if (j != d) {
+          mC[CovarMap[d][j]][i] *= scl;
+        }
+      }
+    }
+  }
+}
+
+} // namespace track
+} // namespace o2
+
+#endif
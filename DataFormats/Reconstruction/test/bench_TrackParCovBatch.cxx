@@ -0,0 +1,215 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file bench_TrackParCovBatch.cxx
+/// \brief Kalman filter operations on single tracks vs batches of tracks
+
+#include "benchmark/benchmark.h"
+#include "ReconstructionDataFormats/TrackParCovBatch.h"
+#include <random>
+#include <vector>
+
+using namespace o2::track;
+
+constexpr int NTracks = 1024;
+constexpr float Bz = -5.f;
+
+struct Input {
+  std::vector<TrackParCov> tracks;
+  std::vector<float> x, alpha;
+  std::vector<std::array<float, 2>> points;
+  std::vector<std::array<float, 3>> pointsCov;
+
+  Input()
+  {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> rnd(-1.f, 1.f);
+    for (int i = 0; i < NTracks; i++) {
+      tracks.emplace_back(20.f + 10.f * rnd(gen), 0.3f * rnd(gen), std::array<float, kNParams>{rnd(gen), 10.f * rnd(gen), 0.5f * rnd(gen), rnd(gen), rnd(gen)},
+                          std::array<float, kCovMatSize>{1e-2, 1e-4, 2e-2, 1e-4, 1e-5, 1e-3, 1e-5, 1e-4, 1e-6, 1e-3, 1e-4, 1e-5, 1e-5, 1e-6, 1e-2});
+      x.push_back(tracks.back().getX() + 5.f);
+      alpha.push_back(tracks.back().getAlpha() + 0.1f * rnd(gen));
+      points.push_back({rnd(gen), 10.f * rnd(gen)});
+      pointsCov.push_back({1e-3f, 1e-5f, 2e-3f});
+    }
+  }
+
+  static const Input& instance()
+  {
+    static Input input;
+    return input;
+  }
+};
+
+template <int W>
+struct BatchInput {
+  std::vector<TrackParCovBatch<W>> batches;
+  std::vector<std::array<float, W>> x, alpha;
+  std::vector<PointBatch<W>> points;
+
+  BatchInput()
+  {
+    auto& in = Input::instance();
+    batches.resize(NTracks / W);
+    x.resize(NTracks / W);
+    alpha.resize(NTracks / W);
+    points.resize(NTracks / W);
+    for (int i = 0; i < NTracks; i++) {
+      batches[i / W].set(i % W, in.tracks[i]);
+      x[i / W][i % W] = in.x[i];
+      alpha[i / W][i % W] = in.alpha[i];
+      points[i / W].set(i % W, in.points[i], in.pointsCov[i]);
+    }
+  }
+};
+
+static void BM_PropagateScalar(benchmark::State& state)
+{
+  auto& in = Input::instance();
+  for (auto _ : state) {
+    auto tracks = in.tracks;
+    for (int i = 0; i < NTracks; i++) {
+      benchmark::DoNotOptimize(tracks[i].propagateTo(in.x[i], Bz));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+template <int W>
+static void BM_PropagateBatch(benchmark::State& state)
+{
+  BatchInput<W> in;
+  for (auto _ : state) {
+    auto batches = in.batches;
+    for (size_t i = 0; i < batches.size(); i++) {
+      benchmark::DoNotOptimize(batches[i].propagateTo(in.x[i], Bz));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+static void BM_RotateScalar(benchmark::State& state)
+{
+  auto& in = Input::instance();
+  for (auto _ : state) {
+    auto tracks = in.tracks;
+    for (int i = 0; i < NTracks; i++) {
+      benchmark::DoNotOptimize(tracks[i].rotate(in.alpha[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+template <int W>
+static void BM_RotateBatch(benchmark::State& state)
+{
+  BatchInput<W> in;
+  for (auto _ : state) {
+    auto batches = in.batches;
+    for (size_t i = 0; i < batches.size(); i++) {
+      benchmark::DoNotOptimize(batches[i].rotate(in.alpha[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+static void BM_Chi2Scalar(benchmark::State& state)
+{
+  auto& in = Input::instance();
+  for (auto _ : state) {
+    for (int i = 0; i < NTracks; i++) {
+      benchmark::DoNotOptimize(in.tracks[i].getPredictedChi2(in.points[i], in.pointsCov[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+template <int W>
+static void BM_Chi2Batch(benchmark::State& state)
+{
+  BatchInput<W> in;
+  for (auto _ : state) {
+    for (size_t i = 0; i < in.batches.size(); i++) {
+      benchmark::DoNotOptimize(in.batches[i].getPredictedChi2(in.points[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+static void BM_TrackChi2Scalar(benchmark::State& state)
+{
+  auto& in = Input::instance();
+  for (auto _ : state) {
+    for (int i = 0; i < NTracks; i++) {
+      benchmark::DoNotOptimize(in.tracks[i].getPredictedChi2(in.tracks[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+template <int W>
+static void BM_TrackChi2Batch(benchmark::State& state)
+{
+  BatchInput<W> in;
+  for (auto _ : state) {
+    for (size_t i = 0; i < in.batches.size(); i++) {
+      benchmark::DoNotOptimize(in.batches[i].getPredictedChi2(in.batches[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+static void BM_UpdateScalar(benchmark::State& state)
+{
+  auto& in = Input::instance();
+  for (auto _ : state) {
+    auto tracks = in.tracks;
+    for (int i = 0; i < NTracks; i++) {
+      benchmark::DoNotOptimize(tracks[i].update(in.points[i], in.pointsCov[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+template <int W>
+static void BM_UpdateBatch(benchmark::State& state)
+{
+  BatchInput<W> in;
+  for (auto _ : state) {
+    auto batches = in.batches;
+    for (size_t i = 0; i < batches.size(); i++) {
+      benchmark::DoNotOptimize(batches[i].update(in.points[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NTracks);
+}
+
+BENCHMARK(BM_PropagateScalar);
+BENCHMARK_TEMPLATE(BM_PropagateBatch, 4);
+BENCHMARK_TEMPLATE(BM_PropagateBatch, 8);
+BENCHMARK_TEMPLATE(BM_PropagateBatch, 16);
+BENCHMARK(BM_RotateScalar);
+BENCHMARK_TEMPLATE(BM_RotateBatch, 4);
+BENCHMARK_TEMPLATE(BM_RotateBatch, 8);
+BENCHMARK_TEMPLATE(BM_RotateBatch, 16);
+BENCHMARK(BM_Chi2Scalar);
+BENCHMARK_TEMPLATE(BM_Chi2Batch, 4);
+BENCHMARK_TEMPLATE(BM_Chi2Batch, 8);
+BENCHMARK_TEMPLATE(BM_Chi2Batch, 16);
+BENCHMARK(BM_TrackChi2Scalar);
+BENCHMARK_TEMPLATE(BM_TrackChi2Batch, 4);
+BENCHMARK_TEMPLATE(BM_TrackChi2Batch, 8);
+BENCHMARK_TEMPLATE(BM_TrackChi2Batch, 16);
+BENCHMARK(BM_UpdateScalar);
+BENCHMARK_TEMPLATE(BM_UpdateBatch, 4);
+BENCHMARK_TEMPLATE(BM_UpdateBatch, 8);
+BENCHMARK_TEMPLATE(BM_UpdateBatch, 16);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,123 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test TrackParCovBatch class
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ReconstructionDataFormats/TrackParCovBatch.h"
+#include <random>
+
+namespace o2
+{
+using namespace o2::track;
+
+constexpr int W = 8;
+constexpr float Bz = -5.f;
+
+bool areClose(float a, float b)
+{
+  // the compiler may contract differently the scalar and the vectorized expressions
+  return std::abs(a - b) <= 1e-4f * (std::abs(a) + std::abs(b)) + 1e-9f;
+}
+
+void checkSame(const TrackParCov& trc, const TrackParCov& ref)
+{
+  BOOST_CHECK(areClose(trc.getX(), ref.getX()));
+  BOOST_CHECK(areClose(trc.getAlpha(), ref.getAlpha()));
+  for (int i = 0; i < kNParams; i++) {
+    BOOST_CHECK(areClose(trc.getParam(i), ref.getParam(i)));
+  }
+  for (int i = 0; i < kCovMatSize; i++) {
+    BOOST_CHECK(areClose(trc.getCov()[i], ref.getCov()[i]));
+  }
+}
+
+struct Sample {
+  std::array<TrackParCov, W> tracks;
+  TrackParCovBatch<W> batch;
+  std::array<float, W> x, alpha;
+  PointBatch<W> points;
+};
+
+Sample generate(std::mt19937& gen)
+{
+  std::uniform_real_distribution<float> rnd(-1.f, 1.f);
+  Sample s;
+  for (int i = 0; i < W; i++) {
+    // some of the tracks with large snp or low pt will fail to be propagated or rotated
+    s.tracks[i] = TrackParCov(20.f + 10.f * rnd(gen), 0.3f * rnd(gen), {rnd(gen), 10.f * rnd(gen), 0.9f * rnd(gen), rnd(gen), 5.f * rnd(gen)},
+                              {1e-2, 1e-4, 2e-2, 1e-4, 1e-5, 1e-3, 1e-5, 1e-4, 1e-6, 1e-3, 1e-4, 1e-5, 1e-5, 1e-6, 1e-2});
+    s.batch.set(i, s.tracks[i]);
+    s.x[i] = s.tracks[i].getX() + 30.f * rnd(gen);
+    s.alpha[i] = s.tracks[i].getAlpha() + 0.5f * rnd(gen);
+    s.points.set(i, {rnd(gen), 10.f * rnd(gen)}, {1e-3f, 1e-5f, 2e-3f});
+  }
+  return s;
+}
+
+// each operation on the batch must give the same result as on the single tracks
+BOOST_AUTO_TEST_CASE(BatchVsScalar)
+{
+  std::mt19937 gen(1);
+  int nFailed = 0;
+  for (int iter = 0; iter < 200; iter++) {
+    auto s = generate(gen);
+
+    auto okProp = s.batch.propagateTo(s.x, Bz);
+    for (int i = 0; i < W; i++) {
+      BOOST_CHECK_EQUAL(bool(okProp[i]), s.tracks[i].propagateTo(s.x[i], Bz));
+      checkSame(s.batch.get(i), s.tracks[i]);
+    }
+
+    auto okRot = s.batch.rotate(s.alpha);
+    for (int i = 0; i < W; i++) {
+      BOOST_CHECK_EQUAL(bool(okRot[i]), s.tracks[i].rotate(s.alpha[i]));
+      checkSame(s.batch.get(i), s.tracks[i]);
+    }
+
+    auto chi2 = s.batch.getPredictedChi2(s.points);
+    auto okUpd = s.batch.update(s.points);
+    for (int i = 0; i < W; i++) {
+      std::array<float, 2> p{s.points.y[i], s.points.z[i]};
+      std::array<float, 3> cov{s.points.sigY2[i], s.points.sigYZ[i], s.points.sigZ2[i]};
+      BOOST_CHECK(areClose(chi2[i], s.tracks[i].getPredictedChi2(p, cov)));
+      BOOST_CHECK_EQUAL(bool(okUpd[i]), s.tracks[i].update(p, cov));
+      checkSame(s.batch.get(i), s.tracks[i]);
+      nFailed += !okProp[i] || !okRot[i] || !okUpd[i];
+    }
+  }
+  // make sure that both the successful and the failed lanes were tested
+  BOOST_CHECK(nFailed > 0 && nFailed < 200 * W / 2);
+}
+
+BOOST_AUTO_TEST_CASE(BatchTrackChi2)
+{
+  std::mt19937 gen(2);
+  std::uniform_real_distribution<float> rnd(-1.f, 1.f);
+  auto s = generate(gen);
+  TrackParCovBatch<W> other;
+  for (int i = 0; i < W; i++) {
+    auto trc = s.tracks[i];
+    trc.setY(trc.getY() + 0.1f * rnd(gen));
+    trc.setQ2Pt(trc.getQ2Pt() + 0.1f * rnd(gen));
+    if (i == W - 1) {
+      trc.setX(trc.getX() + 1.f); // not at the same X, not compatible
+    }
+    other.set(i, trc);
+  }
+  auto chi2 = s.batch.getPredictedChi2(other);
+  for (int i = 0; i < W; i++) {
+    BOOST_CHECK(areClose(chi2[i], s.tracks[i].getPredictedChi2(other.get(i))));
+  }
+  BOOST_CHECK_EQUAL(chi2[W - 1], 2.f * HugeF);
+}
+
+} // namespace o2
@@ -12,6 +12,9 @@
 #define ALICEO2_DATA_PRIMARYCHUNK_H_
 
 #include <cstring>
+#include <vector>
+#include <TParticle.h>
+#include <TVector3.h>
 #include <SimulationDataFormat/MCEventHeader.h>
 
 namespace o2
@@ -44,6 +47,42 @@ inline bool operator<(SubEventInfo const& a, SubEventInfo const& b)
   return a.eventID <= b.eventID && (a.part < b.part);
 }
 
+// trivially copyable image of a TParticle, used to distribute the primaries
+// as a flat array (no TParticle streamer involved)
+struct FlatParticle {
+  double px = 0., py = 0., pz = 0., e = 0.;
+  double vx = 0., vy = 0., vz = 0., t = 0.;
+  double polx = 0., poly = 0., polz = 0.;
+  float weight = 1.;
+  int pdg = 0;
+  int status = 0;
+  int mother[2] = {-1, -1};
+  int daughter[2] = {-1, -1};
+  uint32_t uniqueID = 0; // process ID
+  uint32_t bits = 0;     // TObject user bits (transport status)
+
+  FlatParticle() = default;
+  explicit FlatParticle(TParticle const& p)
+    : px(p.Px()), py(p.Py()), pz(p.Pz()), e(p.Energy()), vx(p.Vx()), vy(p.Vy()), vz(p.Vz()), t(p.T()), weight(p.GetWeight()), pdg(p.GetPdgCode()), status(p.GetStatusCode()), mother{p.GetFirstMother(), p.GetSecondMother()}, daughter{p.GetFirstDaughter(), p.GetLastDaughter()}, uniqueID(p.GetUniqueID()), bits(p.TestBits(TObject::kBitMask))
+  {
+    TVector3 pol;
+    p.GetPolarisation(pol);
+    polx = pol.X();
+    poly = pol.Y();
+    polz = pol.Z();
+  }
+
+  TParticle toTParticle() const
+  {
+    TParticle p(pdg, status, mother[0], mother[1], daughter[0], daughter[1], px, py, pz, e, vx, vy, vz, t);
+    p.SetWeight(weight);
+    p.SetPolarisation(polx, poly, polz);
+    p.SetUniqueID(uniqueID);
+    p.SetBit(bits);
+    return p;
+  }
+};
+
 // Encapsulating primaries/tracks as well as the event info
 // to be processed by the simulation processors.
 struct PrimaryChunk {
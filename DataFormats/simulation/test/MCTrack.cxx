@@ -92,3 +92,26 @@ BOOST_AUTO_TEST_CASE(Stack_test)
     BOOST_CHECK(inst->getPrimaries().size() == 2);
   }
 }
+
+// primaries must survive the flat encoding used to distribute them to the workers
+BOOST_AUTO_TEST_CASE(FlatParticle_test)
+{
+  static_assert(std::is_trivially_copyable<o2::data::FlatParticle>::value, "FlatParticle must be trivially copyable");
+  TParticle p(211, 1, 2, -1, 5, 7, 0.1, -0.2, 3., 3.1, 0.01, -0.02, 1., 1e-9);
+  p.SetWeight(0.5);
+  p.SetPolarisation(0., 0., 1.);
+  p.SetUniqueID(kPDecay);
+  p.SetBit(BIT(16));
+
+  auto q = o2::data::FlatParticle(p).toTParticle();
+  BOOST_CHECK_EQUAL(q.GetPdgCode(), p.GetPdgCode());
+  BOOST_CHECK_EQUAL(q.GetStatusCode(), p.GetStatusCode());
+  BOOST_CHECK_EQUAL(q.GetFirstMother(), p.GetFirstMother());
+  BOOST_CHECK_EQUAL(q.GetLastDaughter(), p.GetLastDaughter());
+  BOOST_CHECK_EQUAL(q.Pz(), p.Pz());
+  BOOST_CHECK_EQUAL(q.T(), p.T());
+  BOOST_CHECK_EQUAL(q.GetWeight(), p.GetWeight());
+  BOOST_CHECK_EQUAL(q.GetPolarTheta(), p.GetPolarTheta());
+  BOOST_CHECK_EQUAL(q.GetUniqueID(), p.GetUniqueID());
+  BOOST_CHECK(q.TestBit(BIT(16)));
+}
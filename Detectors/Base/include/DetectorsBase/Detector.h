@@ -25,6 +25,7 @@
 #include "Rtypes.h" // for Float_t, Int_t, Double_t, Detector::Class, etc
 #include <cxxabi.h>
 #include <typeinfo>
+#include <utility>
 #include <type_traits>
 #include <string>
 #include <TMessage.h>
@@ -34,6 +35,7 @@
 #include <type_traits>
 #include <unistd.h>
 #include <cassert>
+#include <cstring>
 
 class FairMQParts;
 class FairMQChannel;
@@ -43,6 +45,23 @@ namespace o2
 namespace base
 {
 
+/// Header of the flat buffer in which the hits of trivially copyable types are transported.
+/// It is followed by the offset table of the hit containers (nContainers + 1 entries, in units of hits)
+/// and the hits of all containers.
+struct FlatHitsHeader {
+  static constexpr uint32_t MAGIC = 0x4f324854; // "O2HT"
+  uint32_t magic = MAGIC;
+  uint32_t hitSize = 0;     // size of the hit type, for consistency check
+  uint32_t nContainers = 0; // number of hit containers (branches)
+  uint32_t reserved = 0;
+};
+
+/// flat hits buffer as received by the hit merger
+struct FlatHitsBuffer {
+  const char* data = nullptr;
+  size_t size = 0;
+};
+
 /// This is the basic class for any AliceO2 detector module, whether it is
 /// sensitive or not. Detector classes depend on this.
 class Detector : public FairDetector
@@ -169,6 +188,13 @@ class Detector : public FairDetector
   // merging
   virtual void mergeHitEntries(TTree& origin, TTree& target, std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered) = 0;
 
+  // interface for the flat (non ROOT) transport of hits: if usesFlatHits() is true, attachHits
+  // ships all hit containers of the detector as one flat buffer (see FlatHitsHeader); the hit merger
+  // recognises these buffers by their header and merges the buffers of all subevents (given in the
+  // order of arrival) directly into the target TTree
+  virtual bool usesFlatHits() const = 0;
+  virtual void mergeFlatHitEntries(std::vector<FlatHitsBuffer> const& buffers, TTree& target, std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered) = 0;
+
   // hook which is called automatically to custom initialize the O2 detectors
   // all initialization not able to do in constructors should be done here
   // (typically the case for geometry related stuff, etc)
@@ -267,6 +293,84 @@ T decodeTMessage(FairMQParts& dataparts, int index)
 
 void attachDetIDHeaderMessage(int id, FairMQChannel& channel, FairMQParts& parts);
 
+// adds a new message of given size to the parts, returns the pointer to its data
+void* attachNewMessageToParts(FairMQParts& parts, FairMQChannel& channel, size_t size);
+
+// copies the hit containers into a single flat message (header, offset table, hits)
+template <typename Container>
+void attachFlatHits(std::vector<Container const*> const& containers, FairMQChannel& channel, FairMQParts& parts)
+{
+  using Hit_t = typename Container::value_type;
+  static_assert(std::is_trivially_copyable<Hit_t>::value, "Flat hits transport needs trivially copyable hits");
+  FlatHitsHeader header;
+  header.hitSize = sizeof(Hit_t);
+  header.nContainers = containers.size();
+  std::vector<uint64_t> offsets(containers.size() + 1, 0);
+  for (size_t i = 0; i < containers.size(); ++i) {
+    offsets[i + 1] = offsets[i] + containers[i]->size();
+  }
+  size_t size = sizeof(FlatHitsHeader) + offsets.size() * sizeof(uint64_t) + offsets.back() * sizeof(Hit_t);
+  auto buffer = static_cast<char*>(attachNewMessageToParts(parts, channel, size));
+  std::memcpy(buffer, &header, sizeof(FlatHitsHeader));
+  buffer += sizeof(FlatHitsHeader);
+  std::memcpy(buffer, offsets.data(), offsets.size() * sizeof(uint64_t));
+  buffer += offsets.size() * sizeof(uint64_t);
+  for (auto hits : containers) {
+    std::memcpy(buffer, hits->data(), hits->size() * sizeof(Hit_t));
+    buffer += hits->size() * sizeof(Hit_t);
+  }
+}
+
+// checks the flat buffer and returns the offset table of the hit containers and the start of the hits;
+// an empty buffer is accepted as no hits at all
+void decodeFlatHits(FlatHitsBuffer const& buffer, size_t hitSize, FlatHitsHeader& header, const uint64_t*& offsets, const char*& hits);
+
+// true if the buffer starts with the header of a flat hits buffer, as made by attachFlatHits
+bool isFlatHitsBuffer(FlatHitsBuffer const& buffer);
+
+// appends the hits of the flat buffers of all subevents (given in the order of arrival) to the hit
+// containers, adjusting the trackIDs like DetImpl::mergeAndAdjustHits
+template <typename VectorHit_t>
+void mergeFlatHits(std::vector<FlatHitsBuffer> const& buffers, std::vector<VectorHit_t>& merged, std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered)
+{
+  using Hit_t = typename VectorHit_t::value_type;
+  const int entries = buffers.size();
+  Int_t nprimTot = 0;
+  for (int entry = 0; entry < entries; entry++) {
+    nprimTot += nprimaries[entry];
+  }
+  // offset for primary and secondary track index
+  Int_t idelta0 = 0;
+  Int_t idelta1 = nprimTot;
+  for (int entry = entries - 1; entry >= 0; --entry) {
+    // proceed in the order of subevent Ids
+    Int_t index = subevtsOrdered[entry];
+    Int_t nprim = nprimaries[index];
+    idelta1 -= nprim;
+    FlatHitsHeader header;
+    const uint64_t* offsets = nullptr;
+    const char* hits = nullptr;
+    decodeFlatHits(buffers[index], sizeof(Hit_t), header, offsets, hits);
+    if (merged.size() < header.nContainers) {
+      merged.resize(header.nContainers);
+    }
+    for (uint32_t c = 0; c < header.nContainers; ++c) {
+      auto& dest = merged[c];
+      auto first = dest.size(), nhits = offsets[c + 1] - offsets[c];
+      dest.resize(first + nhits);
+      std::memcpy(dest.data() + first, hits + offsets[c] * sizeof(Hit_t), nhits * sizeof(Hit_t));
+      for (auto i = first; i < dest.size(); ++i) {
+        auto& hit = dest[i];
+        const auto oldID = hit.GetTrackID();
+        hit.SetTrackID(oldID + ((oldID < nprim) ? idelta0 : idelta1));
+      }
+    }
+    // adjust offsets for next subevent
+    idelta0 += nprim;
+    idelta1 += trackoffsets[index];
+  }
+}
+
 template <typename T>
 TBranch* getOrMakeBranch(TTree& tree, const char* brname, T* ptr)
 {
@@ -284,6 +388,13 @@ struct UseShm {
   static constexpr bool value = false;
 };
 
+// a trait to determine if we should ship hits as flat buffers (applies only to trivially copyable hits
+// and when the hits are not shared via shared mem); on by default
+template <typename Det>
+struct UseFlatHits {
+  static constexpr bool value = true;
+};
+
 // an implementation helper template which automatically implements
 // common functionality for deriving classes via the CRT pattern
 // (example: it implements the updateHitTrackIndices function and avoids
@@ -330,6 +441,16 @@ class DetImpl : public o2::base::Detector
 
     attachDetIDHeaderMessage(GetDetId(), channel, parts); // the DetId s are universal as they come from o2::detector::DetID
 
+    if (usesFlatHits()) {
+      using VectorHit_t = typename std::remove_pointer<decltype(static_cast<Det*>(this)->Det::getHits(0))>::type;
+      std::vector<VectorHit_t const*> containers;
+      while (auto hits = static_cast<Det*>(this)->Det::getHits(probe++)) {
+        containers.push_back(hits);
+      }
+      attachFlatHits(containers, channel, parts);
+      return;
+    }
+
     while (auto hits = static_cast<Det*>(this)->Det::getHits(probe++)) {
       if (!UseShm<Det>::value || !o2::utils::ShmManager::Instance().isOperational()) {
         attachTMessage(*hits, channel, parts);
@@ -410,6 +531,34 @@ class DetImpl : public o2::base::Detector
     }
   }
 
+  bool usesFlatHits() const final
+  {
+    using VectorHit_t = typename std::remove_pointer<decltype(std::declval<Det&>().getHits(0))>::type;
+    return UseFlatHits<Det>::value && std::is_trivially_copyable<typename VectorHit_t::value_type>::value &&
+           !(UseShm<Det>::value && o2::utils::ShmManager::Instance().isOperational());
+  }
+
+  // merges the flat hit buffers of all subevents of an event into a single entry of the target TTree,
+  // adjusting the trackIDs like mergeAndAdjustHits
+  void mergeFlatHitEntries(std::vector<FlatHitsBuffer> const& buffers, TTree& target, std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered) final
+  {
+    using VectorHit_t = typename std::remove_pointer<decltype(static_cast<Det*>(this)->Det::getHits(0))>::type;
+    std::vector<VectorHit_t> merged;
+    mergeFlatHits(buffers, merged, trackoffsets, nprimaries, subevtsOrdered);
+    // fill target for this event, one branch per hit container
+    VectorHit_t empty;
+    int probe = 0;
+    std::string name = static_cast<Det*>(this)->getHitBranchNames(probe);
+    while (name.size() > 0) {
+      VectorHit_t* filladdress = probe < (int)merged.size() ? &merged[probe] : &empty;
+      auto targetbr = o2::base::getOrMakeBranch(target, name.c_str(), &filladdress);
+      targetbr->SetAddress(&filladdress);
+      targetbr->Fill();
+      targetbr->ResetAddress();
+      name = static_cast<Det*>(this)->getHitBranchNames(++probe);
+    }
+  }
+
   void mergeHitEntries(TTree& origin, TTree& target, std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered) final
   {
     // loop over hit containers / different branches
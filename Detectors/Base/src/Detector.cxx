@@ -194,6 +194,9 @@ int Detector::registerSensitiveVolumeAndGetVolID(std::string const& name)
 #include <FairMQMessage.h>
 #include <FairMQParts.h>
 #include <FairMQChannel.h>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
 namespace o2
 {
 namespace base
@@ -210,6 +213,45 @@ void attachDetIDHeaderMessage(int id, FairMQChannel& channel, FairMQParts& parts
   std::unique_ptr<FairMQMessage> message(channel.NewSimpleMessage(id));
   parts.AddPart(std::move(message));
 }
+void* attachNewMessageToParts(FairMQParts& parts, FairMQChannel& channel, size_t size)
+{
+  std::unique_ptr<FairMQMessage> message(channel.NewMessage(size));
+  auto data = message->GetData();
+  parts.AddPart(std::move(message));
+  return data;
+}
+bool isFlatHitsBuffer(FlatHitsBuffer const& buffer)
+{
+  uint32_t magic = 0;
+  if (buffer.size < sizeof(FlatHitsHeader)) {
+    return false;
+  }
+  std::memcpy(&magic, buffer.data + offsetof(FlatHitsHeader, magic), sizeof(magic));
+  return magic == FlatHitsHeader::MAGIC;
+}
+void decodeFlatHits(FlatHitsBuffer const& buffer, size_t hitSize, FlatHitsHeader& header, const uint64_t*& offsets, const char*& hits)
+{
+  header = FlatHitsHeader();
+  if (buffer.size == 0) {
+    return;
+  }
+  if (buffer.size < sizeof(FlatHitsHeader)) {
+    throw std::runtime_error("Flat hits buffer is too short");
+  }
+  std::memcpy(&header, buffer.data, sizeof(FlatHitsHeader));
+  if (header.magic != FlatHitsHeader::MAGIC || header.hitSize != hitSize) {
+    throw std::runtime_error("Flat hits buffer of wrong format or hit type");
+  }
+  size_t hitsStart = sizeof(FlatHitsHeader) + (header.nContainers + 1) * sizeof(uint64_t);
+  if (hitsStart > buffer.size) {
+    throw std::runtime_error("Flat hits buffer is too short for its offset table");
+  }
+  offsets = reinterpret_cast<const uint64_t*>(buffer.data + sizeof(FlatHitsHeader));
+  hits = buffer.data + hitsStart;
+  if (hitsStart + offsets[header.nContainers] * hitSize != buffer.size) {
+    throw std::runtime_error("Flat hits buffer size does not match its offset table");
+  }
+}
 void attachShmMessage(void* hits_ptr, FairMQChannel& channel, FairMQParts& parts, bool* busy_ptr)
 {
   struct shmcontext {
@@ -0,0 +1,146 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test FlatHits
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "DetectorsBase/Detector.h"
+#include "SimulationDataFormat/BaseHits.h"
+#include <FairMQChannel.h>
+#include <FairMQParts.h>
+#include <FairMQTransportFactory.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace o2::base;
+using TestHit = o2::BasicXYZEHit<float>;
+using TestHits = std::vector<TestHit>;
+
+// three subevents, given in their order of arrival at the merger
+const std::vector<int> subevtsOrdered{2, 0, 1}; // arrival index of the subevents 1, 2 and 3
+const std::vector<int> nprimaries{2, 3, 1};
+const std::vector<int> trackoffsets{5, 4, 3}; // number of tracks of each subevent
+// trackID after merging of every trackID of each subevent: the primaries of all subevents come
+// first, then the secondaries, each group from the last subevent to the first one
+const std::vector<std::vector<int>> mergedTrackIDs{{3, 4, 7, 8, 9}, {0, 1, 2, 6}, {5, 10, 11}};
+
+// one hit per track, alternating between 2 containers, the last subevent has no hits in the second one
+std::vector<TestHits> makeHits(int arrival)
+{
+  std::vector<TestHits> containers(2);
+  for (int trackID = 0; trackID < trackoffsets[arrival]; ++trackID) {
+    auto& hits = containers[arrival == 2 ? 0 : trackID % 2];
+    hits.emplace_back(100. * arrival + trackID, 0., 0., 1., 1e-6, trackID, 7);
+  }
+  return containers;
+}
+
+FlatHitsBuffer getBuffer(FairMQParts& parts, int index)
+{
+  return {static_cast<const char*>(parts.At(index)->GetData()), parts.At(index)->GetSize()};
+}
+
+BOOST_AUTO_TEST_CASE(FlatHits_roundTrip)
+{
+  auto factory = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  FairMQChannel channel("hits", "push", factory);
+  FairMQParts parts;
+  std::vector<std::vector<TestHits>> sent;
+  for (int arrival = 0; arrival < (int)nprimaries.size(); ++arrival) {
+    sent.push_back(makeHits(arrival));
+    std::vector<TestHits const*> containers;
+    for (auto& hits : sent.back()) {
+      containers.push_back(&hits);
+    }
+    attachFlatHits(containers, channel, parts);
+  }
+  BOOST_REQUIRE_EQUAL(parts.Size(), sent.size());
+
+  std::vector<FlatHitsBuffer> buffers;
+  for (int arrival = 0; arrival < (int)sent.size(); ++arrival) {
+    buffers.push_back(getBuffer(parts, arrival));
+    BOOST_CHECK(isFlatHitsBuffer(buffers.back()));
+
+    FlatHitsHeader header;
+    const uint64_t* offsets = nullptr;
+    const char* hits = nullptr;
+    decodeFlatHits(buffers.back(), sizeof(TestHit), header, offsets, hits);
+    BOOST_CHECK_EQUAL(header.hitSize, sizeof(TestHit));
+    BOOST_REQUIRE_EQUAL(header.nContainers, sent[arrival].size());
+    for (uint32_t c = 0; c < header.nContainers; ++c) {
+      const auto& orig = sent[arrival][c];
+      BOOST_REQUIRE_EQUAL(offsets[c + 1] - offsets[c], orig.size());
+      auto decoded = reinterpret_cast<const TestHit*>(hits) + offsets[c];
+      for (size_t i = 0; i < orig.size(); ++i) {
+        BOOST_CHECK_EQUAL(decoded[i].GetTrackID(), orig[i].GetTrackID());
+        BOOST_CHECK_EQUAL(decoded[i].GetX(), orig[i].GetX());
+      }
+    }
+    // a different hit type is refused
+    BOOST_CHECK_THROW(decodeFlatHits(buffers.back(), sizeof(TestHit) + 4, header, offsets, hits), std::runtime_error);
+  }
+
+  std::vector<TestHits> merged;
+  mergeFlatHits(buffers, merged, trackoffsets, nprimaries, subevtsOrdered);
+  BOOST_REQUIRE_EQUAL(merged.size(), 2);
+  size_t nMerged = 0;
+  for (int c = 0; c < 2; ++c) {
+    // the hits follow the order of the subevent IDs, from the last subevent to the first one
+    size_t pos = 0;
+    for (int entry = (int)subevtsOrdered.size() - 1; entry >= 0; --entry) {
+      int arrival = subevtsOrdered[entry];
+      for (const auto& hit : sent[arrival][c]) {
+        BOOST_REQUIRE(pos < merged[c].size());
+        const auto& mhit = merged[c][pos++];
+        BOOST_CHECK_EQUAL(mhit.GetX(), hit.GetX());
+        BOOST_CHECK_EQUAL(mhit.GetTrackID(), mergedTrackIDs[arrival][hit.GetTrackID()]);
+      }
+    }
+    BOOST_CHECK_EQUAL(pos, merged[c].size());
+    nMerged += pos;
+  }
+  BOOST_CHECK_EQUAL(nMerged, 12);
+}
+
+BOOST_AUTO_TEST_CASE(FlatHits_format)
+{
+  auto factory = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  FairMQChannel channel("hits", "push", factory);
+  FairMQParts parts;
+  TestHits hits;
+  hits.emplace_back(1., 2., 3., 1., 1e-6, 0, 7);
+  attachFlatHits(std::vector<TestHits const*>{&hits}, channel, parts);
+  attachTMessage(hits, channel, parts);
+
+  // the merger tells the flat buffers from the ROOT serialized ones by their header
+  BOOST_CHECK(isFlatHitsBuffer(getBuffer(parts, 0)));
+  BOOST_CHECK(!isFlatHitsBuffer(getBuffer(parts, 1)));
+  BOOST_CHECK(!isFlatHitsBuffer(FlatHitsBuffer{}));
+
+  FlatHitsHeader header;
+  const uint64_t* offsets = nullptr;
+  const char* data = nullptr;
+  // an empty buffer means no hits
+  decodeFlatHits(FlatHitsBuffer{}, sizeof(TestHit), header, offsets, data);
+  BOOST_CHECK_EQUAL(header.nContainers, 0);
+  // a truncated buffer is refused
+  auto buffer = getBuffer(parts, 0);
+  buffer.size -= sizeof(TestHit) / 2;
+  BOOST_CHECK_THROW(decodeFlatHits(buffer, sizeof(TestHit), header, offsets, data), std::runtime_error);
+  // subevents without hits of the detector do not contribute to the merged hits
+  std::vector<TestHits> merged;
+  // but their tracks are counted: the primary of the second subevent comes before the one of the first
+  mergeFlatHits(std::vector<FlatHitsBuffer>{getBuffer(parts, 0), FlatHitsBuffer{}}, merged, {3, 2}, {1, 1}, {0, 1});
+  BOOST_REQUIRE_EQUAL(merged.size(), 1);
+  BOOST_REQUIRE_EQUAL(merged[0].size(), 1);
+  BOOST_CHECK_EQUAL(merged[0][0].GetTrackID(), 1);
+}
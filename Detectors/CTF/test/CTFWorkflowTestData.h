@@ -0,0 +1,77 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   CTFWorkflowTestData.h
+/// @brief  ITS data shared by the CTF writer and reader workflow tests
+
+#ifndef O2_CTF_WORKFLOW_TEST_DATA_H
+#define O2_CTF_WORKFLOW_TEST_DATA_H
+
+#include "DataFormatsITSMFT/CompCluster.h"
+#include "DataFormatsITSMFT/ROFRecord.h"
+#include <TRandom3.h>
+#include <algorithm>
+#include <vector>
+
+namespace o2
+{
+namespace ctf
+{
+namespace test
+{
+
+constexpr int NTFs = 3; // number of TFs written and read back
+
+/// 1st orbit of the TF, also defines the name of the file it is written to
+inline uint32_t getTFOrbit(int tf) { return 256 * (tf + 1); }
+
+struct ITSData {
+  std::vector<o2::itsmft::ROFRecord> rofs;
+  std::vector<o2::itsmft::CompClusterExt> clusters;
+  std::vector<unsigned char> patterns;
+};
+
+/// reproducible content of the TF, so that the reader test can check it independently of the writer test
+inline ITSData generateITSData(int tf)
+{
+  TRandom3 rnd(tf + 1);
+  ITSData data;
+  for (int irof = 0; irof < 10; irof++) {
+    auto& rofr = data.rofs.emplace_back();
+    rofr.getBCData().orbit = getTFOrbit(tf) + irof;
+    rofr.setFirstEntry(data.clusters.size());
+    int chipID = irof;
+    for (int ichip = 0; ichip < 5; ichip++) {
+      int nhits = 1 + rnd.Poisson(20);
+      std::vector<int> col(nhits);
+      for (auto& c : col) {
+        c = rnd.Integer(1024);
+      }
+      std::sort(col.begin(), col.end());
+      for (int c : col) {
+        auto& cl = data.clusters.emplace_back(rnd.Integer(512), c, rnd.Integer(1000), chipID);
+        if (cl.getPatternID() > 900) {
+          for (int i = 1 + rnd.Poisson(3.); i--;) {
+            data.patterns.push_back(char(rnd.Integer(256)));
+          }
+        }
+      }
+      chipID += 1 + rnd.Poisson(10);
+    }
+    rofr.setNEntries(int(data.clusters.size()) - rofr.getFirstEntry());
+  }
+  return data;
+}
+
+} // namespace test
+} // namespace ctf
+} // namespace o2
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test CTFChunks
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "DataFormatsITSMFT/CTF.h"
+#include "DetectorsCommonDataFormats/EncodedBlocks.h"
+#include <TRandom.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using CTF = o2::itsmft::CTF;
+using MD = o2::ctf::Metadata;
+
+// encode the source to a single block of the container, in chunks of given size (0: no chunking)
+std::vector<o2::ctf::BufferType> encodeBlock(const std::vector<uint16_t>& src, int chunkSize, int nThreads)
+{
+  std::vector<o2::ctf::BufferType> vec;
+  CTF::create(vec);
+  CTF::get(vec.data())->encode(src, CTF::BLCrow, o2::rans::ProbabilityBits16Bit, MD::EENCODE, &vec, nullptr, chunkSize, nThreads);
+  return vec;
+}
+
+BOOST_AUTO_TEST_CASE(ChunkedEncodeDecode)
+{
+  const int chunkSize = 1000;
+  std::vector<uint16_t> src(10500);
+  for (auto& s : src) {
+    s = gRandom->Poisson(100);
+  }
+
+  auto vec = encodeBlock(src, chunkSize, 4);
+  const auto ctfImage = CTF::getImage(vec.data());
+  BOOST_REQUIRE_EQUAL(ctfImage.getNChunks(CTF::BLCrow), 11);
+  for (int ic = 0; ic < 10; ic++) {
+    BOOST_CHECK_EQUAL(ctfImage.getChunkLength(CTF::BLCrow, ic), chunkSize);
+  }
+  BOOST_CHECK_EQUAL(ctfImage.getChunkLength(CTF::BLCrow, 10), 500);
+
+  // full decoding, the chunks are decoded in parallel
+  std::vector<uint16_t> dest;
+  ctfImage.decode(dest, CTF::BLCrow, nullptr, 4);
+  BOOST_CHECK(dest == src);
+
+  // every chunk can be decoded on its own, in any order
+  std::vector<uint16_t> destChunks(src.size(), 0);
+  for (int ic = ctfImage.getNChunks(CTF::BLCrow); ic--;) {
+    ctfImage.decodeChunk(destChunks.data() + size_t(ic) * chunkSize, CTF::BLCrow, ic);
+  }
+  BOOST_CHECK(destChunks == src);
+
+  // the same data w/o chunking: a single chunk
+  auto vec1 = encodeBlock(src, 0, 1);
+  const auto ctfImage1 = CTF::getImage(vec1.data());
+  BOOST_CHECK_EQUAL(ctfImage1.getNChunks(CTF::BLCrow), 1);
+  BOOST_CHECK_EQUAL(ctfImage1.getChunkLength(CTF::BLCrow, 0), src.size());
+  std::vector<uint16_t> dest1(src.size(), 0);
+  ctfImage1.decodeChunk(dest1.data(), CTF::BLCrow, 0);
+  BOOST_CHECK(dest1 == src);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelForException)
+{
+  // an exception thrown for one index is passed to the caller
+  std::atomic<int> nCalls{0};
+  BOOST_CHECK_THROW(o2::ctf::parallelFor(100, 4, [&nCalls](int i) {
+                      nCalls++;
+                      if (i == 37) {
+                        throw std::runtime_error("failed chunk");
+                      }
+                    }),
+                    std::runtime_error);
+  BOOST_CHECK(nCalls > 0);
+
+  nCalls = 0;
+  o2::ctf::parallelFor(100, 4, [&nCalls](int) { nCalls++; });
+  BOOST_CHECK_EQUAL(nCalls, 100);
+}
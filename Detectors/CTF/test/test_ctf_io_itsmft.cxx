@@ -133,3 +133,60 @@ BOOST_AUTO_TEST_CASE(CompressedClustersTest)
     BOOST_CHECK(pattVecD[i] == pattVec[i]);
   }
 }
+
+BOOST_AUTO_TEST_CASE(ExternalDictionaryTest)
+{
+  auto generate = [](std::vector<ROFRecord>& rofRecVec, std::vector<CompClusterExt>& cclusVec, uint32_t orbit) {
+    for (int irof = 0; irof < 10; irof++) {
+      auto& rofr = rofRecVec.emplace_back();
+      rofr.getBCData().orbit = orbit + irof;
+      rofr.setFirstEntry(cclusVec.size());
+      int ncl = gRandom->Poisson(500), chipID = gRandom->Integer(100);
+      for (int i = 0; i < ncl; i++) {
+        chipID += gRandom->Poisson(2);
+        cclusVec.emplace_back(gRandom->Integer(512), gRandom->Integer(1024), gRandom->Integer(900), chipID);
+      }
+      rofr.setNEntries(ncl);
+    }
+  };
+  std::vector<unsigned char> pattVec;
+
+  // train the dictionary on few TFs encoded with their own dictionaries
+  o2::ctf::CTFDictionary dict(CTF::getNBlocks());
+  for (int itf = 0; itf < 3; itf++) {
+    std::vector<ROFRecord> rofRecVec;
+    std::vector<CompClusterExt> cclusVec;
+    generate(rofRecVec, cclusVec, 256 * itf);
+    std::vector<o2::ctf::BufferType> vec;
+    CTFCoder::encode(vec, rofRecVec, cclusVec, pattVec);
+    CTF::getImage(vec.data()).updateDictionary(dict);
+  }
+  dict.finalize();
+  BOOST_CHECK(dict.getID() != 0);
+  BOOST_CHECK(dict.getNUpdates() == 3);
+
+  std::vector<ROFRecord> rofRecVec;
+  std::vector<CompClusterExt> cclusVec;
+  generate(rofRecVec, cclusVec, 1024);
+  std::vector<o2::ctf::BufferType> vecOwn, vecExt;
+  CTFCoder::encode(vecOwn, rofRecVec, cclusVec, pattVec);
+  CTFCoder::encode(vecExt, rofRecVec, cclusVec, pattVec, &dict);
+  CTF::get(vecOwn.data())->compactify();
+  CTF::get(vecExt.data())->compactify();
+  const auto ctfImage = CTF::getImage(vecExt.data());
+  BOOST_CHECK(ctfImage.getANSHeader().dictID == dict.getID());
+  BOOST_CHECK(CTF::get(vecExt.data())->size() < CTF::get(vecOwn.data())->size());
+
+  std::vector<ROFRecord> rofRecVecD;
+  std::vector<CompClusterExt> cclusVecD;
+  std::vector<unsigned char> pattVecD;
+  BOOST_CHECK_THROW(CTFCoder::decode(ctfImage, rofRecVecD, cclusVecD, pattVecD), std::runtime_error);
+  CTFCoder::decode(ctfImage, rofRecVecD, cclusVecD, pattVecD, &dict);
+  BOOST_REQUIRE(cclusVecD.size() == cclusVec.size());
+  for (size_t i = 0; i < cclusVec.size(); i++) {
+    BOOST_CHECK(cclusVecD[i].getChipID() == cclusVec[i].getChipID());
+    BOOST_CHECK(cclusVecD[i].getRow() == cclusVec[i].getRow());
+    BOOST_CHECK(cclusVecD[i].getCol() == cclusVec[i].getCol());
+    BOOST_CHECK(cclusVecD[i].getPatternID() == cclusVec[i].getPatternID());
+  }
+}
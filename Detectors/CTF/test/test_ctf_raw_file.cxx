@@ -0,0 +1,117 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test CTFRawFile
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "DataFormatsITSMFT/CompCluster.h"
+#include "DataFormatsITSMFT/CTF.h"
+#include "DataFormatsITSMFT/ROFRecord.h"
+#include "ITSMFTReconstruction/CTFCoder.h"
+#include "CTFWorkflow/CTFRawFile.h"
+#include "Framework/Logger.h"
+#include <TRandom.h>
+#include <fstream>
+
+using namespace o2::itsmft;
+using DetID = o2::detectors::DetID;
+
+BOOST_AUTO_TEST_CASE(CTFRawFileTest)
+{
+  const int nTF = 5;
+  std::vector<std::vector<CompClusterExt>> cclusVecs(nTF);
+  std::vector<std::vector<ROFRecord>> rofRecVecs(nTF);
+  std::vector<unsigned char> pattVec;
+
+  // write CTFs of several TFs to the same file, MFT is stored only for even TFs
+  {
+    o2::ctf::CTFRawFileWriter writer;
+    writer.open("test_ctf_raw_file.ctf");
+    for (int itf = 0; itf < nTF; itf++) {
+      auto& rofRecVec = rofRecVecs[itf];
+      auto& cclusVec = cclusVecs[itf];
+      for (int irof = 0; irof < 10; irof++) {
+        auto& rofr = rofRecVec.emplace_back();
+        rofr.getBCData().orbit = 256 * itf + irof;
+        rofr.setFirstEntry(cclusVec.size());
+        int ncl = gRandom->Poisson(500), chipID = gRandom->Integer(100);
+        for (int i = 0; i < ncl; i++) {
+          chipID += gRandom->Poisson(2);
+          cclusVec.emplace_back(gRandom->Integer(512), gRandom->Integer(1024), gRandom->Integer(900), chipID);
+        }
+        rofr.setNEntries(ncl);
+      }
+      std::vector<o2::ctf::BufferType> vec;
+      CTFCoder::encode(vec, rofRecVec, cclusVec, pattVec);
+
+      o2::ctf::CTFHeader header{1, uint32_t(256 * itf)};
+      std::array<o2::ctf::CTFRawFileWriter::ImageSpan, DetID::nDetectors> images{};
+      images[DetID::ITS] = {vec.data(), vec.size()};
+      header.detectors.set(DetID::ITS);
+      if (itf % 2 == 0) {
+        images[DetID::MFT] = {vec.data(), vec.size()};
+        header.detectors.set(DetID::MFT);
+      }
+      writer.addCTF(header, images);
+    }
+  }
+
+  BOOST_CHECK(o2::ctf::CTFRawFileReader::isRawCTFFile("test_ctf_raw_file.ctf"));
+  o2::ctf::CTFRawFileReader reader;
+  reader.open("test_ctf_raw_file.ctf");
+  BOOST_CHECK(reader.getNCTFs() == nTF);
+
+  // access TFs in random order, decoding directly from the mapped file
+  for (int itf : {3, 0, 4, 1, 2}) {
+    auto header = reader.getCTFHeader(itf);
+    BOOST_CHECK(header.firstTForbit == uint32_t(256 * itf));
+    BOOST_CHECK(header.detectors[DetID::ITS]);
+    BOOST_CHECK(header.detectors[DetID::MFT] == (itf % 2 == 0));
+    BOOST_CHECK(reader.getImage(itf, DetID::MFT).empty() != (itf % 2 == 0));
+
+    std::vector<ROFRecord> rofRecVecD;
+    std::vector<CompClusterExt> cclusVecD;
+    std::vector<unsigned char> pattVecD;
+    auto image = reader.getImage(itf, DetID::ITS);
+    const auto ctfImage = o2::itsmft::CTF::getImage(image.data());
+    CTFCoder::decode(ctfImage, rofRecVecD, cclusVecD, pattVecD);
+
+    BOOST_REQUIRE(rofRecVecD.size() == rofRecVecs[itf].size());
+    BOOST_REQUIRE(cclusVecD.size() == cclusVecs[itf].size());
+    for (size_t i = 0; i < rofRecVecD.size(); i++) {
+      BOOST_CHECK(rofRecVecD[i].getBCData() == rofRecVecs[itf][i].getBCData());
+      BOOST_CHECK(rofRecVecD[i].getNEntries() == rofRecVecs[itf][i].getNEntries());
+    }
+    for (size_t i = 0; i < cclusVecD.size(); i++) {
+      BOOST_CHECK(cclusVecD[i].getChipID() == cclusVecs[itf][i].getChipID());
+      BOOST_CHECK(cclusVecD[i].getRow() == cclusVecs[itf][i].getRow());
+      BOOST_CHECK(cclusVecD[i].getCol() == cclusVecs[itf][i].getCol());
+    }
+  }
+  BOOST_CHECK_THROW(reader.getImage(nTF, DetID::ITS), std::out_of_range);
+  BOOST_CHECK_THROW(reader.getCTFHeader(nTF), std::out_of_range);
+  reader.close();
+
+  // an index entry pointing outside of the file must be rejected on opening
+  {
+    std::fstream file("test_ctf_raw_file.ctf", std::ios::binary | std::ios::in | std::ios::out);
+    o2::ctf::CTFRawFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    o2::ctf::CTFRawIndexEntry entry;
+    file.seekg(header.indexOffset);
+    file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+    entry.size[DetID::ITS] = header.indexOffset;
+    file.seekp(header.indexOffset);
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+  }
+  BOOST_CHECK_THROW(reader.open("test_ctf_raw_file.ctf"), std::runtime_error);
+  BOOST_CHECK(!reader.isOpen());
+}
@@ -0,0 +1,88 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/CallbackService.h"
+#include "Framework/ControlService.h"
+#include "Framework/DataProcessorSpec.h"
+#include "Framework/DataRefUtils.h"
+#include "Framework/EndOfStreamContext.h"
+#include "Framework/Logger.h"
+#include "Framework/runDataProcessing.h"
+#include "CTFWorkflow/CTFReaderSpec.h"
+#include "DetectorsCommonDataFormats/CTFHeader.h"
+#include "DetectorsCommonDataFormats/NameConf.h"
+#include "DataFormatsITSMFT/CTF.h"
+#include "ITSMFTReconstruction/CTFCoder.h"
+#include "CommonUtils/StringUtils.h"
+#include "CTFWorkflowTestData.h"
+
+using namespace o2::framework;
+using DetID = o2::detectors::DetID;
+
+#define ASSERT_ERROR(condition)                                   \
+  if ((condition) == false) {                                     \
+    LOG(ERROR) << R"(Test condition ")" #condition R"(" failed)"; \
+  }
+
+// Reads back the files stored by the writer test: the sink checks that
+// every TF arrives once, in order, with the header and the ITS clusters
+// which were written, and that the end of stream comes after all of them.
+WorkflowSpec defineDataProcessing(ConfigContext const&)
+{
+  DetID::mask_t dets;
+  dets.set(DetID::ITS);
+  std::string input;
+  for (int tf = 0; tf < o2::ctf::test::NTFs; tf++) {
+    input += o2::utils::concat_string(tf ? "," : "", o2::base::NameConf::getCTFFileName(o2::ctf::test::getTFOrbit(tf)));
+  }
+  return WorkflowSpec{
+    o2::ctf::getCTFReaderSpec(dets, input),
+    DataProcessorSpec{
+      "ctf-test-sink",
+      {InputSpec{"header", "CTF", "HEADER", 0, Lifetime::Timeframe},
+       InputSpec{"ctf", "ITS", "CTFDATA", 0, Lifetime::Timeframe}},
+      Outputs{},
+      AlgorithmSpec{[](InitContext& ic) {
+        auto counter = std::make_shared<int>(0);
+        ic.services().get<CallbackService>().set(CallbackService::Id::EndOfStream, [counter](EndOfStreamContext&) {
+          ASSERT_ERROR(*counter == o2::ctf::test::NTFs);
+        });
+        return [counter](ProcessingContext& pc) {
+          ASSERT_ERROR(*counter < o2::ctf::test::NTFs);
+          auto orbit = o2::ctf::test::getTFOrbit(*counter);
+          auto header = pc.inputs().get<o2::ctf::CTFHeader>("header");
+          ASSERT_ERROR(header.firstTForbit == orbit);
+          ASSERT_ERROR(header.detectors[DetID::ITS]);
+          ASSERT_ERROR(DataRefUtils::getHeader<o2::header::DataHeader*>(pc.inputs().get("ctf"))->firstTForbit == orbit);
+
+          auto buffer = pc.inputs().get<gsl::span<o2::ctf::BufferType>>("ctf");
+          std::vector<o2::itsmft::ROFRecord> rofs;
+          std::vector<o2::itsmft::CompClusterExt> clusters;
+          std::vector<unsigned char> patterns;
+          o2::itsmft::CTFCoder::decode(o2::itsmft::CTF::getImage(buffer.data()), rofs, clusters, patterns);
+          auto expected = o2::ctf::test::generateITSData(*counter);
+          ASSERT_ERROR(rofs.size() == expected.rofs.size());
+          for (size_t i = 0; i < std::min(rofs.size(), expected.rofs.size()); i++) {
+            ASSERT_ERROR(rofs[i].getBCData() == expected.rofs[i].getBCData());
+            ASSERT_ERROR(rofs[i].getFirstEntry() == expected.rofs[i].getFirstEntry());
+            ASSERT_ERROR(rofs[i].getNEntries() == expected.rofs[i].getNEntries());
+          }
+          ASSERT_ERROR(clusters.size() == expected.clusters.size());
+          for (size_t i = 0; i < std::min(clusters.size(), expected.clusters.size()); i++) {
+            ASSERT_ERROR(clusters[i].getChipID() == expected.clusters[i].getChipID());
+            ASSERT_ERROR(clusters[i].getRow() == expected.clusters[i].getRow());
+            ASSERT_ERROR(clusters[i].getCol() == expected.clusters[i].getCol());
+            ASSERT_ERROR(clusters[i].getPatternID() == expected.clusters[i].getPatternID());
+          }
+          ASSERT_ERROR(patterns == expected.patterns);
+          (*counter)++;
+        };
+      }}}};
+}
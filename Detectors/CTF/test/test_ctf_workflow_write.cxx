@@ -0,0 +1,47 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/ControlService.h"
+#include "Framework/DataProcessorSpec.h"
+#include "Framework/Logger.h"
+#include "Framework/runDataProcessing.h"
+#include "CTFWorkflow/CTFWriterSpec.h"
+#include "ITSMFTReconstruction/CTFCoder.h"
+#include "CTFWorkflowTestData.h"
+
+using namespace o2::framework;
+using DetID = o2::detectors::DetID;
+
+// The source encodes the ITS clusters of NTFs TFs, which the CTF writer
+// stores, one TF per file. The files are read back by the reader test.
+WorkflowSpec defineDataProcessing(ConfigContext const&)
+{
+  DetID::mask_t dets;
+  dets.set(DetID::ITS);
+  return WorkflowSpec{
+    DataProcessorSpec{
+      "ctf-test-source",
+      Inputs{},
+      {OutputSpec{{"ctf"}, "ITS", "CTFDATA", 0, Lifetime::Timeframe}},
+      AlgorithmSpec{[counter = std::make_shared<int>(0)](ProcessingContext& pc) {
+        if (*counter < o2::ctf::test::NTFs) {
+          auto data = o2::ctf::test::generateITSData(*counter);
+          auto& buffer = pc.outputs().make<std::vector<o2::ctf::BufferType>>(OutputRef{"ctf"});
+          o2::itsmft::CTFCoder::encode(buffer, data.rofs, data.clusters, data.patterns);
+          pc.outputs().findMessageHeader(OutputRef{"ctf"})->firstTForbit = o2::ctf::test::getTFOrbit(*counter);
+          (*counter)++;
+        }
+        if (*counter == o2::ctf::test::NTFs) {
+          pc.services().get<ControlService>().endOfStream();
+          pc.services().get<ControlService>().readyToQuit(QuitRequest::Me);
+        }
+      }}},
+    o2::ctf::getCTFWriterSpec(dets, 1)};
+}
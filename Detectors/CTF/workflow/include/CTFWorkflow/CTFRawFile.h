@@ -0,0 +1,122 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   CTFRawFile.h
+/// @brief  Raw container of flat CTF images, readable via mmap w/o deserialization
+
+#ifndef O2_CTFRAWFILE_H
+#define O2_CTFRAWFILE_H
+
+#include <array>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gsl/span>
+
+#include "DetectorsCommonDataFormats/DetID.h"
+#include "DetectorsCommonDataFormats/CTFHeader.h"
+#include "DetectorsCommonDataFormats/EncodedBlocks.h"
+
+namespace o2
+{
+namespace ctf
+{
+
+using DetID = o2::detectors::DetID;
+
+/// File layout: CTFRawFileHeader | flat EncodedBlocks images of all CTFs | index (CTFRawIndexEntry per CTF).
+/// Every image starts at the offset aligned to o2::ctf::Alignment, so that the mapped file can be used as is.
+struct CTFRawFileHeader {
+  static constexpr uint32_t CurrentVersion = 1;
+
+  char magic[8] = {'O', '2', 'C', 'T', 'F', 'R', 'A', 'W'};
+  uint32_t version = CurrentVersion;
+  uint32_t nDetectors = DetID::nDetectors; // size of the per-detector arrays of the index entries
+  uint64_t nCTFs = 0;                      // number of stored CTFs
+  uint64_t indexOffset = 0;                // offset of the index wrt the file start, 0 if the file was not closed properly
+};
+
+struct CTFRawIndexEntry {
+  uint64_t run = 0;
+  uint32_t firstTForbit = 0;
+  uint32_t reserved = 0;
+  uint64_t detectors = 0;                            // mask of stored detectors
+  std::array<uint64_t, DetID::nDetectors> offset{}; // offset of the detector image wrt the file start
+  std::array<uint64_t, DetID::nDetectors> size{};   // size of the detector image in bytes
+};
+
+/// writes CTF images to raw file
+class CTFRawFileWriter
+{
+ public:
+  using ImageSpan = gsl::span<const o2::ctf::BufferType>;
+
+  CTFRawFileWriter() = default;
+  ~CTFRawFileWriter();
+
+  void open(const std::string& name);
+  void close();
+  bool isOpen() const { return mFile.is_open(); }
+
+  /// add CTF of single TF, images of absent detectors must be empty
+  void addCTF(const CTFHeader& header, const std::array<ImageSpan, DetID::nDetectors>& images);
+
+  const std::string& getName() const { return mName; }
+  size_t getNCTFs() const { return mIndex.size(); }
+  size_t getSize() const { return mOffset; }
+
+ private:
+  void write(const void* data, size_t size);
+
+  std::ofstream mFile;
+  std::string mName;
+  std::vector<CTFRawIndexEntry> mIndex;
+  size_t mOffset = 0; // current write position
+};
+
+/// maps the raw CTF file in memory and provides direct access to the stored images
+class CTFRawFileReader
+{
+ public:
+  using ImageSpan = gsl::span<const o2::ctf::BufferType>;
+
+  CTFRawFileReader() = default;
+  CTFRawFileReader(const CTFRawFileReader&) = delete;
+  CTFRawFileReader& operator=(const CTFRawFileReader&) = delete;
+  ~CTFRawFileReader() { close(); }
+
+  /// check if the file is in raw CTF format
+  static bool isRawCTFFile(const std::string& name);
+
+  void open(const std::string& name);
+  void close();
+  bool isOpen() const { return mData != nullptr; }
+
+  const std::string& getName() const { return mName; }
+  size_t getNCTFs() const { return mHeader ? mHeader->nCTFs : 0; }
+  CTFHeader getCTFHeader(size_t i) const;
+
+  /// image of the detector CTF which can be passed to CTF::getImage, empty if the detector is absent
+  ImageSpan getImage(size_t i, DetID det) const;
+
+ private:
+  const CTFRawIndexEntry& getEntry(size_t i) const;
+
+  std::string mName;
+  const char* mData = nullptr; // mapped file
+  size_t mSize = 0;
+  const CTFRawFileHeader* mHeader = nullptr;
+  const CTFRawIndexEntry* mIndex = nullptr;
+};
+
+} // namespace ctf
+} // namespace o2
+
+#endif /* O2_CTFRAWFILE_H */
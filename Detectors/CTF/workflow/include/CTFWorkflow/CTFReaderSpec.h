@@ -16,11 +16,13 @@
 #include "TFile.h"
 #include "TTree.h"
 #include <TStopwatch.h>
+#include <memory>
 
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/Task.h"
 
 #include "DetectorsCommonDataFormats/DetID.h"
+#include "CTFWorkflow/CTFRawFile.h"
 
 namespace o2
 {
@@ -38,9 +40,22 @@ class CTFReaderSpec : public o2::framework::Task
   void run(o2::framework::ProcessingContext& pc) final;
 
  private:
+  bool prepareNextEntry();
+  void openFile(const std::string& inputFile);
+  void selectEntries(const std::vector<uint32_t>& orbits);
+  void sendRawImage(o2::framework::ProcessingContext& pc, DetID det, int entry);
+
   DetID::mask_t mDets;             // detectors
   std::vector<std::string> mInput; // input files
-  size_t mNextToProcess = 0;
+  std::vector<uint32_t> mOrbits;   // TFs to read (sorted 1st orbits), all if empty
+  size_t mNextToProcess = 0;       // next input file to open
+  std::unique_ptr<TFile> mFile;    // currently read file
+  std::unique_ptr<TTree> mTree;    // CTF tree of the current file
+  CTFRawFileReader mRawFile;       // currently read file in raw CTF format
+  bool mRawInput = false;          // current file is in raw CTF format
+  std::vector<int> mEntries;       // tree entries to read from the current file
+  size_t mNextEntry = 0;           // next entry in mEntries to read
+  bool mDone = false;              // all selected entries were sent and the end of stream was signalled
   TStopwatch mTimer;
 };
 
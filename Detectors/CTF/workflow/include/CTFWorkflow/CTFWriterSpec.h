@@ -19,7 +19,18 @@
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/Task.h"
 #include "DataFormatsParameters/GRPObject.h"
+#include "DetectorsCommonDataFormats/CTFHeader.h"
+#include "DetectorsCommonDataFormats/EncodedBlocks.h"
+#include "DetectorsCommonDataFormats/CTFDictionary.h"
+#include "CTFWorkflow/CTFRawFile.h"
 #include <TStopwatch.h>
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <condition_variable>
 
 namespace o2
 {
@@ -36,15 +47,65 @@ class CTFWriterSpec : public o2::framework::Task
     mTimer.Stop();
     mTimer.Reset();
   }
-  ~CTFWriterSpec() override = default;
+  ~CTFWriterSpec() override;
   void init(o2::framework::InitContext& ic) final;
   void run(o2::framework::ProcessingContext& pc) final;
   void endOfStream(o2::framework::EndOfStreamContext& ec) final;
   bool isPresent(DetID id) const { return mDets[id]; }
 
  private:
+  /// private copy of the CTF of a single TF, owned by the writer until it is stored
+  struct CTFData {
+    CTFHeader header;
+    std::array<std::vector<o2::ctf::BufferType>, DetID::nDetectors> buffers;
+    size_t size = 0; // total size of the buffers in bytes
+  };
+
+  void writeCTF(const CTFData& ctf);
+  void appendToROOTFile(const CTFData& ctf);
+  void openFile(uint32_t tfOrb);
+  void closeFile();
+  void startWriter();
+  void stopWriter();
+  void writerLoop();
+  void updateDictionaries(const CTFData& ctf);
+  void storeDictionaries();
+  void finalize(); // store everything pending and close the file, at the end of stream or stop
+
+  bool mFinalized = false;
+
   DetID::mask_t mDets; // detectors
   uint64_t mRun = 0;
+
+  // aggregation of TFs in the same file
+  int mMaxCTFPerFile = 1;     // close the file after this number of CTFs, 0: no limit
+  size_t mMaxFileSize = 0;    // close the file once its (uncompressed) CTF content exceeds this size, 0: no limit
+  bool mRawOutput = false;    // write raw CTF container instead of ROOT file
+  std::string mFileName;      // currently written file, empty if none
+  std::unique_ptr<TFile> mFile;
+  std::unique_ptr<TTree> mTree;
+  CTFRawFileWriter mRawFile;
+  std::vector<CTFHeader> mIndex; // headers of the CTFs stored in the current file, in order of entries
+  size_t mFileSize = 0;
+
+  // training of external dictionaries from the dictionaries stored with the encoded blocks
+  bool mCreateDict = false;
+  int mSaveDictAfter = 0; // store intermediate dictionaries after this number of TFs, 0: at the end of stream only
+  int mNDictTFs = 0;
+  std::array<std::unique_ptr<CTFDictionary>, DetID::nDetectors> mDicts;
+
+  // asynchronous writing
+  bool mAsync = false;
+  size_t mMaxPendingSize = 0; // max size of CTF data waiting to be written, the processing blocks above this
+  size_t mPendingSize = 0;
+  bool mStopRequested = false;
+  std::deque<std::unique_ptr<CTFData>> mQueue;
+  std::mutex mMutex;
+  std::condition_variable mCondNewData;
+  std::condition_variable mCondDataWritten;
+  std::thread mWriterThread;
+  std::exception_ptr mWriterException;
+
   TStopwatch mTimer;
 };
 
@@ -0,0 +1,191 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   CTFRawFile.cxx
+
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "CTFWorkflow/CTFRawFile.h"
+#include "CommonUtils/StringUtils.h"
+#include "Framework/Logger.h"
+
+using namespace o2::ctf;
+
+///_______________________________________
+CTFRawFileWriter::~CTFRawFileWriter()
+{
+  try {
+    close();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to close raw CTF file " << mName << ": " << e.what();
+  }
+}
+
+///_______________________________________
+void CTFRawFileWriter::open(const std::string& name)
+{
+  close();
+  mFile.open(name, std::ios::binary | std::ios::trunc);
+  if (!mFile.is_open()) {
+    throw std::runtime_error(o2::utils::concat_string("failed to open raw CTF file ", name));
+  }
+  mName = name;
+  mIndex.clear();
+  mOffset = 0;
+  CTFRawFileHeader header; // will be rewritten with the final content on closing
+  write(&header, sizeof(header));
+}
+
+///_______________________________________
+void CTFRawFileWriter::write(const void* data, size_t size)
+{
+  mFile.write(reinterpret_cast<const char*>(data), size);
+  mOffset += size;
+  // pad to alignment
+  static const std::array<char, Alignment> padding{};
+  auto alignedOffset = alignSize(mOffset);
+  if (alignedOffset != mOffset) {
+    mFile.write(padding.data(), alignedOffset - mOffset);
+    mOffset = alignedOffset;
+  }
+  if (!mFile) {
+    throw std::runtime_error(o2::utils::concat_string("failed to write to raw CTF file ", mName));
+  }
+}
+
+///_______________________________________
+void CTFRawFileWriter::addCTF(const CTFHeader& header, const std::array<ImageSpan, DetID::nDetectors>& images)
+{
+  assert(isOpen());
+  auto& entry = mIndex.emplace_back();
+  entry.run = header.run;
+  entry.firstTForbit = header.firstTForbit;
+  entry.detectors = header.detectors.to_ullong();
+  for (int id = DetID::First; id <= DetID::Last; id++) {
+    if (images[id].empty()) {
+      continue;
+    }
+    entry.offset[id] = mOffset;
+    entry.size[id] = images[id].size();
+    write(images[id].data(), images[id].size());
+  }
+}
+
+///_______________________________________
+void CTFRawFileWriter::close()
+{
+  if (!isOpen()) {
+    return;
+  }
+  CTFRawFileHeader header;
+  header.nCTFs = mIndex.size();
+  header.indexOffset = mOffset;
+  write(mIndex.data(), mIndex.size() * sizeof(CTFRawIndexEntry));
+  mFile.seekp(0);
+  mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  mFile.close();
+  LOG(INFO) << "Closed raw CTF file " << mName << " with " << header.nCTFs << " CTFs, " << mOffset << " bytes";
+}
+
+///_______________________________________
+bool CTFRawFileReader::isRawCTFFile(const std::string& name)
+{
+  CTFRawFileHeader header;
+  std::ifstream file(name, std::ios::binary);
+  return file.read(reinterpret_cast<char*>(&header), sizeof(header)) && std::memcmp(header.magic, CTFRawFileHeader{}.magic, sizeof(header.magic)) == 0;
+}
+
+///_______________________________________
+void CTFRawFileReader::open(const std::string& name)
+{
+  close();
+  int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(o2::utils::concat_string("failed to open raw CTF file ", name));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(CTFRawFileHeader)) {
+    ::close(fd);
+    throw std::runtime_error(o2::utils::concat_string("raw CTF file ", name, " is too short"));
+  }
+  void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping stays valid
+  if (ptr == MAP_FAILED) {
+    throw std::runtime_error(o2::utils::concat_string("failed to map raw CTF file ", name));
+  }
+  mName = name;
+  mData = reinterpret_cast<const char*>(ptr);
+  mSize = st.st_size;
+  mHeader = reinterpret_cast<const CTFRawFileHeader*>(mData);
+  if (std::memcmp(mHeader->magic, CTFRawFileHeader{}.magic, sizeof(mHeader->magic)) != 0 ||
+      mHeader->version != CTFRawFileHeader::CurrentVersion || mHeader->nDetectors != DetID::nDetectors) {
+    close();
+    throw std::runtime_error(o2::utils::concat_string("file ", name, " is not a raw CTF file of supported version"));
+  }
+  if (!mHeader->indexOffset || mHeader->indexOffset > mSize || mHeader->nCTFs > (mSize - mHeader->indexOffset) / sizeof(CTFRawIndexEntry)) {
+    close();
+    throw std::runtime_error(o2::utils::concat_string("raw CTF file ", name, " has no valid index, was it closed?"));
+  }
+  mIndex = reinterpret_cast<const CTFRawIndexEntry*>(mData + mHeader->indexOffset);
+  // the images must lie between the header and the index
+  for (size_t i = 0; i < mHeader->nCTFs; i++) {
+    for (int id = DetID::First; id <= DetID::Last; id++) {
+      auto offset = mIndex[i].offset[id], size = mIndex[i].size[id];
+      if (size && (offset < sizeof(CTFRawFileHeader) || offset > mHeader->indexOffset || size > mHeader->indexOffset - offset)) {
+        close();
+        throw std::runtime_error(o2::utils::concat_string("raw CTF file ", name, " is corrupted: image of ", DetID::getName(id),
+                                                          " for CTF ", std::to_string(i), " is outside of the data section"));
+      }
+    }
+  }
+  LOG(INFO) << "Mapped raw CTF file " << name << " with " << getNCTFs() << " CTFs";
+}
+
+///_______________________________________
+void CTFRawFileReader::close()
+{
+  if (mData) {
+    munmap(const_cast<char*>(mData), mSize);
+  }
+  mData = nullptr;
+  mSize = 0;
+  mHeader = nullptr;
+  mIndex = nullptr;
+}
+
+///_______________________________________
+const CTFRawIndexEntry& CTFRawFileReader::getEntry(size_t i) const
+{
+  if (i >= getNCTFs()) {
+    throw std::out_of_range(o2::utils::concat_string("CTF ", std::to_string(i), " requested from raw CTF file ", mName,
+                                                     " with ", std::to_string(getNCTFs()), " CTFs"));
+  }
+  return mIndex[i];
+}
+
+///_______________________________________
+CTFHeader CTFRawFileReader::getCTFHeader(size_t i) const
+{
+  const auto& entry = getEntry(i);
+  return CTFHeader{entry.run, entry.firstTForbit, DetID::mask_t(entry.detectors)};
+}
+
+///_______________________________________
+CTFRawFileReader::ImageSpan CTFRawFileReader::getImage(size_t i, DetID det) const
+{
+  // the image bounds were validated when opening the file
+  const auto& entry = getEntry(i);
+  return ImageSpan(reinterpret_cast<const o2::ctf::BufferType*>(mData + entry.offset[det]), entry.size[det]);
+}
@@ -11,6 +11,8 @@
 /// @file   CTFReaderSpec.cxx
 
 #include <vector>
+#include <algorithm>
+#include <cstring>
 #include <TFile.h>
 #include <TTree.h>
 
@@ -59,31 +61,116 @@ CTFReaderSpec::CTFReaderSpec(DetID::mask_t dm, const std::string& inp) : mDets(d
 ///_______________________________________
 void CTFReaderSpec::init(InitContext& ic)
 {
+  mOrbits = RangeTokenizer::tokenize<uint32_t>(ic.options().get<std::string>("select-tf-orbits"));
+  std::sort(mOrbits.begin(), mOrbits.end());
 }
 
 ///_______________________________________
-void CTFReaderSpec::run(ProcessingContext& pc)
+void CTFReaderSpec::openFile(const std::string& inputFile)
 {
-  if (mNextToProcess >= mInput.size()) {
+  LOG(INFO) << "Opening CTF input " << mNextToProcess << ' ' << inputFile;
+  mTree.reset();
+  mFile.reset();
+  mRawFile.close();
+  mEntries.clear();
+  mNextEntry = 0;
+  std::vector<uint32_t> orbits;
+  mRawInput = CTFRawFileReader::isRawCTFFile(inputFile);
+  if (mRawInput) {
+    mRawFile.open(inputFile);
+    for (size_t i = 0; i < mRawFile.getNCTFs(); i++) {
+      orbits.push_back(mRawFile.getCTFHeader(i).firstTForbit);
+    }
+    selectEntries(orbits);
     return;
   }
-
-  auto cput = mTimer.CpuTime();
-  mTimer.Start(false);
-  const auto& inputFile = mInput[mNextToProcess];
-  LOG(INFO) << "Reading CTF input " << mNextToProcess << ' ' << inputFile;
-
-  TFile flIn(inputFile.c_str());
-  if (!flIn.IsOpen() || flIn.IsZombie()) {
+  mFile = std::make_unique<TFile>(inputFile.c_str());
+  if (!mFile->IsOpen() || mFile->IsZombie()) {
     LOG(ERROR) << "Failed to open file " << inputFile;
     throw std::runtime_error("failed to open CTF file");
   }
-  std::unique_ptr<TTree> tree((TTree*)flIn.Get(std::string(o2::base::NameConf::CTFTREENAME).c_str()));
-  if (!tree) {
+  mTree.reset((TTree*)mFile->Get(std::string(o2::base::NameConf::CTFTREENAME).c_str()));
+  if (!mTree) {
     throw std::runtime_error("failed to load CTF tree");
   }
+  // use the index of stored TFs if available, otherwise (old single-TF files) scan the headers
+  std::vector<CTFHeader>* index = nullptr;
+  mFile->GetObject(std::string(o2::base::NameConf::CTFINDEXNAME).c_str(), index);
+  if (index) {
+    for (const auto& h : *index) {
+      orbits.push_back(h.firstTForbit);
+    }
+    delete index;
+  } else {
+    CTFHeader ctfHeader;
+    for (int ev = 0; ev < mTree->GetEntries(); ev++) {
+      if (!readFromTree(*mTree, "CTFHeader", ctfHeader, ev)) {
+        throw std::runtime_error("did not find CTFHeader");
+      }
+      orbits.push_back(ctfHeader.firstTForbit);
+    }
+  }
+  selectEntries(orbits);
+}
+
+///_______________________________________
+void CTFReaderSpec::selectEntries(const std::vector<uint32_t>& orbits)
+{
+  for (int ev = 0; ev < int(orbits.size()); ev++) {
+    if (mOrbits.empty() || std::binary_search(mOrbits.begin(), mOrbits.end(), orbits[ev])) {
+      mEntries.push_back(ev);
+    }
+  }
+  LOG(INFO) << "Selected " << mEntries.size() << " of " << orbits.size() << " CTFs stored in " << mInput[mNextToProcess - 1];
+}
+
+///_______________________________________
+void CTFReaderSpec::sendRawImage(ProcessingContext& pc, DetID det, int entry)
+{
+  // the image is already a flat EncodedBlocks object, no deserialization is needed
+  auto image = mRawFile.getImage(entry, det);
+  auto buffer = pc.outputs().make<o2::ctf::BufferType>({det.getName()}, image.size());
+  std::memcpy(buffer.data(), image.data(), image.size());
+}
+
+///_______________________________________
+bool CTFReaderSpec::prepareNextEntry()
+{
+  while (mNextEntry >= mEntries.size()) {
+    if (mNextToProcess >= mInput.size()) {
+      return false;
+    }
+    openFile(mInput[mNextToProcess++]);
+  }
+  return true;
+}
+
+///_______________________________________
+void CTFReaderSpec::run(ProcessingContext& pc)
+{
+  if (mDone) { // the device may still be called after requesting to quit
+    return;
+  }
+  auto finalize = [&]() {
+    mDone = true;
+    pc.services().get<ControlService>().endOfStream();
+    pc.services().get<ControlService>().readyToQuit(QuitRequest::Me);
+    LOGF(INFO, "CTF reading total timing: Cpu: %.3e Real: %.3e s in %d slots",
+         mTimer.CpuTime(), mTimer.RealTime(), mTimer.Counter() - 1);
+  };
+  if (!prepareNextEntry()) { // nothing was selected
+    finalize();
+    return;
+  }
+
+  auto cput = mTimer.CpuTime();
+  mTimer.Start(false);
+  int entry = mEntries[mNextEntry++];
+  auto* tree = mTree.get();
   CTFHeader ctfHeader;
-  if (!readFromTree(*tree, "CTFHeader", ctfHeader)) {
+  if (mRawInput) {
+    ctfHeader = mRawFile.getCTFHeader(entry);
+  } else if (!readFromTree(*tree, "CTFHeader", ctfHeader, entry)) {
     throw std::runtime_error("did not find CTFHeader");
   }
   LOG(INFO) << ctfHeader;
@@ -105,33 +192,42 @@ void CTFReaderSpec::run(ProcessingContext& pc)
 
   det = DetID::ITS;
   if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::itsmft::CTF));
-    o2::itsmft::CTF::readFromTree(bufVec, *(tree.get()), det.getName());
+    if (mRawInput) {
+      sendRawImage(pc, det, entry);
+    } else {
+      auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::itsmft::CTF));
+      o2::itsmft::CTF::readFromTree(bufVec, *tree, det.getName(), entry);
+    }
     setFirstTFOrbit(det.getName());
   }
 
   det = DetID::MFT;
   if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::itsmft::CTF));
-    o2::itsmft::CTF::readFromTree(bufVec, *(tree.get()), det.getName());
+    if (mRawInput) {
+      sendRawImage(pc, det, entry);
+    } else {
+      auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::itsmft::CTF));
+      o2::itsmft::CTF::readFromTree(bufVec, *tree, det.getName(), entry);
+    }
     setFirstTFOrbit(det.getName());
   }
 
   det = DetID::TPC;
   if (detsTF[det]) {
-    auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::tpc::CTF));
-    o2::tpc::CTF::readFromTree(bufVec, *(tree.get()), det.getName());
+    if (mRawInput) {
+      sendRawImage(pc, det, entry);
+    } else {
+      auto& bufVec = pc.outputs().make<std::vector<o2::ctf::BufferType>>({det.getName()}, sizeof(o2::tpc::CTF));
+      o2::tpc::CTF::readFromTree(bufVec, *tree, det.getName(), entry);
+    }
     setFirstTFOrbit(det.getName());
   }
 
   mTimer.Stop();
-  LOG(INFO) << "Read CTF " << inputFile << " in " << mTimer.CpuTime() - cput << " s";
+  LOG(INFO) << "Read CTF entry " << entry << " of " << mInput[mNextToProcess - 1] << " in " << mTimer.CpuTime() - cput << " s";
 
-  if (++mNextToProcess >= mInput.size()) {
-    pc.services().get<ControlService>().endOfStream();
-    pc.services().get<ControlService>().readyToQuit(QuitRequest::Me);
-    LOGF(INFO, "CTF reading total timing: Cpu: %.3e Real: %.3e s in %d slots",
-         mTimer.CpuTime(), mTimer.RealTime(), mTimer.Counter() - 1);
+  if (!prepareNextEntry()) {
+    finalize();
   }
 }
 
@@ -152,7 +248,7 @@ DataProcessorSpec getCTFReaderSpec(DetID::mask_t dets, const std::string& inp)
     Inputs{},
     outputs,
     AlgorithmSpec{adaptFromTask<CTFReaderSpec>(dets, inp)},
-    Options{}};
+    Options{{"select-tf-orbits", VariantType::String, "", {"comma-separated list of 1st orbits of the TFs to read, all if empty"}}}};
 }
 
 } // namespace ctf
@@ -13,9 +13,11 @@
 #include <vector>
 #include <TFile.h>
 #include <TTree.h>
+#include <TROOT.h>
 
 #include "Framework/Logger.h"
 #include "Framework/ControlService.h"
+#include "Framework/CallbackService.h"
 #include "Framework/ConfigParamRegistry.h"
 #include "Framework/InputSpec.h"
 #include "CommonUtils/StringUtils.h"
@@ -47,8 +49,72 @@ void appendToTree(TTree& tree, const std::string brname, T& ptr)
   br->ResetAddress();
 }
 
+/// append CTF of the detector to the tree, if the detector is not present in the TF an empty container is stored
+template <typename C>
+void appendDetCTF(TTree& tree, DetID det, const std::vector<o2::ctf::BufferType>& buffer)
+{
+  if (buffer.empty()) {
+    C ctf;
+    ctf.appendToTree(tree, det.getName());
+  } else {
+    const auto ctfImage = C::getImage(buffer.data());
+    LOG(INFO) << "CTF for " << det.getName();
+    ctfImage.print();
+    ctfImage.appendToTree(tree, det.getName());
+  }
+}
+
+/// add the dictionaries stored with the CTF blocks of the detector to its external dictionary
+template <typename C>
+void updateDetDictionary(std::unique_ptr<CTFDictionary>& dict, const std::vector<o2::ctf::BufferType>& buffer)
+{
+  if (buffer.empty()) {
+    return;
+  }
+  if (!dict) {
+    dict = std::make_unique<CTFDictionary>(C::getNBlocks());
+  }
+  const auto ctfImage = C::getImage(buffer.data());
+  ctfImage.updateDictionary(*dict);
+}
+
+CTFWriterSpec::~CTFWriterSpec()
+{
+  // normally everything is written at the end of stream or stop, this only covers the abnormal termination
+  try {
+    stopWriter();
+    closeFile();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to finalize CTF writing: " << e.what();
+  } catch (...) {
+    LOG(ERROR) << "Failed to finalize CTF writing";
+  }
+}
+
 void CTFWriterSpec::init(InitContext& ic)
 {
+  mMaxCTFPerFile = ic.options().get<int>("ctf-per-file");
+  mMaxFileSize = size_t(ic.options().get<int64_t>("max-file-size"));
+  mMaxPendingSize = size_t(ic.options().get<int64_t>("max-pending-size"));
+  mAsync = ic.options().get<bool>("async-write");
+  auto outType = ic.options().get<std::string>("output-type");
+  if (outType != "root" && outType != "raw") {
+    throw std::runtime_error(o2::utils::concat_string("unknown CTF output type ", outType));
+  }
+  mRawOutput = outType == "raw";
+  mCreateDict = ic.options().get<bool>("create-dict");
+  mSaveDictAfter = ic.options().get<int>("save-dict-after");
+  if (mCreateDict) {
+    LOG(INFO) << "Will create CTF dictionaries in " << o2::base::NameConf::CTFDICTFILENAME
+              << (mSaveDictAfter > 0 ? o2::utils::concat_string(", updated every ", mSaveDictAfter, " TFs") : std::string{});
+  }
+  LOG(INFO) << "Will store up to " << mMaxCTFPerFile << " CTFs (0: no limit) or " << mMaxFileSize << " bytes (0: no limit) per file"
+            << (mAsync ? o2::utils::concat_string(", asynchronously with up to ", std::to_string(mMaxPendingSize), " bytes in flight") : std::string{});
+  if (mAsync) {
+    startWriter();
+  }
+  // the device may be stopped w/o end of stream
+  ic.services().get<CallbackService>().set(CallbackService::Id::Stop, [this]() { finalize(); });
 }
 
 void CTFWriterSpec::run(ProcessingContext& pc)
@@ -57,56 +123,240 @@ void CTFWriterSpec::run(ProcessingContext& pc)
   mTimer.Start(false);
 
   auto tfOrb = DataRefUtils::getHeader<o2::header::DataHeader*>(pc.inputs().getByPos(0))->firstTForbit;
-  TFile flOut(o2::base::NameConf::getCTFFileName(tfOrb).c_str(), "recreate");
-  TTree ctfTree(std::string(o2::base::NameConf::CTFTREENAME).c_str(), "O2 CTF tree");
 
-  // create header
-  CTFHeader header{mRun, tfOrb};
+  // the input messages are owned by the framework, take a copy to be stored
+  auto ctf = std::make_unique<CTFData>();
+  ctf->header = CTFHeader{mRun, tfOrb};
+  for (auto id = DetID::First; id <= DetID::Last; id++) {
+    DetID det(id);
+    if (isPresent(det) && pc.inputs().isValid(det.getName())) {
+      auto ctfBuffer = pc.inputs().get<gsl::span<o2::ctf::BufferType>>(det.getName());
+      ctf->buffers[id].assign(ctfBuffer.begin(), ctfBuffer.end());
+      ctf->size += ctfBuffer.size();
+      ctf->header.detectors.set(det);
+    }
+  }
+
+  if (mCreateDict) {
+    updateDictionaries(*ctf);
+  }
+
+  if (mAsync) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    // block the processing if too much data is waiting to be written
+    mCondDataWritten.wait(lock, [this, &ctf] { return mQueue.empty() || mPendingSize + ctf->size <= mMaxPendingSize || mWriterException; });
+    if (mWriterException) {
+      std::rethrow_exception(mWriterException);
+    }
+    mPendingSize += ctf->size;
+    mQueue.push_back(std::move(ctf));
+    lock.unlock();
+    mCondNewData.notify_one();
+  } else {
+    writeCTF(*ctf);
+  }
 
+  mTimer.Stop();
+  LOG(INFO) << "Processed CTF{" << CTFHeader{mRun, tfOrb} << "} in " << mTimer.CpuTime() - cput << " s";
+}
+
+void CTFWriterSpec::writeCTF(const CTFData& ctf)
+{
+  if (mFileName.empty()) {
+    openFile(ctf.header.firstTForbit);
+  }
+  auto header = ctf.header;
+  if (mRawOutput) {
+    std::array<CTFRawFileWriter::ImageSpan, DetID::nDetectors> images{};
+    for (auto id = DetID::First; id <= DetID::Last; id++) {
+      images[id] = CTFRawFileWriter::ImageSpan(ctf.buffers[id].data(), ctf.buffers[id].size());
+    }
+    mRawFile.addCTF(header, images);
+  } else {
+    appendToROOTFile(ctf);
+  }
+  mIndex.push_back(header);
+  mFileSize += ctf.size;
+  LOG(INFO) << "Stored CTF{" << header << "} as entry " << mIndex.size() - 1 << " of " << mFileName;
+
+  if ((mMaxCTFPerFile > 0 && int(mIndex.size()) >= mMaxCTFPerFile) || (mMaxFileSize > 0 && mFileSize >= mMaxFileSize)) {
+    closeFile();
+  }
+}
+
+void CTFWriterSpec::appendToROOTFile(const CTFData& ctf)
+{
+  // every CTF fills all detector branches, so that the tree entries stay aligned
   DetID det;
 
   det = DetID::ITS;
-  if (isPresent(det) && pc.inputs().isValid(det.getName())) {
-    auto ctfBuffer = pc.inputs().get<gsl::span<o2::ctf::BufferType>>(det.getName());
-    const auto ctfImage = o2::itsmft::CTF::getImage(ctfBuffer.data());
-    LOG(INFO) << "CTF for " << det.getName();
-    ctfImage.print();
-    ctfImage.appendToTree(ctfTree, det.getName());
-    header.detectors.set(det);
+  if (isPresent(det)) {
+    appendDetCTF<o2::itsmft::CTF>(*mTree, det, ctf.buffers[det]);
   }
 
   det = DetID::MFT;
-  if (isPresent(det) && pc.inputs().isValid(det.getName())) {
-    auto ctfBuffer = pc.inputs().get<gsl::span<o2::ctf::BufferType>>(det.getName());
-    const auto ctfImage = o2::itsmft::CTF::getImage(ctfBuffer.data());
-    LOG(INFO) << "CTF for " << det.getName();
-    ctfImage.print();
-    ctfImage.appendToTree(ctfTree, det.getName());
-    header.detectors.set(det);
+  if (isPresent(det)) {
+    appendDetCTF<o2::itsmft::CTF>(*mTree, det, ctf.buffers[det]);
   }
 
   det = DetID::TPC;
-  if (isPresent(det) && pc.inputs().isValid(det.getName())) {
-    auto ctfBuffer = pc.inputs().get<gsl::span<o2::ctf::BufferType>>(det.getName());
-    const auto ctfImage = o2::tpc::CTF::getImage(ctfBuffer.data());
-    LOG(INFO) << "CTF for " << det.getName();
-    ctfImage.print();
-    ctfImage.appendToTree(ctfTree, det.getName());
-    header.detectors.set(det);
+  if (isPresent(det)) {
+    appendDetCTF<o2::tpc::CTF>(*mTree, det, ctf.buffers[det]);
   }
 
-  appendToTree(ctfTree, "CTFHeader", header);
+  auto header = ctf.header;
+  appendToTree(*mTree, "CTFHeader", header);
+  mTree->SetEntries(mTree->GetEntries() + 1);
+}
 
-  ctfTree.SetEntries(1);
-  ctfTree.Write();
-  flOut.Close();
+void CTFWriterSpec::updateDictionaries(const CTFData& ctf)
+{
+  DetID det;
 
-  mTimer.Stop();
-  LOG(INFO) << "Wrote " << flOut.GetName() << " with CTF{" << header << "} in " << mTimer.CpuTime() - cput << " s";
+  det = DetID::ITS;
+  if (isPresent(det)) {
+    updateDetDictionary<o2::itsmft::CTF>(mDicts[det], ctf.buffers[det]);
+  }
+
+  det = DetID::MFT;
+  if (isPresent(det)) {
+    updateDetDictionary<o2::itsmft::CTF>(mDicts[det], ctf.buffers[det]);
+  }
+
+  det = DetID::TPC;
+  if (isPresent(det)) {
+    updateDetDictionary<o2::tpc::CTF>(mDicts[det], ctf.buffers[det]);
+  }
+
+  if (mSaveDictAfter > 0 && ++mNDictTFs % mSaveDictAfter == 0) {
+    storeDictionaries();
+  }
+}
+
+void CTFWriterSpec::storeDictionaries()
+{
+  // finalization does not reset the running histograms, so the training can continue
+  std::string fileName(o2::base::NameConf::CTFDICTFILENAME);
+  std::string option = "recreate";
+  for (auto id = DetID::First; id <= DetID::Last; id++) {
+    auto& dict = mDicts[id];
+    if (!dict) {
+      continue;
+    }
+    dict->finalize();
+    dict->writeTo(fileName, DetID::getName(id), option);
+    option = "update";
+    LOG(INFO) << "Stored CTF dictionary " << dict->getID() << " for " << DetID::getName(id) << " from " << dict->getNUpdates() << " TFs to " << fileName;
+  }
+}
+
+void CTFWriterSpec::openFile(uint32_t tfOrb)
+{
+  mFileName = o2::base::NameConf::getCTFFileName(tfOrb, "o2_ctf", mRawOutput ? ".ctf" : ".root");
+  mIndex.clear();
+  mFileSize = 0;
+  if (mRawOutput) {
+    mRawFile.open(mFileName);
+    return;
+  }
+  mFile = std::make_unique<TFile>(mFileName.c_str(), "recreate");
+  if (!mFile->IsOpen() || mFile->IsZombie()) {
+    throw std::runtime_error(o2::utils::concat_string("failed to open CTF file ", mFileName));
+  }
+  mTree = std::make_unique<TTree>(std::string(o2::base::NameConf::CTFTREENAME).c_str(), "O2 CTF tree");
+}
+
+void CTFWriterSpec::closeFile()
+{
+  if (mFileName.empty()) {
+    return;
+  }
+  if (mRawOutput) {
+    mRawFile.close();
+  } else {
+    mFile->cd();
+    mTree->Write();
+    mFile->WriteObjectAny(&mIndex, "std::vector<o2::ctf::CTFHeader>", std::string(o2::base::NameConf::CTFINDEXNAME).c_str());
+    mTree.reset();
+    mFile->Close();
+    mFile.reset();
+  }
+  LOG(INFO) << "Wrote " << mFileName << " with " << mIndex.size() << " CTFs";
+  mFileName.clear();
+  mIndex.clear();
+}
+
+void CTFWriterSpec::startWriter()
+{
+  // the writer thread is the only one touching the output files, but ROOT global state must be protected
+  ROOT::EnableThreadSafety();
+  mStopRequested = false;
+  mWriterThread = std::thread(&CTFWriterSpec::writerLoop, this);
+}
+
+void CTFWriterSpec::stopWriter()
+{
+  if (!mWriterThread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopRequested = true;
+  }
+  mCondNewData.notify_one();
+  mWriterThread.join();
+}
+
+void CTFWriterSpec::writerLoop()
+{
+  while (true) {
+    std::unique_ptr<CTFData> ctf;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondNewData.wait(lock, [this] { return !mQueue.empty() || mStopRequested; });
+      if (mQueue.empty()) { // stop requested and everything is written
+        break;
+      }
+      ctf = std::move(mQueue.front());
+      mQueue.pop_front();
+    }
+    try {
+      writeCTF(*ctf);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mWriterException = std::current_exception();
+      mQueue.clear();
+      mPendingSize = 0;
+      mCondDataWritten.notify_all();
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mPendingSize -= ctf->size;
+    }
+    mCondDataWritten.notify_all();
+  }
 }
 
 void CTFWriterSpec::endOfStream(EndOfStreamContext& ec)
 {
+  finalize();
+}
+
+void CTFWriterSpec::finalize()
+{
+  if (mFinalized) {
+    return;
+  }
+  mFinalized = true;
+  stopWriter();
+  if (mWriterException) {
+    std::rethrow_exception(mWriterException);
+  }
+  closeFile();
+  if (mCreateDict) {
+    storeDictionaries();
+  }
   LOGF(INFO, "CTF writing total timing: Cpu: %.3e Real: %.3e s in %d slots",
        mTimer.CpuTime(), mTimer.RealTime(), mTimer.Counter() - 1);
 }
@@ -124,7 +374,13 @@ DataProcessorSpec getCTFWriterSpec(DetID::mask_t dets, uint64_t run)
     inputs,
     Outputs{},
     AlgorithmSpec{adaptFromTask<CTFWriterSpec>(dets, run)},
-    Options{}};
+    Options{{"output-type", VariantType::String, "root", {"CTF file format: root (TTree) or raw (flat images, mmap-able)"}},
+            {"ctf-per-file", VariantType::Int, 1, {"max number of CTFs per file, 0: no limit"}},
+            {"max-file-size", VariantType::Int64, 0L, {"close the file once the stored CTFs exceed this size in bytes, 0: no limit"}},
+            {"async-write", VariantType::Bool, false, {"store the CTFs in a separate thread"}},
+            {"max-pending-size", VariantType::Int64, 2000000000L, {"max size in bytes of CTFs waiting for asynchronous writing"}},
+            {"create-dict", VariantType::Bool, false, {"create external CTF dictionaries from the dictionaries stored with the CTFs"}},
+            {"save-dict-after", VariantType::Int, 0, {"store intermediate dictionaries every N TFs, 0: at the end of stream only"}}}};
 }
 
 } // namespace ctf
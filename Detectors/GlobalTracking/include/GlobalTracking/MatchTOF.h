@@ -26,6 +26,7 @@
 #include "ReconstructionDataFormats/MatchInfoTOF.h"
 #include "DataFormatsTOF/CalibInfoTOF.h"
 #include "CommonDataFormat/EvIndex.h"
+#include "CommonDataFormat/RangeReference.h"
 #include "SimulationDataFormat/MCCompLabel.h"
 #include "CommonUtils/TreeStreamRedirector.h"
 #include "TOFBase/Geo.h"
@@ -68,6 +69,49 @@ struct TrackLocTPCITS : public o2::track::TrackParCov {
   ClassDefNV(TrackLocTPCITS, 1); // RS TODO: is this class needed?
 };
 
+///< TOF strips (at most 2) crossed by a track propagated through the TOF volume, with the residuals
+///< wrt the crossed pads averaged over the propagation steps inside the strip
+struct CrossedStripsTOF {
+  int nStrips = 0;                     ///< number of strips crossed
+  int detId[2][5];                     ///< det. indices (sector, plate, strip, padZ, padX) of the crossed strips
+  float deltaPos[2][3];                ///< average residuals in the crossed strips
+  o2::track::TrackLTIntegral intLT[2]; ///< integrated length and time at the entrance of the crossed strips
+};
+
+///< TOF clusters of a sector grouped per strip, ordered in time inside each strip.
+///< Built once per TF to fetch the clusters of given strip within the time window of a track.
+class StripTimeIndexTOF
+{
+  using Cluster = o2::tof::Cluster;
+
+ public:
+  using ClusRange = o2::dataformats::RangeReference<int, int>;
+
+  ///< clusters of a strip of the sector (Geo::getStripNumberPerSM numbering) within [tMin:tMax] (ps)
+  struct Query {
+    int strip = -1;
+    float tMin = 0.f;
+    float tMax = 0.f;
+  };
+
+  ///< build the index from the time-ordered entries of the sector clusters
+  void build(const std::vector<Cluster>& clusters, const std::vector<int>& sectorCache);
+
+  ///< range of the index entries of the clusters of given strip within [tMin:tMax] (ps)
+  ClusRange query(int strip, float tMin, float tMax) const;
+
+  ///< ranges of the index entries for a batch of queries
+  void query(gsl::span<const Query> queries, std::vector<ClusRange>& ranges) const;
+
+  ///< entry in the sector cache of the cluster stored at given index entry
+  int getSectorCacheEntry(int entry) const { return mEntries[entry]; }
+
+ private:
+  std::array<int, o2::tof::Geo::NSTRIPXSECTOR + 1> mStripStart{}; ///< 1st index entry of each strip
+  std::vector<int> mEntries;                                       ///< sector cache entries, grouped in strips
+  std::vector<double> mTimes;                                      ///< cluster times of the entries
+};
+
 class MatchTOF
 {
   using Geo = o2::tof::Geo;
@@ -145,6 +189,10 @@ class MatchTOF
   ///< get number of sigma used to do the matching
   float getSigmaTimeCut() const { return mSigmaTimeCut; }
 
+  ///< set number of threads for the propagation of the tracks (<1: rely on openMP default)
+  void setNThreads(int n);
+  int getNThreads() const { return mNThreads; }
+
   enum DebugFlagTypes : UInt_t {
     MatchTreeAll = 0x1 << 1, ///< produce matching candidates tree for all candidates
   };
@@ -203,9 +251,11 @@ class MatchTOF
   bool loadTOFClustersNextChunk();
 
   void doMatching(int sec);
+  void propagateThroughStrips(int trackID, CrossedStripsTOF& strips);
   void selectBestMatches();
   bool propagateToRefX(o2::track::TrackParCov& trc, float xRef /*in cm*/, float stepInCm /*in cm*/, o2::track::TrackLTIntegral& intLT);
   bool propagateToRefXWithoutCov(o2::track::TrackParCov& trc, float xRef /*in cm*/, float stepInCm /*in cm*/, float bz);
+  void attachGeoNavigator() const;
 
   //================================================================
 
@@ -213,6 +263,7 @@ class MatchTOF
 
   bool mSAInitDone = false;      ///< flag that standalone init already done
   bool mWFInputAttached = false; ///< flag that the standalone input is attached
+  bool mTOFGeoInitDone = false;  ///< flag that the TOF geometry tables were filled
 
   float mXRef = Geo::RMIN; ///< reference radius to propage tracks for matching
 
@@ -228,6 +279,7 @@ class MatchTOF
   float mTimeTolerance = 1e3; ///<tolerance in ns for track-TOF time bracket matching
   float mSpaceTolerance = 10; ///<tolerance in cm for track-TOF time bracket matching
   int mSigmaTimeCut = 30.;    ///< number of sigmas to cut on time when matching the track to the TOF cluster
+  int mNThreads = 1;          ///< number of threads for the propagation of the tracks
 
   TTree* mInputTreeTracks = nullptr; ///< input tree for tracks
   TTree* mTreeTPCTracks = nullptr;   ///< input tree for TPC tracks
@@ -266,6 +318,10 @@ class MatchTOF
   std::array<std::vector<int>, o2::constants::math::NSectors> mTracksSectIndexCache;
   ///< per sector indices of TOF cluster entry in mTOFClusWork
   std::array<std::vector<int>, o2::constants::math::NSectors> mTOFClusSectIndexCache;
+  ///< per sector strip-time index of the entries of mTOFClusSectIndexCache
+  std::array<StripTimeIndexTOF, o2::constants::math::NSectors> mTOFClusStripIndex; //!
+  ///< strips crossed by the tracks of the current sector
+  std::vector<CrossedStripsTOF> mCrossedStrips; //!
 
   ///<array of track-TOFCluster pairs from the matching
   std::vector<o2::dataformats::MatchInfoTOF> mMatchedTracksPairs;
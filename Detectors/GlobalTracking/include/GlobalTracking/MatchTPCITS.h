@@ -132,6 +132,18 @@ struct matchRecord {
   matchRecord() = default;
 };
 
+///< ITS-TPC pair found compatible (or, for the debug output, rejected) in the candidates check,
+///< kept until it is registered in the match records
+struct matchCandidate {
+  int iITS = MinusOne;  ///< ITS track entry in mITSWork
+  int iTPC = MinusOne;  ///< TPC track entry in mTPCWork
+  float chi2 = -1.f;    ///< matching chi2
+  int rejFlag = Accept; ///< rejection flag, Accept for the candidates to register
+
+  matchCandidate(int its, int tpc, float chi2match, int rej) : iITS(its), iTPC(tpc), chi2(chi2match), rejFlag(rej) {}
+  matchCandidate() = default;
+};
+
 ///< Link of the AfterBurner track: update at sertain cluster
 ///< original track in the currently loaded TPC reco output
 struct ABTrackLink : public o2::track::TrackParCov {
@@ -412,6 +424,10 @@ class MatchTPCITS
   void setUseMatCorrFlag(int f);
   int getUseMatCorrFlag() const { return mUseMatCorrFlag; }
 
+  ///< set number of threads for the candidates check, refit and afterburner (<1: rely on openMP default)
+  void setNThreads(int n);
+  int getNThreads() const { return mNThreads; }
+
   //<<< ====================== options =============================<<<
 
 #ifdef _ALLOW_DEBUG_TREES_
@@ -464,10 +480,13 @@ class MatchTPCITS
   void flagUsedITSClusters(const o2::its::TrackITS& track, int rofOffset);
 
   void doMatching(int sec);
+  void checkSectorCandidates(int sec, int itpcStart, int itpcEnd, std::vector<matchCandidate>& candidates,
+                             int& nCheckTPC, int& nCheckITS) const;
 
   void refitWinners(bool loopInITS = false);
-  bool refitTrackTPCITSloopITS(int iITS, int& iTPC);
-  bool refitTrackTPCITSloopTPC(int iTPC, int& iITS);
+  bool refitTrackTPCITSloopITS(int iITS, int& iTPC, o2::dataformats::TrackTPCITS& trfit) const;
+  bool refitTrackTPCITSloopTPC(int iTPC, int& iITS, o2::dataformats::TrackTPCITS& trfit) const;
+  void attachGeoNavigator() const;
   bool refitTPCInward(o2::track::TrackParCov& trcIn, float& chi2, float xTgt, int trcID, float timeTB, float m = o2::constants::physics::MassPionCharged) const;
 
   void selectBestMatches();
@@ -539,6 +558,8 @@ class MatchTPCITS
 
   int mUseMatCorrFlag = o2::base::Propagator::USEMatCorrTGeo;
 
+  int mNThreads = 1; ///< number of threads for the candidates check, refit and afterburner
+
   bool mITSTriggered = false; ///< ITS readout is triggered
 
   ///< do we use track Z difference to reject fake matches? makes sense for triggered mode only
@@ -647,6 +668,7 @@ class MatchTPCITS
   static constexpr float MaxSnp = 0.9;                 // max snp of ITS or TPC track at xRef to be matched
   static constexpr float MaxTgp = 2.064;               // max tg corresponting to MaxSnp = MaxSnp/std::sqrt(1.-MaxSnp^2)
   static constexpr float MinTBToCleanCache = 600.;     // keep in AB ITS cluster refs cache at most this number of TPC bins
+  static constexpr int LoopPerThread = 4;              // in MT mode run so many chunks of TPC tracks per thread
 
   enum TimerIDs { SWTot,
                   SWPrepITS,
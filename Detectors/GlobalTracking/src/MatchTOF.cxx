@@ -9,6 +9,7 @@
 // or submit itself to any jurisdiction.
 #include <TTree.h>
 #include <cassert>
+#include <algorithm>
 
 #include "FairLogger.h"
 #include "Field/MagneticField.h"
@@ -29,6 +30,7 @@
 #include <Math/SVector.h>
 #include <TFile.h>
 #include <TGeoGlobalMagField.h>
+#include <TGeoManager.h>
 #include "DataFormatsParameters/GRPObject.h"
 #include "ReconstructionDataFormats/PID.h"
 #include "ReconstructionDataFormats/TrackLTIntegral.h"
@@ -36,6 +38,10 @@
 #include "GlobalTracking/MatchTOF.h"
 #include "GlobalTracking/MatchTPCITS.h"
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace o2::globaltracking;
 using timeEst = o2::dataformats::TimeStampWithError<float, float>;
 using evIdx = o2::dataformats::EvIndex<int, int>;
@@ -53,6 +59,16 @@ void MatchTOF::run()
   }
   mTimerTot.Start();
 
+  if (mNThreads > 1 && gGeoManager && !gGeoManager->IsMultiThread()) {
+    gGeoManager->SetMaxThreads(mNThreads); // allow threads to have their own navigators for material queries
+  }
+  if (!mTOFGeoInitDone) {
+    // the TOF geometry tables are otherwise filled on first use, which is not thread safe:
+    // fill them before the propagation through the strips runs in several threads
+    Geo::Init();
+    mTOFGeoInitDone = true;
+  }
+
   // we load all TOF clusters (to be checked if we need to split per time frame)
   prepareTOFClusters();
 
@@ -241,6 +257,7 @@ void MatchTOF::print() const
   LOG(INFO) << "Time tolerance: " << mTimeTolerance;
   LOG(INFO) << "Space tolerance: " << mSpaceTolerance;
   LOG(INFO) << "SigmaTimeCut: " << mSigmaTimeCut;
+  LOG(INFO) << "Number of threads: " << mNThreads;
 
   LOG(INFO) << "**********************************************************************";
 }
@@ -342,19 +359,26 @@ bool MatchTOF::prepareTracks()
   Printf("\n\nWe have %d tracks to try to match to TOF", mNumOfTracks);
   int nNotPropagatedToTOF = 0;
   for (int it = 0; it < mNumOfTracks; it++) {
-    const o2::dataformats::TrackTPCITS& trcOrig = mTracksArrayInp[it]; // TODO: check if we cannot directly use the o2::track::TrackParCov class instead of o2::dataformats::TrackTPCITS, and then avoid the casting below; this is the track at the vertex
+    // create working copy of track param
+    mTracksWork.emplace_back(mTracksArrayInp[it]); //, mCurrTracksTreeEntry, it);
+  }
+  std::vector<int> trackSector(mNumOfTracks, -1); // sector of the track at the reference X, -1 if it was not propagated there
+
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads)
+#endif
+  //>> start of MT region
+  for (int it = 0; it < mNumOfTracks; it++) {
+    attachGeoNavigator();
     std::array<float, 3> globalPos;
 
-    // create working copy of track param
-    mTracksWork.emplace_back(trcOrig); //, mCurrTracksTreeEntry, it);
     // make a copy of the TPC track that we have to propagate
     //o2::tpc::TrackTPC* trc = new o2::tpc::TrackTPC(trcTPCOrig); // this would take the TPCout track
-    //auto& trc = mTracksWork.back(); // with this we take the TPCITS track propagated to the vertex
-    auto& trc = mTracksWork.back().getParamOut();        // with this we take the TPCITS track propagated to the vertex
-    auto& intLT = mTracksWork.back().getLTIntegralOut(); // we get the integrated length from TPC-ITC outward propagation
+    //auto& trc = mTracksWork[it]; // with this we take the TPCITS track propagated to the vertex
+    auto& trc = mTracksWork[it].getParamOut();        // with this we take the TPCITS track propagated to the vertex
+    auto& intLT = mTracksWork[it].getLTIntegralOut(); // we get the integrated length from TPC-ITC outward propagation
 
     if (trc.getX() < o2::globaltracking::MatchTPCITS::XTPCOuterRef - 1.) { // tpc-its track outward propagation did not reach outer ref.radius, skip this track
-      nNotPropagatedToTOF++;
       continue;
     }
 
@@ -364,13 +388,11 @@ bool MatchTOF::prepareTracks()
     LOG(DEBUG) << "Radius xy Before propagating to 371 cm = " << TMath::Sqrt(globalPos[0] * globalPos[0] + globalPos[1] * globalPos[1]);
     LOG(DEBUG) << "Radius xyz Before propagating to 371 cm = " << TMath::Sqrt(globalPos[0] * globalPos[0] + globalPos[1] * globalPos[1] + globalPos[2] * globalPos[2]);
     if (!propagateToRefXWithoutCov(trc, mXRef, 2, bzField)) { // we first propagate to 371 cm without considering the covariance matrix
-      nNotPropagatedToTOF++;
       continue;
     }
 
     // the "rough" propagation worked; now we can propagate considering also the cov matrix
     if (!propagateToRefX(trc, mXRef, 2, intLT) || TMath::Abs(trc.getZ()) > Geo::MAXHZTOF) { // we check that the propagation with the cov matrix worked; CHECK: can it happen that it does not if the propagation without the errors succeeded?
-      nNotPropagatedToTOF++;
       continue;
     }
 
@@ -381,9 +403,19 @@ bool MatchTOF::prepareTracks()
     LOG(DEBUG) << "Radius xyz After propagating to 371 cm = " << TMath::Sqrt(globalPos[0] * globalPos[0] + globalPos[1] * globalPos[1] + globalPos[2] * globalPos[2]);
     LOG(DEBUG) << "The track will go to sector " << o2::utils::Angle2Sector(TMath::ATan2(globalPos[1], globalPos[0]));
 
-    mTracksSectIndexCache[o2::utils::Angle2Sector(TMath::ATan2(globalPos[1], globalPos[0]))].push_back(it);
+    trackSector[it] = o2::utils::Angle2Sector(TMath::ATan2(globalPos[1], globalPos[0]));
     //delete trc; // Check: is this needed?
   }
+  //<< end of MT region
+
+  // fill the sector tables in the order of the input tracks
+  for (int it = 0; it < mNumOfTracks; it++) {
+    if (trackSector[it] < 0) {
+      nNotPropagatedToTOF++;
+      continue;
+    }
+    mTracksSectIndexCache[trackSector[it]].push_back(it);
+  }
 
   LOG(INFO) << "Total number of tracks = " << mNumOfTracks << ", Number of tracks that failed to be propagated to TOF = " << nNotPropagatedToTOF;
 
@@ -483,6 +515,11 @@ bool MatchTOF::prepareTOFClusters()
     });
   } // loop over TOF clusters of single sector
 
+  // group the clusters of each sector per strip, keeping the time ordering
+  for (int sec = o2::constants::math::NSectors; sec--;) {
+    mTOFClusStripIndex[sec].build(mTOFClusWork, mTOFClusSectIndexCache[sec]);
+  }
+
   if (mMatchedClustersIndex)
     delete[] mMatchedClustersIndex;
   mMatchedClustersIndex = new int[mNumOfClusters];
@@ -554,287 +591,165 @@ void MatchTOF::doMatching(int sec)
   */
   auto& cacheTOF = mTOFClusSectIndexCache[sec]; // array of cached TOF cluster indices for this sector; reminder: they are ordered in time!
   auto& cacheTrk = mTracksSectIndexCache[sec];  // array of cached tracks indices for this sector; reminder: they are ordered in time!
+  auto& stripIndex = mTOFClusStripIndex[sec];   // TOF clusters of this sector grouped per strip
   int nTracks = cacheTrk.size(), nTOFCls = cacheTOF.size();
   LOG(INFO) << "Matching sector " << sec << ": number of tracks: " << nTracks << ", number of TOF clusters: " << nTOFCls;
   if (!nTracks || !nTOFCls) {
     return;
   }
-  int itof0 = 0;                          // starting index in TOF clusters for matching of the track
-  int detId[2][5];                        // at maximum one track can fall in 2 strips during the propagation; the second dimention of the array is the TOF det index
-  float deltaPos[2][3];                   // at maximum one track can fall in 2 strips during the propagation; the second dimention of the array is the residuals
-  o2::track::TrackLTIntegral trkLTInt[2]; // Here we store the integrated track length and time for the (max 2) matched strips
-  int nStepsInsideSameStrip[2] = {0, 0};  // number of propagation steps in the same strip (since we have maximum 2 strips, it has dimention = 2)
-  float deltaPosTemp[3];
-  std::array<float, 3> pos;
-  std::array<float, 3> posBeforeProp;
-  float posFloat[3];
-
-  LOG(DEBUG) << "Trying to match %d tracks" << cacheTrk.size();
-  for (int itrk = 0; itrk < cacheTrk.size(); itrk++) {
-    for (int ii = 0; ii < 2; ii++) {
-      detId[ii][2] = -1; // before trying to match, we need to inizialize the detId corresponding to the strip number to -1; this is the array that we will use to save the det id of the maximum 2 strips matched
-      nStepsInsideSameStrip[ii] = 0;
-    }
-    int nStripsCrossedInPropagation = 0; // how many strips were hit during the propagation
-    auto& trackWork = mTracksWork[cacheTrk[itrk]];
-    auto& trefTrk = trackWork.getParamOut();
-    auto& intLT = trackWork.getLTIntegralOut();
-    //    Printf("intLT (before doing anything): length = %f, time (Pion) = %f", intLT.getL(), intLT.getTOF(o2::track::PID::Pion));
-    float minTrkTime = (trackWork.getTimeMUS().getTimeStamp() - mSigmaTimeCut * trackWork.getTimeMUS().getTimeStampError()) * 1.E6; // minimum time in ps
-    float maxTrkTime = (trackWork.getTimeMUS().getTimeStamp() + mSigmaTimeCut * trackWork.getTimeMUS().getTimeStampError()) * 1.E6; // maximum time in ps
-    int istep = 1;                                                                                                                  // number of steps
-    float step = 1.0;                                                                                                               // step size in cm
-                                                                                                                                    //uncomment for local debug
-                                                                                                                                    /*
-																//trefTrk.getXYZGlo(posBeforeProp);
-																//float posBeforeProp[3] = {trefTrk.getX(), trefTrk.getY(), trefTrk.getZ()}; // in local ref system
-																//printf("Global coordinates: posBeforeProp[0] = %f, posBeforeProp[1] = %f, posBeforeProp[2] = %f\n", posBeforeProp[0], posBeforeProp[1], posBeforeProp[2]);
-																//Printf("Radius xy = %f", TMath::Sqrt(posBeforeProp[0]*posBeforeProp[0] + posBeforeProp[1]*posBeforeProp[1]));
-																//Printf("Radius xyz = %f", TMath::Sqrt(posBeforeProp[0]*posBeforeProp[0] + posBeforeProp[1]*posBeforeProp[1] + posBeforeProp[2]*posBeforeProp[2]));
-																*/
 
 #ifdef _ALLOW_TOF_DEBUG_
-    if (mDBGFlags) {
+  if (mDBGFlags) {
+    for (int itrk = 0; itrk < nTracks; itrk++) {
       (*mDBGOut) << "propOK"
-                 << "track=" << trefTrk << "\n";
+                 << "track=" << mTracksWork[cacheTrk[itrk]].getParamOut() << "\n";
     }
+  }
 #endif
 
-    // initializing
-    for (int ii = 0; ii < 2; ii++) {
-      for (int iii = 0; iii < 5; iii++) {
-        detId[ii][iii] = -1;
-      }
-    }
-
-    int detIdTemp[5] = {-1, -1, -1, -1, -1}; // TOF detector id at the current propagation point
-
-    double reachedPoint = mXRef + istep * step;
-
-    while (propagateToRefX(trefTrk, reachedPoint, step, intLT) && nStripsCrossedInPropagation <= 2 && reachedPoint < Geo::RMAX) {
-      // while (o2::base::Propagator::Instance()->PropagateToXBxByBz(trefTrk,  mXRef + istep * step, o2::constants::physics::MassPionCharged, MAXSNP, step, 1, &intLT) && nStripsCrossedInPropagation <= 2 && mXRef + istep * step < Geo::RMAX) {
-
-      trefTrk.getXYZGlo(pos);
-      for (int ii = 0; ii < 3; ii++) { // we need to change the type...
-        posFloat[ii] = pos[ii];
-      }
-      // uncomment below only for local debug; this will produce A LOT of output - one print per propagation step
-      /*
-      Printf("posFloat[0] = %f, posFloat[1] = %f, posFloat[2] = %f", posFloat[0], posFloat[1], posFloat[2]);
-      Printf("radius xy = %f", TMath::Sqrt(posFloat[0]*posFloat[0] + posFloat[1]*posFloat[1]));
-      Printf("radius xyz = %f", TMath::Sqrt(posFloat[0]*posFloat[0] + posFloat[1]*posFloat[1] + posFloat[2]*posFloat[2]));
-      */
-
-      for (int idet = 0; idet < 5; idet++)
-        detIdTemp[idet] = -1;
-
-      Geo::getPadDxDyDz(posFloat, detIdTemp, deltaPosTemp);
-
-      if (detIdTemp[2] == -1) {
-        reachedPoint += step;
-        continue;
-      }
-
-      // to reduce the active region of the strip -> uncomment these lines
-      // float yresidual = TMath::Abs(deltaPosTemp[1]);
-      // if(yresidual > 0.55){
-      // 	reachedPoint += step;
-      // 	continue;
-      // }
-
-      //      printf("res %f %f %f -- %f %f %f (%d)\n",deltaPosTemp[0],deltaPosTemp[1],deltaPosTemp[2],pos[0],pos[1],pos[2],detIdTemp[2]);
-
-      // if you want to exit from the strip matched uncomment this line
-      //      reachedPoint += 3.0; // go out from the strip at the next step
-
-      //      printf("idet: %d %d %d %d %d\n",detIdTemp[0],detIdTemp[1],detIdTemp[2],detIdTemp[3],detIdTemp[4]);
-
-      // uncomment below only for local debug; this will produce A LOT of output - one print per propagation step
-      //Printf("detIdTemp[0] = %d, detIdTemp[1] = %d, detIdTemp[2] = %d, detIdTemp[3] = %d, detIdTemp[4] = %d", detIdTemp[0], detIdTemp[1], detIdTemp[2], detIdTemp[3], detIdTemp[4]);
-      // if (nStripsCrossedInPropagation == 0) { // print in case you have a useful propagation
-      //   LOG(DEBUG) << "*********** We have crossed a strip during propagation!*********";
-      //   LOG(DEBUG) << "Global coordinates: pos[0] = " << pos[0] << ", pos[1] = " << pos[1] << ", pos[2] = " << pos[2];
-      //   LOG(DEBUG) << "detIdTemp[0] = " << detIdTemp[0] << ", detIdTemp[1] = " << detIdTemp[1] << ", detIdTemp[2] = " << detIdTemp[2] << ", detIdTemp[3] = " << detIdTemp[3] << ", detIdTemp[4] = " << detIdTemp[4];
-      //   LOG(DEBUG) << "deltaPosTemp[0] = " << deltaPosTemp[0] << ", deltaPosTemp[1] = " << deltaPosTemp[1] << " deltaPosTemp[2] = " << deltaPosTemp[2];
-      // } else {
-      //   LOG(DEBUG) << "*********** We have NOT crossed a strip during propagation!*********";
-      //   LOG(DEBUG) << "Global coordinates: pos[0] = " << pos[0] << ", pos[1] = " << pos[1] << ", pos[2] = " << pos[2];
-      //   LOG(DEBUG) << "detIdTemp[0] = " << detIdTemp[0] << ", detIdTemp[1] = " << detIdTemp[1] << ", detIdTemp[2] = " << detIdTemp[2] << ", detIdTemp[3] = " << detIdTemp[3] << ", detIdTemp[4] = " << detIdTemp[4];
-      //   LOG(DEBUG) << "deltaPosTemp[0] = " << deltaPosTemp[0] << ", deltaPosTemp[1] = " << deltaPosTemp[1] << " deltaPosTemp[2] = " << deltaPosTemp[2];
-      // }
-
-      // check if after the propagation we are in a TOF strip
-      // we ended in a TOF strip
-      // LOG(DEBUG) << "nStripsCrossedInPropagation = " << nStripsCrossedInPropagation << ", detId[nStripsCrossedInPropagation][0] = " << detId[nStripsCrossedInPropagation][0] << ", detIdTemp[0] = " << detIdTemp[0] << ", detId[nStripsCrossedInPropagation][1] = " << detId[nStripsCrossedInPropagation][1] << ", detIdTemp[1] = " << detIdTemp[1] << ", detId[nStripsCrossedInPropagation][2] = " << detId[nStripsCrossedInPropagation][2] << ", detIdTemp[2] = " << detIdTemp[2];
-      if (nStripsCrossedInPropagation == 0 ||                                                                                                                                                                                            // we are crossing a strip for the first time...
-          (nStripsCrossedInPropagation >= 1 && (detId[nStripsCrossedInPropagation - 1][0] != detIdTemp[0] || detId[nStripsCrossedInPropagation - 1][1] != detIdTemp[1] || detId[nStripsCrossedInPropagation - 1][2] != detIdTemp[2]))) { // ...or we are crossing a new strip
-        if (nStripsCrossedInPropagation == 0)
-          // LOG(DEBUG) << "We cross a strip for the first time";
-          if (nStripsCrossedInPropagation == 2) {
-            break; // we have already matched 2 strips, we cannot match more
-          }
-        nStripsCrossedInPropagation++;
-      }
-      //Printf("nStepsInsideSameStrip[nStripsCrossedInPropagation-1] = %d", nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]);
-      if (nStepsInsideSameStrip[nStripsCrossedInPropagation - 1] == 0) {
-        detId[nStripsCrossedInPropagation - 1][0] = detIdTemp[0];
-        detId[nStripsCrossedInPropagation - 1][1] = detIdTemp[1];
-        detId[nStripsCrossedInPropagation - 1][2] = detIdTemp[2];
-        detId[nStripsCrossedInPropagation - 1][3] = detIdTemp[3];
-        detId[nStripsCrossedInPropagation - 1][4] = detIdTemp[4];
-        deltaPos[nStripsCrossedInPropagation - 1][0] = deltaPosTemp[0];
-        deltaPos[nStripsCrossedInPropagation - 1][1] = deltaPosTemp[1];
-        deltaPos[nStripsCrossedInPropagation - 1][2] = deltaPosTemp[2];
-        trkLTInt[nStripsCrossedInPropagation - 1] = intLT;
-        //          Printf("intLT (after matching to strip %d): length = %f, time (Pion) = %f", nStripsCrossedInPropagation - 1, trkLTInt[nStripsCrossedInPropagation - 1].getL(), trkLTInt[nStripsCrossedInPropagation - 1].getTOF(o2::track::PID::Pion));
-        nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]++;
-      } else { // a further propagation step in the same strip -> update info (we sum up on all matching with strip - we will divide for the number of steps a bit below)
-        // N.B. the integrated length and time are taken (at least for now) from the first time we crossed the strip, so here we do nothing with those
-        deltaPos[nStripsCrossedInPropagation - 1][0] += deltaPosTemp[0] + (detIdTemp[4] - detId[nStripsCrossedInPropagation - 1][4]) * Geo::XPAD; // residual in x
-        deltaPos[nStripsCrossedInPropagation - 1][1] += deltaPosTemp[1];                                                                          // residual in y
-        deltaPos[nStripsCrossedInPropagation - 1][2] += deltaPosTemp[2] + (detIdTemp[3] - detId[nStripsCrossedInPropagation - 1][3]) * Geo::ZPAD; // residual in z
-        nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]++;
-      }
-    }
-    //    LOG(DEBUG) << "while done, we propagated track " << itrk << " in %d strips" << nStripsCrossedInPropagation;
-    //    LOG(INFO) << "while done, we propagated track " << itrk << " in %d strips" << nStripsCrossedInPropagation;
+  // propagate the tracks through the TOF volume to find the strips they cross
+  mCrossedStrips.clear();
+  mCrossedStrips.resize(nTracks);
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads)
+#endif
+  //>> start of MT region
+  for (int itrk = 0; itrk < nTracks; itrk++) {
+    attachGeoNavigator();
+    propagateThroughStrips(cacheTrk[itrk], mCrossedStrips[itrk]);
+  }
+  //<< end of MT region
 
-    // uncomment for debug purposes, to check tracks that did not cross any strip
-    /*
+  std::vector<StripTimeIndexTOF::Query> queries;
+  std::vector<StripTimeIndexTOF::ClusRange> ranges;
+  LOG(DEBUG) << "Trying to match %d tracks" << cacheTrk.size();
+  for (int itrk = 0; itrk < nTracks; itrk++) {
+    const auto& strips = mCrossedStrips[itrk];
+    const auto& detId = strips.detId;
+    const auto& deltaPos = strips.deltaPos;
+    const auto& trkLTInt = strips.intLT;
+    int nStripsCrossedInPropagation = strips.nStrips;
     if (nStripsCrossedInPropagation == 0) {
-      auto labelTPCNoStripsCrossed = mTPCLabels->at(mTracksSectIndexCache[sec][itrk]);    
-      Printf("The current track (index = %d) never crossed a strip", cacheTrk[itrk]);
-      Printf("TrackID = %d, EventID = %d, SourceID = %d", labelTPCNoStripsCrossed.getTrackID(), labelTPCNoStripsCrossed.getEventID(), labelTPCNoStripsCrossed.getSourceID());
-      printf("Global coordinates: pos[0] = %f, pos[1] = %f, pos[2] = %f\n", pos[0], pos[1], pos[2]);
-      printf("detIdTemp[0] = %d, detIdTemp[1] = %d, detIdTemp[2] = %d, detIdTemp[3] = %d, detIdTemp[4] = %d\n", detIdTemp[0], detIdTemp[1], detIdTemp[2], detIdTemp[3], detIdTemp[4]);
-      printf("deltaPosTemp[0] = %f, deltaPosTemp[1] = %f, deltaPosTemp[2] = %f\n", deltaPosTemp[0], deltaPosTemp[1], deltaPosTemp[2]);
+      continue; // the track never hit a TOF strip during the propagation
     }
-    */
+    auto& trackWork = mTracksWork[cacheTrk[itrk]];
+    auto& trefTrk = trackWork.getParamOut();
+    float minTrkTime = (trackWork.getTimeMUS().getTimeStamp() - mSigmaTimeCut * trackWork.getTimeMUS().getTimeStampError()) * 1.E6; // minimum time in ps
+    float maxTrkTime = (trackWork.getTimeMUS().getTimeStamp() + mSigmaTimeCut * trackWork.getTimeMUS().getTimeStampError()) * 1.E6; // maximum time in ps
 
-    for (Int_t imatch = 0; imatch < nStripsCrossedInPropagation; imatch++) {
-      // we take as residual the average of the residuals along the propagation in the same strip
-      deltaPos[imatch][0] /= nStepsInsideSameStrip[imatch];
-      deltaPos[imatch][1] /= nStepsInsideSameStrip[imatch];
-      deltaPos[imatch][2] /= nStepsInsideSameStrip[imatch];
-      //   LOG(DEBUG) << "matched strip " << imatch << ": deltaPos[0] = " << deltaPos[imatch][0] << ", deltaPos[1] = " << deltaPos[imatch][1] << ", deltaPos[2] = " << deltaPos[imatch][2] << ", residual (x, z) = " << TMath::Sqrt(deltaPos[imatch][0] * deltaPos[imatch][0] + deltaPos[imatch][2] * deltaPos[imatch][2]);
+    // only the clusters of the crossed strips of this sector within the time window of the track can be matched
+    queries.clear();
+    for (int iPropagation = 0; iPropagation < nStripsCrossedInPropagation; iPropagation++) {
+      if (detId[iPropagation][0] == sec) {
+        queries.push_back({Geo::getStripNumberPerSM(detId[iPropagation][1], detId[iPropagation][2]), minTrkTime, maxTrkTime});
+      }
     }
+    stripIndex.query(queries, ranges);
 
-    if (nStripsCrossedInPropagation == 0) {
-      continue; // the track never hit a TOF strip during the propagation
-    }
     bool foundCluster = false;
-    for (auto itof = itof0; itof < nTOFCls; itof++) {
-      //      printf("itof = %d\n", itof);
-      auto& trefTOF = mTOFClusWork[cacheTOF[itof]];
-      // compare the times of the track and the TOF clusters - remember that they both are ordered in time!
-      //Printf("trefTOF.getTime() = %f, maxTrkTime = %f, minTrkTime = %f", trefTOF.getTime(), maxTrkTime, minTrkTime);
-
-      if (trefTOF.getTime() < minTrkTime) { // this cluster has a time that is too small for the current track, we will get to the next one
-        //Printf("In trefTOF.getTime() < minTrkTime");
-        itof0 = itof + 1; // but for the next track that we will check, we will ignore this cluster (the time is anyway too small)
-        continue;
-      }
-      if (trefTOF.getTime() > maxTrkTime) { // no more TOF clusters can be matched to this track
-        break;
-      }
-
-      int mainChannel = trefTOF.getMainContributingChannel();
-      int indices[5];
-      Geo::getVolumeIndices(mainChannel, indices);
-
-      // compute fine correction using cluster position instead of pad center
-      // this because in case of multiple-hit cluster position is averaged on all pads contributing to the cluster (then error position matrix can be used for Chi2 if nedeed)
-      int ndigits = 1;
-      float posCorr[3] = {0, 0, 0};
-
-      if (trefTOF.isBitSet(Cluster::kLeft))
-        posCorr[0] += Geo::XPAD, ndigits++;
-      if (trefTOF.isBitSet(Cluster::kUpLeft))
-        posCorr[0] += Geo::XPAD, posCorr[2] -= Geo::ZPAD, ndigits++;
-      if (trefTOF.isBitSet(Cluster::kDownLeft))
-        posCorr[0] += Geo::XPAD, posCorr[2] += Geo::ZPAD, ndigits++;
-      if (trefTOF.isBitSet(Cluster::kUp))
-        posCorr[2] -= Geo::ZPAD, ndigits++;
-      if (trefTOF.isBitSet(Cluster::kDown))
-        posCorr[2] += Geo::ZPAD, ndigits++;
-      if (trefTOF.isBitSet(Cluster::kRight))
-        posCorr[0] -= Geo::XPAD, ndigits++;
-      if (trefTOF.isBitSet(Cluster::kUpRight))
-        posCorr[0] -= Geo::XPAD, posCorr[2] -= Geo::ZPAD, ndigits++;
-      if (trefTOF.isBitSet(Cluster::kDownRight))
-        posCorr[0] -= Geo::XPAD, posCorr[2] += Geo::ZPAD, ndigits++;
-
-      if (ndigits > 1) {
-        posCorr[0] /= ndigits;
-        posCorr[1] /= ndigits;
-        posCorr[2] /= ndigits;
-      }
+    for (const auto& range : ranges) {
+      for (int entry = range.getFirstEntry(); entry < range.getFirstEntry() + range.getEntries(); entry++) {
+        int itof = stripIndex.getSectorCacheEntry(entry);
+        auto& trefTOF = mTOFClusWork[cacheTOF[itof]];
+
+        int mainChannel = trefTOF.getMainContributingChannel();
+        int indices[5];
+        Geo::getVolumeIndices(mainChannel, indices);
+
+        // compute fine correction using cluster position instead of pad center
+        // this because in case of multiple-hit cluster position is averaged on all pads contributing to the cluster (then error position matrix can be used for Chi2 if nedeed)
+        int ndigits = 1;
+        float posCorr[3] = {0, 0, 0};
+
+        if (trefTOF.isBitSet(Cluster::kLeft))
+          posCorr[0] += Geo::XPAD, ndigits++;
+        if (trefTOF.isBitSet(Cluster::kUpLeft))
+          posCorr[0] += Geo::XPAD, posCorr[2] -= Geo::ZPAD, ndigits++;
+        if (trefTOF.isBitSet(Cluster::kDownLeft))
+          posCorr[0] += Geo::XPAD, posCorr[2] += Geo::ZPAD, ndigits++;
+        if (trefTOF.isBitSet(Cluster::kUp))
+          posCorr[2] -= Geo::ZPAD, ndigits++;
+        if (trefTOF.isBitSet(Cluster::kDown))
+          posCorr[2] += Geo::ZPAD, ndigits++;
+        if (trefTOF.isBitSet(Cluster::kRight))
+          posCorr[0] -= Geo::XPAD, ndigits++;
+        if (trefTOF.isBitSet(Cluster::kUpRight))
+          posCorr[0] -= Geo::XPAD, posCorr[2] -= Geo::ZPAD, ndigits++;
+        if (trefTOF.isBitSet(Cluster::kDownRight))
+          posCorr[0] -= Geo::XPAD, posCorr[2] += Geo::ZPAD, ndigits++;
+
+        if (ndigits > 1) {
+          posCorr[0] /= ndigits;
+          posCorr[1] /= ndigits;
+          posCorr[2] /= ndigits;
+        }
 
-      int trackIdTOF;
-      int eventIdTOF;
-      int sourceIdTOF;
-      for (auto iPropagation = 0; iPropagation < nStripsCrossedInPropagation; iPropagation++) {
-        LOG(DEBUG) << "TOF Cluster [" << itof << ", " << cacheTOF[itof] << "]:      indices   = " << indices[0] << ", " << indices[1] << ", " << indices[2] << ", " << indices[3] << ", " << indices[4];
-        LOG(DEBUG) << "Propagated Track [" << itrk << ", " << cacheTrk[itrk] << "]: detId[" << iPropagation << "]  = " << detId[iPropagation][0] << ", " << detId[iPropagation][1] << ", " << detId[iPropagation][2] << ", " << detId[iPropagation][3] << ", " << detId[iPropagation][4];
-        float resX = deltaPos[iPropagation][0] - (indices[4] - detId[iPropagation][4]) * Geo::XPAD + posCorr[0]; // readjusting the residuals due to the fact that the propagation fell in a pad that was not exactly the one of the cluster
-        float resZ = deltaPos[iPropagation][2] - (indices[3] - detId[iPropagation][3]) * Geo::ZPAD + posCorr[2]; // readjusting the residuals due to the fact that the propagation fell in a pad that was not exactly the one of the cluster
-        float res = TMath::Sqrt(resX * resX + resZ * resZ);
-
-        LOG(DEBUG) << "resX = " << resX << ", resZ = " << resZ << ", res = " << res;
+        int trackIdTOF;
+        int eventIdTOF;
+        int sourceIdTOF;
+        for (auto iPropagation = 0; iPropagation < nStripsCrossedInPropagation; iPropagation++) {
+          LOG(DEBUG) << "TOF Cluster [" << itof << ", " << cacheTOF[itof] << "]:      indices   = " << indices[0] << ", " << indices[1] << ", " << indices[2] << ", " << indices[3] << ", " << indices[4];
+          LOG(DEBUG) << "Propagated Track [" << itrk << ", " << cacheTrk[itrk] << "]: detId[" << iPropagation << "]  = " << detId[iPropagation][0] << ", " << detId[iPropagation][1] << ", " << detId[iPropagation][2] << ", " << detId[iPropagation][3] << ", " << detId[iPropagation][4];
+          float resX = deltaPos[iPropagation][0] - (indices[4] - detId[iPropagation][4]) * Geo::XPAD + posCorr[0]; // readjusting the residuals due to the fact that the propagation fell in a pad that was not exactly the one of the cluster
+          float resZ = deltaPos[iPropagation][2] - (indices[3] - detId[iPropagation][3]) * Geo::ZPAD + posCorr[2]; // readjusting the residuals due to the fact that the propagation fell in a pad that was not exactly the one of the cluster
+          float res = TMath::Sqrt(resX * resX + resZ * resZ);
+
+          LOG(DEBUG) << "resX = " << resX << ", resZ = " << resZ << ", res = " << res;
 #ifdef _ALLOW_TOF_DEBUG_
-        fillTOFmatchTree("match0", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
-        int tofLabelTrackID[3] = {-1, -1, -1};
-        int tofLabelEventID[3] = {-1, -1, -1};
-        int tofLabelSourceID[3] = {-1, -1, -1};
-        if (mMCTruthON) {
-          const auto& labelsTOF = mTOFClusLabels.getLabels(mTOFClusSectIndexCache[indices[0]][itof]);
-          for (int ilabel = 0; ilabel < labelsTOF.size(); ilabel++) {
-            tofLabelTrackID[ilabel] = labelsTOF[ilabel].getTrackID();
-            tofLabelEventID[ilabel] = labelsTOF[ilabel].getEventID();
-            tofLabelSourceID[ilabel] = labelsTOF[ilabel].getSourceID();
+          fillTOFmatchTree("match0", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
+          int tofLabelTrackID[3] = {-1, -1, -1};
+          int tofLabelEventID[3] = {-1, -1, -1};
+          int tofLabelSourceID[3] = {-1, -1, -1};
+          if (mMCTruthON) {
+            const auto& labelsTOF = mTOFClusLabels.getLabels(mTOFClusSectIndexCache[indices[0]][itof]);
+            for (int ilabel = 0; ilabel < labelsTOF.size(); ilabel++) {
+              tofLabelTrackID[ilabel] = labelsTOF[ilabel].getTrackID();
+              tofLabelEventID[ilabel] = labelsTOF[ilabel].getEventID();
+              tofLabelSourceID[ilabel] = labelsTOF[ilabel].getSourceID();
+            }
+            auto labelTPC = mTPCLabels[mTracksSectIndexCache[sec][itrk]];
+            auto labelITS = mITSLabels[mTracksSectIndexCache[indices[0]][itrk]];
+            fillTOFmatchTreeWithLabels("matchPossibleWithLabels", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, labelTPC.getTrackID(), labelTPC.getEventID(), labelTPC.getSourceID(), labelITS.getTrackID(), labelITS.getEventID(), labelITS.getSourceID(), tofLabelTrackID[0], tofLabelEventID[0], tofLabelSourceID[0], tofLabelTrackID[1], tofLabelEventID[1], tofLabelSourceID[1], tofLabelTrackID[2], tofLabelEventID[2], tofLabelSourceID[2], trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
           }
-          auto labelTPC = mTPCLabels[mTracksSectIndexCache[sec][itrk]];
-          auto labelITS = mITSLabels[mTracksSectIndexCache[indices[0]][itrk]];
-          fillTOFmatchTreeWithLabels("matchPossibleWithLabels", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, labelTPC.getTrackID(), labelTPC.getEventID(), labelTPC.getSourceID(), labelITS.getTrackID(), labelITS.getEventID(), labelITS.getSourceID(), tofLabelTrackID[0], tofLabelEventID[0], tofLabelSourceID[0], tofLabelTrackID[1], tofLabelEventID[1], tofLabelSourceID[1], tofLabelTrackID[2], tofLabelEventID[2], tofLabelSourceID[2], trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
-        }
 #endif
-        if (indices[0] != detId[iPropagation][0])
-          continue;
-        if (indices[1] != detId[iPropagation][1])
-          continue;
-        if (indices[2] != detId[iPropagation][2])
-          continue;
-        float chi2 = res; // TODO: take into account also the time!
+          if (indices[0] != detId[iPropagation][0])
+            continue;
+          if (indices[1] != detId[iPropagation][1])
+            continue;
+          if (indices[2] != detId[iPropagation][2])
+            continue;
+          float chi2 = res; // TODO: take into account also the time!
 #ifdef _ALLOW_TOF_DEBUG_
-        fillTOFmatchTree("match1", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
-        if (mMCTruthON) {
-          auto labelTPC = mTPCLabels[mTracksSectIndexCache[sec][itrk]];
-          auto labelITS = mITSLabels[mTracksSectIndexCache[indices[0]][itrk]];
-          fillTOFmatchTreeWithLabels("matchOkWithLabels", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, labelTPC.getTrackID(), labelTPC.getEventID(), labelTPC.getSourceID(), labelITS.getTrackID(), labelITS.getEventID(), labelITS.getSourceID(), tofLabelTrackID[0], tofLabelEventID[0], tofLabelSourceID[0], tofLabelTrackID[1], tofLabelEventID[1], tofLabelSourceID[1], tofLabelTrackID[2], tofLabelEventID[2], tofLabelSourceID[2], trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
-        }
+          fillTOFmatchTree("match1", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
+          if (mMCTruthON) {
+            auto labelTPC = mTPCLabels[mTracksSectIndexCache[sec][itrk]];
+            auto labelITS = mITSLabels[mTracksSectIndexCache[indices[0]][itrk]];
+            fillTOFmatchTreeWithLabels("matchOkWithLabels", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, labelTPC.getTrackID(), labelTPC.getEventID(), labelTPC.getSourceID(), labelITS.getTrackID(), labelITS.getEventID(), labelITS.getSourceID(), tofLabelTrackID[0], tofLabelEventID[0], tofLabelSourceID[0], tofLabelTrackID[1], tofLabelEventID[1], tofLabelSourceID[1], tofLabelTrackID[2], tofLabelEventID[2], tofLabelSourceID[2], trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
+          }
 #endif
 
-        if (res < mSpaceTolerance) { // matching ok!
-          LOG(DEBUG) << "MATCHING FOUND: We have a match! between track " << mTracksSectIndexCache[indices[0]][itrk] << " and TOF cluster " << mTOFClusSectIndexCache[indices[0]][itof];
-          foundCluster = true;
-          // set event indexes (to be checked)
-          evIdx eventIndexTOFCluster(trefTOF.getEntryInTree(), mTOFClusSectIndexCache[indices[0]][itof]);
-          evIdx eventIndexTracks(mCurrTracksTreeEntry, mTracksSectIndexCache[indices[0]][itrk]);
-          mMatchedTracksPairs.emplace_back(o2::dataformats::MatchInfoTOF(eventIndexTOFCluster, chi2, trkLTInt[iPropagation], eventIndexTracks)); // TODO: check if this is correct!
+          if (res < mSpaceTolerance) { // matching ok!
+            LOG(DEBUG) << "MATCHING FOUND: We have a match! between track " << mTracksSectIndexCache[indices[0]][itrk] << " and TOF cluster " << mTOFClusSectIndexCache[indices[0]][itof];
+            foundCluster = true;
+            // set event indexes (to be checked)
+            evIdx eventIndexTOFCluster(trefTOF.getEntryInTree(), mTOFClusSectIndexCache[indices[0]][itof]);
+            evIdx eventIndexTracks(mCurrTracksTreeEntry, mTracksSectIndexCache[indices[0]][itrk]);
+            mMatchedTracksPairs.emplace_back(o2::dataformats::MatchInfoTOF(eventIndexTOFCluster, chi2, trkLTInt[iPropagation], eventIndexTracks)); // TODO: check if this is correct!
 
 #ifdef _ALLOW_TOF_DEBUG_
-          if (mMCTruthON) {
-            const auto& labelsTOF = mTOFClusLabels.getLabels(mTOFClusSectIndexCache[indices[0]][itof]);
-            auto labelTPC = mTPCLabels[mTracksSectIndexCache[sec][itrk]];
-            auto labelITS = mITSLabels[mTracksSectIndexCache[indices[0]][itrk]];
-            for (int ilabel = 0; ilabel < labelsTOF.size(); ilabel++) {
-              LOG(DEBUG) << "TOF label " << ilabel << labelsTOF[ilabel];
+            if (mMCTruthON) {
+              const auto& labelsTOF = mTOFClusLabels.getLabels(mTOFClusSectIndexCache[indices[0]][itof]);
+              auto labelTPC = mTPCLabels[mTracksSectIndexCache[sec][itrk]];
+              auto labelITS = mITSLabels[mTracksSectIndexCache[indices[0]][itrk]];
+              for (int ilabel = 0; ilabel < labelsTOF.size(); ilabel++) {
+                LOG(DEBUG) << "TOF label " << ilabel << labelsTOF[ilabel];
+              }
+              LOG(DEBUG) << "TPC label " << labelTPC;
+              LOG(DEBUG) << "ITS label " << labelITS;
+              fillTOFmatchTreeWithLabels("matchOkWithLabelsInSpaceTolerance", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, labelTPC.getTrackID(), labelTPC.getEventID(), labelTPC.getSourceID(), labelITS.getTrackID(), labelITS.getEventID(), labelITS.getSourceID(), tofLabelTrackID[0], tofLabelEventID[0], tofLabelSourceID[0], tofLabelTrackID[1], tofLabelEventID[1], tofLabelSourceID[1], tofLabelTrackID[2], tofLabelEventID[2], tofLabelSourceID[2], trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
             }
-            LOG(DEBUG) << "TPC label " << labelTPC;
-            LOG(DEBUG) << "ITS label " << labelITS;
-            fillTOFmatchTreeWithLabels("matchOkWithLabelsInSpaceTolerance", cacheTOF[itof], indices[0], indices[1], indices[2], indices[3], indices[4], cacheTrk[itrk], iPropagation, detId[iPropagation][0], detId[iPropagation][1], detId[iPropagation][2], detId[iPropagation][3], detId[iPropagation][4], resX, resZ, res, trackWork, labelTPC.getTrackID(), labelTPC.getEventID(), labelTPC.getSourceID(), labelITS.getTrackID(), labelITS.getEventID(), labelITS.getSourceID(), tofLabelTrackID[0], tofLabelEventID[0], tofLabelSourceID[0], tofLabelTrackID[1], tofLabelEventID[1], tofLabelSourceID[1], tofLabelTrackID[2], tofLabelEventID[2], tofLabelSourceID[2], trkLTInt[iPropagation].getL(), trkLTInt[iPropagation].getTOF(o2::track::PID::Pion), trefTOF.getTime());
-          }
 #endif
+          }
         }
       }
     }
@@ -845,6 +760,131 @@ void MatchTOF::doMatching(int sec)
   }
   return;
 }
+
+//______________________________________________
+void MatchTOF::propagateThroughStrips(int trackID, CrossedStripsTOF& strips)
+{
+  ///< propagate the track at the reference X through the TOF volume, finding the (max 2) strips that it crosses
+  int(&detId)[2][5] = strips.detId;                       // at maximum one track can fall in 2 strips during the propagation; the second dimention of the array is the TOF det index
+  float(&deltaPos)[2][3] = strips.deltaPos;               // at maximum one track can fall in 2 strips during the propagation; the second dimention of the array is the residuals
+  o2::track::TrackLTIntegral(&trkLTInt)[2] = strips.intLT; // Here we store the integrated track length and time for the (max 2) matched strips
+  int nStepsInsideSameStrip[2] = {0, 0};                   // number of propagation steps in the same strip (since we have maximum 2 strips, it has dimention = 2)
+  float deltaPosTemp[3];
+  std::array<float, 3> pos;
+  float posFloat[3];
+
+  int nStripsCrossedInPropagation = 0; // how many strips were hit during the propagation
+  auto& trackWork = mTracksWork[trackID];
+  auto& trefTrk = trackWork.getParamOut();
+  auto& intLT = trackWork.getLTIntegralOut();
+  int istep = 1;    // number of steps
+  float step = 1.0; // step size in cm
+
+  // initializing
+  for (int ii = 0; ii < 2; ii++) {
+    for (int iii = 0; iii < 5; iii++) {
+      detId[ii][iii] = -1;
+    }
+  }
+
+  int detIdTemp[5] = {-1, -1, -1, -1, -1}; // TOF detector id at the current propagation point
+
+  double reachedPoint = mXRef + istep * step;
+
+  while (propagateToRefX(trefTrk, reachedPoint, step, intLT) && nStripsCrossedInPropagation <= 2 && reachedPoint < Geo::RMAX) {
+    // while (o2::base::Propagator::Instance()->PropagateToXBxByBz(trefTrk,  mXRef + istep * step, o2::constants::physics::MassPionCharged, MAXSNP, step, 1, &intLT) && nStripsCrossedInPropagation <= 2 && mXRef + istep * step < Geo::RMAX) {
+
+    trefTrk.getXYZGlo(pos);
+    for (int ii = 0; ii < 3; ii++) { // we need to change the type...
+      posFloat[ii] = pos[ii];
+    }
+    // uncomment below only for local debug; this will produce A LOT of output - one print per propagation step
+    /*
+    Printf("posFloat[0] = %f, posFloat[1] = %f, posFloat[2] = %f", posFloat[0], posFloat[1], posFloat[2]);
+    Printf("radius xy = %f", TMath::Sqrt(posFloat[0]*posFloat[0] + posFloat[1]*posFloat[1]));
+    Printf("radius xyz = %f", TMath::Sqrt(posFloat[0]*posFloat[0] + posFloat[1]*posFloat[1] + posFloat[2]*posFloat[2]));
+    */
+
+    for (int idet = 0; idet < 5; idet++)
+      detIdTemp[idet] = -1;
+
+    Geo::getPadDxDyDz(posFloat, detIdTemp, deltaPosTemp);
+
+    if (detIdTemp[2] == -1) {
+      reachedPoint += step;
+      continue;
+    }
+
+    // to reduce the active region of the strip -> uncomment these lines
+    // float yresidual = TMath::Abs(deltaPosTemp[1]);
+    // if(yresidual > 0.55){
+    // 	reachedPoint += step;
+    // 	continue;
+    // }
+
+    //      printf("res %f %f %f -- %f %f %f (%d)\n",deltaPosTemp[0],deltaPosTemp[1],deltaPosTemp[2],pos[0],pos[1],pos[2],detIdTemp[2]);
+
+    // if you want to exit from the strip matched uncomment this line
+    //      reachedPoint += 3.0; // go out from the strip at the next step
+
+    //      printf("idet: %d %d %d %d %d\n",detIdTemp[0],detIdTemp[1],detIdTemp[2],detIdTemp[3],detIdTemp[4]);
+
+    // uncomment below only for local debug; this will produce A LOT of output - one print per propagation step
+    //Printf("detIdTemp[0] = %d, detIdTemp[1] = %d, detIdTemp[2] = %d, detIdTemp[3] = %d, detIdTemp[4] = %d", detIdTemp[0], detIdTemp[1], detIdTemp[2], detIdTemp[3], detIdTemp[4]);
+    // if (nStripsCrossedInPropagation == 0) { // print in case you have a useful propagation
+    //   LOG(DEBUG) << "*********** We have crossed a strip during propagation!*********";
+    //   LOG(DEBUG) << "Global coordinates: pos[0] = " << pos[0] << ", pos[1] = " << pos[1] << ", pos[2] = " << pos[2];
+    //   LOG(DEBUG) << "detIdTemp[0] = " << detIdTemp[0] << ", detIdTemp[1] = " << detIdTemp[1] << ", detIdTemp[2] = " << detIdTemp[2] << ", detIdTemp[3] = " << detIdTemp[3] << ", detIdTemp[4] = " << detIdTemp[4];
+    //   LOG(DEBUG) << "deltaPosTemp[0] = " << deltaPosTemp[0] << ", deltaPosTemp[1] = " << deltaPosTemp[1] << " deltaPosTemp[2] = " << deltaPosTemp[2];
+    // } else {
+    //   LOG(DEBUG) << "*********** We have NOT crossed a strip during propagation!*********";
+    //   LOG(DEBUG) << "Global coordinates: pos[0] = " << pos[0] << ", pos[1] = " << pos[1] << ", pos[2] = " << pos[2];
+    //   LOG(DEBUG) << "detIdTemp[0] = " << detIdTemp[0] << ", detIdTemp[1] = " << detIdTemp[1] << ", detIdTemp[2] = " << detIdTemp[2] << ", detIdTemp[3] = " << detIdTemp[3] << ", detIdTemp[4] = " << detIdTemp[4];
+    //   LOG(DEBUG) << "deltaPosTemp[0] = " << deltaPosTemp[0] << ", deltaPosTemp[1] = " << deltaPosTemp[1] << " deltaPosTemp[2] = " << deltaPosTemp[2];
+    // }
+
+    // check if after the propagation we are in a TOF strip
+    // we ended in a TOF strip
+    // LOG(DEBUG) << "nStripsCrossedInPropagation = " << nStripsCrossedInPropagation << ", detId[nStripsCrossedInPropagation][0] = " << detId[nStripsCrossedInPropagation][0] << ", detIdTemp[0] = " << detIdTemp[0] << ", detId[nStripsCrossedInPropagation][1] = " << detId[nStripsCrossedInPropagation][1] << ", detIdTemp[1] = " << detIdTemp[1] << ", detId[nStripsCrossedInPropagation][2] = " << detId[nStripsCrossedInPropagation][2] << ", detIdTemp[2] = " << detIdTemp[2];
+    if (nStripsCrossedInPropagation == 0 ||                                                                                                                                                                                            // we are crossing a strip for the first time...
+        (nStripsCrossedInPropagation >= 1 && (detId[nStripsCrossedInPropagation - 1][0] != detIdTemp[0] || detId[nStripsCrossedInPropagation - 1][1] != detIdTemp[1] || detId[nStripsCrossedInPropagation - 1][2] != detIdTemp[2]))) { // ...or we are crossing a new strip
+      if (nStripsCrossedInPropagation == 0)
+        // LOG(DEBUG) << "We cross a strip for the first time";
+        if (nStripsCrossedInPropagation == 2) {
+          break; // we have already matched 2 strips, we cannot match more
+        }
+      nStripsCrossedInPropagation++;
+    }
+    //Printf("nStepsInsideSameStrip[nStripsCrossedInPropagation-1] = %d", nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]);
+    if (nStepsInsideSameStrip[nStripsCrossedInPropagation - 1] == 0) {
+      detId[nStripsCrossedInPropagation - 1][0] = detIdTemp[0];
+      detId[nStripsCrossedInPropagation - 1][1] = detIdTemp[1];
+      detId[nStripsCrossedInPropagation - 1][2] = detIdTemp[2];
+      detId[nStripsCrossedInPropagation - 1][3] = detIdTemp[3];
+      detId[nStripsCrossedInPropagation - 1][4] = detIdTemp[4];
+      deltaPos[nStripsCrossedInPropagation - 1][0] = deltaPosTemp[0];
+      deltaPos[nStripsCrossedInPropagation - 1][1] = deltaPosTemp[1];
+      deltaPos[nStripsCrossedInPropagation - 1][2] = deltaPosTemp[2];
+      trkLTInt[nStripsCrossedInPropagation - 1] = intLT;
+      //          Printf("intLT (after matching to strip %d): length = %f, time (Pion) = %f", nStripsCrossedInPropagation - 1, trkLTInt[nStripsCrossedInPropagation - 1].getL(), trkLTInt[nStripsCrossedInPropagation - 1].getTOF(o2::track::PID::Pion));
+      nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]++;
+    } else { // a further propagation step in the same strip -> update info (we sum up on all matching with strip - we will divide for the number of steps a bit below)
+      // N.B. the integrated length and time are taken (at least for now) from the first time we crossed the strip, so here we do nothing with those
+      deltaPos[nStripsCrossedInPropagation - 1][0] += deltaPosTemp[0] + (detIdTemp[4] - detId[nStripsCrossedInPropagation - 1][4]) * Geo::XPAD; // residual in x
+      deltaPos[nStripsCrossedInPropagation - 1][1] += deltaPosTemp[1];                                                                          // residual in y
+      deltaPos[nStripsCrossedInPropagation - 1][2] += deltaPosTemp[2] + (detIdTemp[3] - detId[nStripsCrossedInPropagation - 1][3]) * Geo::ZPAD; // residual in z
+      nStepsInsideSameStrip[nStripsCrossedInPropagation - 1]++;
+    }
+  }
+
+  for (Int_t imatch = 0; imatch < nStripsCrossedInPropagation; imatch++) {
+    // we take as residual the average of the residuals along the propagation in the same strip
+    deltaPos[imatch][0] /= nStepsInsideSameStrip[imatch];
+    deltaPos[imatch][1] /= nStepsInsideSameStrip[imatch];
+    deltaPos[imatch][2] /= nStepsInsideSameStrip[imatch];
+  }
+  strips.nStrips = nStripsCrossedInPropagation;
+}
 //______________________________________________
 int MatchTOF::findFITIndex(int bc)
 {
@@ -1015,6 +1055,29 @@ bool MatchTOF::propagateToRefXWithoutCov(o2::track::TrackParCov& trc, float xRef
   return refReached && std::abs(trcNoCov.getSnp()) < 0.95 && TMath::Abs(trcNoCov.getZ()) < Geo::MAXHZTOF; // Here we need to put MAXSNP
 }
 
+//______________________________________________
+void MatchTOF::setNThreads(int n)
+{
+  ///< set number of threads for the propagation of the tracks
+#ifdef WITH_OPENMP
+  mNThreads = n > 0 ? n : omp_get_max_threads();
+#else
+  if (n != 1) {
+    LOG(WARNING) << "No OpenMP support, TOF matching will run in 1 thread instead of " << n;
+  }
+  mNThreads = 1;
+#endif
+}
+
+//______________________________________________
+void MatchTOF::attachGeoNavigator() const
+{
+  ///< in MT mode the TGeo material queries need a geometry navigator per thread, create it if needed
+  if (gGeoManager && gGeoManager->IsMultiThread() && !gGeoManager->GetCurrentNavigator()) {
+    gGeoManager->AddNavigator();
+  }
+}
+
 //______________________________________________
 void MatchTOF::setDebugFlag(UInt_t flag, bool on)
 {
@@ -1066,3 +1129,50 @@ void MatchTOF::fillTOFmatchTreeWithLabels(const char* trname, int cacheTOF, int
   }
   mTimerDBG.Stop();
 }
+
+//______________________________________________
+void StripTimeIndexTOF::build(const std::vector<Cluster>& clusters, const std::vector<int>& sectorCache)
+{
+  ///< group the entries of the sector cache per strip; since the cache is ordered in time
+  ///< and the grouping is stable, the clusters of each strip stay ordered in time
+  int nCls = sectorCache.size();
+  mStripStart.fill(0);
+  for (int icl : sectorCache) {
+    mStripStart[clusters[icl].getPadInSector() / o2::tof::Geo::NPADS + 1]++;
+  }
+  for (int strip = 0; strip < o2::tof::Geo::NSTRIPXSECTOR; strip++) {
+    mStripStart[strip + 1] += mStripStart[strip];
+  }
+  mEntries.resize(nCls);
+  mTimes.resize(nCls);
+  auto next = mStripStart;
+  for (int itof = 0; itof < nCls; itof++) {
+    const auto& cl = clusters[sectorCache[itof]];
+    int entry = next[cl.getPadInSector() / o2::tof::Geo::NPADS]++;
+    mEntries[entry] = itof;
+    mTimes[entry] = cl.getTime();
+  }
+}
+
+//______________________________________________
+StripTimeIndexTOF::ClusRange StripTimeIndexTOF::query(int strip, float tMin, float tMax) const
+{
+  ///< the clusters of the strip with time in [tMin:tMax] occupy a contiguous range of the index
+  if (strip < 0 || strip >= o2::tof::Geo::NSTRIPXSECTOR || tMax < tMin) {
+    return ClusRange(0, 0);
+  }
+  auto first = mTimes.begin() + mStripStart[strip], last = mTimes.begin() + mStripStart[strip + 1];
+  auto low = std::lower_bound(first, last, double(tMin));
+  auto up = std::upper_bound(low, last, double(tMax));
+  return ClusRange(low - mTimes.begin(), up - low);
+}
+
+//______________________________________________
+void StripTimeIndexTOF::query(gsl::span<const Query> queries, std::vector<ClusRange>& ranges) const
+{
+  ranges.clear();
+  ranges.reserve(queries.size());
+  for (const auto& q : queries) {
+    ranges.push_back(query(q.strip, q.tMin, q.tMax));
+  }
+}
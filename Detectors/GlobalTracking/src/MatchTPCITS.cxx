@@ -34,6 +34,7 @@
 #include <Math/SVector.h>
 #include <TFile.h>
 #include <TGeoGlobalMagField.h>
+#include <TGeoManager.h>
 #include "DataFormatsParameters/GRPObject.h"
 #include "SimulationDataFormat/MCTruthContainer.h"
 #include "GlobalTracking/MatchTPCITS.h"
@@ -43,6 +44,10 @@
 #include "GPUO2Interface.h" // Needed for propper settings in GPUParam.h
 #include "GPUParam.inc"     // Consider more universal access
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using namespace o2::globaltracking;
 
 using MatrixDSym4 = ROOT::Math::SMatrix<double, 4, 4, ROOT::Math::MatRepSym<double, 4>>;
@@ -259,6 +264,9 @@ void MatchTPCITS::run()
   if (!prepareITSTracks() || !prepareTPCTracks() || !prepareFITInfo()) {
     return;
   }
+  if (mNThreads > 1 && mUseMatCorrFlag == o2::base::Propagator::USEMatCorrTGeo && gGeoManager && !gGeoManager->IsMultiThread()) {
+    gGeoManager->SetMaxThreads(mNThreads); // allow threads to have their own navigators for material queries
+  }
   mTimer[SWDoMatching].Start(false);
   for (int sec = o2::constants::math::NSectors; sec--;) {
     doMatching(sec);
@@ -786,7 +794,6 @@ void MatchTPCITS::doMatching(int sec)
   auto& cacheITS = mITSSectIndexCache[sec];   // array of cached ITS track indices for this sector
   auto& cacheTPC = mTPCSectIndexCache[sec];   // array of cached ITS track indices for this sector
   auto& tbinStartTPC = mTPCTimeBinStart[sec]; // array of 1st TPC track with timeMax in ITS ROFrame
-  auto& tbinStartITS = mITSTimeBinStart[sec];
   int nTracksTPC = cacheTPC.size(), nTracksITS = cacheITS.size();
   if (!nTracksTPC || !nTracksITS) {
     LOG(INFO) << "Matchng sector " << sec << " : N tracks TPC:" << nTracksTPC << " ITS:" << nTracksITS << " in sector "
@@ -794,9 +801,6 @@ void MatchTPCITS::doMatching(int sec)
     return;
   }
 
-  /// full drift time + safety margin
-  float maxTDriftSafe = (mNTPCBinsFullDrift + mParams->TPCITSTimeBinSafeMargin + mTPCTimeEdgeTSafeMargin);
-
   // get min ROFrame (in TPC time-bins) of ITS tracks currently in cache
   auto minROFITS = mITSWork[cacheITS.front()].roFrame;
 
@@ -809,7 +813,66 @@ void MatchTPCITS::doMatching(int sec)
   int nCheckTPCControl = 0, nCheckITSControl = 0, nMatchesControl = 0; // temporary
 
   int idxMinTPC = tbinStartTPC[minROFITS]; // index of 1st cached TPC track within cached ITS ROFrames
-  for (int itpc = idxMinTPC; itpc < nTracksTPC; itpc++) {
+
+  // The TPC tracks are checked in chunks, concurrently in MT mode. The candidates are registered afterwards
+  // in the order of TPC and ITS tracks, so that the match records do not depend on the number of threads
+  int nChunks = std::min(nTracksTPC - idxMinTPC, mNThreads == 1 ? 1 : LoopPerThread * mNThreads);
+  if (nChunks > 0) {
+    int chunkSize = (nTracksTPC - idxMinTPC + nChunks - 1) / nChunks;
+    std::vector<std::vector<matchCandidate>> candidates(nChunks);
+    std::vector<int> nCheckTPC(nChunks, 0), nCheckITS(nChunks, 0);
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads)
+#endif
+    //>> start of MT region
+    for (int ich = 0; ich < nChunks; ich++) {
+      int itpcStart = idxMinTPC + ich * chunkSize;
+      checkSectorCandidates(sec, itpcStart, std::min(itpcStart + chunkSize, nTracksTPC), candidates[ich], nCheckTPC[ich], nCheckITS[ich]);
+    }
+    //<< end of MT region
+
+    for (int ich = 0; ich < nChunks; ich++) {
+      nCheckTPCControl += nCheckTPC[ich];
+      nCheckITSControl += nCheckITS[ich];
+      for (const auto& cand : candidates[ich]) {
+#ifdef _ALLOW_DEBUG_TREES_
+        if (mDBGOut && ((cand.rejFlag == Accept && isDebugFlag(MatchTreeAccOnly)) || isDebugFlag(MatchTreeAll))) {
+          fillTPCITSmatchTree(cand.iITS, cand.iTPC, cand.rejFlag, cand.chi2);
+        }
+#endif
+        if (cand.rejFlag != Accept) {
+          continue;
+        }
+        registerMatchRecordTPC(cand.iITS, cand.iTPC, cand.chi2); // register matching candidate
+        nMatchesControl++;
+      }
+    }
+  }
+
+  LOG(INFO) << "Match sector " << sec << " N tracks TPC:" << nTracksTPC << " ITS:" << nTracksITS
+            << " N TPC tracks checked: " << nCheckTPCControl << " (starting from " << idxMinTPC
+            << "), checks: " << nCheckITSControl << ", matches:" << nMatchesControl;
+}
+
+//______________________________________________
+void MatchTPCITS::checkSectorCandidates(int sec, int itpcStart, int itpcEnd, std::vector<matchCandidate>& candidates,
+                                        int& nCheckTPC, int& nCheckITS) const
+{
+  ///< compare TPC tracks [itpcStart:itpcEnd) of the sector cache with the time-compatible ITS tracks, storing
+  ///< the accepted pairs (and, if the full debug tree is requested, the rejected ones) as candidates
+  const auto& cacheITS = mITSSectIndexCache[sec];
+  const auto& cacheTPC = mTPCSectIndexCache[sec];
+  const auto& tbinStartITS = mITSTimeBinStart[sec];
+  int nTracksITS = cacheITS.size();
+  bool storeRejected = false;
+#ifdef _ALLOW_DEBUG_TREES_
+  storeRejected = mDBGOut && isDebugFlag(MatchTreeAll);
+#endif
+
+  /// full drift time + safety margin
+  float maxTDriftSafe = (mNTPCBinsFullDrift + mParams->TPCITSTimeBinSafeMargin + mTPCTimeEdgeTSafeMargin);
+
+  for (int itpc = itpcStart; itpc < itpcEnd; itpc++) {
     auto& trefTPC = mTPCWork[cacheTPC[itpc]];
     // estimate ITS 1st ROframe bin this track may match to: TPC track are sorted according to their
     // timeMax, hence the timeMax - MaxmNTPCBinsFullDrift are non-decreasing
@@ -819,7 +882,7 @@ void MatchTPCITS::doMatching(int sec)
       break;
     }
     int iits0 = tbinStartITS[itsROBin];
-    nCheckTPCControl++;
+    nCheckTPC++;
     for (auto iits = iits0; iits < nTracksITS; iits++) {
       auto& trefITS = mITSWork[cacheITS[iits]];
       const auto& timeITS = mITSROFTimes[trefITS.roFrame];
@@ -832,15 +895,13 @@ void MatchTPCITS::doMatching(int sec)
       if (trefTPC.timeBins > timeITS) { // its bracket precedes TPC bracket
         continue;
       }
-      nCheckITSControl++;
+      nCheckITS++;
       float chi2 = -1;
       int rejFlag = compareTPCITSTracks(trefITS, trefTPC, chi2);
 
-#ifdef _ALLOW_DEBUG_TREES_
-      if (mDBGOut && ((rejFlag == Accept && isDebugFlag(MatchTreeAccOnly)) || isDebugFlag(MatchTreeAll))) {
-        fillTPCITSmatchTree(cacheITS[iits], cacheTPC[itpc], rejFlag, chi2);
+      if (rejFlag == Accept || storeRejected) {
+        candidates.emplace_back(cacheITS[iits], cacheTPC[itpc], chi2, rejFlag);
       }
-#endif
 
       if (rejFlag == RejectOnTgl) {
         // ITS tracks in each ROFrame are ordered in Tgl, hence if this check failed on Tgl check
@@ -860,17 +921,8 @@ void MatchTPCITS::doMatching(int sec)
         }
         continue;
       }
-      if (rejFlag != Accept) {
-        continue;
-      }
-      registerMatchRecordTPC(cacheITS[iits], cacheTPC[itpc], chi2); // register matching candidate
-      nMatchesControl++;
     }
   }
-
-  LOG(INFO) << "Match sector " << sec << " N tracks TPC:" << nTracksTPC << " ITS:" << nTracksITS
-            << " N TPC tracks checked: " << nCheckTPCControl << " (starting from " << idxMinTPC
-            << "), checks: " << nCheckITSControl << ", matches:" << nMatchesControl;
 }
 
 //______________________________________________
@@ -1215,6 +1267,7 @@ void MatchTPCITS::print() const
   printf("Account Z dimension: %s\n", mCompareTracksDZ ? "on" : "off");
   printf("Cut on matching chi2: %.3f\n", mParams->cutMatchingChi2);
   printf("Max number ITS candidates per TPC track: %d\n", mParams->maxMatchCandidates);
+  printf("Number of threads: %d\n", mNThreads);
   printf("Crude cut on track params: ");
   for (int i = 0; i < o2::track::kNParams; i++) {
     printf(" %.3e", mParams->crudeAbsDiffCut[i]);
@@ -1255,31 +1308,57 @@ void MatchTPCITS::refitWinners(bool loopInITS)
   mTimer[SWRefit].Start(false);
   LOG(INFO) << "Refitting winner matches";
   mWinnerChi2Refit.resize(mITSWork.size(), -1.f);
+  // the winners are refitted concurrently in MT mode, each to its own slot, and then stored in the order of
+  // the single-threaded loop
+  std::vector<int> winners;
   if (loopInITS) {
-    int iTPC = 0; // will be ignored
     for (int iITS = 0; iITS < (int)mITSWork.size(); iITS++) {
-      if (!refitTrackTPCITSloopITS(iITS, iTPC)) {
-        continue;
+      if (!isDisabledITS(mITSWork[iITS])) {
+        winners.push_back(iITS);
       }
-      mWinnerChi2Refit[iITS] = mMatchedTracks.back().getChi2Refit();
     }
   } else {
-    int iITS;
     for (int iTPC = 0; iTPC < (int)mTPCWork.size(); iTPC++) {
-      if (!refitTrackTPCITSloopTPC(iTPC, iITS)) {
-        continue;
+      if (!isDisabledTPC(mTPCWork[iTPC])) {
+        winners.push_back(iTPC);
       }
-      mWinnerChi2Refit[iITS] = mMatchedTracks.back().getChi2Refit();
     }
   }
-  /*
-  */
-  // flush last tracks
+  int nWinners = winners.size();
+  std::vector<o2::dataformats::TrackTPCITS> refitted(nWinners);
+  std::vector<int> partners(nWinners, MinusOne); // TPC (ITS) partner of the ITS (TPC) winner, MinusOne if the refit failed
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads)
+#endif
+  //>> start of MT region
+  for (int iw = 0; iw < nWinners; iw++) {
+    attachGeoNavigator();
+    int partner = MinusOne;
+    bool res = loopInITS ? refitTrackTPCITSloopITS(winners[iw], partner, refitted[iw]) : refitTrackTPCITSloopTPC(winners[iw], partner, refitted[iw]);
+    if (res) {
+      partners[iw] = partner;
+    }
+  }
+  //<< end of MT region
+
+  mMatchedTracks.reserve(mMatchedTracks.size() + nWinners);
+  for (int iw = 0; iw < nWinners; iw++) {
+    if (partners[iw] == MinusOne) {
+      continue;
+    }
+    int iITS = loopInITS ? winners[iw] : partners[iw], iTPC = loopInITS ? partners[iw] : winners[iw];
+    mMatchedTracks.emplace_back(refitted[iw]);
+    mWinnerChi2Refit[iITS] = mMatchedTracks.back().getChi2Refit();
+    if (mMCTruthON) { // store MC info
+      mOutITSLabels.emplace_back(mITSLblWork[iITS]);
+      mOutTPCLabels.emplace_back(mTPCLblWork[iTPC]);
+    }
+  }
   mTimer[SWRefit].Stop();
 }
 
 //______________________________________________
-bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC)
+bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC, o2::dataformats::TrackTPCITS& trfit) const
 {
   ///< refit in inward direction the pair of TPC and ITS tracks
 
@@ -1294,8 +1373,7 @@ bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC)
   const auto& tTPC = mTPCWork[iTPC];
   const auto& itsTrOrig = mITSTracksArray[tITS.sourceID]; // currently we store clusterIDs in the track
 
-  mMatchedTracks.emplace_back(tTPC, tITS); // create a copy of TPC track at xRef
-  auto& trfit = mMatchedTracks.back();
+  trfit = o2::dataformats::TrackTPCITS(tTPC, tITS); // create a copy of TPC track at xRef
   // in continuos mode the Z of TPC track is meaningless, unless it is CE crossing
   // track (currently absent, TODO)
   if (!mCompareTracksDZ) {
@@ -1338,7 +1416,6 @@ bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC)
     tITS.print();
     printf("tpc was:  ");
     tTPC.print();
-    mMatchedTracks.pop_back(); // destroy failed track
     return false;
   }
 
@@ -1379,7 +1456,6 @@ bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC)
     // rotate to 1 cluster's sector
     if (!tracOut.rotate(o2::utils::Sector2Angle(sector % 18))) {
       LOG(WARNING) << "Rotation to sector " << int(sector % 18) << " failed";
-      mMatchedTracks.pop_back(); // destroy failed track
       return false;
     }
     // TODO: consider propagating in empty space till TPC entrance in large step, and then in more detailed propagation with mat. corrections
@@ -1387,7 +1463,6 @@ bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC)
     // propagate to 1st cluster X
     if (!propagator->PropagateToXBxByBz(tracOut, clsX, o2::constants::physics::MassPionCharged, MaxSnp, 10., mUseMatCorrFlag, &trfit.getLTIntegralOut())) {
       LOG(WARNING) << "Propagation to 1st cluster at X=" << clsX << " failed, Xtr=" << tracOut.getX() << " snp=" << tracOut.getSnp();
-      mMatchedTracks.pop_back(); // destroy failed track
       return false;
     }
     //
@@ -1396,7 +1471,6 @@ bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC)
     float chi2Out = tracOut.getPredictedChi2(clsYZ, clsCov);
     if (!tracOut.update(clsYZ, clsCov)) {
       LOG(WARNING) << "Update failed at 1st cluster, chi2 =" << chi2Out;
-      mMatchedTracks.pop_back(); // destroy failed track
       return false;
     }
     prevrow = row;
@@ -1419,7 +1493,6 @@ bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC)
         prevsector = sector;
         if (!tracOut.rotate(o2::utils::Sector2Angle(sector % 18))) {
           LOG(WARNING) << "Rotation to sector " << int(sector % 18) << " failed";
-          mMatchedTracks.pop_back(); // destroy failed track
           return false;
         }
       }
@@ -1427,13 +1500,11 @@ bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC)
                                           10., o2::base::Propagator::USEMatCorrNONE, &trfit.getLTIntegralOut())) { // no material correction!
         LOG(INFO) << "Propagation to cluster " << icl << " (of " << tpcTrOrig.getNClusterReferences() << ") at X="
                   << clsX << " failed, Xtr=" << tracOut.getX() << " snp=" << tracOut.getSnp() << " pT=" << tracOut.getPt();
-        mMatchedTracks.pop_back(); // destroy failed track
         return false;
       }
       chi2Out += tracOut.getPredictedChi2(clsYZ, clsCov);
       if (!tracOut.update(clsYZ, clsCov)) {
         LOG(WARNING) << "Update failed at cluster " << icl << ", chi2 =" << chi2Out;
-        mMatchedTracks.pop_back(); // destroy failed track
         return false;
       }
     }
@@ -1451,18 +1522,13 @@ bool MatchTPCITS::refitTrackTPCITSloopITS(int iITS, int& iTPC)
   trfit.setRefTPC(tTPC.sourceID);
   trfit.setRefITS(tITS.sourceID);
 
-  if (mMCTruthON) { // store MC info
-    mOutITSLabels.emplace_back(mITSLblWork[iITS]);
-    mOutTPCLabels.emplace_back(mTPCLblWork[iTPC]);
-  }
-
   //  trfit.print(); // DBG
 
   return true;
 }
 
 //______________________________________________
-bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS)
+bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS, o2::dataformats::TrackTPCITS& trfit) const
 {
   ///< refit in inward direction the pair of TPC and ITS tracks
 
@@ -1477,8 +1543,7 @@ bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS)
   const auto& tITS = mITSWork[iITS];
   const auto& itsTrOrig = mITSTracksArray[tITS.sourceID];
 
-  mMatchedTracks.emplace_back(tTPC, tITS); // create a copy of TPC track at xRef
-  auto& trfit = mMatchedTracks.back();
+  trfit = o2::dataformats::TrackTPCITS(tTPC, tITS); // create a copy of TPC track at xRef
   // in continuos mode the Z of TPC track is meaningless, unless it is CE crossing
   // track (currently absent, TODO)
   if (!mCompareTracksDZ) {
@@ -1520,7 +1585,6 @@ bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS)
     tITS.print();
     printf("tpc was:  ");
     tTPC.print();
-    mMatchedTracks.pop_back(); // destroy failed track
     return false;
   }
 
@@ -1561,7 +1625,6 @@ bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS)
     // rotate to 1 cluster's sector
     if (!tracOut.rotate(o2::utils::Sector2Angle(sector % 18))) {
       LOG(WARNING) << "Rotation to sector " << int(sector % 18) << " failed";
-      mMatchedTracks.pop_back(); // destroy failed track
       return false;
     }
     // TODO: consider propagating in empty space till TPC entrance in large step, and then in more detailed propagation with mat. corrections
@@ -1569,7 +1632,6 @@ bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS)
     // propagate to 1st cluster X
     if (!propagator->PropagateToXBxByBz(tracOut, clsX, o2::constants::physics::MassPionCharged, MaxSnp, 10., mUseMatCorrFlag, &trfit.getLTIntegralOut())) {
       LOG(WARNING) << "Propagation to 1st cluster at X=" << clsX << " failed, Xtr=" << tracOut.getX() << " snp=" << tracOut.getSnp();
-      mMatchedTracks.pop_back(); // destroy failed track
       return false;
     }
     //
@@ -1578,7 +1640,6 @@ bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS)
     float chi2Out = tracOut.getPredictedChi2(clsYZ, clsCov);
     if (!tracOut.update(clsYZ, clsCov)) {
       LOG(WARNING) << "Update failed at 1st cluster, chi2 =" << chi2Out;
-      mMatchedTracks.pop_back(); // destroy failed track
       return false;
     }
     prevrow = row;
@@ -1601,7 +1662,6 @@ bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS)
         prevsector = sector;
         if (!tracOut.rotate(o2::utils::Sector2Angle(sector % 18))) {
           LOG(WARNING) << "Rotation to sector " << int(sector % 18) << " failed";
-          mMatchedTracks.pop_back(); // destroy failed track
           return false;
         }
       }
@@ -1609,13 +1669,11 @@ bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS)
                                           10., o2::base::Propagator::USEMatCorrNONE, &trfit.getLTIntegralOut())) { // no material correction!
         LOG(INFO) << "Propagation to cluster " << icl << " (of " << tpcTrOrig.getNClusterReferences() << ") at X="
                   << clsX << " failed, Xtr=" << tracOut.getX() << " snp=" << tracOut.getSnp() << " pT=" << tracOut.getPt();
-        mMatchedTracks.pop_back(); // destroy failed track
         return false;
       }
       chi2Out += tracOut.getPredictedChi2(clsYZ, clsCov);
       if (!tracOut.update(clsYZ, clsCov)) {
         LOG(WARNING) << "Update failed at cluster " << icl << ", chi2 =" << chi2Out;
-        mMatchedTracks.pop_back(); // destroy failed track
         return false;
       }
     }
@@ -1633,11 +1691,6 @@ bool MatchTPCITS::refitTrackTPCITSloopTPC(int iTPC, int& iITS)
   trfit.setRefTPC(tTPC.sourceID);
   trfit.setRefITS(tITS.sourceID);
 
-  if (mMCTruthON) { // store MC info
-    mOutITSLabels.emplace_back(mITSLblWork[iITS]);
-    mOutTPCLabels.emplace_back(mTPCLblWork[iTPC]);
-  }
-
   //  trfit.print(); // DBG
 
   return true;
@@ -1744,9 +1797,17 @@ int MatchTPCITS::prepareTPCTracksAfterBurner()
 
   auto propagator = o2::base::Propagator::Instance();
 
-  for (int iTPC = 0; iTPC < (int)mTPCWork.size(); iTPC++) {
+  // the tracks are propagated concurrently in MT mode, each one modifying only its own entry
+  int nTPC = mTPCWork.size();
+  std::vector<char> selected(nTPC, 0);
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic, 64) num_threads(mNThreads)
+#endif
+  //>> start of MT region
+  for (int iTPC = 0; iTPC < nTPC; iTPC++) {
     auto& tTPC = mTPCWork[iTPC];
     if (isDisabledTPC(tTPC)) {
+      attachGeoNavigator();
       // Popagate to the vicinity of the out layer. Note: the Z of the track might be uncertain,
       // in this case the material corrections will be correct only in the limit of their uniformity in Z,
       // which should be good assumption....
@@ -1755,6 +1816,12 @@ int MatchTPCITS::prepareTPCTracksAfterBurner()
           !propagator->PropagateToXBxByBz(tTPC, xTgt, o2::constants::physics::MassPionCharged, MaxSnp, 2., mUseMatCorrFlag)) {
         continue;
       }
+      selected[iTPC] = 1;
+    }
+  }
+  //<< end of MT region
+  for (int iTPC = 0; iTPC < nTPC; iTPC++) {
+    if (selected[iTPC]) {
       mTPCABIndexCache.push_back(iTPC);
     }
   }
@@ -2616,6 +2683,29 @@ void MatchTPCITS::setITSROFrameLengthInBC(int nbc)
 
 //<<============================= AfterBurner for TPC-track / ITS cluster matching ===================<<
 
+//_________________________________________________________
+void MatchTPCITS::setNThreads(int n)
+{
+  ///< set number of threads for the candidates check, refit and afterburner
+#ifdef WITH_OPENMP
+  mNThreads = n > 0 ? n : omp_get_max_threads();
+#else
+  if (n != 1) {
+    LOG(WARNING) << "No OpenMP support, TPC-ITS matching will run in 1 thread instead of " << n;
+  }
+  mNThreads = 1;
+#endif
+}
+
+//_________________________________________________________
+void MatchTPCITS::attachGeoNavigator() const
+{
+  ///< in MT mode the TGeo material queries need a geometry navigator per thread, create it if needed
+  if (mUseMatCorrFlag == o2::base::Propagator::USEMatCorrTGeo && gGeoManager && gGeoManager->IsMultiThread() && !gGeoManager->GetCurrentNavigator()) {
+    gGeoManager->AddNavigator();
+  }
+}
+
 #ifdef _ALLOW_DEBUG_TREES_
 //______________________________________________
 void MatchTPCITS::setDebugFlag(UInt_t flag, bool on)
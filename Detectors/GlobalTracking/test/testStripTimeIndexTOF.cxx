@@ -0,0 +1,110 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test StripTimeIndexTOF
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "GlobalTracking/MatchTOF.h"
+#include "TOFBase/Geo.h"
+#include <TRandom.h>
+#include <algorithm>
+#include <vector>
+
+using namespace o2::globaltracking;
+using Geo = o2::tof::Geo;
+
+// the clusters of the strip within the time window, by brute force over the sector cache
+std::vector<int> findClusters(const std::vector<o2::tof::Cluster>& clusters, const std::vector<int>& cache, int strip, float tMin, float tMax)
+{
+  std::vector<int> res;
+  for (int itof = 0; itof < int(cache.size()); itof++) {
+    const auto& cl = clusters[cache[itof]];
+    if (cl.getPadInSector() / Geo::NPADS == strip && cl.getTime() >= tMin && cl.getTime() <= tMax) {
+      res.push_back(itof);
+    }
+  }
+  return res;
+}
+
+BOOST_AUTO_TEST_CASE(StripTimeIndexTOF_query)
+{
+  gRandom->SetSeed(1);
+  const int nClusters = 5000;
+  const double tMaxTF = 1e6; // ps
+  std::vector<o2::tof::Cluster> clusters(nClusters);
+  for (auto& cl : clusters) {
+    // few strips only, to have several clusters per strip, and some with the same time
+    cl.setPadInSector(Geo::NPADS * gRandom->Integer(10) + gRandom->Integer(Geo::NPADS));
+    cl.setTime(gRandom->Rndm() < 0.05 ? 5e5 : gRandom->Uniform(tMaxTF));
+  }
+  // the sector cache is ordered in time, like in the matching
+  std::vector<int> cache(nClusters);
+  for (int i = 0; i < nClusters; i++) {
+    cache[i] = i;
+  }
+  std::sort(cache.begin(), cache.end(), [&clusters](int a, int b) { return clusters[a].getTime() < clusters[b].getTime(); });
+
+  StripTimeIndexTOF index;
+  index.build(clusters, cache);
+
+  std::vector<StripTimeIndexTOF::Query> queries;
+  for (int iq = 0; iq < 1000; iq++) {
+    float tMin = gRandom->Uniform(-1e4, tMaxTF), tMax = tMin + gRandom->Uniform(5e4);
+    queries.push_back({int(gRandom->Integer(12)), tMin, tMax}); // also strips without clusters
+  }
+  queries.push_back({3, 5e5, 5e5});   // only the clusters with exactly this time
+  queries.push_back({3, 2e5, 1e5});   // empty window
+  queries.push_back({-1, 0, tMaxTF}); // invalid strips
+  queries.push_back({Geo::NSTRIPXSECTOR, 0, tMaxTF});
+
+  std::vector<StripTimeIndexTOF::ClusRange> ranges;
+  index.query(queries, ranges);
+  BOOST_REQUIRE_EQUAL(ranges.size(), queries.size());
+  for (size_t iq = 0; iq < queries.size(); iq++) {
+    const auto& q = queries[iq];
+    auto range = index.query(q.strip, q.tMin, q.tMax);
+    BOOST_CHECK_EQUAL(range.getFirstEntry(), ranges[iq].getFirstEntry());
+    BOOST_CHECK_EQUAL(range.getEntries(), ranges[iq].getEntries());
+
+    std::vector<int> found;
+    double tPrev = -1e9;
+    for (int entry = range.getFirstEntry(); entry < range.getFirstEntry() + range.getEntries(); entry++) {
+      int itof = index.getSectorCacheEntry(entry);
+      double t = clusters[cache[itof]].getTime();
+      BOOST_CHECK(t >= tPrev); // the clusters of the strip are ordered in time
+      tPrev = t;
+      found.push_back(itof);
+    }
+    std::sort(found.begin(), found.end());
+    BOOST_CHECK(found == findClusters(clusters, cache, q.strip, q.tMin, q.tMax));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(StripTimeIndexTOF_rebuild)
+{
+  // the index is rebuilt for each TF: nothing of the previous content must survive
+  std::vector<o2::tof::Cluster> clusters(2);
+  clusters[0].setPadInSector(Geo::NPADS * 7);
+  clusters[0].setTime(100.);
+  clusters[1].setPadInSector(Geo::NPADS * 7 + 1);
+  clusters[1].setTime(200.);
+  StripTimeIndexTOF index;
+  index.build(clusters, {0, 1});
+  BOOST_CHECK_EQUAL(index.query(7, 0., 1000.).getEntries(), 2);
+
+  index.build(clusters, {1});
+  auto range = index.query(7, 0., 1000.);
+  BOOST_CHECK_EQUAL(range.getEntries(), 1);
+  BOOST_CHECK_EQUAL(index.getSectorCacheEntry(range.getFirstEntry()), 0);
+
+  index.build(clusters, {});
+  BOOST_CHECK_EQUAL(index.query(7, 0., 1000.).getEntries(), 0);
+}
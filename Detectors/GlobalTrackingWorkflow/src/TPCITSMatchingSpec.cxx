@@ -58,6 +58,7 @@ void TPCITSMatchingDPL::init(InitContext& ic)
     mMatching.setITSROFrameLengthInBC(alpParams.roFrameLengthInBC); // ITS ROFrame duration in \mus
   }
   mMatching.setMCTruthOn(mUseMC);
+  mMatching.setNThreads(ic.options().get<int>("nthreads"));
   //
   std::string dictPath = ic.options().get<std::string>("its-dictionary-path");
   std::string dictFile = o2::base::NameConf::getDictionaryFileName(o2::detectors::DetID::ITS, dictPath, ".bin");
@@ -282,7 +283,9 @@ DataProcessorSpec getTPCITSMatchingSpec(bool useMC, const std::vector<int>& tpcC
     inputs,
     outputs,
     AlgorithmSpec{adaptFromTask<TPCITSMatchingDPL>(useMC)},
-    Options{{"its-dictionary-path", VariantType::String, "", {"Path of the cluster-topology dictionary file"}}}};
+    Options{
+      {"its-dictionary-path", VariantType::String, "", {"Path of the cluster-topology dictionary file"}},
+      {"nthreads", VariantType::Int, 1, {"Number of matching threads (<1: rely on openMP default)"}}}};
 }
 
 } // namespace globaltracking
@@ -55,6 +55,7 @@ class TOFDPLRecoWorkflowTask
     // nothing special to be set up
     o2::base::GeometryManager::loadGeometry();
     o2::base::Propagator::initFieldFromGRP("o2sim_grp.root");
+    mMatcher.setNThreads(ic.options().get<int>("nthreads"));
     mTimer.Stop();
     mTimer.Reset();
   }
@@ -159,7 +160,8 @@ o2::framework::DataProcessorSpec getTOFRecoWorkflowSpec(bool useMC, bool useFIT)
     inputs,
     outputs,
     AlgorithmSpec{adaptFromTask<TOFDPLRecoWorkflowTask>(useMC, useFIT)},
-    Options{/* for the moment no options */}};
+    Options{
+      {"nthreads", VariantType::Int, 1, {"Number of threads for the propagation of the tracks (<1: rely on openMP default)"}}}};
 }
 
 } // end namespace tof
@@ -62,6 +62,8 @@ struct TrackingParameters {
   /// Neighbour finding cuts
   float NeighbourMaxDeltaCurvature[constants::its::CellsPerRoad - 1] = {0.008f, 0.0025f, 0.003f, 0.0035f};
   float NeighbourMaxDeltaN[constants::its::CellsPerRoad - 1] = {0.002f, 0.0090f, 0.002f, 0.005f};
+  /// CPU tracklet finding on the structure-of-arrays copy of the clusters
+  bool UseClustersSoA = false;
 };
 
 struct MemoryParameters {
@@ -97,6 +99,7 @@ inline TrackingParameters& TrackingParameters::operator=(const TrackingParameter
     this->NeighbourMaxDeltaCurvature[iC] = t.NeighbourMaxDeltaCurvature[iC];
     this->NeighbourMaxDeltaN[iC] = t.NeighbourMaxDeltaN[iC];
   }
+  this->UseClustersSoA = t.UseClustersSoA;
   return *this;
 }
 
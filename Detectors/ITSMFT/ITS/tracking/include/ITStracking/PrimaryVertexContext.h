@@ -32,6 +32,19 @@ namespace o2
 namespace its
 {
 
+/// Coordinates of the clusters of a layer used in the tracklet finding, stored as structure of arrays
+/// in the order of the clusters (i.e. sorted in index table bins) to be scanned in vectorized loops
+struct ClustersSoA {
+  void clear();
+  void fill(const std::vector<Cluster>& clusters);
+  int size() const { return static_cast<int>(clusterId.size()); }
+
+  std::vector<float> zCoordinate;
+  std::vector<float> phiCoordinate;
+  std::vector<float> rCoordinate;
+  std::vector<int> clusterId;
+};
+
 class PrimaryVertexContext
 {
  public:
@@ -46,6 +59,7 @@ class PrimaryVertexContext
                           const std::array<float, 3>& pv, const int iteration);
   const float3& getPrimaryVertex() const;
   std::array<std::vector<Cluster>, constants::its::LayersNumber>& getClusters();
+  std::array<ClustersSoA, constants::its::LayersNumber>& getClustersSoA();
   std::array<std::vector<Cell>, constants::its::CellsPerRoad>& getCells();
   std::array<std::vector<int>, constants::its::CellsPerRoad - 1>& getCellsLookupTable();
   std::array<std::vector<std::vector<int>>, constants::its::CellsPerRoad - 1>& getCellsNeighbours();
@@ -69,6 +83,8 @@ class PrimaryVertexContext
   float3 mPrimaryVertex;
   std::array<std::vector<Cluster>, constants::its::LayersNumber> mUnsortedClusters;
   std::array<std::vector<Cluster>, constants::its::LayersNumber> mClusters;
+  std::array<ClustersSoA, constants::its::LayersNumber> mClustersSoA; /// filled on demand from mClusters
+  bool mClustersSoAFilled = false;
   std::array<std::vector<bool>, constants::its::LayersNumber> mUsedClusters;
   std::array<std::vector<Cell>, constants::its::CellsPerRoad> mCells;
   std::array<std::vector<int>, constants::its::CellsPerRoad - 1> mCellsLookupTable;
@@ -91,6 +107,17 @@ inline std::array<std::vector<Cluster>, constants::its::LayersNumber>& PrimaryVe
   return mClusters;
 }
 
+inline std::array<ClustersSoA, constants::its::LayersNumber>& PrimaryVertexContext::getClustersSoA()
+{
+  if (!mClustersSoAFilled) {
+    for (int iLayer{0}; iLayer < constants::its::LayersNumber; ++iLayer) {
+      mClustersSoA[iLayer].fill(mClusters[iLayer]);
+    }
+    mClustersSoAFilled = true;
+  }
+  return mClustersSoA;
+}
+
 inline std::array<std::vector<Cell>, constants::its::CellsPerRoad>& PrimaryVertexContext::getCells() { return mCells; }
 
 inline std::array<std::vector<int>, constants::its::CellsPerRoad - 1>& PrimaryVertexContext::getCellsLookupTable()
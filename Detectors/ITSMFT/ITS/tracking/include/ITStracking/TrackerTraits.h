@@ -64,9 +64,14 @@ class TrackerTraits
   void UpdateTrackingParameters(const TrackingParameters& trkPar);
   PrimaryVertexContext* getPrimaryVertexContext() { return mPrimaryVertexContext; }
 
+  /// number of threads for the tracklet and cell finding, used only by the CPU traits
+  void setNThreads(int n) { mNThreads = n > 0 ? n : 1; }
+  int getNThreads() const { return mNThreads; }
+
  protected:
   PrimaryVertexContext* mPrimaryVertexContext;
   TrackingParameters mTrkParams;
+  int mNThreads = 1;
 
   o2::gpu::GPUChainITS* mChain = nullptr;
   FuncRunITSTrackFit_t mChainRunITSTrackFit;
@@ -47,8 +47,18 @@ class TrackerTraitsCPU : public TrackerTraits
   void refitTracks(const std::array<std::vector<TrackingFrameInfo>, 7>& tf, std::vector<TrackITSExt>& tracks) final;
 
  protected:
-  std::vector<std::vector<Tracklet>> mTracklets;
-  std::vector<std::vector<Cell>> mCells;
+  void computeTrackletsInRange(int iLayer, int firstCluster, int lastCluster, std::vector<Tracklet>& tracklets);
+  void findTrackletsInRow(int iLayer, int iCluster, float tanLambda, int firstRowClusterIndex, int maxRowClusterIndex,
+                          std::vector<Tracklet>& tracklets, std::vector<unsigned char>& selected);
+  void computeCellsInRange(int iLayer, int firstTracklet, int lastTracklet, std::vector<Cell>& cells);
+  int getNChunks(int nItems) const;
+
+  /// work is split in chunks of consecutive clusters (tracklets), at least ChunksPerThread per thread
+  /// to balance the load, and the results of the chunks are merged in their order
+  static constexpr int ChunksPerThread = 4;
+
+  std::vector<std::vector<Tracklet>> mTracklets; /// tracklets found in each chunk of clusters
+  std::vector<std::vector<Cell>> mCells;         /// cells found in each chunk of tracklets
 };
 } // namespace its
 } // namespace o2
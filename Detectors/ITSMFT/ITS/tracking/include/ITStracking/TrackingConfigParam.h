@@ -36,6 +36,13 @@ struct VertexerParamConfig : public o2::conf::ConfigurableParamHelper<VertexerPa
   O2ParamDef(VertexerParamConfig, "ITSVertexerParam");
 };
 
+struct TrackerParamConfig : public o2::conf::ConfigurableParamHelper<TrackerParamConfig> {
+
+  bool useClustersSoA = false; // CPU tracklet finding on the structure-of-arrays copy of the clusters
+
+  O2ParamDef(TrackerParamConfig, "ITSCATrackerParam");
+};
+
 // VertexerParamConfig VertexerParamConfig::sInstance;
 } // namespace its
 } // namespace o2
@@ -36,6 +36,7 @@ void PrimaryVertexContext::initialise(const MemoryParameters& memParam, const st
 
   if (iteration == 0) {
 
+    mClustersSoAFilled = false;
     std::vector<ClusterHelper> cHelper;
 
     for (int iLayer{0}; iLayer < constants::its::LayersNumber; ++iLayer) {
@@ -145,5 +146,29 @@ void PrimaryVertexContext::initialise(const MemoryParameters& memParam, const st
   }
 }
 
+void ClustersSoA::clear()
+{
+  zCoordinate.clear();
+  phiCoordinate.clear();
+  rCoordinate.clear();
+  clusterId.clear();
+}
+
+void ClustersSoA::fill(const std::vector<Cluster>& clusters)
+{
+  clear();
+  const int clustersNum{static_cast<int>(clusters.size())};
+  zCoordinate.reserve(clustersNum);
+  phiCoordinate.reserve(clustersNum);
+  rCoordinate.reserve(clustersNum);
+  clusterId.reserve(clustersNum);
+  for (const Cluster& c : clusters) {
+    zCoordinate.push_back(c.zCoordinate);
+    phiCoordinate.push_back(c.phiCoordinate);
+    rCoordinate.push_back(c.rCoordinate);
+    clusterId.push_back(c.clusterId);
+  }
+}
+
 } // namespace its
 } // namespace o2
@@ -21,6 +21,7 @@
 #include "ITStracking/Tracklet.h"
 #include "ITStracking/TrackerTraits.h"
 #include "ITStracking/TrackerTraitsCPU.h"
+#include "ITStracking/TrackingConfigParam.h"
 
 #include "ReconstructionDataFormats/Track.h"
 #include <cassert>
@@ -46,6 +47,20 @@ Tracker::Tracker(o2::its::TrackerTraits* traits)
 
 Tracker::~Tracker() = default;
 
+void Tracker::getGlobalConfiguration()
+{
+  auto& tc = o2::its::TrackerParamConfig::Instance();
+
+  for (auto& trkPar : mTrkParams) {
+    trkPar.UseClustersSoA = tc.useClustersSoA;
+  }
+}
+
+void Tracker::setNThreads(int n)
+{
+  mTraits->setNThreads(n);
+}
+
 void Tracker::clustersToTracks(const ROframe& event, std::ostream& timeBenchmarkOutputStream)
 {
   const int verticesNum = event.getPrimaryVerticesNum();
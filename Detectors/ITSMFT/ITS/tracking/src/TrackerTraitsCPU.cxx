@@ -21,8 +21,11 @@
 #include "ITStracking/Tracklet.h"
 
 #include "ReconstructionDataFormats/Track.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <iostream>
+#include <thread>
 
 #include "GPUCommonMath.h"
 
@@ -31,82 +34,194 @@ namespace o2
 namespace its
 {
 
+namespace
+{
+/// first item of the chunk when splitting nItems in nChunks chunks of consecutive items
+inline int getChunkStart(int iChunk, int nChunks, int nItems)
+{
+  return static_cast<int>(static_cast<long>(iChunk) * nItems / nChunks);
+}
+
+/// process the chunks with nThreads threads: each thread picks the next chunk not yet taken as soon as it
+/// is done with the previous one, fn(iChunk, firstItem, lastItem) must only write the output of its chunk
+template <typename F>
+void processChunks(int nThreads, int nChunks, int nItems, F&& fn)
+{
+  std::atomic<int> nextChunk{0};
+  auto executor = [&]() {
+    for (int iChunk{nextChunk++}; iChunk < nChunks; iChunk = nextChunk++) {
+      fn(iChunk, getChunkStart(iChunk, nChunks, nItems), getChunkStart(iChunk + 1, nChunks, nItems));
+    }
+  };
+  std::vector<std::thread> executors;
+  for (int iThread{1}; iThread < std::min(nThreads, nChunks); ++iThread) {
+    executors.emplace_back(executor);
+  }
+  executor();
+  for (auto&& thread : executors) {
+    thread.join();
+  }
+}
+} // namespace
+
 void TrackerTraitsCPU::computeLayerTracklets()
 {
   PrimaryVertexContext* primaryVertexContext = mPrimaryVertexContext;
+  if (mTrkParams.UseClustersSoA) {
+    primaryVertexContext->getClustersSoA(); /// fill it before the threads start reading it
+  }
   for (int iLayer{0}; iLayer < constants::its::TrackletsPerRoad; ++iLayer) {
     if (primaryVertexContext->getClusters()[iLayer].empty() || primaryVertexContext->getClusters()[iLayer + 1].empty()) {
       return;
     }
 
-    const float3& primaryVertex = primaryVertexContext->getPrimaryVertex();
     const int currentLayerClustersNum{static_cast<int>(primaryVertexContext->getClusters()[iLayer].size())};
+    const int chunksNum{getNChunks(currentLayerClustersNum)};
+    std::vector<Tracklet>& layerTracklets{primaryVertexContext->getTracklets()[iLayer]};
 
-    for (int iCluster{0}; iCluster < currentLayerClustersNum; ++iCluster) {
-      const Cluster& currentCluster{primaryVertexContext->getClusters()[iLayer][iCluster]};
+    if (chunksNum == 1) {
+      computeTrackletsInRange(iLayer, 0, currentLayerClustersNum, layerTracklets);
+      continue;
+    }
 
-      if (primaryVertexContext->isClusterUsed(iLayer, currentCluster.clusterId)) {
-        continue;
+    mTracklets.resize(chunksNum);
+    processChunks(mNThreads, chunksNum, currentLayerClustersNum, [&](int iChunk, int firstCluster, int lastCluster) {
+      mTracklets[iChunk].clear();
+      computeTrackletsInRange(iLayer, firstCluster, lastCluster, mTracklets[iChunk]);
+    });
+
+    /// merge the chunks in the order of the clusters, shifting the lookup table to the merged tracklets
+    for (int iChunk{0}; iChunk < chunksNum; ++iChunk) {
+      const int offset{static_cast<int>(layerTracklets.size())};
+      if (iLayer > 0 && offset > 0) {
+        for (int iCluster{getChunkStart(iChunk, chunksNum, currentLayerClustersNum)};
+             iCluster < getChunkStart(iChunk + 1, chunksNum, currentLayerClustersNum); ++iCluster) {
+          int& firstTracklet{primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster]};
+          if (firstTracklet != constants::its::UnusedIndex) {
+            firstTracklet += offset;
+          }
+        }
       }
+      layerTracklets.insert(layerTracklets.end(), mTracklets[iChunk].begin(), mTracklets[iChunk].end());
+    }
+  }
+}
 
-      const float tanLambda{(currentCluster.zCoordinate - primaryVertex.z) / currentCluster.rCoordinate};
-      const float directionZIntersection{tanLambda * (constants::its::LayersRCoordinate()[iLayer + 1] -
-                                                      currentCluster.rCoordinate) +
-                                         currentCluster.zCoordinate};
+void TrackerTraitsCPU::computeTrackletsInRange(int iLayer, int firstCluster, int lastCluster, std::vector<Tracklet>& tracklets)
+{
+  PrimaryVertexContext* primaryVertexContext = mPrimaryVertexContext;
+  const float3& primaryVertex = primaryVertexContext->getPrimaryVertex();
+  std::vector<unsigned char> selected;
 
-      const int4 selectedBinsRect{getBinsRect(currentCluster, iLayer, directionZIntersection,
-                                              mTrkParams.TrackletMaxDeltaZ[iLayer], mTrkParams.TrackletMaxDeltaPhi)};
+  for (int iCluster{firstCluster}; iCluster < lastCluster; ++iCluster) {
+    const Cluster& currentCluster{primaryVertexContext->getClusters()[iLayer][iCluster]};
 
-      if (selectedBinsRect.x == 0 && selectedBinsRect.y == 0 && selectedBinsRect.z == 0 && selectedBinsRect.w == 0) {
-        continue;
-      }
+    if (primaryVertexContext->isClusterUsed(iLayer, currentCluster.clusterId)) {
+      continue;
+    }
 
-      int phiBinsNum{selectedBinsRect.w - selectedBinsRect.y + 1};
+    const float tanLambda{(currentCluster.zCoordinate - primaryVertex.z) / currentCluster.rCoordinate};
+    const float directionZIntersection{tanLambda * (constants::its::LayersRCoordinate()[iLayer + 1] -
+                                                    currentCluster.rCoordinate) +
+                                       currentCluster.zCoordinate};
 
-      if (phiBinsNum < 0) {
-        phiBinsNum += constants::index_table::PhiBins;
-      }
+    const int4 selectedBinsRect{getBinsRect(currentCluster, iLayer, directionZIntersection,
+                                            mTrkParams.TrackletMaxDeltaZ[iLayer], mTrkParams.TrackletMaxDeltaPhi)};
 
-      for (int iPhiBin{selectedBinsRect.y}, iPhiCount{0}; iPhiCount < phiBinsNum;
-           iPhiBin = ++iPhiBin == constants::index_table::PhiBins ? 0 : iPhiBin, iPhiCount++) {
-        const int firstBinIndex{index_table_utils::getBinIndex(selectedBinsRect.x, iPhiBin)};
-        const int maxBinIndex{firstBinIndex + selectedBinsRect.z - selectedBinsRect.x + 1};
-        const int firstRowClusterIndex = primaryVertexContext->getIndexTables()[iLayer][firstBinIndex];
-        const int maxRowClusterIndex = primaryVertexContext->getIndexTables()[iLayer][maxBinIndex];
+    if (selectedBinsRect.x == 0 && selectedBinsRect.y == 0 && selectedBinsRect.z == 0 && selectedBinsRect.w == 0) {
+      continue;
+    }
 
-        for (int iNextLayerCluster{firstRowClusterIndex}; iNextLayerCluster < maxRowClusterIndex;
-             ++iNextLayerCluster) {
+    int phiBinsNum{selectedBinsRect.w - selectedBinsRect.y + 1};
 
-          const Cluster& nextCluster{primaryVertexContext->getClusters()[iLayer + 1][iNextLayerCluster]};
+    if (phiBinsNum < 0) {
+      phiBinsNum += constants::index_table::PhiBins;
+    }
 
-          if (primaryVertexContext->isClusterUsed(iLayer + 1, nextCluster.clusterId)) {
-            continue;
-          }
+    for (int iPhiBin{selectedBinsRect.y}, iPhiCount{0}; iPhiCount < phiBinsNum;
+         iPhiBin = ++iPhiBin == constants::index_table::PhiBins ? 0 : iPhiBin, iPhiCount++) {
+      const int firstBinIndex{index_table_utils::getBinIndex(selectedBinsRect.x, iPhiBin)};
+      const int maxBinIndex{firstBinIndex + selectedBinsRect.z - selectedBinsRect.x + 1};
+      const int firstRowClusterIndex = primaryVertexContext->getIndexTables()[iLayer][firstBinIndex];
+      const int maxRowClusterIndex = primaryVertexContext->getIndexTables()[iLayer][maxBinIndex];
+
+      if (mTrkParams.UseClustersSoA) {
+        findTrackletsInRow(iLayer, iCluster, tanLambda, firstRowClusterIndex, maxRowClusterIndex, tracklets, selected);
+        continue;
+      }
+
+      for (int iNextLayerCluster{firstRowClusterIndex}; iNextLayerCluster < maxRowClusterIndex;
+           ++iNextLayerCluster) {
+
+        const Cluster& nextCluster{primaryVertexContext->getClusters()[iLayer + 1][iNextLayerCluster]};
 
-          const float deltaZ{gpu::GPUCommonMath::Abs(tanLambda * (nextCluster.rCoordinate - currentCluster.rCoordinate) +
-                                                     currentCluster.zCoordinate - nextCluster.zCoordinate)};
-          const float deltaPhi{gpu::GPUCommonMath::Abs(currentCluster.phiCoordinate - nextCluster.phiCoordinate)};
+        if (primaryVertexContext->isClusterUsed(iLayer + 1, nextCluster.clusterId)) {
+          continue;
+        }
 
-          if (deltaZ < mTrkParams.TrackletMaxDeltaZ[iLayer] &&
-              (deltaPhi < mTrkParams.TrackletMaxDeltaPhi ||
-               gpu::GPUCommonMath::Abs(deltaPhi - constants::math::TwoPi) < mTrkParams.TrackletMaxDeltaPhi)) {
+        const float deltaZ{gpu::GPUCommonMath::Abs(tanLambda * (nextCluster.rCoordinate - currentCluster.rCoordinate) +
+                                                   currentCluster.zCoordinate - nextCluster.zCoordinate)};
+        const float deltaPhi{gpu::GPUCommonMath::Abs(currentCluster.phiCoordinate - nextCluster.phiCoordinate)};
 
-            if (iLayer > 0 &&
-                primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] == constants::its::UnusedIndex) {
+        if (deltaZ < mTrkParams.TrackletMaxDeltaZ[iLayer] &&
+            (deltaPhi < mTrkParams.TrackletMaxDeltaPhi ||
+             gpu::GPUCommonMath::Abs(deltaPhi - constants::math::TwoPi) < mTrkParams.TrackletMaxDeltaPhi)) {
 
-              primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] =
-                primaryVertexContext->getTracklets()[iLayer].size();
-            }
+          if (iLayer > 0 &&
+              primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] == constants::its::UnusedIndex) {
 
-            primaryVertexContext->getTracklets()[iLayer].emplace_back(iCluster, iNextLayerCluster, currentCluster,
-                                                                      nextCluster);
+            primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] = tracklets.size();
           }
+
+          tracklets.emplace_back(iCluster, iNextLayerCluster, currentCluster, nextCluster);
         }
       }
     }
   }
 }
 
+void TrackerTraitsCPU::findTrackletsInRow(int iLayer, int iCluster, float tanLambda, int firstRowClusterIndex,
+                                          int maxRowClusterIndex, std::vector<Tracklet>& tracklets,
+                                          std::vector<unsigned char>& selected)
+{
+  PrimaryVertexContext* primaryVertexContext = mPrimaryVertexContext;
+  const Cluster& currentCluster{primaryVertexContext->getClusters()[iLayer][iCluster]};
+  const ClustersSoA& nextLayerClusters{primaryVertexContext->getClustersSoA()[iLayer + 1]};
+  const int rowClustersNum{maxRowClusterIndex - firstRowClusterIndex};
+  if (rowClustersNum <= 0) {
+    return;
+  }
+
+  /// window test on all the clusters of the row, without branches to let the compiler vectorize it
+  selected.resize(rowClustersNum);
+  const float* zCoordinate{nextLayerClusters.zCoordinate.data() + firstRowClusterIndex};
+  const float* phiCoordinate{nextLayerClusters.phiCoordinate.data() + firstRowClusterIndex};
+  const float* rCoordinate{nextLayerClusters.rCoordinate.data() + firstRowClusterIndex};
+  const float maxDeltaZ{mTrkParams.TrackletMaxDeltaZ[iLayer]};
+  const float maxDeltaPhi{mTrkParams.TrackletMaxDeltaPhi};
+  for (int iRow{0}; iRow < rowClustersNum; ++iRow) {
+    const float deltaZ{std::abs(tanLambda * (rCoordinate[iRow] - currentCluster.rCoordinate) +
+                                currentCluster.zCoordinate - zCoordinate[iRow])};
+    const float deltaPhi{std::abs(currentCluster.phiCoordinate - phiCoordinate[iRow])};
+    selected[iRow] = (deltaZ < maxDeltaZ) & ((deltaPhi < maxDeltaPhi) | (std::abs(deltaPhi - constants::math::TwoPi) < maxDeltaPhi));
+  }
+
+  for (int iRow{0}; iRow < rowClustersNum; ++iRow) {
+    const int iNextLayerCluster{firstRowClusterIndex + iRow};
+    if (!selected[iRow] || primaryVertexContext->isClusterUsed(iLayer + 1, nextLayerClusters.clusterId[iNextLayerCluster])) {
+      continue;
+    }
+    if (iLayer > 0 &&
+        primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] == constants::its::UnusedIndex) {
+
+      primaryVertexContext->getTrackletsLookupTable()[iLayer - 1][iCluster] = tracklets.size();
+    }
+
+    tracklets.emplace_back(iCluster, iNextLayerCluster, currentCluster,
+                           primaryVertexContext->getClusters()[iLayer + 1][iNextLayerCluster]);
+  }
+}
+
 void TrackerTraitsCPU::computeLayerCells()
 {
   PrimaryVertexContext* primaryVertexContext = mPrimaryVertexContext;
@@ -118,116 +233,153 @@ void TrackerTraitsCPU::computeLayerCells()
       return;
     }
 
-    const float3& primaryVertex = primaryVertexContext->getPrimaryVertex();
     const int currentLayerTrackletsNum{static_cast<int>(primaryVertexContext->getTracklets()[iLayer].size())};
+    const int chunksNum{getNChunks(currentLayerTrackletsNum)};
+    std::vector<Cell>& layerCells{primaryVertexContext->getCells()[iLayer]};
+
+    if (chunksNum == 1) {
+      computeCellsInRange(iLayer, 0, currentLayerTrackletsNum, layerCells);
+      continue;
+    }
+
+    mCells.resize(chunksNum);
+    processChunks(mNThreads, chunksNum, currentLayerTrackletsNum, [&](int iChunk, int firstTracklet, int lastTracklet) {
+      mCells[iChunk].clear();
+      computeCellsInRange(iLayer, firstTracklet, lastTracklet, mCells[iChunk]);
+    });
+
+    /// merge the chunks in the order of the tracklets, shifting the lookup table to the merged cells
+    for (int iChunk{0}; iChunk < chunksNum; ++iChunk) {
+      const int offset{static_cast<int>(layerCells.size())};
+      if (iLayer > 0 && offset > 0) {
+        for (int iTracklet{getChunkStart(iChunk, chunksNum, currentLayerTrackletsNum)};
+             iTracklet < getChunkStart(iChunk + 1, chunksNum, currentLayerTrackletsNum); ++iTracklet) {
+          int& firstCell{primaryVertexContext->getCellsLookupTable()[iLayer - 1][iTracklet]};
+          if (firstCell != constants::its::UnusedIndex) {
+            firstCell += offset;
+          }
+        }
+      }
+      layerCells.insert(layerCells.end(), mCells[iChunk].begin(), mCells[iChunk].end());
+    }
+  }
+}
 
-    for (int iTracklet{0}; iTracklet < currentLayerTrackletsNum; ++iTracklet) {
+void TrackerTraitsCPU::computeCellsInRange(int iLayer, int firstTracklet, int lastTracklet, std::vector<Cell>& cells)
+{
+  PrimaryVertexContext* primaryVertexContext = mPrimaryVertexContext;
+  const float3& primaryVertex = primaryVertexContext->getPrimaryVertex();
 
-      const Tracklet& currentTracklet{primaryVertexContext->getTracklets()[iLayer][iTracklet]};
-      const int nextLayerClusterIndex{currentTracklet.secondClusterIndex};
-      const int nextLayerFirstTrackletIndex{
-        primaryVertexContext->getTrackletsLookupTable()[iLayer][nextLayerClusterIndex]};
+  for (int iTracklet{firstTracklet}; iTracklet < lastTracklet; ++iTracklet) {
 
-      if (nextLayerFirstTrackletIndex == constants::its::UnusedIndex) {
+    const Tracklet& currentTracklet{primaryVertexContext->getTracklets()[iLayer][iTracklet]};
+    const int nextLayerClusterIndex{currentTracklet.secondClusterIndex};
+    const int nextLayerFirstTrackletIndex{
+      primaryVertexContext->getTrackletsLookupTable()[iLayer][nextLayerClusterIndex]};
 
-        continue;
-      }
+    if (nextLayerFirstTrackletIndex == constants::its::UnusedIndex) {
+
+      continue;
+    }
+
+    const Cluster& firstCellCluster{primaryVertexContext->getClusters()[iLayer][currentTracklet.firstClusterIndex]};
+    const Cluster& secondCellCluster{
+      primaryVertexContext->getClusters()[iLayer + 1][currentTracklet.secondClusterIndex]};
+    const float firstCellClusterQuadraticRCoordinate{firstCellCluster.rCoordinate * firstCellCluster.rCoordinate};
+    const float secondCellClusterQuadraticRCoordinate{secondCellCluster.rCoordinate *
+                                                      secondCellCluster.rCoordinate};
+    const float3 firstDeltaVector{secondCellCluster.xCoordinate - firstCellCluster.xCoordinate,
+                                  secondCellCluster.yCoordinate - firstCellCluster.yCoordinate,
+                                  secondCellClusterQuadraticRCoordinate - firstCellClusterQuadraticRCoordinate};
+    const int nextLayerTrackletsNum{static_cast<int>(primaryVertexContext->getTracklets()[iLayer + 1].size())};
+
+    for (int iNextLayerTracklet{nextLayerFirstTrackletIndex};
+         iNextLayerTracklet < nextLayerTrackletsNum &&
+         primaryVertexContext->getTracklets()[iLayer + 1][iNextLayerTracklet].firstClusterIndex ==
+           nextLayerClusterIndex;
+         ++iNextLayerTracklet) {
+
+      const Tracklet& nextTracklet{primaryVertexContext->getTracklets()[iLayer + 1][iNextLayerTracklet]};
+      const float deltaTanLambda{std::abs(currentTracklet.tanLambda - nextTracklet.tanLambda)};
+      const float deltaPhi{std::abs(currentTracklet.phiCoordinate - nextTracklet.phiCoordinate)};
 
-      const Cluster& firstCellCluster{primaryVertexContext->getClusters()[iLayer][currentTracklet.firstClusterIndex]};
-      const Cluster& secondCellCluster{
-        primaryVertexContext->getClusters()[iLayer + 1][currentTracklet.secondClusterIndex]};
-      const float firstCellClusterQuadraticRCoordinate{firstCellCluster.rCoordinate * firstCellCluster.rCoordinate};
-      const float secondCellClusterQuadraticRCoordinate{secondCellCluster.rCoordinate *
-                                                        secondCellCluster.rCoordinate};
-      const float3 firstDeltaVector{secondCellCluster.xCoordinate - firstCellCluster.xCoordinate,
-                                    secondCellCluster.yCoordinate - firstCellCluster.yCoordinate,
-                                    secondCellClusterQuadraticRCoordinate - firstCellClusterQuadraticRCoordinate};
-      const int nextLayerTrackletsNum{static_cast<int>(primaryVertexContext->getTracklets()[iLayer + 1].size())};
-
-      for (int iNextLayerTracklet{nextLayerFirstTrackletIndex};
-           iNextLayerTracklet < nextLayerTrackletsNum &&
-           primaryVertexContext->getTracklets()[iLayer + 1][iNextLayerTracklet].firstClusterIndex ==
-             nextLayerClusterIndex;
-           ++iNextLayerTracklet) {
-
-        const Tracklet& nextTracklet{primaryVertexContext->getTracklets()[iLayer + 1][iNextLayerTracklet]};
-        const float deltaTanLambda{std::abs(currentTracklet.tanLambda - nextTracklet.tanLambda)};
-        const float deltaPhi{std::abs(currentTracklet.phiCoordinate - nextTracklet.phiCoordinate)};
-
-        if (deltaTanLambda < mTrkParams.CellMaxDeltaTanLambda &&
-            (deltaPhi < mTrkParams.CellMaxDeltaPhi ||
-             std::abs(deltaPhi - constants::math::TwoPi) < mTrkParams.CellMaxDeltaPhi)) {
-
-          const float averageTanLambda{0.5f * (currentTracklet.tanLambda + nextTracklet.tanLambda)};
-          const float directionZIntersection{-averageTanLambda * firstCellCluster.rCoordinate +
-                                             firstCellCluster.zCoordinate};
-          const float deltaZ{std::abs(directionZIntersection - primaryVertex.z)};
-
-          if (deltaZ < mTrkParams.CellMaxDeltaZ[iLayer]) {
-
-            const Cluster& thirdCellCluster{
-              primaryVertexContext->getClusters()[iLayer + 2][nextTracklet.secondClusterIndex]};
-
-            const float thirdCellClusterQuadraticRCoordinate{thirdCellCluster.rCoordinate *
-                                                             thirdCellCluster.rCoordinate};
-
-            const float3 secondDeltaVector{thirdCellCluster.xCoordinate - firstCellCluster.xCoordinate,
-                                           thirdCellCluster.yCoordinate - firstCellCluster.yCoordinate,
-                                           thirdCellClusterQuadraticRCoordinate -
-                                             firstCellClusterQuadraticRCoordinate};
-
-            float3 cellPlaneNormalVector{math_utils::crossProduct(firstDeltaVector, secondDeltaVector)};
-
-            const float vectorNorm{std::sqrt(cellPlaneNormalVector.x * cellPlaneNormalVector.x +
-                                             cellPlaneNormalVector.y * cellPlaneNormalVector.y +
-                                             cellPlaneNormalVector.z * cellPlaneNormalVector.z)};
-
-            if (vectorNorm < constants::math::FloatMinThreshold ||
-                std::abs(cellPlaneNormalVector.z) < constants::math::FloatMinThreshold) {
-
-              continue;
-            }
-
-            const float inverseVectorNorm{1.0f / vectorNorm};
-            const float3 normalizedPlaneVector{cellPlaneNormalVector.x * inverseVectorNorm,
-                                               cellPlaneNormalVector.y * inverseVectorNorm,
-                                               cellPlaneNormalVector.z * inverseVectorNorm};
-            const float planeDistance{-normalizedPlaneVector.x * (secondCellCluster.xCoordinate - primaryVertex.x) -
-                                      (normalizedPlaneVector.y * secondCellCluster.yCoordinate - primaryVertex.y) -
-                                      normalizedPlaneVector.z * secondCellClusterQuadraticRCoordinate};
-            const float normalizedPlaneVectorQuadraticZCoordinate{normalizedPlaneVector.z * normalizedPlaneVector.z};
-            const float cellTrajectoryRadius{std::sqrt(
-              (1.0f - normalizedPlaneVectorQuadraticZCoordinate - 4.0f * planeDistance * normalizedPlaneVector.z) /
-              (4.0f * normalizedPlaneVectorQuadraticZCoordinate))};
-            const float2 circleCenter{-0.5f * normalizedPlaneVector.x / normalizedPlaneVector.z,
-                                      -0.5f * normalizedPlaneVector.y / normalizedPlaneVector.z};
-            const float distanceOfClosestApproach{std::abs(
-              cellTrajectoryRadius - std::sqrt(circleCenter.x * circleCenter.x + circleCenter.y * circleCenter.y))};
-
-            if (distanceOfClosestApproach >
-                mTrkParams.CellMaxDCA[iLayer]) {
-
-              continue;
-            }
-
-            const float cellTrajectoryCurvature{1.0f / cellTrajectoryRadius};
-            if (iLayer > 0 &&
-                primaryVertexContext->getCellsLookupTable()[iLayer - 1][iTracklet] == constants::its::UnusedIndex) {
-
-              primaryVertexContext->getCellsLookupTable()[iLayer - 1][iTracklet] =
-                primaryVertexContext->getCells()[iLayer].size();
-            }
-
-            primaryVertexContext->getCells()[iLayer].emplace_back(
-              currentTracklet.firstClusterIndex, nextTracklet.firstClusterIndex, nextTracklet.secondClusterIndex,
-              iTracklet, iNextLayerTracklet, normalizedPlaneVector, cellTrajectoryCurvature);
+      if (deltaTanLambda < mTrkParams.CellMaxDeltaTanLambda &&
+          (deltaPhi < mTrkParams.CellMaxDeltaPhi ||
+           std::abs(deltaPhi - constants::math::TwoPi) < mTrkParams.CellMaxDeltaPhi)) {
+
+        const float averageTanLambda{0.5f * (currentTracklet.tanLambda + nextTracklet.tanLambda)};
+        const float directionZIntersection{-averageTanLambda * firstCellCluster.rCoordinate +
+                                           firstCellCluster.zCoordinate};
+        const float deltaZ{std::abs(directionZIntersection - primaryVertex.z)};
+
+        if (deltaZ < mTrkParams.CellMaxDeltaZ[iLayer]) {
+
+          const Cluster& thirdCellCluster{
+            primaryVertexContext->getClusters()[iLayer + 2][nextTracklet.secondClusterIndex]};
+
+          const float thirdCellClusterQuadraticRCoordinate{thirdCellCluster.rCoordinate *
+                                                           thirdCellCluster.rCoordinate};
+
+          const float3 secondDeltaVector{thirdCellCluster.xCoordinate - firstCellCluster.xCoordinate,
+                                         thirdCellCluster.yCoordinate - firstCellCluster.yCoordinate,
+                                         thirdCellClusterQuadraticRCoordinate -
+                                           firstCellClusterQuadraticRCoordinate};
+
+          float3 cellPlaneNormalVector{math_utils::crossProduct(firstDeltaVector, secondDeltaVector)};
+
+          const float vectorNorm{std::sqrt(cellPlaneNormalVector.x * cellPlaneNormalVector.x +
+                                           cellPlaneNormalVector.y * cellPlaneNormalVector.y +
+                                           cellPlaneNormalVector.z * cellPlaneNormalVector.z)};
+
+          if (vectorNorm < constants::math::FloatMinThreshold ||
+              std::abs(cellPlaneNormalVector.z) < constants::math::FloatMinThreshold) {
+
+            continue;
           }
+
+          const float inverseVectorNorm{1.0f / vectorNorm};
+          const float3 normalizedPlaneVector{cellPlaneNormalVector.x * inverseVectorNorm,
+                                             cellPlaneNormalVector.y * inverseVectorNorm,
+                                             cellPlaneNormalVector.z * inverseVectorNorm};
+          const float planeDistance{-normalizedPlaneVector.x * (secondCellCluster.xCoordinate - primaryVertex.x) -
+                                    (normalizedPlaneVector.y * secondCellCluster.yCoordinate - primaryVertex.y) -
+                                    normalizedPlaneVector.z * secondCellClusterQuadraticRCoordinate};
+          const float normalizedPlaneVectorQuadraticZCoordinate{normalizedPlaneVector.z * normalizedPlaneVector.z};
+          const float cellTrajectoryRadius{std::sqrt(
+            (1.0f - normalizedPlaneVectorQuadraticZCoordinate - 4.0f * planeDistance * normalizedPlaneVector.z) /
+            (4.0f * normalizedPlaneVectorQuadraticZCoordinate))};
+          const float2 circleCenter{-0.5f * normalizedPlaneVector.x / normalizedPlaneVector.z,
+                                    -0.5f * normalizedPlaneVector.y / normalizedPlaneVector.z};
+          const float distanceOfClosestApproach{std::abs(
+            cellTrajectoryRadius - std::sqrt(circleCenter.x * circleCenter.x + circleCenter.y * circleCenter.y))};
+
+          if (distanceOfClosestApproach >
+              mTrkParams.CellMaxDCA[iLayer]) {
+
+            continue;
+          }
+
+          const float cellTrajectoryCurvature{1.0f / cellTrajectoryRadius};
+          if (iLayer > 0 &&
+              primaryVertexContext->getCellsLookupTable()[iLayer - 1][iTracklet] == constants::its::UnusedIndex) {
+
+            primaryVertexContext->getCellsLookupTable()[iLayer - 1][iTracklet] = cells.size();
+          }
+
+          cells.emplace_back(
+            currentTracklet.firstClusterIndex, nextTracklet.firstClusterIndex, nextTracklet.secondClusterIndex,
+            iTracklet, iNextLayerTracklet, normalizedPlaneVector, cellTrajectoryCurvature);
         }
       }
     }
   }
 }
 
+int TrackerTraitsCPU::getNChunks(int nItems) const
+{
+  return mNThreads > 1 ? std::max(1, std::min(nItems, ChunksPerThread * mNThreads)) : 1;
+}
+
 void TrackerTraitsCPU::refitTracks(const std::array<std::vector<TrackingFrameInfo>, 7>& tf, std::vector<TrackITSExt>& tracks)
 {
   std::array<const Cell*, 5> cells;
@@ -20,5 +20,7 @@
 
 #pragma link C++ class o2::its::VertexerParamConfig + ;
 #pragma link C++ class o2::conf::ConfigurableParamHelper <o2::its::VertexerParamConfig> + ;
+#pragma link C++ class o2::its::TrackerParamConfig + ;
+#pragma link C++ class o2::conf::ConfigurableParamHelper <o2::its::TrackerParamConfig> + ;
 
 #endif
@@ -0,0 +1,110 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test ITS ClustersSoA
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ITStracking/Cluster.h"
+#include "ITStracking/Configuration.h"
+#include "ITStracking/Constants.h"
+#include "ITStracking/TrackerTraitsCPU.h"
+#include <TRandom.h>
+#include <array>
+#include <cmath>
+#include <vector>
+
+using namespace o2::its;
+
+using Clusters = std::array<std::vector<Cluster>, constants::its::LayersNumber>;
+
+struct TrackletsAndCells {
+  std::array<std::vector<Tracklet>, constants::its::TrackletsPerRoad> tracklets;
+  std::array<std::vector<int>, constants::its::CellsPerRoad> trackletsLookupTable;
+  std::array<std::vector<Cell>, constants::its::CellsPerRoad> cells;
+};
+
+// straight tracks from the vertex crossing all the layers, on top of uniformly distributed clusters
+Clusters generateClusters()
+{
+  gRandom->SetSeed(1);
+  Clusters clusters;
+  constexpr auto layersR = constants::its::LayersRCoordinate();
+  constexpr auto layersZ = constants::its::LayersZCoordinate();
+  for (int iTrack = 0; iTrack < 500; iTrack++) {
+    float phi = gRandom->Uniform(0., constants::math::TwoPi), tanLambda = gRandom->Uniform(-0.8, 0.8);
+    for (int iLayer = 0; iLayer < constants::its::LayersNumber; iLayer++) {
+      float r = layersR[iLayer], z = r * tanLambda;
+      if (std::abs(z) < layersZ[iLayer]) {
+        float dPhi = gRandom->Gaus(0., 1e-3);
+        clusters[iLayer].emplace_back(r * std::cos(phi + dPhi), r * std::sin(phi + dPhi), z + gRandom->Gaus(0., 5e-3), clusters[iLayer].size());
+      }
+    }
+  }
+  for (int iLayer = 0; iLayer < constants::its::LayersNumber; iLayer++) {
+    for (int iCluster = 0; iCluster < 2000; iCluster++) {
+      float phi = gRandom->Uniform(0., constants::math::TwoPi), r = layersR[iLayer];
+      clusters[iLayer].emplace_back(r * std::cos(phi), r * std::sin(phi), gRandom->Uniform(-layersZ[iLayer], layersZ[iLayer]), clusters[iLayer].size());
+    }
+  }
+  return clusters;
+}
+
+void findTrackletsAndCells(const Clusters& clusters, bool useClustersSoA, int nThreads, TrackletsAndCells& res)
+{
+  TrackerTraitsCPU traits;
+  TrackingParameters trkParams;
+  trkParams.UseClustersSoA = useClustersSoA;
+  traits.UpdateTrackingParameters(trkParams);
+  traits.setNThreads(nThreads);
+  auto context = traits.getPrimaryVertexContext();
+  context->initialise(MemoryParameters{}, clusters, {0.f, 0.f, 0.f}, 0);
+  traits.computeLayerTracklets();
+  traits.computeLayerCells();
+  res.tracklets = context->getTracklets();
+  res.trackletsLookupTable = context->getTrackletsLookupTable();
+  res.cells = context->getCells();
+}
+
+BOOST_AUTO_TEST_CASE(ClustersSoA_equivalence)
+{
+  auto clusters = generateClusters();
+  TrackletsAndCells ref;
+  findTrackletsAndCells(clusters, false, 1, ref);
+  BOOST_REQUIRE(!ref.tracklets[0].empty());
+  BOOST_REQUIRE(!ref.cells[0].empty());
+
+  for (int nThreads : {1, 3}) {
+    TrackletsAndCells res;
+    findTrackletsAndCells(clusters, true, nThreads, res);
+    for (int iLayer = 0; iLayer < constants::its::TrackletsPerRoad; iLayer++) {
+      BOOST_REQUIRE_EQUAL(res.tracklets[iLayer].size(), ref.tracklets[iLayer].size());
+      for (size_t i = 0; i < ref.tracklets[iLayer].size(); i++) {
+        const auto &t = res.tracklets[iLayer][i], &tref = ref.tracklets[iLayer][i];
+        BOOST_CHECK_EQUAL(t.firstClusterIndex, tref.firstClusterIndex);
+        BOOST_CHECK_EQUAL(t.secondClusterIndex, tref.secondClusterIndex);
+        BOOST_CHECK_EQUAL(t.tanLambda, tref.tanLambda);
+        BOOST_CHECK_EQUAL(t.phiCoordinate, tref.phiCoordinate);
+      }
+    }
+    for (int iLayer = 0; iLayer < constants::its::CellsPerRoad; iLayer++) {
+      BOOST_CHECK(res.trackletsLookupTable[iLayer] == ref.trackletsLookupTable[iLayer]);
+      BOOST_REQUIRE_EQUAL(res.cells[iLayer].size(), ref.cells[iLayer].size());
+      for (size_t i = 0; i < ref.cells[iLayer].size(); i++) {
+        const auto &c = res.cells[iLayer][i], &cref = ref.cells[iLayer][i];
+        BOOST_CHECK_EQUAL(c.getFirstClusterIndex(), cref.getFirstClusterIndex());
+        BOOST_CHECK_EQUAL(c.getSecondClusterIndex(), cref.getSecondClusterIndex());
+        BOOST_CHECK_EQUAL(c.getThirdClusterIndex(), cref.getThirdClusterIndex());
+        BOOST_CHECK_EQUAL(c.getFirstTrackletIndex(), cref.getFirstTrackletIndex());
+        BOOST_CHECK_EQUAL(c.getSecondTrackletIndex(), cref.getSecondTrackletIndex());
+      }
+    }
+  }
+}
@@ -70,9 +70,11 @@ void TrackerDPL::init(InitContext& ic)
     mVertexer = std::make_unique<Vertexer>(chainITS->GetITSVertexerTraits());
     mTracker = std::make_unique<Tracker>(chainITS->GetITSTrackerTraits());
     mVertexer->getGlobalConfiguration();
+    mTracker->getGlobalConfiguration();
     // mVertexer->dumpTraits();
     double origD[3] = {0., 0., 0.};
     mTracker->setBz(field->getBz(origD));
+    mTracker->setNThreads(ic.options().get<int>("nthreads"));
   } else {
     throw std::runtime_error(o2::utils::concat_string("Cannot retrieve GRP from the ", filename));
   }
@@ -263,7 +265,8 @@ DataProcessorSpec getTrackerSpec(bool useMC, o2::gpu::GPUDataTypes::DeviceType d
     AlgorithmSpec{adaptFromTask<TrackerDPL>(useMC, dType)},
     Options{
       {"grp-file", VariantType::String, "o2sim_grp.root", {"Name of the grp file"}},
-      {"its-dictionary-path", VariantType::String, "", {"Path of the cluster-topology dictionary file"}}}};
+      {"its-dictionary-path", VariantType::String, "", {"Path of the cluster-topology dictionary file"}},
+      {"nthreads", VariantType::Int, 1, {"Number of threads for the tracklet and cell finding"}}}};
 }
 
 } // namespace its
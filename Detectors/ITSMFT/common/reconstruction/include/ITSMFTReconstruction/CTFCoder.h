@@ -22,6 +22,7 @@
 #include "DataFormatsITSMFT/ROFRecord.h"
 #include "DataFormatsITSMFT/CompCluster.h"
 #include "DetectorsCommonDataFormats/DetID.h"
+#include "DetectorsCommonDataFormats/EncodedBlocksParam.h"
 #include "rANS/rans.h"
 
 class TTree;
@@ -34,13 +35,14 @@ namespace itsmft
 class CTFCoder
 {
  public:
-  /// entropy-encode clusters to buffer with CTF
+  /// entropy-encode clusters to buffer with CTF, using the external dictionary if provided
   template <typename VEC>
-  static void encode(VEC& buff, const gsl::span<const ROFRecord>& rofRecVec, const gsl::span<const CompClusterExt>& cclusVec, const gsl::span<const unsigned char>& pattVec);
+  static void encode(VEC& buff, const gsl::span<const ROFRecord>& rofRecVec, const gsl::span<const CompClusterExt>& cclusVec, const gsl::span<const unsigned char>& pattVec,
+                     const o2::ctf::CTFDictionary* dict = nullptr);
 
-  /// entropy decode clusters from buffer with CTF
+  /// entropy decode clusters from buffer with CTF, the external dictionary must be provided if it was used for encoding
   template <typename VROF, typename VCLUS, typename VPAT>
-  static void decode(const CTF::base& ec, VROF& rofRecVec, VCLUS& cclusVec, VPAT& pattVec);
+  static void decode(const CTF::base& ec, VROF& rofRecVec, VCLUS& cclusVec, VPAT& pattVec, const o2::ctf::CTFDictionary* dict = nullptr);
 
  private:
   /// compres compact clusters to CompressedClusters
@@ -59,7 +61,8 @@ class CTFCoder
 
 /// entropy-encode clusters to buffer with CTF
 template <typename VEC>
-void CTFCoder::encode(VEC& buff, const gsl::span<const ROFRecord>& rofRecVec, const gsl::span<const CompClusterExt>& cclusVec, const gsl::span<const unsigned char>& pattVec)
+void CTFCoder::encode(VEC& buff, const gsl::span<const ROFRecord>& rofRecVec, const gsl::span<const CompClusterExt>& cclusVec, const gsl::span<const unsigned char>& pattVec,
+                      const o2::ctf::CTFDictionary* dict)
 {
   using MD = o2::ctf::Metadata::OptStore;
   // what to do which each field: see o2::ctd::Metadata explanation
@@ -83,41 +86,43 @@ void CTFCoder::encode(VEC& buff, const gsl::span<const ROFRecord>& rofRecVec, co
   ec->setHeader(cc.header);
   ec->getANSHeader().majorVersion = 0;
   ec->getANSHeader().minorVersion = 1;
+  const auto& ebParam = o2::ctf::EncodedBlocksParam::Instance(); // chunking and threading of the entropy coding
   // at every encoding the buffer might be autoexpanded, so we don't work with fixed pointer ec
 #define ENCODE CTF::get(buff.data())->encode
   // clang-format off
-  ENCODE(cc.firstChipROF, CTF::BLCfirstChipROF, o2::rans::ProbabilityBits16Bit, optField[CTF::BLCfirstChipROF], &buff);
-  ENCODE(cc.bcIncROF,     CTF::BLCbcIncROF ,    o2::rans::ProbabilityBits16Bit, optField[CTF::BLCbcIncROF],     &buff);
-  ENCODE(cc.orbitIncROF,  CTF::BLCorbitIncROF,  o2::rans::ProbabilityBits16Bit, optField[CTF::BLCorbitIncROF],  &buff);
-  ENCODE(cc.nclusROF,     CTF::BLCnclusROF,     o2::rans::ProbabilityBits16Bit, optField[CTF::BLCnclusROF],     &buff);
+  ENCODE(cc.firstChipROF, CTF::BLCfirstChipROF, o2::rans::ProbabilityBits16Bit, optField[CTF::BLCfirstChipROF], &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(cc.bcIncROF,     CTF::BLCbcIncROF ,    o2::rans::ProbabilityBits16Bit, optField[CTF::BLCbcIncROF],     &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(cc.orbitIncROF,  CTF::BLCorbitIncROF,  o2::rans::ProbabilityBits16Bit, optField[CTF::BLCorbitIncROF],  &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(cc.nclusROF,     CTF::BLCnclusROF,     o2::rans::ProbabilityBits16Bit, optField[CTF::BLCnclusROF],     &buff, dict, ebParam.chunkSize, ebParam.nThreads);
   //
-  ENCODE(cc.chipInc,      CTF::BLCchipInc,      o2::rans::ProbabilityBits16Bit, optField[CTF::BLCchipInc], &buff);
-  ENCODE(cc.chipMul,      CTF::BLCchipMul,      o2::rans::ProbabilityBits16Bit, optField[CTF::BLCchipMul], &buff);
-  ENCODE(cc.row,          CTF::BLCrow,          o2::rans::ProbabilityBits16Bit, optField[CTF::BLCrow],     &buff);
-  ENCODE(cc.colInc,       CTF::BLCcolInc,       o2::rans::ProbabilityBits16Bit, optField[CTF::BLCcolInc],  &buff);
-  ENCODE(cc.pattID,       CTF::BLCpattID,       o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpattID],  &buff);
-  ENCODE(cc.pattMap,      CTF::BLCpattMap,      o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpattMap], &buff);
+  ENCODE(cc.chipInc,      CTF::BLCchipInc,      o2::rans::ProbabilityBits16Bit, optField[CTF::BLCchipInc], &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(cc.chipMul,      CTF::BLCchipMul,      o2::rans::ProbabilityBits16Bit, optField[CTF::BLCchipMul], &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(cc.row,          CTF::BLCrow,          o2::rans::ProbabilityBits16Bit, optField[CTF::BLCrow],     &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(cc.colInc,       CTF::BLCcolInc,       o2::rans::ProbabilityBits16Bit, optField[CTF::BLCcolInc],  &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(cc.pattID,       CTF::BLCpattID,       o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpattID],  &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(cc.pattMap,      CTF::BLCpattMap,      o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpattMap], &buff, dict, ebParam.chunkSize, ebParam.nThreads);
   // clang-format on
 }
 
 /// decode entropy-encoded clusters to standard compact clusters
 template <typename VROF, typename VCLUS, typename VPAT>
-void CTFCoder::decode(const CTF::base& ec, VROF& rofRecVec, VCLUS& cclusVec, VPAT& pattVec)
+void CTFCoder::decode(const CTF::base& ec, VROF& rofRecVec, VCLUS& cclusVec, VPAT& pattVec, const o2::ctf::CTFDictionary* dict)
 {
   CompressedClusters cc;
   cc.header = ec.getHeader();
+  const auto& ebParam = o2::ctf::EncodedBlocksParam::Instance(); // chunking and threading of the entropy coding
   // clang-format off
-    ec.decode(cc.firstChipROF, CTF::BLCfirstChipROF);
-    ec.decode(cc.bcIncROF,     CTF::BLCbcIncROF);
-    ec.decode(cc.orbitIncROF,  CTF::BLCorbitIncROF);
-    ec.decode(cc.nclusROF,     CTF::BLCnclusROF);
+    ec.decode(cc.firstChipROF, CTF::BLCfirstChipROF, dict, ebParam.nThreads);
+    ec.decode(cc.bcIncROF,     CTF::BLCbcIncROF, dict, ebParam.nThreads);
+    ec.decode(cc.orbitIncROF,  CTF::BLCorbitIncROF, dict, ebParam.nThreads);
+    ec.decode(cc.nclusROF,     CTF::BLCnclusROF, dict, ebParam.nThreads);
     //    
-    ec.decode(cc.chipInc,      CTF::BLCchipInc);
-    ec.decode(cc.chipMul,      CTF::BLCchipMul);
-    ec.decode(cc.row,          CTF::BLCrow);
-    ec.decode(cc.colInc,       CTF::BLCcolInc);
-    ec.decode(cc.pattID,       CTF::BLCpattID);
-    ec.decode(cc.pattMap,      CTF::BLCpattMap);
+    ec.decode(cc.chipInc,      CTF::BLCchipInc, dict, ebParam.nThreads);
+    ec.decode(cc.chipMul,      CTF::BLCchipMul, dict, ebParam.nThreads);
+    ec.decode(cc.row,          CTF::BLCrow, dict, ebParam.nThreads);
+    ec.decode(cc.colInc,       CTF::BLCcolInc, dict, ebParam.nThreads);
+    ec.decode(cc.pattID,       CTF::BLCpattID, dict, ebParam.nThreads);
+    ec.decode(cc.pattMap,      CTF::BLCpattMap, dict, ebParam.nThreads);
   // clang-format on
   //
   decompress(cc, rofRecVec, cclusVec, pattVec);
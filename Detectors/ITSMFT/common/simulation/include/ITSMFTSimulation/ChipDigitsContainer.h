@@ -18,7 +18,7 @@
 
 #include "SimulationDataFormat/MCCompLabel.h"
 #include "ITSMFTSimulation/PreDigit.h"
-#include <map>
+#include <memory>
 #include <vector>
 
 namespace o2
@@ -29,58 +29,130 @@ class DigiParams;
 
 /// @class ChipDigitsContainer
 /// @brief Container for similated points connected to a given chip
+/// The fired pixels are accumulated per readout frame in flat arrays, indexed by an open addressing
+/// hash of the pixel position. They are sorted in column and row only when the frame is emitted.
 
 class ChipDigitsContainer
 {
  public:
+  /// Fired pixels of the chip in a single readout frame
+  class Frame
+  {
+   public:
+    UInt_t getROFrame() const { return mROFrame; }
+    bool isEmpty() const { return mDigits.empty(); }
+
+    /// pixels in order of arrival, or sorted in column and row after sortDigits
+    std::vector<o2::itsmft::PreDigit>& getDigits() { return mDigits; }
+    /// extra contributions to the pixels, referred to by the PreDigitLabelRef::next indices
+    std::vector<o2::itsmft::PreDigitLabelRef>& getExtraLabels() { return mExtra; }
+
+    o2::itsmft::PreDigit* findDigit(UShort_t row, UShort_t col);
+    void addDigit(UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl);
+    void sortDigits();
+    void reset(UInt_t roframe);
+
+   private:
+    static UInt_t getPixelKey(UShort_t row, UShort_t col) { return (UInt_t(col) << (8 * sizeof(UShort_t))) + row; }
+    size_t getSlot(UInt_t key) const { return UInt_t(key * 2654435761u) >> mHashShift; } // Fibonacci hashing
+    void rehash();
+
+    UInt_t mROFrame = 0;
+    std::vector<o2::itsmft::PreDigit> mDigits;        ///< fired pixels
+    std::vector<o2::itsmft::PreDigitLabelRef> mExtra; ///< extra contributions to the fired pixels
+    std::vector<int> mIndex;                          ///< hash slots with the position of the pixel in mDigits, -1 if free
+    int mHashShift = 32;                              ///< 32 - log2 of the number of hash slots
+  };
+
   /// Default constructor
   ChipDigitsContainer(UShort_t idx = 0) : mChipIndex(idx){};
 
   /// Destructor
   ~ChipDigitsContainer() = default;
 
-  std::map<ULong64_t, o2::itsmft::PreDigit>& getPreDigits() { return mDigits; }
-  bool isEmpty() const { return mDigits.empty(); }
+  ChipDigitsContainer(ChipDigitsContainer&&) = default;
+  ChipDigitsContainer& operator=(ChipDigitsContainer&&) = default;
+
+  bool isEmpty() const { return mFrames.empty(); }
 
   void setChipIndex(UShort_t ind) { mChipIndex = ind; }
   UShort_t getChipIndex() const { return mChipIndex; }
 
-  o2::itsmft::PreDigit* findDigit(ULong64_t key);
-  void addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl);
+  /// Get the pixels of the given readout frame, nullptr if there are none
+  Frame* getFrame(UInt_t roframe);
+  /// Get the pixels of the given readout frame, creating the frame if needed
+  Frame& getOrCreateFrame(UInt_t roframe);
+  /// Discard the pixels of the given readout frame, keeping the memory for later frames
+  void releaseFrame(UInt_t roframe);
+
+  o2::itsmft::PreDigit* findDigit(UInt_t roframe, UShort_t row, UShort_t col);
+  void addDigit(UInt_t roframe, UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl);
   void addNoise(UInt_t rofMin, UInt_t rofMax, const o2::itsmft::DigiParams* params);
 
-  /// Get global ordering key made of readout frame, column and row
-  static ULong64_t getOrderingKey(UInt_t roframe, UShort_t row, UShort_t col)
-  {
-    return (static_cast<ULong64_t>(roframe) << (8 * sizeof(UInt_t))) + (col << (8 * sizeof(Short_t))) + row;
-  }
+ protected:
+  UShort_t mChipIndex = 0;                        ///< chip index
+  std::vector<std::unique_ptr<Frame>> mFrames;    //! frames with fired pixels
+  std::vector<std::unique_ptr<Frame>> mFreeFrames; //! released frames, for reuse
 
-  /// Get ROFrame from the ordering key
-  static UInt_t key2ROFrame(ULong64_t key)
-  {
-    return static_cast<UInt_t>(key >> (8 * sizeof(UInt_t)));
+  ClassDefNV(ChipDigitsContainer, 2);
+};
+
+//_______________________________________________________________________
+inline o2::itsmft::PreDigit* ChipDigitsContainer::Frame::findDigit(UShort_t row, UShort_t col)
+{
+  // finds the digit corresponding to the pixel
+  if (mIndex.empty()) {
+    return nullptr;
+  }
+  auto key = getPixelKey(row, col);
+  for (auto slot = getSlot(key);; slot = (slot + 1) & (mIndex.size() - 1)) {
+    int id = mIndex[slot];
+    if (id < 0) {
+      return nullptr;
+    }
+    if (mDigits[id].row == row && mDigits[id].col == col) {
+      return &mDigits[id];
+    }
   }
+}
 
- protected:
-  UShort_t mChipIndex = 0;                           ///< chip index
-  std::map<ULong64_t, o2::itsmft::PreDigit> mDigits; ///< Map of fired pixels, possibly in multiple frames
+//_______________________________________________________________________
+inline void ChipDigitsContainer::Frame::addDigit(UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl)
+{
+  // adds the pixel, which must not be present yet
+  if (2 * (mDigits.size() + 1) > mIndex.size()) {
+    rehash();
+  }
+  auto slot = getSlot(getPixelKey(row, col));
+  while (mIndex[slot] >= 0) {
+    slot = (slot + 1) & (mIndex.size() - 1);
+  }
+  mIndex[slot] = mDigits.size();
+  mDigits.emplace_back(mROFrame, row, col, charge, lbl);
+}
 
-  ClassDefNV(ChipDigitsContainer, 1);
-};
+//_______________________________________________________________________
+inline ChipDigitsContainer::Frame* ChipDigitsContainer::getFrame(UInt_t roframe)
+{
+  for (auto& frame : mFrames) {
+    if (frame->getROFrame() == roframe) {
+      return frame.get();
+    }
+  }
+  return nullptr;
+}
 
 //_______________________________________________________________________
-inline o2::itsmft::PreDigit* ChipDigitsContainer::findDigit(ULong64_t key)
+inline o2::itsmft::PreDigit* ChipDigitsContainer::findDigit(UInt_t roframe, UShort_t row, UShort_t col)
 {
-  // finds the digit corresponding to global key
-  auto digitentry = mDigits.find(key);
-  return digitentry != mDigits.end() ? &(digitentry->second) : nullptr;
+  auto frame = getFrame(roframe);
+  return frame ? frame->findDigit(row, col) : nullptr;
 }
 
 //_______________________________________________________________________
-inline void ChipDigitsContainer::addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col,
-                                          int charge, o2::MCCompLabel lbl)
+inline void ChipDigitsContainer::addDigit(UInt_t roframe, UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl)
 {
-  mDigits.emplace(std::make_pair(key, o2::itsmft::PreDigit(roframe, row, col, charge, lbl)));
+  getOrCreateFrame(roframe).addDigit(row, col, charge, lbl);
 }
 } // namespace itsmft
 } // namespace o2
@@ -69,12 +69,14 @@ class DigiParams
   void setChargeThreshold(int v, float frac2Account = 0.1);
   void setNSimSteps(int v);
   void setEnergyToNElectrons(float v) { mEnergyToNElectrons = v; }
+  void setNThreads(int v) { mNThreads = v > 0 ? v : 1; }
 
   int getChargeThreshold() const { return mChargeThreshold; }
   int getMinChargeToAccount() const { return mMinChargeToAccount; }
   int getNSimSteps() const { return mNSimSteps; }
   float getNSimStepsInv() const { return mNSimStepsInv; }
   float getEnergyToNElectrons() const { return mEnergyToNElectrons; }
+  int getNThreads() const { return mNThreads; }
 
   bool isTimeOffsetSet() const { return mTimeOffset > -infTime; }
 
@@ -100,6 +102,7 @@ class DigiParams
   int mMinChargeToAccount = 15;            ///< minimum charge contribution to account
   int mNSimSteps = 7;                      ///< number of steps in response simulation
   float mEnergyToNElectrons = 1. / 3.6e-9; // conversion of eloss to Nelectrons
+  int mNThreads = 1;                       ///< number of threads digitizing the chips in parallel
 
   o2::itsmft::AlpideSignalTrapezoid mSignalShape; ///< signal timeshape parameterization
 
@@ -109,7 +112,7 @@ class DigiParams
   float mROFrameLengthInv = 0; ///< inverse length of RO frame in ns
   float mNSimStepsInv = 0;     ///< its inverse
 
-  ClassDefNV(DigiParams, 2);
+  ClassDefNV(DigiParams, 3);
 };
 } // namespace itsmft
 } // namespace o2
@@ -14,7 +14,6 @@
 #define ALICEO2_ITSMFT_DIGITIZER_H
 
 #include <vector>
-#include <deque>
 #include <memory>
 
 #include "Rtypes.h"  // for Digitizer::Class, Double_t, ClassDef, etc
@@ -30,6 +29,8 @@
 #include "CommonDataFormat/InteractionRecord.h"
 #include "SimulationDataFormat/MCCompLabel.h"
 
+class TRandom;
+
 namespace o2
 {
 
@@ -39,15 +40,18 @@ template <typename T>
 class MCTruthContainer;
 }
 
+namespace utils
+{
+class ThreadPool;
+}
+
 namespace itsmft
 {
 class Digitizer : public TObject
 {
-  using ExtraDig = std::vector<PreDigitLabelRef>; ///< container for extra contributions to PreDigits
-
  public:
-  Digitizer() = default;
-  ~Digitizer() override = default;
+  Digitizer();
+  ~Digitizer() override;
   Digitizer(const Digitizer&) = delete;
   Digitizer& operator=(const Digitizer&) = delete;
 
@@ -88,21 +92,17 @@ class Digitizer : public TObject
   }
 
  private:
-  void processHit(const o2::itsmft::Hit& hit, UInt_t& maxFr, int evID, int srcID);
+  /// RO frames reached by the processed hits, accumulated separately by each thread
+  struct ROFrameRange {
+    UInt_t maxFrame = 0;              ///< highest RO frame of current digits
+    UInt_t eventMinFrame = 0xffffffff; ///< lowest RO frame of the processed events
+    UInt_t eventMaxFrame = 0;         ///< highest RO frame of the processed events
+  };
+
+  void processHit(const o2::itsmft::Hit& hit, ROFrameRange& frames, int evID, int srcID, TRandom& rnd);
+  void processHitsPerChip(const std::vector<Hit>& hits, const std::vector<int>& hitIdx, ROFrameRange& frames, int evID, int srcID);
   void registerDigits(ChipDigitsContainer& chip, UInt_t roFrame, float tInROF, int nROF,
-                      UShort_t row, UShort_t col, int nEle, o2::MCCompLabel& lbl);
-
-  ExtraDig* getExtraDigBuffer(UInt_t roFrame)
-  {
-    if (mROFrameMin > roFrame) {
-      return nullptr; // nothing to do
-    }
-    int ind = roFrame - mROFrameMin;
-    while (ind >= int(mExtraBuff.size())) {
-      mExtraBuff.emplace_back(std::make_unique<ExtraDig>());
-    }
-    return mExtraBuff[ind].get();
-  }
+                      UShort_t row, UShort_t col, int nEle, o2::MCCompLabel& lbl, ROFrameRange& frames);
 
   static constexpr float sec2ns = 1e9;
 
@@ -121,13 +121,14 @@ class Digitizer : public TObject
   const o2::itsmft::GeometryTGeo* mGeometry = nullptr; ///< ITS OR MFT upgrade geometry
 
   std::vector<o2::itsmft::ChipDigitsContainer> mChips; ///< Array of chips digits containers
-  std::deque<std::unique_ptr<ExtraDig>> mExtraBuff;    ///< burrer (per roFrame) for extra digits
 
   std::vector<o2::itsmft::Digit>* mDigits = nullptr;                       //! output digits
   std::vector<o2::itsmft::ROFRecord>* mROFRecords = nullptr;               //! output ROF records
   o2::dataformats::MCTruthContainer<o2::MCCompLabel>* mMCLabels = nullptr; //! output labels
 
-  ClassDefOverride(Digitizer, 2);
+  std::unique_ptr<o2::utils::ThreadPool> mThreadPool; //! worker threads digitizing the chips, started with the first event digitized in parallel
+
+  ClassDefOverride(Digitizer, 3);
 };
 } // namespace itsmft
 } // namespace o2
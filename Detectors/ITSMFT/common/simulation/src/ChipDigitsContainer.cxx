@@ -17,12 +17,85 @@
 #include "ITSMFTSimulation/DigiParams.h"
 #include "ITSMFTBase/SegmentationAlpide.h"
 #include <TRandom.h>
+#include <algorithm>
 
 using namespace o2::itsmft;
 using Segmentation = o2::itsmft::SegmentationAlpide;
 
 ClassImp(o2::itsmft::ChipDigitsContainer);
 
+//______________________________________________________________________
+void ChipDigitsContainer::Frame::rehash()
+{
+  // grow the hash index, keeping its size a power of 2
+  size_t size = 64;
+  mHashShift = 32 - 6;
+  while (size < mIndex.size() || 2 * (mDigits.size() + 1) > size) {
+    size *= 2;
+    mHashShift--;
+  }
+  mIndex.assign(size, -1);
+  for (int id = 0; id < int(mDigits.size()); id++) {
+    auto slot = getSlot(getPixelKey(mDigits[id].row, mDigits[id].col));
+    while (mIndex[slot] >= 0) {
+      slot = (slot + 1) & (mIndex.size() - 1);
+    }
+    mIndex[slot] = id;
+  }
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::Frame::sortDigits()
+{
+  // order the pixels in column then row, as they are expected in the output;
+  // the hash index is not valid anymore, the frame is supposed to be emitted
+  std::sort(mDigits.begin(), mDigits.end(), [](const PreDigit& a, const PreDigit& b) {
+    return a.col < b.col || (a.col == b.col && a.row < b.row);
+  });
+  mIndex.clear();
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::Frame::reset(UInt_t roframe)
+{
+  // prepare the frame for new pixels, keeping the allocated memory
+  mROFrame = roframe;
+  mDigits.clear();
+  mExtra.clear();
+  if (!mIndex.empty()) {
+    std::fill(mIndex.begin(), mIndex.end(), -1);
+  }
+}
+
+//______________________________________________________________________
+ChipDigitsContainer::Frame& ChipDigitsContainer::getOrCreateFrame(UInt_t roframe)
+{
+  auto frame = getFrame(roframe);
+  if (frame) {
+    return *frame;
+  }
+  if (mFreeFrames.empty()) {
+    mFrames.emplace_back(std::make_unique<Frame>());
+  } else {
+    mFrames.emplace_back(std::move(mFreeFrames.back()));
+    mFreeFrames.pop_back();
+  }
+  mFrames.back()->reset(roframe);
+  return *mFrames.back();
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::releaseFrame(UInt_t roframe)
+{
+  for (size_t i = 0; i < mFrames.size(); i++) {
+    if (mFrames[i]->getROFrame() == roframe) {
+      mFreeFrames.emplace_back(std::move(mFrames[i]));
+      mFrames.erase(mFrames.begin() + i);
+      return;
+    }
+  }
+}
+
 //______________________________________________________________________
 void ChipDigitsContainer::addNoise(UInt_t rofMin, UInt_t rofMax, const o2::itsmft::DigiParams* params)
 {
@@ -40,9 +113,8 @@ void ChipDigitsContainer::addNoise(UInt_t rofMin, UInt_t rofMax, const o2::itsmf
       row = gRandom->Integer(Segmentation::NRows);
       col = gRandom->Integer(Segmentation::NCols);
       // RS TODO: why the noise was added with 0 charge? It should be above the threshold!
-      auto key = getOrderingKey(rof, row, col);
-      if (!findDigit(key)) {
-        addDigit(key, rof, row, col, nel, o2::MCCompLabel(true));
+      if (!findDigit(rof, row, col)) {
+        addDigit(rof, row, col, nel, o2::MCCompLabel(true));
       }
     }
   }
@@ -69,6 +69,7 @@ void DigiParams::print() const
   printf("Number of charge sharing steps : %d\n", mNSimSteps);
   printf("ELoss to N electrons factor    : %e\n", mEnergyToNElectrons);
   printf("Noise level per pixel          : %e\n", mNoisePerPixel);
+  printf("Number of threads              : %d\n", mNThreads);
   printf("Charge time-response:\n");
   mSignalShape.print();
 }
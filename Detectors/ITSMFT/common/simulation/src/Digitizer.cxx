@@ -15,10 +15,14 @@
 #include "ITSMFTBase/SegmentationAlpide.h"
 #include "ITSMFTSimulation/Digitizer.h"
 #include "MathUtils/Cartesian3D.h"
+#include "CommonUtils/ThreadPool.h"
 #include "SimulationDataFormat/MCTruthContainer.h"
 
 #include <TRandom.h>
+#include <TRandom3.h>
+#include <atomic>
 #include <climits>
+#include <functional>
 #include <vector>
 #include <numeric>
 #include "FairLogger.h" // for LOG
@@ -30,6 +34,12 @@ using Segmentation = o2::itsmft::SegmentationAlpide;
 using namespace o2::itsmft;
 // using namespace o2::base;
 
+//_______________________________________________________________________
+Digitizer::Digitizer() = default;
+
+//_______________________________________________________________________
+Digitizer::~Digitizer() = default;
+
 //_______________________________________________________________________
 void Digitizer::init()
 {
@@ -69,9 +79,11 @@ void Digitizer::process(const std::vector<Hit>* hits, int evID, int srcID)
             [hits](auto lhs, auto rhs) {
               return (*hits)[lhs].GetDetectorID() < (*hits)[rhs].GetDetectorID();
             });
-  for (int i : hitIdx) {
-    processHit((*hits)[i], mROFrameMax, evID, srcID);
-  }
+  ROFrameRange frames{mROFrameMax, mEventROFrameMin, mEventROFrameMax};
+  processHitsPerChip(*hits, hitIdx, frames, evID, srcID);
+  mROFrameMax = frames.maxFrame;
+  mEventROFrameMin = frames.eventMinFrame;
+  mEventROFrameMax = frames.eventMaxFrame;
   // in the triggered mode store digits after every MC event
   // TODO: in the real triggered mode this will not be needed, this is actually for the
   // single event processing only
@@ -80,6 +92,53 @@ void Digitizer::process(const std::vector<Hit>* hits, int evID, int srcID)
   }
 }
 
+//_______________________________________________________________________
+void Digitizer::processHitsPerChip(const std::vector<Hit>& hits, const std::vector<int>& hitIdx, ROFrameRange& frames, int evID, int srcID)
+{
+  // the hits are sorted in chip: each chip is digitized by a single thread, so that the chip
+  // containers need no locking, with its own random generator
+  std::vector<int> chipStart; // first entry in hitIdx of every chip with hits
+  for (int i = 0; i < int(hitIdx.size()); i++) {
+    if (i == 0 || hits[hitIdx[i]].GetDetectorID() != hits[hitIdx[i - 1]].GetDetectorID()) {
+      chipStart.push_back(i);
+    }
+  }
+  int nChips = chipStart.size();
+  chipStart.push_back(hitIdx.size());
+
+  // the generators are seeded per chip from the global one: the result does not depend on the number of threads
+  // also with a single thread, which then digitizes all the chips itself
+  const UInt_t seed = gRandom->Integer(0x7fffffff);
+  int nSlots = mParams.getNThreads();
+  if (nSlots > 1 && (!mThreadPool || mThreadPool->getNSlots() != nSlots)) {
+    mThreadPool.reset(); // the number of threads was changed
+    mThreadPool = std::make_unique<o2::utils::ThreadPool>(nSlots);
+  }
+  std::vector<ROFrameRange> threadFrames(nSlots, frames);
+  std::atomic<int> nextChip{0};
+  std::function<void(int)> digitizeChips = [&](int slot) {
+    TRandom3 rnd;
+    auto& thFrames = threadFrames[slot];
+    for (int ic = nextChip++; ic < nChips; ic = nextChip++) {
+      rnd.SetSeed(seed + hits[hitIdx[chipStart[ic]]].GetDetectorID() + 1); // 0 would give a time dependent seed
+      for (int i = chipStart[ic]; i < chipStart[ic + 1]; i++) {
+        processHit(hits[hitIdx[i]], thFrames, evID, srcID, rnd);
+      }
+    }
+  };
+  if (nSlots > 1) {
+    mThreadPool->run(digitizeChips); // rethrows the exceptions of the worker threads
+  } else {
+    digitizeChips(0);
+  }
+
+  for (const auto& thFrames : threadFrames) {
+    frames.maxFrame = std::max(frames.maxFrame, thFrames.maxFrame);
+    frames.eventMinFrame = std::min(frames.eventMinFrame, thFrames.eventMinFrame);
+    frames.eventMaxFrame = std::max(frames.eventMaxFrame, thFrames.eventMaxFrame);
+  }
+}
+
 //_______________________________________________________________________
 void Digitizer::setEventTime(const o2::InteractionTimeRecord& irt)
 {
@@ -120,9 +179,6 @@ void Digitizer::fillOutputContainer(UInt_t frameLast)
   if (frameLast > mROFrameMax) {
     frameLast = mROFrameMax;
   }
-  // make sure all buffers for extra digits are created up to the maxFrame
-  getExtraDigBuffer(mROFrameMax);
-
   LOG(INFO) << "Filling " << mGeometry->getName() << " digits output for RO frames " << mROFrameMin << ":"
             << frameLast;
 
@@ -133,33 +189,27 @@ void Digitizer::fillOutputContainer(UInt_t frameLast)
     rcROF.setROFrame(mROFrameMin);
     rcROF.setFirstEntry(mDigits->size()); // start of current ROF in digits
 
-    auto& extra = *(mExtraBuff.front().get());
     for (auto& chip : mChips) {
       chip.addNoise(mROFrameMin, mROFrameMin, &mParams);
-      auto& buffer = chip.getPreDigits();
-      if (buffer.empty()) {
+      auto frame = chip.getFrame(mROFrameMin);
+      if (!frame) {
         continue;
       }
-      auto itBeg = buffer.begin();
-      auto iter = itBeg;
-      ULong64_t maxKey = chip.getOrderingKey(mROFrameMin + 1, 0, 0) - 1; // fetch digits with key below that
-      for (; iter != buffer.end(); ++iter) {
-        if (iter->first > maxKey) {
-          break; // is the digit ROFrame from the key > the max requested frame
-        }
-        auto& preDig = iter->second; // preDigit
+      frame->sortDigits(); // digits are written in column then row order
+      const auto& extra = frame->getExtraLabels();
+      for (const auto& preDig : frame->getDigits()) {
         if (preDig.charge >= mParams.getChargeThreshold()) {
           int digID = mDigits->size();
           mDigits->emplace_back(chip.getChipIndex(), preDig.row, preDig.col, preDig.charge);
           mMCLabels->addElement(digID, preDig.labelRef.label);
-          auto& nextRef = preDig.labelRef; // extra contributors are in extra array
-          while (nextRef.next >= 0) {
-            nextRef = extra[nextRef.next];
-            mMCLabels->addElement(digID, nextRef.label);
+          const auto* nextRef = &preDig.labelRef; // extra contributors are in extra array
+          while (nextRef->next >= 0) {
+            nextRef = &extra[nextRef->next];
+            mMCLabels->addElement(digID, nextRef->label);
           }
         }
       }
-      buffer.erase(itBeg, iter);
+      chip.releaseFrame(mROFrameMin);
     }
     // finalize ROF record
     rcROF.setNEntries(mDigits->size() - rcROF.getFirstEntry()); // number of digits
@@ -171,21 +221,17 @@ void Digitizer::fillOutputContainer(UInt_t frameLast)
     if (mROFRecords) {
       mROFRecords->push_back(rcROF);
     }
-    extra.clear(); // clear container for extra digits of the mROFrameMin ROFrame
-    // and move it as a new slot in the end
-    mExtraBuff.emplace_back(mExtraBuff.front().release());
-    mExtraBuff.pop_front();
   }
 }
 
 //_______________________________________________________________________
-void Digitizer::processHit(const o2::itsmft::Hit& hit, UInt_t& maxFr, int evID, int srcID)
+void Digitizer::processHit(const o2::itsmft::Hit& hit, ROFrameRange& frames, int evID, int srcID, TRandom& rnd)
 {
   // convert single hit to digits
   float timeInROF = hit.GetTime() * sec2ns;
   if (timeInROF > 20e3) {
     const int maxWarn = 10;
-    static int warnNo = 0;
+    static std::atomic<int> warnNo{0};
     if (warnNo < maxWarn) {
       LOG(WARNING) << "Ignoring hit with time_in_event = " << timeInROF << " ns"
                    << ((++warnNo < maxWarn) ? "" : " (suppressing further warnings)");
@@ -206,8 +252,8 @@ void Digitizer::processHit(const o2::itsmft::Hit& hit, UInt_t& maxFr, int evID,
   UInt_t roFrameRelMax = mParams.isContinuous() ? (timeInROF + tTot) * mParams.getROFrameLengthInv() : roFrameRel;
   int nFrames = roFrameRelMax + 1 - roFrameRel;
   UInt_t roFrameMax = mNewROFrame + roFrameRelMax;
-  if (roFrameMax > maxFr) {
-    maxFr = roFrameMax; // if signal extends beyond current maxFrame, increase the latter
+  if (roFrameMax > frames.maxFrame) {
+    frames.maxFrame = roFrameMax; // if signal extends beyond current maxFrame, increase the latter
   }
 
   // here we start stepping in the depth of the sensor to generate charge diffision
@@ -331,21 +377,21 @@ void Digitizer::processHit(const o2::itsmft::Hit& hit, UInt_t& maxFr, int evID,
       if (!nEleResp) {
         continue;
       }
-      int nEle = gRandom->Poisson(nElectrons * nEleResp); // total charge in given pixel
+      int nEle = rnd.Poisson(nElectrons * nEleResp); // total charge in given pixel
       // ignore charge which have no chance to fire the pixel
       if (nEle < mParams.getMinChargeToAccount()) {
         continue;
       }
       UShort_t colIS = icol + colS;
       //
-      registerDigits(chip, roFrameAbs, timeInROF, nFrames, rowIS, colIS, nEle, lbl);
+      registerDigits(chip, roFrameAbs, timeInROF, nFrames, rowIS, colIS, nEle, lbl, frames);
     }
   }
 }
 
 //________________________________________________________________________________
 void Digitizer::registerDigits(ChipDigitsContainer& chip, UInt_t roFrame, float tInROF, int nROF,
-                               UShort_t row, UShort_t col, int nEle, o2::MCCompLabel& lbl)
+                               UShort_t row, UShort_t col, int nEle, o2::MCCompLabel& lbl, ROFrameRange& frames)
 {
   // Register digits for given pixel, accounting for the possible signal contribution to
   // multiple ROFrame. The signal starts at time tInROF wrt the start of provided roFrame
@@ -361,35 +407,35 @@ void Digitizer::registerDigits(ChipDigitsContainer& chip, UInt_t roFrame, float
     if (nEleROF < mParams.getMinChargeToAccount()) {
       continue;
     }
-    if (roFr > mEventROFrameMax)
-      mEventROFrameMax = roFr;
-    if (roFr < mEventROFrameMin)
-      mEventROFrameMin = roFr;
-    auto key = chip.getOrderingKey(roFr, row, col);
-    PreDigit* pd = chip.findDigit(key);
+    if (roFr > frames.eventMaxFrame)
+      frames.eventMaxFrame = roFr;
+    if (roFr < frames.eventMinFrame)
+      frames.eventMinFrame = roFr;
+    auto& frame = chip.getOrCreateFrame(roFr);
+    PreDigit* pd = frame.findDigit(row, col);
     if (!pd) {
-      chip.addDigit(key, roFr, row, col, nEleROF, lbl);
+      frame.addDigit(row, col, nEleROF, lbl);
     } else { // there is already a digit at this slot, account as PreDigitExtra contribution
       pd->charge += nEleROF;
       if (pd->labelRef.label == lbl) { // don't store the same label twice
         continue;
       }
-      ExtraDig* extra = getExtraDigBuffer(roFr);
-      int& nxt = pd->labelRef.next;
+      auto& extra = frame.getExtraLabels();
+      int* nxt = &pd->labelRef.next;
       bool skip = false;
-      while (nxt >= 0) {
-        if ((*extra)[nxt].label == lbl) { // don't store the same label twice
+      while (*nxt >= 0) {
+        if (extra[*nxt].label == lbl) { // don't store the same label twice
           skip = true;
           break;
         }
-        nxt = (*extra)[nxt].next;
+        nxt = &extra[*nxt].next;
       }
       if (skip) {
         continue;
       }
       // new predigit will be added in the end of the chain
-      nxt = extra->size();
-      extra->emplace_back(lbl);
+      *nxt = extra.size();
+      extra.emplace_back(lbl);
     }
   }
 }
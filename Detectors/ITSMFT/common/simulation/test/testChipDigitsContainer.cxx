@@ -0,0 +1,119 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test ChipDigitsContainer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ITSMFTSimulation/ChipDigitsContainer.h"
+#include "ITSMFTBase/SegmentationAlpide.h"
+#include <TRandom.h>
+#include <set>
+#include <utility>
+
+using namespace o2::itsmft;
+using Segmentation = o2::itsmft::SegmentationAlpide;
+
+BOOST_AUTO_TEST_CASE(ChipDigitsContainer_growth)
+{
+  // many more pixels than the initial 64 hash slots: every one must still be found after the rehashes
+  gRandom->SetSeed(1);
+  ChipDigitsContainer chip(3);
+  std::set<std::pair<UShort_t, UShort_t>> pixels;
+  while (pixels.size() < 5000) {
+    UShort_t row = gRandom->Integer(Segmentation::NRows), col = gRandom->Integer(Segmentation::NCols);
+    if (pixels.emplace(row, col).second) {
+      BOOST_CHECK(chip.findDigit(10, row, col) == nullptr);
+      chip.addDigit(10, row, col, row + col, o2::MCCompLabel(pixels.size(), 0, 0));
+    }
+  }
+  auto frame = chip.getFrame(10);
+  BOOST_REQUIRE(frame != nullptr);
+  BOOST_CHECK_EQUAL(frame->getDigits().size(), pixels.size());
+  BOOST_CHECK(chip.getFrame(11) == nullptr);
+  BOOST_CHECK(chip.findDigit(11, pixels.begin()->first, pixels.begin()->second) == nullptr);
+  for (const auto& pix : pixels) {
+    auto dig = chip.findDigit(10, pix.first, pix.second);
+    BOOST_REQUIRE(dig != nullptr);
+    BOOST_CHECK_EQUAL(dig->row, pix.first);
+    BOOST_CHECK_EQUAL(dig->col, pix.second);
+    BOOST_CHECK_EQUAL(dig->charge, pix.first + pix.second);
+    BOOST_CHECK_EQUAL(dig->roFrame, 10);
+  }
+  // the neighbours of the fired pixels, which may share their hash slots, are not found
+  for (const auto& pix : pixels) {
+    UShort_t row = pix.first + 1;
+    if (row < Segmentation::NRows && !pixels.count({row, pix.second})) {
+      BOOST_CHECK(chip.findDigit(10, row, pix.second) == nullptr);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ChipDigitsContainer_sort)
+{
+  gRandom->SetSeed(2);
+  ChipDigitsContainer chip;
+  auto& frame = chip.getOrCreateFrame(0);
+  for (int i = 0; i < 1000; i++) {
+    UShort_t row = gRandom->Integer(Segmentation::NRows), col = gRandom->Integer(Segmentation::NCols);
+    if (!frame.findDigit(row, col)) {
+      frame.addDigit(row, col, 1, o2::MCCompLabel(i, 0, 0));
+    }
+  }
+  auto nDigits = frame.getDigits().size();
+  frame.sortDigits();
+  const auto& digits = frame.getDigits();
+  BOOST_CHECK_EQUAL(digits.size(), nDigits);
+  for (size_t i = 1; i < digits.size(); i++) {
+    bool ordered = digits[i - 1].col < digits[i].col || (digits[i - 1].col == digits[i].col && digits[i - 1].row < digits[i].row);
+    BOOST_CHECK(ordered);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ChipDigitsContainer_frameReuse)
+{
+  ChipDigitsContainer chip;
+  for (int i = 0; i < 200; i++) {
+    chip.addDigit(5, i, 2 * i, 10, o2::MCCompLabel(i, 0, 0));
+  }
+  chip.addDigit(6, 1, 1, 10, o2::MCCompLabel(1, 0, 0));
+  auto& frame5 = chip.getOrCreateFrame(5);
+  frame5.getExtraLabels().emplace_back(o2::MCCompLabel(7, 0, 0));
+  BOOST_CHECK_EQUAL(&frame5, chip.getFrame(5));
+  BOOST_CHECK_EQUAL(frame5.getDigits().size(), 200);
+
+  // the released frame is reused for the next new readout frame, without any of its former content
+  chip.releaseFrame(5);
+  BOOST_CHECK(chip.getFrame(5) == nullptr);
+  BOOST_CHECK(chip.getFrame(6) != nullptr);
+  auto& frame7 = chip.getOrCreateFrame(7);
+  BOOST_CHECK_EQUAL(&frame7, &frame5);
+  BOOST_CHECK_EQUAL(frame7.getROFrame(), 7);
+  BOOST_CHECK(frame7.isEmpty());
+  BOOST_CHECK(frame7.getExtraLabels().empty());
+  for (int i = 0; i < 200; i++) {
+    BOOST_CHECK(frame7.findDigit(i, 2 * i) == nullptr);
+  }
+  chip.addDigit(7, 3, 6, 20, o2::MCCompLabel(3, 0, 0));
+  auto dig = chip.findDigit(7, 3, 6);
+  BOOST_REQUIRE(dig != nullptr);
+  BOOST_CHECK_EQUAL(dig->charge, 20);
+  BOOST_CHECK_EQUAL(dig->roFrame, 7);
+
+  // a frame emitted after sorting can be reused as well
+  frame7.sortDigits();
+  chip.releaseFrame(7);
+  auto& frame8 = chip.getOrCreateFrame(8);
+  BOOST_CHECK(frame8.isEmpty());
+  BOOST_CHECK(frame8.findDigit(3, 6) == nullptr);
+  frame8.addDigit(3, 6, 30, o2::MCCompLabel(3, 0, 0));
+  BOOST_REQUIRE(frame8.findDigit(3, 6) != nullptr);
+  BOOST_CHECK_EQUAL(frame8.findDigit(3, 6)->charge, 30);
+}
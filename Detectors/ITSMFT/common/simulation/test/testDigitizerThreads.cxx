@@ -0,0 +1,118 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test DigitizerThreads
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ITSMFTSimulation/Digitizer.h"
+#include "ITSMFTBase/SegmentationAlpide.h"
+#include "DetectorsCommonDataFormats/DetID.h"
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include <TRandom.h>
+#include <TVector3.h>
+#include <vector>
+
+using namespace o2::itsmft;
+using Segmentation = o2::itsmft::SegmentationAlpide;
+
+// chips with the local frame as global one, enough for the digitization
+class TestGeometry : public GeometryTGeo
+{
+ public:
+  TestGeometry(int nChips) : GeometryTGeo(o2::detectors::DetID::ITS), mNChips(nChips) { Build(0); }
+  void Build(int) override
+  {
+    setSize(mNChips);
+    fillMatrixCache(0);
+  }
+  void fillMatrixCache(int) override
+  {
+    getCacheL2G().setSize(mSize);
+    for (int i = 0; i < mSize; i++) {
+      getCacheL2G().setMatrix(Mat3D(), i);
+    }
+  }
+
+ private:
+  int mNChips = 0;
+};
+
+struct DigitizerOutput {
+  std::vector<Digit> digits;
+  std::vector<ROFRecord> rofs;
+  o2::dataformats::MCTruthContainer<o2::MCCompLabel> labels;
+};
+
+// digitize the same events with the given number of threads
+void digitize(const TestGeometry& geom, const std::vector<std::vector<Hit>>& events, int nThreads, DigitizerOutput& out)
+{
+  gRandom->SetSeed(123); // used for the noise and to seed the per chip generators
+  Digitizer digitizer;
+  digitizer.setGeometry(&geom);
+  digitizer.getParams().setContinuous(true);
+  digitizer.getParams().setNThreads(nThreads);
+  digitizer.init();
+  digitizer.setDigits(&out.digits);
+  digitizer.setROFRecords(&out.rofs);
+  digitizer.setMCLabels(&out.labels);
+  for (size_t ev = 0; ev < events.size(); ev++) {
+    o2::InteractionTimeRecord irt;
+    irt.setFromNS(1000. + ev * 3000.);
+    digitizer.setEventTime(irt);
+    digitizer.process(&events[ev], ev, 0);
+  }
+  digitizer.fillOutputContainer();
+}
+
+BOOST_AUTO_TEST_CASE(DigitizerThreads_equivalence)
+{
+  const int nChips = 50;
+  TestGeometry geom(nChips);
+  gRandom->SetSeed(1);
+  std::vector<std::vector<Hit>> events(5);
+  for (int ev = 0; ev < int(events.size()); ev++) {
+    for (int ih = 0; ih < 500; ih++) {
+      // tracks crossing the sensor, several of them per chip and some sharing pixels
+      unsigned short chip = gRandom->Integer(nChips);
+      float x = gRandom->Uniform(-0.3, 0.3), z = gRandom->Uniform(-0.5, 0.5);
+      TVector3 start(x, -Segmentation::SensorLayerThickness / 2, z);
+      TVector3 end(x + gRandom->Uniform(-2e-3, 2e-3), Segmentation::SensorLayerThickness / 2, z + gRandom->Uniform(-2e-3, 2e-3));
+      events[ev].emplace_back(ih % 20, chip, start, end, TVector3(0, 1, 0), 1., 1., gRandom->Uniform(5e-6, 5e-5), 0, 0);
+    }
+  }
+
+  DigitizerOutput ref;
+  digitize(geom, events, 1, ref);
+  BOOST_REQUIRE(!ref.digits.empty());
+  for (int nThreads : {2, 4}) {
+    DigitizerOutput out;
+    digitize(geom, events, nThreads, out);
+    BOOST_REQUIRE_EQUAL(out.digits.size(), ref.digits.size());
+    BOOST_REQUIRE_EQUAL(out.labels.getIndexedSize(), ref.labels.getIndexedSize());
+    for (size_t i = 0; i < ref.digits.size(); i++) {
+      const auto &d = out.digits[i], &dref = ref.digits[i];
+      BOOST_CHECK_EQUAL(d.getChipIndex(), dref.getChipIndex());
+      BOOST_CHECK_EQUAL(d.getRow(), dref.getRow());
+      BOOST_CHECK_EQUAL(d.getColumn(), dref.getColumn());
+      BOOST_CHECK_EQUAL(d.getCharge(), dref.getCharge());
+      auto lbl = out.labels.getLabels(i), lblref = ref.labels.getLabels(i);
+      BOOST_REQUIRE_EQUAL(lbl.size(), lblref.size());
+      for (size_t il = 0; il < lbl.size(); il++) {
+        BOOST_CHECK(lbl[il] == lblref[il]);
+      }
+    }
+    BOOST_REQUIRE_EQUAL(out.rofs.size(), ref.rofs.size());
+    for (size_t i = 0; i < ref.rofs.size(); i++) {
+      BOOST_CHECK_EQUAL(out.rofs[i].getFirstEntry(), ref.rofs[i].getFirstEntry());
+      BOOST_CHECK_EQUAL(out.rofs[i].getNEntries(), ref.rofs[i].getNEntries());
+    }
+  }
+}
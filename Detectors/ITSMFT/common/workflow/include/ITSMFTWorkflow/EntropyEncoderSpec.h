@@ -17,7 +17,9 @@
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/Task.h"
 #include "Headers/DataHeader.h"
+#include "DetectorsCommonDataFormats/CTFDictionary.h"
 #include <TStopwatch.h>
+#include <memory>
 
 namespace o2
 {
@@ -29,11 +31,13 @@ class EntropyEncoderSpec : public o2::framework::Task
  public:
   EntropyEncoderSpec(o2::header::DataOrigin orig);
   ~EntropyEncoderSpec() override = default;
+  void init(o2::framework::InitContext& ic) final;
   void run(o2::framework::ProcessingContext& pc) final;
   void endOfStream(o2::framework::EndOfStreamContext& ec) final;
 
  private:
   o2::header::DataOrigin mOrigin = o2::header::gDataOriginInvalid;
+  std::unique_ptr<o2::ctf::CTFDictionary> mCTFDict; // optional external dictionary
   TStopwatch mTimer;
 };
 
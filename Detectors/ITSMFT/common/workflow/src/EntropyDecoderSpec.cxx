@@ -33,6 +33,15 @@ EntropyDecoderSpec::EntropyDecoderSpec(o2::header::DataOrigin orig) : mOrigin(or
   mTimer.Reset();
 }
 
+void EntropyDecoderSpec::init(InitContext& ic)
+{
+  auto dictFile = ic.options().get<std::string>("ctf-dict");
+  if (!dictFile.empty()) {
+    mCTFDict.reset(o2::ctf::CTFDictionary::loadFrom(dictFile, mOrigin.as<std::string>()));
+    LOG(INFO) << "Loaded CTF dictionary " << mCTFDict->getID() << " for " << mOrigin.as<std::string>() << " from " << dictFile;
+  }
+}
+
 void EntropyDecoderSpec::run(ProcessingContext& pc)
 {
   auto cput = mTimer.CpuTime();
@@ -47,7 +56,7 @@ void EntropyDecoderSpec::run(ProcessingContext& pc)
 
   // since the buff is const, we cannot use EncodedBlocks::relocate directly, instead we wrap its data to another flat object
   const auto ctfImage = o2::itsmft::CTF::getImage(buff.data());
-  CTFCoder::decode(ctfImage, rofs, compcl, patterns);
+  CTFCoder::decode(ctfImage, rofs, compcl, patterns, mCTFDict.get());
 
   mTimer.Stop();
   LOG(INFO) << "Decoded " << compcl.size() << " clusters in " << rofs.size() << " RO frames in " << mTimer.CpuTime() - cput << " s";
@@ -73,7 +82,7 @@ DataProcessorSpec getEntropyDecoderSpec(o2::header::DataOrigin orig)
     Inputs{InputSpec{"ctf", orig, "CTFDATA", 0, Lifetime::Timeframe}},
     outputs,
     AlgorithmSpec{adaptFromTask<EntropyDecoderSpec>(orig)},
-    Options{}};
+    Options{{"ctf-dict", VariantType::String, "", {"File with external CTF dictionary, none if empty"}}}};
 }
 
 } // namespace itsmft
@@ -32,6 +32,15 @@ EntropyEncoderSpec::EntropyEncoderSpec(o2::header::DataOrigin orig) : mOrigin(or
   mTimer.Reset();
 }
 
+void EntropyEncoderSpec::init(InitContext& ic)
+{
+  auto dictFile = ic.options().get<std::string>("ctf-dict");
+  if (!dictFile.empty()) {
+    mCTFDict.reset(o2::ctf::CTFDictionary::loadFrom(dictFile, mOrigin.as<std::string>()));
+    LOG(INFO) << "Loaded CTF dictionary " << mCTFDict->getID() << " for " << mOrigin.as<std::string>() << " from " << dictFile;
+  }
+}
+
 void EntropyEncoderSpec::run(ProcessingContext& pc)
 {
   auto cput = mTimer.CpuTime();
@@ -41,7 +50,7 @@ void EntropyEncoderSpec::run(ProcessingContext& pc)
   auto rofs = pc.inputs().get<gsl::span<o2::itsmft::ROFRecord>>("ROframes");
 
   auto& buffer = pc.outputs().make<std::vector<o2::ctf::BufferType>>(Output{mOrigin, "CTFDATA", 0, Lifetime::Timeframe});
-  CTFCoder::encode(buffer, rofs, compClusters, pspan);
+  CTFCoder::encode(buffer, rofs, compClusters, pspan, mCTFDict.get());
   auto eeb = CTF::get(buffer.data()); // cast to container pointer
   eeb->compactify();                  // eliminate unnecessary padding
   buffer.resize(eeb->size());         // shrink buffer to strictly necessary size
@@ -68,7 +77,7 @@ DataProcessorSpec getEntropyEncoderSpec(o2::header::DataOrigin orig)
     inputs,
     Outputs{{orig, "CTFDATA", 0, Lifetime::Timeframe}},
     AlgorithmSpec{adaptFromTask<EntropyEncoderSpec>(orig)},
-    Options{}};
+    Options{{"ctf-dict", VariantType::String, "", {"File with external CTF dictionary, none if empty"}}}};
 }
 
 } // namespace itsmft
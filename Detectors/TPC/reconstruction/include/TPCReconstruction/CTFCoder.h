@@ -21,6 +21,7 @@
 #include "DataFormatsTPC/CTF.h"
 #include "DataFormatsTPC/CompressedClusters.h"
 #include "DetectorsCommonDataFormats/DetID.h"
+#include "DetectorsCommonDataFormats/EncodedBlocksParam.h"
 #include "rANS/rans.h"
 
 class TTree;
@@ -33,12 +34,12 @@ namespace tpc
 class CTFCoder
 {
  public:
-  /// entropy-encode compressed clusters to flat buffer
+  /// entropy-encode compressed clusters to flat buffer, using the external dictionary if provided
   template <typename VEC>
-  static void encode(VEC& buff, const CompressedClusters& ccl);
+  static void encode(VEC& buff, const CompressedClusters& ccl, const o2::ctf::CTFDictionary* dict = nullptr);
 
   template <typename VEC>
-  static void decode(const CTF::base& ec, VEC& buff);
+  static void decode(const CTF::base& ec, VEC& buff, const o2::ctf::CTFDictionary* dict = nullptr);
 
   static size_t constexpr Alignment = 16;
   static size_t estimateSize(CompressedClusters& c);
@@ -67,7 +68,7 @@ class CTFCoder
 
 /// entropy-encode clusters to buffer with CTF
 template <typename VEC>
-void CTFCoder::encode(VEC& buff, const CompressedClusters& ccl)
+void CTFCoder::encode(VEC& buff, const CompressedClusters& ccl, const o2::ctf::CTFDictionary* dict)
 {
   using MD = o2::ctf::Metadata::OptStore;
   // what to do which each field: see o2::ctf::Metadata explanation
@@ -101,38 +102,39 @@ void CTFCoder::encode(VEC& buff, const CompressedClusters& ccl)
   ec->setHeader(reinterpret_cast<const CompressedClustersCounters&>(ccl));
   ec->getANSHeader().majorVersion = 0;
   ec->getANSHeader().minorVersion = 1;
+  const auto& ebParam = o2::ctf::EncodedBlocksParam::Instance(); // chunking and threading of the entropy coding
   // at every encoding the buffer might be autoexpanded, so we don't work with fixed pointer ec
 #define ENCODE CTF::get(buff.data())->encode
   // clang-format off
-  ENCODE(ccl.qTotA,             ccl.qTotA + ccl.nAttachedClusters,                CTF::BLCqTotA,             o2::rans::ProbabilityBits16Bit, optField[CTF::BLCqTotA],             &buff);
-  ENCODE(ccl.qMaxA,             ccl.qMaxA + ccl.nAttachedClusters,                CTF::BLCqMaxA,             o2::rans::ProbabilityBits16Bit, optField[CTF::BLCqMaxA],             &buff);
-  ENCODE(ccl.flagsA,            ccl.flagsA + ccl.nAttachedClusters,               CTF::BLCflagsA,            o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCflagsA],            &buff);
-  ENCODE(ccl.rowDiffA,          ccl.rowDiffA + ccl.nAttachedClustersReduced,      CTF::BLCrowDiffA,          o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCrowDiffA],          &buff);
-  ENCODE(ccl.sliceLegDiffA,     ccl.sliceLegDiffA + ccl.nAttachedClustersReduced, CTF::BLCsliceLegDiffA,     o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsliceLegDiffA],     &buff);
-  ENCODE(ccl.padResA,           ccl.padResA + ccl.nAttachedClustersReduced,       CTF::BLCpadResA,           o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpadResA],           &buff);
-  ENCODE(ccl.timeResA,          ccl.timeResA + ccl.nAttachedClustersReduced,      CTF::BLCtimeResA,          o2::rans::ProbabilityBits25Bit, optField[CTF::BLCtimeResA],          &buff);
-  ENCODE(ccl.sigmaPadA,         ccl.sigmaPadA + ccl.nAttachedClusters,            CTF::BLCsigmaPadA,         o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsigmaPadA],         &buff);
-  ENCODE(ccl.sigmaTimeA,        ccl.sigmaTimeA + ccl.nAttachedClusters,           CTF::BLCsigmaTimeA,        o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsigmaTimeA],        &buff);  
-  ENCODE(ccl.qPtA,              ccl.qPtA + ccl.nTracks,                           CTF::BLCqPtA,              o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCqPtA],              &buff);
-  ENCODE(ccl.rowA,              ccl.rowA + ccl.nTracks,                           CTF::BLCrowA,              o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCrowA],              &buff);
-  ENCODE(ccl.sliceA,            ccl.sliceA + ccl.nTracks,                         CTF::BLCsliceA,            o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsliceA],            &buff);
-  ENCODE(ccl.timeA,             ccl.timeA + ccl.nTracks,                          CTF::BLCtimeA,             o2::rans::ProbabilityBits25Bit, optField[CTF::BLCtimeA],             &buff);
-  ENCODE(ccl.padA,              ccl.padA + ccl.nTracks,                           CTF::BLCpadA,              o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpadA],              &buff);
-  ENCODE(ccl.qTotU,             ccl.qTotU + ccl.nUnattachedClusters,              CTF::BLCqTotU,             o2::rans::ProbabilityBits16Bit, optField[CTF::BLCqTotU],             &buff);
-  ENCODE(ccl.qMaxU,             ccl.qMaxU + ccl.nUnattachedClusters,              CTF::BLCqMaxU,             o2::rans::ProbabilityBits16Bit, optField[CTF::BLCqMaxU],             &buff);
-  ENCODE(ccl.flagsU,            ccl.flagsU + ccl.nUnattachedClusters,             CTF::BLCflagsU,            o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCflagsU],            &buff);
-  ENCODE(ccl.padDiffU,          ccl.padDiffU + ccl.nUnattachedClusters,           CTF::BLCpadDiffU,          o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpadDiffU],          &buff);
-  ENCODE(ccl.timeDiffU,         ccl.timeDiffU + ccl.nUnattachedClusters,          CTF::BLCtimeDiffU,         o2::rans::ProbabilityBits25Bit, optField[CTF::BLCtimeDiffU],         &buff);
-  ENCODE(ccl.sigmaPadU,         ccl.sigmaPadU + ccl.nUnattachedClusters,          CTF::BLCsigmaPadU,         o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsigmaPadU],         &buff); 
-  ENCODE(ccl.sigmaTimeU,        ccl.sigmaTimeU + ccl.nUnattachedClusters,         CTF::BLCsigmaTimeU,        o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsigmaTimeU],        &buff);
-  ENCODE(ccl.nTrackClusters,    ccl.nTrackClusters + ccl.nTracks,                 CTF::BLCnTrackClusters,    o2::rans::ProbabilityBits16Bit, optField[CTF::BLCnTrackClusters],    &buff);
-  ENCODE(ccl.nSliceRowClusters, ccl.nSliceRowClusters + ccl.nSliceRows,           CTF::BLCnSliceRowClusters, o2::rans::ProbabilityBits25Bit, optField[CTF::BLCnSliceRowClusters], &buff);
+  ENCODE(ccl.qTotA,             ccl.qTotA + ccl.nAttachedClusters,                CTF::BLCqTotA,             o2::rans::ProbabilityBits16Bit, optField[CTF::BLCqTotA],             &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.qMaxA,             ccl.qMaxA + ccl.nAttachedClusters,                CTF::BLCqMaxA,             o2::rans::ProbabilityBits16Bit, optField[CTF::BLCqMaxA],             &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.flagsA,            ccl.flagsA + ccl.nAttachedClusters,               CTF::BLCflagsA,            o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCflagsA],            &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.rowDiffA,          ccl.rowDiffA + ccl.nAttachedClustersReduced,      CTF::BLCrowDiffA,          o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCrowDiffA],          &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.sliceLegDiffA,     ccl.sliceLegDiffA + ccl.nAttachedClustersReduced, CTF::BLCsliceLegDiffA,     o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsliceLegDiffA],     &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.padResA,           ccl.padResA + ccl.nAttachedClustersReduced,       CTF::BLCpadResA,           o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpadResA],           &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.timeResA,          ccl.timeResA + ccl.nAttachedClustersReduced,      CTF::BLCtimeResA,          o2::rans::ProbabilityBits25Bit, optField[CTF::BLCtimeResA],          &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.sigmaPadA,         ccl.sigmaPadA + ccl.nAttachedClusters,            CTF::BLCsigmaPadA,         o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsigmaPadA],         &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.sigmaTimeA,        ccl.sigmaTimeA + ccl.nAttachedClusters,           CTF::BLCsigmaTimeA,        o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsigmaTimeA],        &buff, dict, ebParam.chunkSize, ebParam.nThreads);  
+  ENCODE(ccl.qPtA,              ccl.qPtA + ccl.nTracks,                           CTF::BLCqPtA,              o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCqPtA],              &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.rowA,              ccl.rowA + ccl.nTracks,                           CTF::BLCrowA,              o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCrowA],              &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.sliceA,            ccl.sliceA + ccl.nTracks,                         CTF::BLCsliceA,            o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsliceA],            &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.timeA,             ccl.timeA + ccl.nTracks,                          CTF::BLCtimeA,             o2::rans::ProbabilityBits25Bit, optField[CTF::BLCtimeA],             &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.padA,              ccl.padA + ccl.nTracks,                           CTF::BLCpadA,              o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpadA],              &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.qTotU,             ccl.qTotU + ccl.nUnattachedClusters,              CTF::BLCqTotU,             o2::rans::ProbabilityBits16Bit, optField[CTF::BLCqTotU],             &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.qMaxU,             ccl.qMaxU + ccl.nUnattachedClusters,              CTF::BLCqMaxU,             o2::rans::ProbabilityBits16Bit, optField[CTF::BLCqMaxU],             &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.flagsU,            ccl.flagsU + ccl.nUnattachedClusters,             CTF::BLCflagsU,            o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCflagsU],            &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.padDiffU,          ccl.padDiffU + ccl.nUnattachedClusters,           CTF::BLCpadDiffU,          o2::rans::ProbabilityBits16Bit, optField[CTF::BLCpadDiffU],          &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.timeDiffU,         ccl.timeDiffU + ccl.nUnattachedClusters,          CTF::BLCtimeDiffU,         o2::rans::ProbabilityBits25Bit, optField[CTF::BLCtimeDiffU],         &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.sigmaPadU,         ccl.sigmaPadU + ccl.nUnattachedClusters,          CTF::BLCsigmaPadU,         o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsigmaPadU],         &buff, dict, ebParam.chunkSize, ebParam.nThreads); 
+  ENCODE(ccl.sigmaTimeU,        ccl.sigmaTimeU + ccl.nUnattachedClusters,         CTF::BLCsigmaTimeU,        o2::rans::ProbabilityBits8Bit,  optField[CTF::BLCsigmaTimeU],        &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.nTrackClusters,    ccl.nTrackClusters + ccl.nTracks,                 CTF::BLCnTrackClusters,    o2::rans::ProbabilityBits16Bit, optField[CTF::BLCnTrackClusters],    &buff, dict, ebParam.chunkSize, ebParam.nThreads);
+  ENCODE(ccl.nSliceRowClusters, ccl.nSliceRowClusters + ccl.nSliceRows,           CTF::BLCnSliceRowClusters, o2::rans::ProbabilityBits25Bit, optField[CTF::BLCnSliceRowClusters], &buff, dict, ebParam.chunkSize, ebParam.nThreads);
   // clang-format on
 }
 
 /// decode entropy-encoded bloks to TPC CompressedClusters into the externally provided vector (e.g. PMR vector from DPL)
 template <typename VEC>
-void CTFCoder::decode(const CTF::base& ec, VEC& buffVec)
+void CTFCoder::decode(const CTF::base& ec, VEC& buffVec, const o2::ctf::CTFDictionary* dict)
 {
   CompressedClusters cc;
   CompressedClustersCounters& ccCount = cc;
@@ -148,31 +150,32 @@ void CTFCoder::decode(const CTF::base& ec, VEC& buffVec)
   setCompClusAddresses(cc, buff);
   ccFlat->set(sz, cc); // set offsets
 
+  const auto& ebParam = o2::ctf::EncodedBlocksParam::Instance(); // chunking and threading of the entropy coding
   // decode encoded data directly to destination buff
   // clang-format off
-  ec.decode(cc.qTotA,             CTF::BLCqTotA);
-  ec.decode(cc.qMaxA,             CTF::BLCqMaxA);
-  ec.decode(cc.flagsA,            CTF::BLCflagsA);
-  ec.decode(cc.rowDiffA,          CTF::BLCrowDiffA);
-  ec.decode(cc.sliceLegDiffA,     CTF::BLCsliceLegDiffA);
-  ec.decode(cc.padResA,           CTF::BLCpadResA);
-  ec.decode(cc.timeResA,          CTF::BLCtimeResA);
-  ec.decode(cc.sigmaPadA,         CTF::BLCsigmaPadA);
-  ec.decode(cc.sigmaTimeA,        CTF::BLCsigmaTimeA);
-  ec.decode(cc.qPtA,              CTF::BLCqPtA);
-  ec.decode(cc.rowA,              CTF::BLCrowA);
-  ec.decode(cc.sliceA,            CTF::BLCsliceA);
-  ec.decode(cc.timeA,             CTF::BLCtimeA);
-  ec.decode(cc.padA,              CTF::BLCpadA);
-  ec.decode(cc.qTotU,             CTF::BLCqTotU);
-  ec.decode(cc.qMaxU,             CTF::BLCqMaxU);
-  ec.decode(cc.flagsU,            CTF::BLCflagsU);
-  ec.decode(cc.padDiffU,          CTF::BLCpadDiffU);
-  ec.decode(cc.timeDiffU,         CTF::BLCtimeDiffU);
-  ec.decode(cc.sigmaPadU,         CTF::BLCsigmaPadU);
-  ec.decode(cc.sigmaTimeU,        CTF::BLCsigmaTimeU);
-  ec.decode(cc.nTrackClusters,    CTF::BLCnTrackClusters);
-  ec.decode(cc.nSliceRowClusters, CTF::BLCnSliceRowClusters);
+  ec.decode(cc.qTotA,             CTF::BLCqTotA, dict, ebParam.nThreads);
+  ec.decode(cc.qMaxA,             CTF::BLCqMaxA, dict, ebParam.nThreads);
+  ec.decode(cc.flagsA,            CTF::BLCflagsA, dict, ebParam.nThreads);
+  ec.decode(cc.rowDiffA,          CTF::BLCrowDiffA, dict, ebParam.nThreads);
+  ec.decode(cc.sliceLegDiffA,     CTF::BLCsliceLegDiffA, dict, ebParam.nThreads);
+  ec.decode(cc.padResA,           CTF::BLCpadResA, dict, ebParam.nThreads);
+  ec.decode(cc.timeResA,          CTF::BLCtimeResA, dict, ebParam.nThreads);
+  ec.decode(cc.sigmaPadA,         CTF::BLCsigmaPadA, dict, ebParam.nThreads);
+  ec.decode(cc.sigmaTimeA,        CTF::BLCsigmaTimeA, dict, ebParam.nThreads);
+  ec.decode(cc.qPtA,              CTF::BLCqPtA, dict, ebParam.nThreads);
+  ec.decode(cc.rowA,              CTF::BLCrowA, dict, ebParam.nThreads);
+  ec.decode(cc.sliceA,            CTF::BLCsliceA, dict, ebParam.nThreads);
+  ec.decode(cc.timeA,             CTF::BLCtimeA, dict, ebParam.nThreads);
+  ec.decode(cc.padA,              CTF::BLCpadA, dict, ebParam.nThreads);
+  ec.decode(cc.qTotU,             CTF::BLCqTotU, dict, ebParam.nThreads);
+  ec.decode(cc.qMaxU,             CTF::BLCqMaxU, dict, ebParam.nThreads);
+  ec.decode(cc.flagsU,            CTF::BLCflagsU, dict, ebParam.nThreads);
+  ec.decode(cc.padDiffU,          CTF::BLCpadDiffU, dict, ebParam.nThreads);
+  ec.decode(cc.timeDiffU,         CTF::BLCtimeDiffU, dict, ebParam.nThreads);
+  ec.decode(cc.sigmaPadU,         CTF::BLCsigmaPadU, dict, ebParam.nThreads);
+  ec.decode(cc.sigmaTimeU,        CTF::BLCsigmaTimeU, dict, ebParam.nThreads);
+  ec.decode(cc.nTrackClusters,    CTF::BLCnTrackClusters, dict, ebParam.nThreads);
+  ec.decode(cc.nSliceRowClusters, CTF::BLCnSliceRowClusters, dict, ebParam.nThreads);
   // clang-format on
 }
 
@@ -21,11 +21,40 @@
 #include "TPCBase/Mapper.h"
 #include "MathUtils/RandomRing.h"
 
+#include <vector>
+
 namespace o2
 {
 namespace tpc
 {
 
+/// \struct ElectronBatch
+/// Primary electrons of one hit, stored as structure of arrays for the vectorized transport.
+/// The arrays are padded to a multiple of the SIMD width, only the first size() entries are meaningful.
+struct ElectronBatch {
+  std::vector<float> x;         ///< x position after the drift
+  std::vector<float> y;         ///< y position after the drift
+  std::vector<float> z;         ///< z position after the drift
+  std::vector<float> driftTime; ///< drift time taking into account the diffusion in z direction
+  std::vector<float> random;    ///< workspace for the random numbers
+  std::vector<char> isAttached; ///< flag whether the electron was attached during the drift
+  size_t nElectrons = 0;
+
+  /// Set the number of electrons in the batch
+  void resize(size_t n)
+  {
+    nElectrons = n;
+    const size_t nPadded = (n + Vc::float_v::Size - 1) / Vc::float_v::Size * Vc::float_v::Size;
+    for (auto* v : {&x, &y, &z, &driftTime, &random}) {
+      v->resize(nPadded);
+    }
+    isAttached.resize(nPadded);
+  }
+
+  size_t size() const { return nElectrons; }
+  size_t paddedSize() const { return x.size(); }
+};
+
 /// \class ElectronTransport
 /// This class handles the electron transport in the active volume of the TPC.
 /// In particular, in deals with the diffusion of the charge cloud while drifting towards the readout chambers and the
@@ -34,9 +63,10 @@ namespace tpc
 class ElectronTransport
 {
  public:
+  /// One instance per thread, as the random rings are not shared
   static ElectronTransport& instance()
   {
-    static ElectronTransport electronTransport;
+    static thread_local ElectronTransport electronTransport;
     return electronTransport;
   }
 
@@ -52,6 +82,11 @@ class ElectronTransport
   /// \return GlobalPosition3D with position of the electrons after the drift taking into account diffusion
   GlobalPosition3D getElectronDrift(GlobalPosition3D posEle, float& driftTime);
 
+  /// Drift of a batch of electrons starting from the same position, vectorized version of getElectronDrift
+  /// \param posEle GlobalPosition3D with start position of the electrons
+  /// \param electrons Batch to be filled with the positions and drift times of the electrons after the drift
+  void getElectronDrift(GlobalPosition3D posEle, ElectronBatch& electrons);
+
   /// Drift of electrons in electric field taking into account diffusion with 3 sigma of the width
   /// \param posEle GlobalPosition3D with start position of the electrons
   /// \return GlobalPosition3D with position of the electrons after the drift taking into account diffusion with
@@ -63,6 +98,10 @@ class ElectronTransport
   /// \return Boolean whether the electron is attached (and lost) or not
   bool isElectronAttachment(float driftTime);
 
+  /// Attachment for a batch of electrons, vectorized version of isElectronAttachment
+  /// \param electrons Batch of drifted electrons, for which the attachment flags are set
+  void getElectronAttachment(ElectronBatch& electrons);
+
   /// Compute electron drift time from z position
   /// \param zPos z position of the charge
   /// \param signChange If the zPosition of the charge is shifted to the other TPC side, the drift length needs to be
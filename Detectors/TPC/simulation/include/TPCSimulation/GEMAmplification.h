@@ -20,6 +20,7 @@
 #include "TPCBase/ParameterGEM.h"
 #include "TPCBase/CRU.h"
 #include "TPCBase/PadPos.h"
+#include "TPCBase/DigitPos.h"
 #include "TPCBase/CalDet.h"
 
 namespace o2
@@ -35,10 +36,10 @@ namespace tpc
 class GEMAmplification
 {
  public:
-  /// Default constructor
+  /// Default constructor, one instance per thread as the random rings are not shared
   static GEMAmplification& instance()
   {
-    static GEMAmplification gemAmplification;
+    static thread_local GEMAmplification gemAmplification;
     return gemAmplification;
   }
 
@@ -67,6 +68,13 @@ class GEMAmplification
   /// \return Number of electrons after amplification in a full stack of four GEM foils
   int getStackAmplification(const CRU& cru, const PadPos& pos, const AmplificationMode mode, int nElectrons = 1);
 
+  /// Compute the number of electrons after amplification for a batch of single electrons
+  /// taking into account local variations of the electron amplification. The effective mode is vectorized
+  /// \param digitPos Positions where the electrons arrive
+  /// \param mode Amplification mode (full or effective)
+  /// \param nElectronsGEM Output number of electrons after amplification, one entry per electron
+  void getStackAmplification(const std::vector<DigitPos>& digitPos, const AmplificationMode mode, std::vector<int>& nElectronsGEM);
+
   /// Compute the number of electrons after amplification in a single GEM foil
   /// taking into account collection and extraction efficiencies and fluctuations of the GEM amplification
   /// \param nElectrons Number of electrons to be amplified
@@ -104,6 +112,9 @@ class GEMAmplification
   const ParameterGEM* mGEMParam; ///< Caching of the parameter class to avoid multiple CDB calls
   const ParameterGas* mGasParam; ///< Caching of the parameter class to avoid multiple CDB calls
   const CalPad* mGainMap;        ///< Caching of the parameter class to avoid multiple CDB calls
+
+  std::vector<float> mRandomBlock; ///< Workspace for the block-filled flat random values
+  std::vector<float> mGainBlock;   ///< Workspace for the block-filled gain values
 };
 
 inline int GEMAmplification::getStackAmplification(const CRU& cru, const PadPos& pos, const AmplificationMode mode, int nElectrons)
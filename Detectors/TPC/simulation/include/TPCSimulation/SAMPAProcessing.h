@@ -39,9 +39,10 @@ namespace tpc
 class SAMPAProcessing
 {
  public:
+  /// One instance per thread, as the random ring for the noise is not shared
   static SAMPAProcessing& instance()
   {
-    static SAMPAProcessing sampaProcessing;
+    static thread_local SAMPAProcessing sampaProcessing;
     return sampaProcessing;
   }
   /// Destructor
@@ -52,18 +52,24 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
   auto& eleParam = ParameterElectronics::Instance();
   auto& gemParam = ParameterGEM::Instance();
 
-  static GEMAmplification& gemAmplification = GEMAmplification::instance();
+  static thread_local GEMAmplification& gemAmplification = GEMAmplification::instance();
   gemAmplification.updateParameters();
-  static ElectronTransport& electronTransport = ElectronTransport::instance();
+  static thread_local ElectronTransport& electronTransport = ElectronTransport::instance();
   electronTransport.updateParameters();
-  static SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
+  static thread_local SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
   sampaProcessing.updateParameters();
 
   const int nShapedPoints = eleParam.NShapedPoints;
   const auto amplificationMode = gemParam.AmplMode;
-  static std::vector<float> signalArray;
+  static thread_local std::vector<float> signalArray;
   signalArray.resize(nShapedPoints);
 
+  /// Workspace for the electrons of one hit and for those reaching the readout
+  static thread_local ElectronBatch electrons;
+  static thread_local std::vector<DigitPos> electronPos;
+  static thread_local std::vector<float> electronTime;
+  static thread_local std::vector<int> nElectronsGEM;
+
   /// Reserve space in the digit container for the current event
   mDigitContainer.reserve(sampaProcessing.getTimeBinFromTime(mEventTime));
 
@@ -91,15 +97,22 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
       /// The energy loss stored corresponds to nElectrons
       const int nPrimaryElectrons = static_cast<int>(eh.GetEnergyLoss());
       const float hitTime = eh.GetTime() * 0.001; /// in us
-      float driftTime = 0.f;
 
       /// TODO: add primary ions to space-charge density
 
+      /// Drift, diffusion and attachment of all electrons of the hit at once
+      electrons.resize(nPrimaryElectrons);
+      electronTransport.getElectronDrift(posEle, electrons);
+      electronTransport.getElectronAttachment(electrons);
+      electronPos.clear();
+      electronTime.clear();
+
       /// Loop over electrons
       for (int iEle = 0; iEle < nPrimaryElectrons; ++iEle) {
 
         /// Drift and Diffusion
-        const GlobalPosition3D posEleDiff = electronTransport.getElectronDrift(posEle, driftTime);
+        const GlobalPosition3D posEleDiff(electrons.x[iEle], electrons.y[iEle], electrons.z[iEle]);
+        const float driftTime = electrons.driftTime[iEle];
         const float eleTime = driftTime + hitTime; /// in us
         if (eleTime > maxEleTime) {
           LOG(WARNING) << "Skipping electron with driftTime " << driftTime << " from hit at time " << hitTime;
@@ -108,7 +121,7 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
         const float absoluteTime = eleTime + mEventTime; /// in us
 
         /// Attachment
-        if (electronTransport.isElectronAttachment(driftTime)) {
+        if (electrons.isAttached[iEle]) {
           continue;
         }
 
@@ -133,15 +146,23 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
           continue;
         }
 
-        /// Electron amplification
-        const int nElectronsGEM = gemAmplification.getStackAmplification(digiPadPos.getCRU(), digiPadPos.getPadPos(), amplificationMode);
-        if (nElectronsGEM == 0) {
+        electronPos.emplace_back(digiPadPos);
+        electronTime.emplace_back(absoluteTime);
+      }
+      /// end of loop over electrons
+
+      /// Electron amplification
+      gemAmplification.getStackAmplification(electronPos, amplificationMode, nElectronsGEM);
+
+      const MCCompLabel label(MCTrackID, eventID, sourceID, false);
+      for (size_t iEle = 0; iEle < electronPos.size(); ++iEle) {
+        if (nElectronsGEM[iEle] == 0) {
           continue;
         }
-
+        const DigitPos& digiPadPos = electronPos[iEle];
+        const float absoluteTime = electronTime[iEle];
         const GlobalPadNumber globalPad = mapper.globalPadNumber(digiPadPos.getGlobalPadPos());
-        const float ADCsignal = sampaProcessing.getADCvalue(static_cast<float>(nElectronsGEM));
-        const MCCompLabel label(MCTrackID, eventID, sourceID, false);
+        const float ADCsignal = sampaProcessing.getADCvalue(static_cast<float>(nElectronsGEM[iEle]));
         sampaProcessing.getShapedSignal(ADCsignal, absoluteTime, signalArray);
         for (float i = 0; i < nShapedPoints; ++i) {
           const float time = absoluteTime + i * eleParam.ZbinWidth;
@@ -150,7 +171,6 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
         }
         /// TODO: add ion backflow to space-charge density
       }
-      /// end of loop over electrons
     }
   }
 }
@@ -160,7 +180,7 @@ void Digitizer::flush(std::vector<o2::tpc::Digit>& digits,
                       std::vector<o2::tpc::CommonMode>& commonModeOutput,
                       bool finalFlush)
 {
-  static SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
+  static thread_local SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
   mDigitContainer.fillOutputContainer(digits, labels, commonModeOutput, mSector, sampaProcessing.getTimeBinFromTime(mEventTime), mIsContinuous, finalFlush);
 }
 
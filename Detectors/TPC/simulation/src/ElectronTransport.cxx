@@ -65,6 +65,63 @@ GlobalPosition3D ElectronTransport::getElectronDrift(GlobalPosition3D posEle, fl
   return posEleDiffusion;
 }
 
+void ElectronTransport::getElectronDrift(GlobalPosition3D posEle, ElectronBatch& electrons)
+{
+  using Vc::float_v;
+
+  /// For drift lengths shorter than 1 mm, the drift length is set to that value
+  float driftl = mDetParam->TPClength - std::abs(posEle.Z());
+  if (driftl < 0.01) {
+    driftl = 0.01;
+  }
+  driftl = std::sqrt(driftl);
+  const float_v sigT(driftl * mGasParam->DiffT);
+  const float_v sigL(driftl * mGasParam->DiffL);
+
+  /// The random numbers are copied block-wise into the arrays and then turned into positions in place
+  const size_t nPadded = electrons.paddedSize();
+  mRandomGaus.fillNextValues(electrons.x.data(), nPadded);
+  mRandomGaus.fillNextValues(electrons.y.data(), nPadded);
+  mRandomGaus.fillNextValues(electrons.z.data(), nPadded);
+
+  const float_v startX(posEle.X());
+  const float_v startY(posEle.Y());
+  const float_v startZ(posEle.Z());
+  const float_v tpcLength(mDetParam->TPClength);
+  const float_v driftV(mGasParam->DriftV);
+  for (size_t i = 0; i < nPadded; i += float_v::Size) {
+    const float_v x = float_v(&electrons.x[i], Vc::Unaligned) * sigT + startX;
+    const float_v y = float_v(&electrons.y[i], Vc::Unaligned) * sigT + startY;
+    const float_v z = float_v(&electrons.z[i], Vc::Unaligned) * sigL + startZ;
+
+    /// Same treatment of a sign change in the z position as for single electrons
+    const auto signChange = startZ / z < float_v::Zero();
+    const float_v absZ = Vc::abs(z);
+    const float_v driftTime = Vc::iif(signChange, tpcLength + absZ, tpcLength - absZ) / driftV;
+
+    x.store(&electrons.x[i], Vc::Unaligned);
+    y.store(&electrons.y[i], Vc::Unaligned);
+    Vc::iif(signChange, startZ, z).store(&electrons.z[i], Vc::Unaligned);
+    driftTime.store(&electrons.driftTime[i], Vc::Unaligned);
+  }
+}
+
+void ElectronTransport::getElectronAttachment(ElectronBatch& electrons)
+{
+  using Vc::float_v;
+
+  const size_t nPadded = electrons.paddedSize();
+  mRandomFlat.fillNextValues(electrons.random.data(), nPadded);
+
+  const float_v attachmentProbability(mGasParam->AttCoeff * mGasParam->OxygenCont);
+  for (size_t i = 0; i < nPadded; i += float_v::Size) {
+    const auto isAttached = float_v(&electrons.random[i], Vc::Unaligned) < attachmentProbability * float_v(&electrons.driftTime[i], Vc::Unaligned);
+    for (size_t j = 0; j < float_v::Size; ++j) {
+      electrons.isAttached[i + j] = isAttached[j];
+    }
+  }
+}
+
 bool ElectronTransport::isCompletelyOutOfSectorCoarseElectronDrift(GlobalPosition3D posEle, const Sector& sector) const
 {
   /// For drift lengths shorter than 1 mm, the drift length is set to that value
@@ -18,12 +18,19 @@
 #include <TFile.h>
 #include "TPCBase/CDBInterface.h"
 #include <fstream>
+#include <mutex>
 #include "FairLogger.h"
 
 using namespace o2::tpc;
 using namespace o2::math_utils;
 using boost::format;
 
+namespace
+{
+/// the instances of the different threads share the cache file of the polya distributions
+std::mutex polyaCacheMutex;
+} // namespace
+
 GEMAmplification::GEMAmplification()
   : mRandomGaus(),
     mRandomFlat(RandomRing<>::RandomType::Flat),
@@ -31,6 +38,7 @@ GEMAmplification::GEMAmplification()
 {
   updateParameters();
 
+  std::lock_guard<std::mutex> lock(polyaCacheMutex);
   TStopwatch watch;
   watch.Start();
   const float sigmaOverMu = mGasParam->SigmaOverMu;
@@ -126,6 +134,39 @@ int GEMAmplification::getStackAmplification(int nElectrons)
   return nElectronsGEM4;
 }
 
+void GEMAmplification::getStackAmplification(const std::vector<DigitPos>& digitPos, const AmplificationMode mode, std::vector<int>& nElectronsGEM)
+{
+  const size_t n = digitPos.size();
+  nElectronsGEM.resize(n);
+  if (mode != AmplificationMode::EffectiveMode) {
+    for (size_t i = 0; i < n; ++i) {
+      nElectronsGEM[i] = getStackAmplification(digitPos[i].getCRU(), digitPos[i].getPadPos(), mode);
+    }
+    return;
+  }
+
+  /// Same as getEffectiveStackAmplification for single electrons, with block-filled random values
+  using Vc::float_v;
+  const size_t nPadded = (n + float_v::Size - 1) / float_v::Size * float_v::Size;
+  mRandomBlock.resize(nPadded);
+  mGainBlock.resize(nPadded);
+  mRandomFlat.fillNextValues(mRandomBlock.data(), nPadded);
+  mGainFullStack.fillNextValues(mGainBlock.data(), nPadded);
+
+  const float_v efficiency(mGEMParam->EfficiencyStack);
+  for (size_t i = 0; i < nPadded; i += float_v::Size) {
+    const float_v flat(&mRandomBlock[i], Vc::Unaligned);
+    /// the gain is truncated as in the integer sum of the single electron case
+    const float_v gain = Vc::floor(float_v(&mGainBlock[i], Vc::Unaligned));
+    Vc::iif(flat < efficiency, float_v::Zero(), gain).store(&mGainBlock[i], Vc::Unaligned);
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    const auto& pos = digitPos[i];
+    nElectronsGEM[i] = static_cast<int>(mGainBlock[i] * mGainMap->getValue(pos.getCRU(), pos.getPadPos().getRow(), pos.getPadPos().getPad()));
+  }
+}
+
 int GEMAmplification::getEffectiveStackAmplification(int nElectrons)
 {
   /// We start with an arbitrary number of electrons given to the first amplification stage
@@ -0,0 +1,147 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCDigitizerThreads.cxx
+/// \brief This task tests the digitization of TPC sectors on parallel threads
+
+#define BOOST_TEST_MODULE Test TPC DigitizerThreads
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCSimulation/Digitizer.h"
+#include "TPCSimulation/GEMAmplification.h"
+#include "TPCSimulation/SAMPAProcessing.h"
+#include "TPCSimulation/CommonMode.h"
+#include "TPCBase/CDBInterface.h"
+#include "DataFormatsTPC/Digit.h"
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include "SimulationDataFormat/MCCompLabel.h"
+#include "CommonUtils/ThreadPool.h"
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "TROOT.h"
+
+namespace o2
+{
+namespace tpc
+{
+
+/// statistics of the digits of one sector
+struct SectorStats {
+  size_t nDigits = 0;
+  double charge = 0.;
+  double meanRow = 0.;
+  double meanTime = 0.;
+};
+
+/// straight tracks crossing the sector radially at different angles and heights
+std::vector<HitGroup> createHits(int sector)
+{
+  std::vector<HitGroup> hits;
+  for (int itrack = 0; itrack < 20; ++itrack) {
+    const float phi = (sector + 0.1f + 0.04f * itrack) * 20.f * M_PI / 180.f;
+    const float z = 20.f + 8.f * itrack;
+    hits.emplace_back(itrack);
+    for (int ihit = 0; ihit < 100; ++ihit) {
+      const float r = 90.f + 1.5f * ihit;
+      hits.back().addHit(r * std::cos(phi), r * std::sin(phi), z, 0.f, 40);
+    }
+  }
+  return hits;
+}
+
+/// digitize one sector from scratch, as done by the TPC digitizer device
+SectorStats digitizeSector(Digitizer& digitizer, int sector, const std::vector<HitGroup>& hits)
+{
+  digitizer.setSector(sector);
+  digitizer.init();
+  digitizer.setStartTime(0);
+  digitizer.setEventTime(0.f);
+  digitizer.process(hits, 0, 0);
+
+  std::vector<Digit> digits;
+  o2::dataformats::MCTruthContainer<o2::MCCompLabel> labels;
+  std::vector<CommonMode> commonMode;
+  digitizer.flush(digits, labels, commonMode, true);
+
+  SectorStats stats;
+  stats.nDigits = digits.size();
+  for (const auto& digit : digits) {
+    stats.charge += digit.getChargeFloat();
+    stats.meanRow += digit.getChargeFloat() * digit.getRow();
+    stats.meanTime += digit.getChargeFloat() * digit.getTimeStamp();
+  }
+  if (stats.charge > 0.) {
+    stats.meanRow /= stats.charge;
+    stats.meanTime /= stats.charge;
+  }
+  return stats;
+}
+
+/// \brief Test of the digitization of sectors on parallel threads
+/// Each thread has its own digitizer and its own transport, amplification and SAMPA instances, as with
+/// --TPCsectorThreads in the digitizer workflow. The random numbers differ between the threads,
+/// so the digits of each sector must have the same statistics as with a single thread, not the same values
+BOOST_AUTO_TEST_CASE(DigitizerThreads_test)
+{
+  auto& cdb = CDBInterface::instance();
+  cdb.setUseDefaults();
+  Digitizer::setContinuousReadout(true);
+
+  const int nSectors = 8;
+  const int nThreads = 4;
+  std::vector<std::vector<HitGroup>> hits;
+  for (int sector = 0; sector < nSectors; ++sector) {
+    hits.emplace_back(createHits(sector));
+  }
+
+  /// reference: all sectors digitized one after the other on this thread
+  std::vector<SectorStats> statsSerial(nSectors);
+  {
+    Digitizer digitizer;
+    for (int sector = 0; sector < nSectors; ++sector) {
+      statsSerial[sector] = digitizeSector(digitizer, sector, hits[sector]);
+    }
+  }
+
+  /// the calibration objects are created on first use, make sure this happens before the threads start
+  ROOT::EnableThreadSafety();
+  GEMAmplification::instance().updateParameters();
+  SAMPAProcessing::instance().updateParameters();
+
+  std::vector<std::unique_ptr<Digitizer>> digitizers;
+  for (int i = 0; i < nThreads; ++i) {
+    digitizers.emplace_back(std::make_unique<Digitizer>());
+  }
+  std::vector<SectorStats> statsThreads(nSectors);
+  std::atomic<int> nextSector{0};
+  o2::utils::ThreadPool pool(nThreads);
+  pool.run([&](int slot) {
+    for (int sector = nextSector++; sector < nSectors; sector = nextSector++) {
+      statsThreads[sector] = digitizeSector(*digitizers[slot], sector, hits[sector]);
+    }
+  });
+
+  for (int sector = 0; sector < nSectors; ++sector) {
+    BOOST_TEST_MESSAGE("sector " << sector << ": " << statsSerial[sector].nDigits << " digits with one thread, "
+                                 << statsThreads[sector].nDigits << " with " << nThreads << " threads");
+    BOOST_CHECK(statsSerial[sector].nDigits > 0);
+    BOOST_CHECK_CLOSE(static_cast<float>(statsThreads[sector].nDigits), static_cast<float>(statsSerial[sector].nDigits), 5.f);
+    BOOST_CHECK_CLOSE(statsThreads[sector].charge, statsSerial[sector].charge, 5.);
+    BOOST_CHECK_CLOSE(statsThreads[sector].meanRow, statsSerial[sector].meanRow, 1.);
+    BOOST_CHECK_CLOSE(statsThreads[sector].meanTime, statsSerial[sector].meanTime, 1.);
+  }
+}
+} // namespace tpc
+} // namespace o2
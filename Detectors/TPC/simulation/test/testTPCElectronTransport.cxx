@@ -21,6 +21,8 @@
 #include "TPCBase/ParameterDetector.h"
 #include "TPCBase/CDBInterface.h"
 
+#include <algorithm>
+
 #include "TH1D.h"
 #include "TF1.h"
 
@@ -120,6 +122,55 @@ BOOST_AUTO_TEST_CASE(ElectronDiffusion_test2)
   BOOST_CHECK_CLOSE(gausZ.GetParameter(2), gasParam.DiffL, 0.5);
 }
 
+/// \brief Test of the vectorized getElectronDrift function
+/// Same as test 1 for a batch of electrons, whose size is not a multiple
+/// of the SIMD width. In addition the drift times have to correspond
+/// to the smeared z positions
+///
+/// Precision: 0.5 %.
+BOOST_AUTO_TEST_CASE(ElectronDiffusion_batch_test)
+{
+  auto& gasParam = ParameterGas::Instance();
+  auto& detParam = ParameterDetector::Instance();
+  const GlobalPosition3D posEle(10.f, 10.f, 10.f);
+  TH1D hTestDiffX("hTestDiffX", "", 500, posEle.X() - 10., posEle.X() + 10.);
+  TH1D hTestDiffY("hTestDiffY", "", 500, posEle.Y() - 10., posEle.Y() + 10.);
+  TH1D hTestDiffZ("hTestDiffZ", "", 500, posEle.Z() - 10., posEle.Z() + 10.);
+
+  TF1 gausX("gausX", "gaus");
+  TF1 gausY("gausY", "gaus");
+  TF1 gausZ("gausZ", "gaus");
+
+  static ElectronTransport& electronTransport = ElectronTransport::instance();
+  ElectronBatch electrons;
+  electrons.resize(500003);
+  electronTransport.getElectronDrift(posEle, electrons);
+
+  for (size_t i = 0; i < electrons.size(); ++i) {
+    hTestDiffX.Fill(electrons.x[i]);
+    hTestDiffY.Fill(electrons.y[i]);
+    hTestDiffZ.Fill(electrons.z[i]);
+    BOOST_CHECK_CLOSE(electrons.driftTime[i], electronTransport.getDriftTime(electrons.z[i]), 1e-3);
+  }
+
+  hTestDiffX.Fit("gausX", "Q0");
+  hTestDiffY.Fit("gausY", "Q0");
+  hTestDiffZ.Fit("gausZ", "Q0");
+
+  // check whether the mean of the gaussian fit matches the starting point
+  BOOST_CHECK_CLOSE(gausX.GetParameter(1), posEle.X(), 0.5);
+  BOOST_CHECK_CLOSE(gausY.GetParameter(1), posEle.Y(), 0.5);
+  BOOST_CHECK_CLOSE(gausZ.GetParameter(1), posEle.Z(), 0.5);
+
+  // check whether the width of the distribution matches the expected one
+  const float sigT = std::sqrt(detParam.TPClength - posEle.Z()) * gasParam.DiffT;
+  const float sigL = std::sqrt(detParam.TPClength - posEle.Z()) * gasParam.DiffL;
+
+  BOOST_CHECK_CLOSE(gausX.GetParameter(2), sigT, 0.5);
+  BOOST_CHECK_CLOSE(gausY.GetParameter(2), sigT, 0.5);
+  BOOST_CHECK_CLOSE(gausZ.GetParameter(2), sigL, 0.5);
+}
+
 /// \brief Test of the isElectronAttachment function
 /// We let the electrons drift for 100 us and compare the fraction
 /// of lost electrons to the expected value
@@ -142,5 +193,25 @@ BOOST_AUTO_TEST_CASE(ElectronAttatchment_test_1)
   BOOST_CHECK_CLOSE(lostElectrons / nEvents,
                     gasParam.AttCoeff * gasParam.OxygenCont * driftTime, 0.5);
 }
+
+/// \brief Test of the vectorized getElectronAttachment function
+/// Same as the test of isElectronAttachment for a batch of electrons
+///
+/// Precision: 0.5 %.
+BOOST_AUTO_TEST_CASE(ElectronAttatchment_batch_test)
+{
+  auto& gasParam = ParameterGas::Instance();
+  static ElectronTransport& electronTransport = ElectronTransport::instance();
+
+  const float driftTime = 100.f;
+  ElectronBatch electrons;
+  electrons.resize(1000000);
+  std::fill(electrons.driftTime.begin(), electrons.driftTime.end(), driftTime);
+  electronTransport.getElectronAttachment(electrons);
+
+  const float lostElectrons = std::count(electrons.isAttached.begin(), electrons.isAttached.begin() + electrons.size(), 1);
+  BOOST_CHECK_CLOSE(lostElectrons / electrons.size(),
+                    gasParam.AttCoeff * gasParam.OxygenCont * driftTime, 0.5);
+}
 } // namespace tpc
 } // namespace o2
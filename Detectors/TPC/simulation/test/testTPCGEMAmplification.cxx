@@ -20,6 +20,11 @@
 #include "TPCBase/ParameterGas.h"
 #include "TPCBase/ParameterGEM.h"
 #include "TPCBase/CDBInterface.h"
+#include "TPCBase/CRU.h"
+#include "TPCBase/DigitPos.h"
+#include "TPCBase/PadPos.h"
+
+#include <vector>
 
 #include "TH1D.h"
 #include "TF1.h"
@@ -85,6 +90,64 @@ BOOST_AUTO_TEST_CASE(GEMamplification_effective_test)
   BOOST_CHECK_CLOSE(energyResolution, 12.4f, 0.5f);
 }
 
+/// \brief Test of the batched effective GEM amplification
+/// The electrons of a batch are amplified at once, with block-filled random values:
+/// the gain distribution must be the same as for the amplification of the electrons one by one
+BOOST_AUTO_TEST_CASE(GEMamplification_effective_batch_test)
+{
+  auto& cdb = CDBInterface::instance();
+  cdb.setUseDefaults();
+  static GEMAmplification& gemStack = GEMAmplification::instance();
+  TH1D hSingle("hSingle", "", 10000, 0, 100000);
+  TH1D hBatch("hBatch", "", 10000, 0, 100000);
+  TH1D hStackSingle("hStackSingle", "", 100000, 0, 1000000);
+  TH1D hStackBatch("hStackBatch", "", 100000, 0, 1000000);
+  TF1 gaus("gaus", "gaus");
+
+  const int nEleIn = 158; /// Number of electrons liberated in Ne-CO2-N2 by an incident Fe-55 photon
+  const CRU cru(0);
+  const PadPos padPos(10, 20);
+  const std::vector<DigitPos> digitPos(nEleIn, DigitPos(cru, padPos));
+  std::vector<int> nElectronsGEM;
+  int nLostSingle = 0, nLostBatch = 0;
+
+  for (int i = 0; i < 10000; ++i) {
+    int stackSingle = 0;
+    for (int iEle = 0; iEle < nEleIn; ++iEle) {
+      const int nEle = gemStack.getStackAmplification(cru, padPos, AmplificationMode::EffectiveMode);
+      hSingle.Fill(nEle);
+      nLostSingle += (nEle == 0);
+      stackSingle += nEle;
+    }
+    hStackSingle.Fill(stackSingle);
+
+    gemStack.getStackAmplification(digitPos, AmplificationMode::EffectiveMode, nElectronsGEM);
+    BOOST_REQUIRE_EQUAL(static_cast<int>(nElectronsGEM.size()), nEleIn);
+    int stackBatch = 0;
+    for (const auto nEle : nElectronsGEM) {
+      hBatch.Fill(nEle);
+      nLostBatch += (nEle == 0);
+      stackBatch += nEle;
+    }
+    hStackBatch.Fill(stackBatch);
+  }
+
+  /// Single electrons: same fraction of losses, same mean and width of the gain
+  BOOST_CHECK_CLOSE(static_cast<float>(nLostBatch), static_cast<float>(nLostSingle), 2.f);
+  BOOST_CHECK_CLOSE(hBatch.GetMean(), hSingle.GetMean(), 1.f);
+  BOOST_CHECK_CLOSE(hBatch.GetRMS(), hSingle.GetRMS(), 1.f);
+
+  /// Full Fe-55 signal: same gain and energy resolution
+  hStackSingle.Fit("gaus", "Q0");
+  const float gainSingle = gaus.GetParameter(1);
+  const float resolutionSingle = gaus.GetParameter(2) / gaus.GetParameter(1) * 100.f;
+  hStackBatch.Fit("gaus", "Q0");
+  const float gainBatch = gaus.GetParameter(1);
+  const float resolutionBatch = gaus.GetParameter(2) / gaus.GetParameter(1) * 100.f;
+  BOOST_CHECK_CLOSE(gainBatch, gainSingle, 1.f);
+  BOOST_CHECK_CLOSE(resolutionBatch, resolutionSingle, 5.f);
+}
+
 /// \brief Test of the getSingleGEMAmplification function
 /// We filter 1000 electrons through a single GEM and compare to the outcome
 BOOST_AUTO_TEST_CASE(GEMamplification_singleGEM_test)
@@ -16,7 +16,9 @@
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/Task.h"
 #include "Headers/DataHeader.h"
+#include "DetectorsCommonDataFormats/CTFDictionary.h"
 #include <TStopwatch.h>
+#include <memory>
 
 namespace o2
 {
@@ -36,6 +38,7 @@ class EntropyDecoderSpec : public o2::framework::Task
   void run(o2::framework::ProcessingContext& pc) final;
 
  private:
+  std::unique_ptr<o2::ctf::CTFDictionary> mCTFDict; // optional external dictionary
   TStopwatch mTimer;
 };
 
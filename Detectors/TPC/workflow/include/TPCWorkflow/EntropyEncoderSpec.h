@@ -17,7 +17,9 @@
 
 #include "Framework/DataProcessorSpec.h"
 #include "Framework/Task.h"
+#include "DetectorsCommonDataFormats/CTFDictionary.h"
 #include <TStopwatch.h>
+#include <memory>
 
 namespace o2
 {
@@ -33,11 +35,13 @@ class EntropyEncoderSpec : public o2::framework::Task
     mTimer.Reset();
   }
   ~EntropyEncoderSpec() override = default;
+  void init(o2::framework::InitContext& ic) final;
   void run(o2::framework::ProcessingContext& pc) final;
   void endOfStream(o2::framework::EndOfStreamContext& ec) final;
 
  private:
   bool mFromFile = false;
+  std::unique_ptr<o2::ctf::CTFDictionary> mCTFDict; // optional external dictionary
   TStopwatch mTimer;
 };
 
@@ -27,7 +27,11 @@ namespace tpc
 
 void EntropyDecoderSpec::init(InitContext& ic)
 {
-  // at the moment do nothing
+  auto dictFile = ic.options().get<std::string>("ctf-dict");
+  if (!dictFile.empty()) {
+    mCTFDict.reset(o2::ctf::CTFDictionary::loadFrom(dictFile, "TPC"));
+    LOG(INFO) << "Loaded CTF dictionary " << mCTFDict->getID() << " for " << "TPC" << " from " << dictFile;
+  }
 }
 
 void EntropyDecoderSpec::run(ProcessingContext& pc)
@@ -39,7 +43,7 @@ void EntropyDecoderSpec::run(ProcessingContext& pc)
 
   auto& compclusters = pc.outputs().make<std::vector<char>>(OutputRef{"output"});
   const auto ctfImage = o2::tpc::CTF::getImage(buff.data());
-  CTFCoder::decode(ctfImage, compclusters);
+  CTFCoder::decode(ctfImage, compclusters, mCTFDict.get());
 
   mTimer.Stop();
   LOG(INFO) << "Decoded " << buff.size() * sizeof(o2::ctf::BufferType) << " encoded bytes to "
@@ -53,7 +57,7 @@ DataProcessorSpec getEntropyDecoderSpec()
     Inputs{InputSpec{"ctf", "TPC", "CTFDATA", 0, Lifetime::Timeframe}},
     Outputs{OutputSpec{{"output"}, "TPC", "COMPCLUSTERSFLAT", 0, Lifetime::Timeframe}},
     AlgorithmSpec{adaptFromTask<EntropyDecoderSpec>()},
-    Options{}};
+    Options{{"ctf-dict", VariantType::String, "", {"File with external CTF dictionary, none if empty"}}}};
 }
 
 } // namespace tpc
@@ -27,6 +27,15 @@ namespace o2
 namespace tpc
 {
 
+void EntropyEncoderSpec::init(InitContext& ic)
+{
+  auto dictFile = ic.options().get<std::string>("ctf-dict");
+  if (!dictFile.empty()) {
+    mCTFDict.reset(o2::ctf::CTFDictionary::loadFrom(dictFile, "TPC"));
+    LOG(INFO) << "Loaded CTF dictionary " << mCTFDict->getID() << " for " << "TPC" << " from " << dictFile;
+  }
+}
+
 void EntropyEncoderSpec::run(ProcessingContext& pc)
 {
   CompressedClusters clusters;
@@ -50,7 +59,7 @@ void EntropyEncoderSpec::run(ProcessingContext& pc)
   mTimer.Start(false);
 
   auto& buffer = pc.outputs().make<std::vector<o2::ctf::BufferType>>(Output{"TPC", "CTFDATA", 0, Lifetime::Timeframe});
-  CTFCoder::encode(buffer, clusters);
+  CTFCoder::encode(buffer, clusters, mCTFDict.get());
   auto encodedBlocks = CTF::get(buffer.data()); // cast to container pointer
   encodedBlocks->compactify();                  // eliminate unnecessary padding
   buffer.resize(encodedBlocks->size());         // shrink buffer to strictly necessary size
@@ -73,7 +82,8 @@ DataProcessorSpec getEntropyEncoderSpec(bool inputFromFile)
     "tpc-entropy-encoder", // process id
     {{"input", "TPC", inputType, 0, Lifetime::Timeframe}},
     Outputs{{"TPC", "CTFDATA", 0, Lifetime::Timeframe}},
-    AlgorithmSpec(adaptFromTask<EntropyEncoderSpec>(inputFromFile))};
+    AlgorithmSpec(adaptFromTask<EntropyEncoderSpec>(inputFromFile)),
+    Options{{"ctf-dict", VariantType::String, "", {"File with external CTF dictionary, none if empty"}}}};
 }
 
 } // namespace tpc
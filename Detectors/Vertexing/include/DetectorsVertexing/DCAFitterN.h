@@ -18,6 +18,8 @@
 #include <TMath.h>
 #include <Math/SMatrix.h>
 #include <Math/SVector.h>
+#include <algorithm>
+#include <vector>
 #include "ReconstructionDataFormats/Track.h"
 #include "DetectorsVertexing/HelixHelper.h"
 
@@ -75,10 +77,12 @@ class DCAFitterN
   static constexpr double NMax = 4;
   static constexpr double NInv = 1. / N;
   static constexpr int MAXHYP = 2;
+  static constexpr int BATCHW = 8; // lanes of the crossing seeds calculation in the batch mode
 
   using Track = o2::track::TrackParCov;
   using TrackAuxPar = o2::track::TrackAuxPar;
   using CrossInfo = o2::track::CrossInfo;
+  using CrossInfoBatch = o2::track::CrossInfoBatch<BATCHW>;
 
   using Vec3D = ROOT::Math::SVector<double, 3>;
   using VecND = ROOT::Math::SVector<double, N>;
@@ -94,6 +98,8 @@ class DCAFitterN
   using ArrTrPos = std::array<Vec3D, N>;         // container of Track positions
 
  public:
+  using TrackIDs = std::array<int, N>; // indices of the candidate prongs in the pool of tracks (batch mode)
+
   static constexpr int getNProngs() { return N; }
 
   DCAFitterN() = default;
@@ -157,9 +163,22 @@ class DCAFitterN
 
   template <class... Tr>
   int process(const Tr&... args);
+
+  ///< batch mode: fit candidates given as N-tuples of indices in the common pool of tracks (no check for their validity).
+  ///  The helix parameters are calculated once per track of the pool, the crossing seeds of the helices are calculated
+  ///  for BATCHW candidates at once (see CrossInfoBatch) and the candidates w/o seeds within the max.R are rejected
+  ///  before the fit. The fits themselves are done one by one. onFit(icand) is called, in increasing icand order, for
+  ///  every candidate with at least 1 vertex, while the fitter holds its results. Returns the number of such candidates.
+  template <class F>
+  int processBatch(const std::vector<Track>& tracks, const std::vector<TrackIDs>& candidates, F&& onFit);
+
   void print() const;
 
  protected:
+  int fitCrossings();
+  void mergeCloseSeeds(CrossInfo& cross) const;
+  void selectSeeds(int icand);
+  bool acceptSeeds(const CrossInfo& cross) const;
   bool calcPCACoefs();
   bool calcInverseWeight();
   void calcResidDerivatives();
@@ -243,6 +262,10 @@ class DCAFitterN
   float mMaxChi2 = 100;          // abs cut on chi2 or abs distance
   float mMaxDist2ToMergeSeeds = 1.; // merge 2 seeds to their average if their distance^2 is below the threshold
 
+  std::vector<TrackAuxPar> mPoolAux;  //! aux info of the tracks pool in the batch mode
+  std::vector<CrossInfo> mBatchCross; //! crossing seeds of the candidates in the batch mode
+  std::vector<int> mBatchSel;         //! candidates surviving the crossing test in the batch mode
+
   ClassDefNV(DCAFitterN, 1);
 };
 
@@ -261,18 +284,120 @@ int DCAFitterN<N, Args...>::process(const Tr&... args)
   if (!mCrossings.set(mTrAux[0], *mOrigTrPtr[0], mTrAux[1], *mOrigTrPtr[1])) { // even for N>2 it should be enough to test just 1 loop
     return 0;                                  // no crossing
   }
-  if (mUseAbsDCA) {
-    calcRMatrices(); // needed for fast residuals derivatives calculation in case of abs. distance minimization
+  mergeCloseSeeds(mCrossings);
+  return fitCrossings();
+}
+
+///_________________________________________________________________________
+template <int N, typename... Args>
+template <class F>
+int DCAFitterN<N, Args...>::processBatch(const std::vector<Track>& tracks, const std::vector<TrackIDs>& candidates, F&& onFit)
+{
+  // Fit of many candidates built from the same pool of tracks
+  int nTracks = tracks.size(), nCands = candidates.size();
+  mPoolAux.resize(nTracks);
+  for (int i = 0; i < nTracks; i++) { // once per track rather than once per candidate
+    mPoolAux[i].set(tracks[i], mBz);
+  }
+  // find the crossing seeds of all candidates, keep only those having an acceptable one
+  mBatchCross.resize(nCands);
+  mBatchSel.clear();
+  CrossInfoBatch lanes;
+  std::array<int, BATCHW> laneCand;
+  int nLanes = 0;
+  auto processLanes = [&]() { // the lanes beyond nLanes are left over from the previous round and ignored
+    lanes.process();
+    for (int l = 0; l < nLanes; l++) {
+      lanes.get(l, mBatchCross[laneCand[l]]);
+      selectSeeds(laneCand[l]);
+    }
+    nLanes = 0;
+  };
+  for (int ic = 0; ic < nCands; ic++) {
+    const auto& ids = candidates[ic];
+    const auto &aux0 = mPoolAux[ids[0]], &aux1 = mPoolAux[ids[1]];
+    if (aux0.rC > o2::constants::math::Almost0 && aux1.rC > o2::constants::math::Almost0) { // 2 helices
+      laneCand[nLanes] = ic;
+      lanes.set(nLanes++, aux0, aux1);
+      if (nLanes == BATCHW) {
+        processLanes();
+      }
+    } else { // straight lines are treated one by one
+      mBatchCross[ic].set(aux0, tracks[ids[0]], aux1, tracks[ids[1]]);
+      selectSeeds(ic);
+    }
+  }
+  if (nLanes) {
+    processLanes();
+  }
+  std::sort(mBatchSel.begin(), mBatchSel.end());
+  // fit the survivors
+  int nFound = 0;
+  for (auto ic : mBatchSel) {
+    const auto& ids = candidates[ic];
+    clear();
+    for (int i = 0; i < N; i++) {
+      mOrigTrPtr[i] = &tracks[ids[i]];
+      mTrAux[i] = mPoolAux[ids[i]];
+    }
+    mCrossings = mBatchCross[ic];
+    if (fitCrossings()) {
+      onFit(ic);
+      nFound++;
+    }
   }
-  if (mCrossings.nDCA == MAXHYP) { // if there are 2 candidates and they are too close, chose their mean as a starting point
-    auto dst2 = (mCrossings.xDCA[0] - mCrossings.xDCA[1]) * (mCrossings.xDCA[0] - mCrossings.xDCA[1]) +
-                (mCrossings.yDCA[0] - mCrossings.yDCA[1]) * (mCrossings.yDCA[0] - mCrossings.yDCA[1]);
+  return nFound;
+}
+
+///_________________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterN<N, Args...>::mergeCloseSeeds(CrossInfo& cross) const
+{
+  if (cross.nDCA == MAXHYP) { // if there are 2 candidates and they are too close, chose their mean as a starting point
+    auto dst2 = (cross.xDCA[0] - cross.xDCA[1]) * (cross.xDCA[0] - cross.xDCA[1]) +
+                (cross.yDCA[0] - cross.yDCA[1]) * (cross.yDCA[0] - cross.yDCA[1]);
     if (dst2 < mMaxDist2ToMergeSeeds) {
-      mCrossings.nDCA = 1;
-      mCrossings.xDCA[0] = 0.5 * (mCrossings.xDCA[0] + mCrossings.xDCA[1]);
-      mCrossings.yDCA[0] = 0.5 * (mCrossings.yDCA[0] + mCrossings.yDCA[1]);
+      cross.nDCA = 1;
+      cross.xDCA[0] = 0.5 * (cross.xDCA[0] + cross.xDCA[1]);
+      cross.yDCA[0] = 0.5 * (cross.yDCA[0] + cross.yDCA[1]);
     }
   }
+}
+
+///_________________________________________________________________________
+template <int N, typename... Args>
+void DCAFitterN<N, Args...>::selectSeeds(int icand)
+{
+  // add the candidate to the list to fit if it has an acceptable crossing seed
+  auto& cross = mBatchCross[icand];
+  if (cross.nDCA) {
+    mergeCloseSeeds(cross);
+    if (acceptSeeds(cross)) {
+      mBatchSel.push_back(icand);
+    }
+  }
+}
+
+///_________________________________________________________________________
+template <int N, typename... Args>
+bool DCAFitterN<N, Args...>::acceptSeeds(const CrossInfo& cross) const
+{
+  // check if at least 1 of the seeds is within the max radius
+  bool accept = false;
+  for (int ic = 0; ic < cross.nDCA; ic++) {
+    accept |= cross.xDCA[ic] * cross.xDCA[ic] + cross.yDCA[ic] * cross.yDCA[ic] <= mMaxR2;
+  }
+  return accept;
+}
+
+///_________________________________________________________________________
+template <int N, typename... Args>
+int DCAFitterN<N, Args...>::fitCrossings()
+{
+  // fit the vertex starting from each of the crossing seeds of the current tracks
+  if (mUseAbsDCA) {
+    calcRMatrices(); // needed for fast residuals derivatives calculation in case of abs. distance minimization
+  }
   // check all crossings
   for (int ic = 0; ic < mCrossings.nDCA; ic++) {
     // check if radius is acceptable
@@ -251,6 +251,76 @@ struct CrossInfo {
   ClassDefNV(CrossInfo, 1);
 };
 
+//__________________________________________________________
+//< crossing coordinates of W pairs of circles, stored as a structure of arrays. The seeds of all the lanes are
+//< calculated at once with the same arithmetic as in CrossInfo::circlesCrossInfo, but with the branches replaced
+//< by per lane selections, so that the loop over the lanes is vectorized by the compiler (only if compiled with
+//< -fno-math-errno -fno-trapping-math, otherwise the lanes are processed one by one).
+//< Only pairs of circles are supported, the pairs involving straight lines must be treated by the CrossInfo.
+template <int W>
+struct CrossInfoBatch {
+  alignas(64) float rC0[W] = {0.f};
+  alignas(64) float xC0[W] = {0.f};
+  alignas(64) float yC0[W] = {0.f};
+  alignas(64) float rC1[W] = {0.f};
+  alignas(64) float xC1[W] = {0.f};
+  alignas(64) float yC1[W] = {0.f};
+  alignas(64) float xDCA[2][W] = {{0.f}};
+  alignas(64) float yDCA[2][W] = {{0.f}};
+  alignas(64) int nDCA[W] = {0};
+
+  void set(int lane, const TrackAuxPar& trax0, const TrackAuxPar& trax1)
+  {
+    rC0[lane] = trax0.rC;
+    xC0[lane] = trax0.xC;
+    yC0[lane] = trax0.yC;
+    rC1[lane] = trax1.rC;
+    xC1[lane] = trax1.xC;
+    yC1[lane] = trax1.yC;
+  }
+
+  void get(int lane, CrossInfo& cross) const
+  {
+    cross.nDCA = nDCA[lane];
+    for (int i = 0; i < 2; i++) {
+      cross.xDCA[i] = xDCA[i][lane];
+      cross.yDCA[i] = yDCA[i][lane];
+    }
+  }
+
+  void process()
+  {
+    for (int l = 0; l < W; l++) {
+      int first = rC0[l] > rC1[l]; // designate the largest circle as A
+      float rA = first ? rC0[l] : rC1[l], xA = first ? xC0[l] : xC1[l], yA = first ? yC0[l] : yC1[l];
+      float rB = first ? rC1[l] : rC0[l], xB = first ? xC1[l] : xC0[l], yB = first ? yC1[l] : yC0[l];
+      float xDist = xB - xA, yDist = yB - yA;
+      float dist2 = xDist * xDist + yDist * yDist, dist = std::sqrt(dist2), rsum = rA + rB;
+      int apart = dist > rsum, nested = !apart & (dist + rB < rA);
+      // 2 intersection points, solved along the coordinate with the largest distance between the centers
+      int alongY = std::abs(xDist) < std::abs(yDist);
+      float dU = alongY ? xDist : yDist, dV = alongY ? yDist : xDist;
+      float uA = alongY ? xA : yA, vA = alongY ? yA : xA;
+      float a = (rA * rA - rB * rB + dist2) / (2. * dV), b = -dU / dV, ab = a * b, bb = b * b;
+      float det = ab * ab - (1. + bb) * (a * a - rA * rA);
+      int cross = !apart & !nested & (det > 0.f);
+      det = std::sqrt(cross ? det : 0.f);
+      float u0 = (-ab + det) / (1. + bb), u1 = (-ab - det) / (1. + bb);
+      float v0 = a + b * u0 + vA, v1 = a + b * u1 + vA;
+      u0 += uA;
+      u1 += uA;
+      // no crossing: the point between the circles on the line connecting their centers, see CrossInfo::notTouchingXY
+      float t2d = (dist + rA - (nested ? -rB : rB)) / dist;
+      float xT = xA + 0.5 * (xDist * t2d), yT = yA + 0.5 * (yDist * t2d);
+      xDCA[0][l] = cross ? (alongY ? u0 : v0) : xT;
+      yDCA[0][l] = cross ? (alongY ? v0 : u0) : yT;
+      xDCA[1][l] = cross ? (alongY ? u1 : v1) : 0.f;
+      yDCA[1][l] = cross ? (alongY ? v1 : u1) : 0.f;
+      nDCA[l] = dist < 1e-12f ? 0 : (cross ? 2 : 1); // circles are concentric?
+    }
+  }
+};
+
 } // namespace track
 } // namespace o2
 
@@ -26,6 +26,9 @@ void __dummy_instance__()
   o2::track::TrackParCov tr;
   ft2.process(tr, tr);
   ft3.process(tr, tr, tr);
+  std::vector<o2::track::TrackParCov> pool(3, tr);
+  ft2.processBatch(pool, std::vector<DCAFitter2::TrackIDs>{{0, 1}}, [](int) {});
+  ft3.processBatch(pool, std::vector<DCAFitter3::TrackIDs>{{0, 1, 2}}, [](int) {});
 }
 
 } // namespace vertexing
@@ -0,0 +1,135 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file bench_DCAFitterN.cxx
+/// \brief 2-prong vertex fits of all the pairs of a pool of tracks, one by one vs batch mode
+
+#include "benchmark/benchmark.h"
+#include "DetectorsVertexing/DCAFitterN.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace o2::track;
+using namespace o2::vertexing;
+
+constexpr int NVertices = 100;
+constexpr float Bz = 5.f;
+
+struct Input {
+  std::vector<TrackParCov> tracks;              // 2 tracks per vertex
+  std::vector<DCAFitter2::TrackIDs> candidates; // all opposite sign pairs: true vertices and combinatorial background
+  std::vector<TrackAuxPar> aux0, aux1;          // helix parameters of the pairs of tracks of the candidates
+
+  Input()
+  {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> rnd(-1.f, 1.f);
+    const std::array<float, kCovMatSize> cov = {1e-4, 0., 1e-4, 0., 0., 1e-6, 0., 0., 0., 1e-6, 0., 0., 0., 0., 4e-4};
+    for (int iv = 0; iv < NVertices; iv++) {
+      float vx = 10.f * rnd(gen), vy = 10.f * rnd(gen), vz = 10.f * rnd(gen);
+      for (int q : {-1, 1}) {
+        float alpha = 3.f * rnd(gen), c = std::cos(alpha), s = std::sin(alpha);
+        float pt = 0.2f + 2.f * std::abs(rnd(gen));
+        tracks.emplace_back(vx * c + vy * s, alpha, std::array<float, kNParams>{-vx * s + vy * c, vz, 0.5f * rnd(gen), rnd(gen), q / pt}, cov);
+      }
+    }
+    int nTracks = tracks.size();
+    for (int i0 = 0; i0 < nTracks; i0++) {
+      for (int i1 = i0 + 1; i1 < nTracks; i1++) {
+        if (tracks[i0].getQ2Pt() * tracks[i1].getQ2Pt() < 0) {
+          candidates.push_back({i0, i1});
+          aux0.emplace_back(tracks[i0], Bz);
+          aux1.emplace_back(tracks[i1], Bz);
+        }
+      }
+    }
+  }
+
+  static const Input& instance()
+  {
+    static Input input;
+    return input;
+  }
+};
+
+static void BM_CrossingsScalar(benchmark::State& state)
+{
+  auto& in = Input::instance();
+  int nCands = in.candidates.size();
+  std::vector<CrossInfo> cross(nCands);
+  for (auto _ : state) {
+    for (int ic = 0; ic < nCands; ic++) {
+      const auto& ids = in.candidates[ic];
+      cross[ic].set(in.aux0[ic], in.tracks[ids[0]], in.aux1[ic], in.tracks[ids[1]]);
+    }
+    benchmark::DoNotOptimize(cross.data());
+  }
+  state.SetItemsProcessed(state.iterations() * nCands);
+}
+
+template <int W>
+static void BM_CrossingsBatch(benchmark::State& state)
+{
+  auto& in = Input::instance();
+  int nCands = in.candidates.size() / W * W;
+  std::vector<CrossInfo> cross(nCands);
+  CrossInfoBatch<W> lanes;
+  for (auto _ : state) {
+    for (int ic = 0; ic < nCands; ic += W) {
+      for (int l = 0; l < W; l++) {
+        lanes.set(l, in.aux0[ic + l], in.aux1[ic + l]);
+      }
+      lanes.process();
+      for (int l = 0; l < W; l++) {
+        lanes.get(l, cross[ic + l]);
+      }
+    }
+    benchmark::DoNotOptimize(cross.data());
+  }
+  state.SetItemsProcessed(state.iterations() * nCands);
+}
+
+static void BM_FitSingle(benchmark::State& state)
+{
+  auto& in = Input::instance();
+  DCAFitter2 ft;
+  ft.setBz(Bz);
+  ft.setMaxR(20.);
+  for (auto _ : state) {
+    int nFound = 0;
+    for (const auto& ids : in.candidates) {
+      nFound += ft.process(in.tracks[ids[0]], in.tracks[ids[1]]) > 0;
+    }
+    benchmark::DoNotOptimize(nFound);
+  }
+  state.SetItemsProcessed(state.iterations() * in.candidates.size());
+}
+
+static void BM_FitBatch(benchmark::State& state)
+{
+  auto& in = Input::instance();
+  DCAFitter2 ft;
+  ft.setBz(Bz);
+  ft.setMaxR(20.);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ft.processBatch(in.tracks, in.candidates, [](int) {}));
+  }
+  state.SetItemsProcessed(state.iterations() * in.candidates.size());
+}
+
+BENCHMARK(BM_CrossingsScalar);
+BENCHMARK_TEMPLATE(BM_CrossingsBatch, 4);
+BENCHMARK_TEMPLATE(BM_CrossingsBatch, 8);
+BENCHMARK_TEMPLATE(BM_CrossingsBatch, 16);
+BENCHMARK(BM_FitSingle);
+BENCHMARK(BM_FitBatch);
+
+BENCHMARK_MAIN();
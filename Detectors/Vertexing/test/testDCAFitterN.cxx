@@ -20,6 +20,7 @@
 #include <TLorentzVector.h>
 #include <TStopwatch.h>
 #include <Math/SVector.h>
+#include <algorithm>
 #include <array>
 
 namespace o2
@@ -385,5 +386,91 @@ BOOST_AUTO_TEST_CASE(DCAFitterNProngs)
   outStream.Close();
 }
 
+template <class FITTER>
+void checkBatch(FITTER& ft, const std::vector<o2::track::TrackParCov>& pool, const std::vector<typename FITTER::TrackIDs>& cands)
+{
+  // fit the candidates one by one for the reference
+  constexpr int N = FITTER::getNProngs();
+  std::vector<int> nVtxRef(cands.size());
+  std::vector<Vec3D> pcaRef(cands.size());
+  std::vector<float> chi2Ref(cands.size());
+  for (size_t ic = 0; ic < cands.size(); ic++) {
+    const auto& ids = cands[ic];
+    if constexpr (N == 2) {
+      nVtxRef[ic] = ft.process(pool[ids[0]], pool[ids[1]]);
+    } else {
+      nVtxRef[ic] = ft.process(pool[ids[0]], pool[ids[1]], pool[ids[2]]);
+    }
+    if (nVtxRef[ic]) {
+      pcaRef[ic] = ft.getPCACandidate();
+      chi2Ref[ic] = ft.getChi2AtPCACandidate();
+    }
+  }
+  int nFoundRef = std::count_if(nVtxRef.begin(), nVtxRef.end(), [](int n) { return n > 0; });
+
+  int nCalls = 0;
+  int nFound = ft.processBatch(pool, cands, [&](int ic) {
+    nCalls++;
+    BOOST_CHECK_EQUAL(ft.getNCandidates(), nVtxRef[ic]);
+    if (nVtxRef[ic]) {
+      const auto& pca = ft.getPCACandidate();
+      for (int i = 0; i < 3; i++) {
+        BOOST_CHECK_CLOSE(pca[i], pcaRef[ic][i], 1e-3);
+      }
+      BOOST_CHECK_CLOSE(ft.getChi2AtPCACandidate(), chi2Ref[ic], 1e-3);
+      for (int i = 0; i < N; i++) {
+        BOOST_CHECK(ft.getOrigTrackPtr(i) == &pool[cands[ic][i]]);
+      }
+    }
+  });
+  BOOST_CHECK_EQUAL(nFound, nFoundRef);
+  BOOST_CHECK_EQUAL(nCalls, nFoundRef);
+  LOG(INFO) << N << "-prong batch: " << nFound << " vertices out of " << cands.size() << " candidates";
+}
+
+// the batch mode must provide the same vertices as the fit of the single candidates
+BOOST_AUTO_TEST_CASE(DCAFitterNBatch)
+{
+  constexpr int NTest = 500;
+  TGenPhaseSpace genPHS;
+  constexpr double pion = 0.13957;
+  constexpr double k0 = 0.49761;
+  constexpr double kch = 0.49368;
+  constexpr double dch = 1.86965;
+  std::vector<double> k0dec = {pion, pion};
+  std::vector<double> dchdec = {pion, kch, pion};
+  std::vector<o2::track::TrackParCov> vctracks, pool2, pool3;
+  Vec3D vtxGen;
+  double bz = 5.0;
+
+  for (int iev = 0; iev < NTest; iev++) {
+    generate(vtxGen, vctracks, bz, genPHS, k0, k0dec, {1, 1});
+    pool2.insert(pool2.end(), vctracks.begin(), vctracks.end());
+    generate(vtxGen, vctracks, bz, genPHS, dch, dchdec, {1, 1, 1});
+    pool3.insert(pool3.end(), vctracks.begin(), vctracks.end());
+  }
+  // true decays and combinatorial background, which is mostly rejected
+  std::vector<DCAFitterN<2>::TrackIDs> cands2;
+  std::vector<DCAFitterN<3>::TrackIDs> cands3;
+  for (int iev = 0; iev < NTest; iev++) {
+    cands2.push_back({2 * iev, 2 * iev + 1});
+    cands2.push_back({2 * iev, (2 * iev + 3) % (2 * NTest)});
+    cands3.push_back({3 * iev, 3 * iev + 1, 3 * iev + 2});
+    cands3.push_back({3 * iev, (3 * iev + 4) % (3 * NTest), 3 * iev + 2});
+  }
+
+  for (bool useAbsDCA : {true, false}) {
+    DCAFitterN<2> ft2;
+    ft2.setBz(bz);
+    ft2.setUseAbsDCA(useAbsDCA);
+    checkBatch(ft2, pool2, cands2);
+
+    DCAFitterN<3> ft3;
+    ft3.setBz(bz);
+    ft3.setUseAbsDCA(useAbsDCA);
+    checkBatch(ft3, pool3, cands3);
+  }
+}
+
 } // namespace vertexing
 } // namespace o2
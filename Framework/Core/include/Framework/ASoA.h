@@ -340,6 +340,10 @@ struct Index : o2::soa::IndexColumn<Index<START, END>> {
 
   int64_t globalIndex() const
   {
+    auto originalRows = *std::get<1>(rowOffsets);
+    if (O2_BUILTIN_UNLIKELY(originalRows != nullptr)) {
+      return originalRows[index<0>()];
+    }
     return index<0>() + offsets<0>();
   }
 
@@ -360,7 +364,7 @@ struct Index : o2::soa::IndexColumn<Index<START, END>> {
     rowIndices = indices;
   }
 
-  void setOffsets(std::tuple<uint64_t const*> offsets)
+  void setOffsets(std::tuple<uint64_t const*, int64_t const* const*> offsets)
   {
     rowOffsets = offsets;
   }
@@ -372,8 +376,9 @@ struct Index : o2::soa::IndexColumn<Index<START, END>> {
   std::tuple<> boundIterators;
   std::tuple<int64_t const*, int64_t const*> rowIndices;
   /// The offsets within larger tables. Currently only
-  /// one level of nesting is supported.
-  std::tuple<uint64_t const*> rowOffsets;
+  /// one level of nesting is supported. The second entry
+  /// are the rows in the original table, if they were reordered.
+  std::tuple<uint64_t const*, int64_t const* const*> rowOffsets;
 };
 
 template <typename T>
@@ -401,6 +406,9 @@ struct IndexPolicyBase {
   int64_t mRowIndex = 0;
   /// Offset within a larger table
   uint64_t mOffset = 0;
+  /// Row in the original table of each row, if the table
+  /// is a reordered copy of it, nullptr otherwise
+  int64_t const* mOriginalRows = nullptr;
 };
 
 struct RowViewSentinel {
@@ -418,8 +426,8 @@ struct DefaultIndexPolicy : IndexPolicyBase {
   /// mMaxRow is one behind the last row, so effectively equal to the number of
   /// rows @a nRows. Offset indicates that the index is actually part of
   /// a larger
-  DefaultIndexPolicy(int64_t nRows, uint64_t offset)
-    : IndexPolicyBase{0, offset},
+  DefaultIndexPolicy(int64_t nRows, uint64_t offset, int64_t const* originalRows = nullptr)
+    : IndexPolicyBase{0, offset, originalRows},
       mMaxRow(nRows)
   {
   }
@@ -438,10 +446,10 @@ struct DefaultIndexPolicy : IndexPolicyBase {
     return std::make_tuple(&mRowIndex, &mRowIndex);
   }
 
-  std::tuple<uint64_t const*>
+  std::tuple<uint64_t const*, int64_t const* const*>
     getOffsets() const
   {
-    return std::make_tuple(&mOffset);
+    return std::make_tuple(&mOffset, &mOriginalRows);
   }
 
   void setCursor(int64_t i)
@@ -486,8 +494,8 @@ struct FilteredIndexPolicy : IndexPolicyBase {
   // which happens below which will properly setup the first index
   // by remapping the filtered index 0 to whatever unfiltered index
   // it belongs to.
-  FilteredIndexPolicy(SelectionVector selection, uint64_t offset = 0)
-    : IndexPolicyBase{-1, offset},
+  FilteredIndexPolicy(SelectionVector selection, uint64_t offset = 0, int64_t const* originalRows = nullptr)
+    : IndexPolicyBase{-1, offset, originalRows},
       mSelectedRows(selection),
       mMaxSelection(selection.size())
   {
@@ -506,10 +514,10 @@ struct FilteredIndexPolicy : IndexPolicyBase {
     return std::make_tuple(&mRowIndex, &mSelectionRow);
   }
 
-  std::tuple<uint64_t const*>
+  std::tuple<uint64_t const*, int64_t const* const*>
     getOffsets() const
   {
-    return std::make_tuple(&mOffset);
+    return std::make_tuple(&mOffset, &mOriginalRows);
   }
 
   void limitRange(int64_t start, int64_t end)
@@ -901,7 +909,7 @@ class Table
     // is held by the table, so we are safe passing the bare pointer. If it does it
     // means that the iterator on a table is outliving the table itself, which is
     // a bad idea.
-    return filtered_iterator(mColumnChunks, {selection, mOffset});
+    return filtered_iterator(mColumnChunks, {selection, mOffset, mOriginalRows});
   }
 
   RowViewSentinel filtered_end(SelectionVector selection)
@@ -939,6 +947,15 @@ class Table
     mBegin.bindExternalIndices(current...);
   }
 
+  /// For a table whose rows are a reordered copy of another table,
+  /// the row in the original table of each row, so that globalIndex()
+  /// refers to the original table. The array must outlive the table.
+  void setOriginalRows(int64_t const* originalRows)
+  {
+    mOriginalRows = originalRows;
+    mBegin.mOriginalRows = originalRows;
+  }
+
  private:
   template <typename T>
   arrow::ChunkedArray* lookupColumn()
@@ -963,6 +980,8 @@ class Table
   RowViewSentinel mEnd;
   /// Offset of the table within a larger table.
   uint64_t mOffset;
+  /// Rows in the original table, if the table was reordered.
+  int64_t const* mOriginalRows = nullptr;
 };
 
 template <typename T>
@@ -1417,6 +1436,12 @@ class Filtered : public T
     mFilteredBegin.bindExternalIndices(current...);
   }
 
+  void setOriginalRows(int64_t const* originalRows)
+  {
+    table_t::setOriginalRows(originalRows);
+    mFilteredBegin.mOriginalRows = originalRows;
+  }
+
  private:
   SelectionVector mSelectedRows;
   iterator mFilteredBegin;
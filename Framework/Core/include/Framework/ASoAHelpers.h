@@ -12,14 +12,22 @@
 #define O2_FRAMEWORK_ASOAHELPERS_H_
 
 #include "Framework/ASoA.h"
+#include "Framework/ArrowTableSlicingCache.h"
 #include "Framework/Kernels.h"
 #include <arrow/table.h>
 
 #include <arrow/compute/context.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
 #include <iterator>
+#include <memory>
+#include <thread>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace o2::soa
 {
@@ -107,24 +115,71 @@ auto groupTable(const T& table, const std::string& categoryColumnName, int minCa
 {
   auto arrowTable = table.asArrowTable();
   auto columnIndex = arrowTable->schema()->GetFieldIndex(categoryColumnName);
-  auto dataType = arrowTable->column(columnIndex)->type();
-  if (dataType->id() == arrow::Type::UINT64) {
-    return doGroupTable<uint64_t, arrow::UInt64Array>(arrowTable, categoryColumnName, minCatSize, outsider);
-  }
-  if (dataType->id() == arrow::Type::INT64) {
-    return doGroupTable<int64_t, arrow::Int64Array>(arrowTable, categoryColumnName, minCatSize, outsider);
-  }
-  if (dataType->id() == arrow::Type::UINT32) {
-    return doGroupTable<uint32_t, arrow::UInt32Array>(arrowTable, categoryColumnName, minCatSize, outsider);
+  auto column = arrowTable->column(columnIndex);
+  auto dataType = column->type();
+  auto compute = [&]() {
+    if (dataType->id() == arrow::Type::UINT64) {
+      return doGroupTable<uint64_t, arrow::UInt64Array>(arrowTable, categoryColumnName, minCatSize, outsider);
+    }
+    if (dataType->id() == arrow::Type::INT64) {
+      return doGroupTable<int64_t, arrow::Int64Array>(arrowTable, categoryColumnName, minCatSize, outsider);
+    }
+    if (dataType->id() == arrow::Type::UINT32) {
+      return doGroupTable<uint32_t, arrow::UInt32Array>(arrowTable, categoryColumnName, minCatSize, outsider);
+    }
+    if (dataType->id() == arrow::Type::INT32) {
+      return doGroupTable<int32_t, arrow::Int32Array>(arrowTable, categoryColumnName, minCatSize, outsider);
+    }
+    if (dataType->id() == arrow::Type::FLOAT) {
+      return doGroupTable<float, arrow::FloatArray>(arrowTable, categoryColumnName, minCatSize, outsider);
+    }
+    // FIXME: Should we support other types as well?
+    throw std::runtime_error("Combinations: category column must be of integral type");
+  };
+  // the tables are grouped only once per dataframe for all the combinations using the same categories
+  if (auto cache = o2::framework::ArrowTableSlicingCache::current()) {
+    auto key = categoryColumnName + "/" + std::to_string(minCatSize) + "/" + std::to_string(outsider);
+    return *cache->getGroupedIndices(column, key, compute);
   }
-  if (dataType->id() == arrow::Type::INT32) {
-    return doGroupTable<int32_t, arrow::Int32Array>(arrowTable, categoryColumnName, minCatSize, outsider);
+  return compute();
+}
+
+/// Split the categories of @a groupedIndices in at most @a nRanges ranges of
+/// consecutive categories [first, last], with similar numbers of
+/// k-combinations within a sliding window of the given size.
+inline std::vector<std::pair<uint64_t, uint64_t>> splitCategories(std::vector<std::pair<uint64_t, uint64_t>> const& groupedIndices, int k, uint64_t slidingWindowSize, int nRanges)
+{
+  std::vector<std::pair<uint64_t, double>> weights;
+  double total = 0;
+  auto catBegin = groupedIndices.begin();
+  while (catBegin != groupedIndices.end()) {
+    auto catEnd = std::upper_bound(catBegin, groupedIndices.end(), *catBegin, sameCategory);
+    double size = std::distance(catBegin, catEnd);
+    double weight = size * std::pow(std::min(size, (double)slidingWindowSize), k - 1);
+    weights.emplace_back(catBegin->first, weight);
+    total += weight;
+    catBegin = catEnd;
   }
-  if (dataType->id() == arrow::Type::FLOAT) {
-    return doGroupTable<float, arrow::FloatArray>(arrowTable, categoryColumnName, minCatSize, outsider);
+
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  double accumulated = 0;
+  for (auto& [category, weight] : weights) {
+    if (ranges.empty() || accumulated >= total * ranges.size() / nRanges) {
+      ranges.emplace_back(category, category);
+    }
+    ranges.back().second = category;
+    accumulated += weight;
   }
-  // FIXME: Should we support other types as well?
-  throw std::runtime_error("Combinations: category column must be of integral type");
+  return ranges;
+}
+
+/// Keep only the entries of @a groupedIndices of the categories in [first, last]
+inline void keepCategories(std::vector<std::pair<uint64_t, uint64_t>>& groupedIndices, uint64_t first, uint64_t last)
+{
+  auto begin = std::lower_bound(groupedIndices.begin(), groupedIndices.end(), std::make_pair(first, uint64_t{0}), sameCategory);
+  auto end = std::upper_bound(begin, groupedIndices.end(), std::make_pair(last, uint64_t{0}), sameCategory);
+  groupedIndices.erase(end, groupedIndices.end());
+  groupedIndices.erase(groupedIndices.begin(), begin);
 }
 
 // Synchronize categories so as groupedIndices contain elements only of categories common to all tables
@@ -325,6 +380,29 @@ struct CombinationsBlockIndexPolicyBase : public CombinationsIndexPolicyBase<Ts.
     });
   }
 
+  /// Split the combinations in independent ranges of categories
+  std::vector<std::pair<uint64_t, uint64_t>> categoryRanges(int nRanges) const
+  {
+    return splitCategories(this->mGroupedIndices[0], sizeof...(Ts), mSlidingWindowSize, nRanges);
+  }
+
+  /// Restrict the grouped indices to the categories in [first, last], to
+  /// be followed by setRanges() if there is any combination left
+  bool keepCategories(uint64_t first, uint64_t last)
+  {
+    constexpr auto k = sizeof...(Ts);
+    for (int i = 0; i < k; i++) {
+      o2::soa::keepCategories(this->mGroupedIndices[i], first, last);
+      if (this->mGroupedIndices[i].size() == 0) {
+        this->mIsEnd = true;
+      }
+    }
+    for_<k>([this](auto i) {
+      std::get<i.value>(this->mCurrentIndices) = 0;
+    });
+    return !this->mIsEnd;
+  }
+
   std::array<std::vector<std::pair<uint64_t, uint64_t>>, sizeof...(Ts)> mGroupedIndices;
   IndicesType mCurrentIndices;
   IndicesType mBeginIndices;
@@ -342,6 +420,14 @@ struct CombinationsBlockUpperIndexPolicy : public CombinationsBlockIndexPolicyBa
     }
   }
 
+  /// Restrict the combinations to the categories in [first, last]
+  void setCategories(uint64_t first, uint64_t last)
+  {
+    if (this->keepCategories(first, last)) {
+      setRanges();
+    }
+  }
+
   void setRanges()
   {
     constexpr auto k = sizeof...(Ts);
@@ -437,6 +523,15 @@ struct CombinationsBlockFullIndexPolicy : public CombinationsBlockIndexPolicyBas
     }
   }
 
+  /// Restrict the combinations to the categories in [first, last]
+  void setCategories(uint64_t first, uint64_t last)
+  {
+    if (this->keepCategories(first, last)) {
+      mCurrentlyFixed = 0;
+      setRanges();
+    }
+  }
+
   void setRanges()
   {
     constexpr auto k = sizeof...(Ts);
@@ -563,6 +658,24 @@ struct CombinationsBlockSameIndexPolicyBase : public CombinationsIndexPolicyBase
     std::get<0>(this->mCurrentIndices) = 0;
   }
 
+  /// Split the combinations in independent ranges of categories
+  std::vector<std::pair<uint64_t, uint64_t>> categoryRanges(int nRanges) const
+  {
+    return splitCategories(this->mGroupedIndices, sizeof...(Ts) + 1, mSlidingWindowSize, nRanges);
+  }
+
+  /// Restrict the grouped indices to the categories in [first, last], to
+  /// be followed by setRanges() if there is any combination left
+  bool keepCategories(uint64_t first, uint64_t last)
+  {
+    o2::soa::keepCategories(this->mGroupedIndices, first, last);
+    if (this->mGroupedIndices.size() == 0) {
+      this->mIsEnd = true;
+    }
+    std::get<0>(this->mCurrentIndices) = 0;
+    return !this->mIsEnd;
+  }
+
   std::vector<std::pair<uint64_t, uint64_t>> mGroupedIndices;
   IndicesType mCurrentIndices;
   uint64_t mSlidingWindowSize;
@@ -579,6 +692,14 @@ struct CombinationsBlockUpperSameIndexPolicy : public CombinationsBlockSameIndex
     }
   }
 
+  /// Restrict the combinations to the categories in [first, last]
+  void setCategories(uint64_t first, uint64_t last)
+  {
+    if (this->keepCategories(first, last)) {
+      setRanges();
+    }
+  }
+
   void setRanges()
   {
     constexpr auto k = sizeof...(Ts) + 1;
@@ -657,6 +778,14 @@ struct CombinationsBlockStrictlyUpperSameIndexPolicy : public CombinationsBlockS
     }
   }
 
+  /// Restrict the combinations to the categories in [first, last]
+  void setCategories(uint64_t first, uint64_t last)
+  {
+    if (this->keepCategories(first, last)) {
+      setRanges();
+    }
+  }
+
   void setRanges()
   {
     constexpr auto k = sizeof...(Ts) + 1;
@@ -738,6 +867,15 @@ struct CombinationsBlockFullSameIndexPolicy : public CombinationsBlockSameIndexP
     }
   }
 
+  /// Restrict the combinations to the categories in [first, last]
+  void setCategories(uint64_t first, uint64_t last)
+  {
+    if (this->keepCategories(first, last)) {
+      mCurrentlyFixed = 0;
+      setRanges();
+    }
+  }
+
   void setRanges()
   {
     constexpr auto k = sizeof...(Ts) + 1;
@@ -919,6 +1057,69 @@ struct CombinationsGenerator {
   iterator mEnd;
 };
 
+template <typename P, typename = void>
+struct has_category_ranges : std::false_type {
+};
+
+template <typename P>
+struct has_category_ranges<P, std::void_t<decltype(std::declval<P&>().setCategories(0, 0))>> : std::true_type {
+};
+
+/// Invoke @a f(slot, combination) on all the combinations of @a policy,
+/// using @a nThreads threads. For the block policies, the combinations are
+/// split in ranges of categories which are processed independently, each
+/// of them by a single thread. The slot in [0, nThreads) identifies the
+/// thread, so that @a f can fill per thread outputs without locking.
+/// Combinations are in the same order as with combinations() only within
+/// each category. Other policies are processed sequentially, in slot 0.
+/// An exception thrown by @a f stops the processing, it is rethrown once
+/// all the threads are done.
+template <typename P, typename F>
+void parallelCombinations(const P& policy, int nThreads, F&& f)
+{
+  if constexpr (has_category_ranges<P>::value) {
+    if (policy.mIsEnd) {
+      return;
+    }
+    // more ranges than threads, to balance categories of different sizes
+    auto ranges = policy.categoryRanges(4 * nThreads);
+    const int nSlots = std::max(1, std::min<int>(nThreads, ranges.size()));
+    std::vector<std::exception_ptr> errors(nSlots);
+    std::atomic<size_t> next{0};
+    auto worker = [&](int slot) {
+      try {
+        for (size_t r = next++; r < ranges.size(); r = next++) {
+          P part{policy};
+          part.setCategories(ranges[r].first, ranges[r].second);
+          for (auto& combination : CombinationsGenerator<P>(part)) {
+            f(slot, combination);
+          }
+        }
+      } catch (...) {
+        errors[slot] = std::current_exception();
+        next = ranges.size(); // the other threads do not start new ranges
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int slot = 1; slot < nSlots; ++slot) {
+      threads.emplace_back(worker, slot);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  } else {
+    for (auto& combination : CombinationsGenerator<P>(policy)) {
+      f(0, combination);
+    }
+  }
+}
+
 template <typename T1, typename T2, typename... T2s>
 auto selfCombinations(const char* categoryColumnName, int categoryNeighbours, const T1& outsider, const T2& table, const T2s&... tables)
 {
@@ -13,6 +13,7 @@
 
 #include "Framework/Kernels.h"
 #include "Framework/AlgorithmSpec.h"
+#include "Framework/ArrowTableSlicingCache.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/CallbackService.h"
 #include "Framework/ControlService.h"
@@ -398,9 +399,9 @@ struct AnalysisDataProcessorBuilder {
   template <typename G, typename... A>
   struct GroupSlicer {
     using grouping_t = std::decay_t<G>;
-    GroupSlicer(G& gt, std::tuple<A...>& at)
+    GroupSlicer(G& gt, std::tuple<A...>& at, ArrowTableSlicingCache* cache = nullptr)
       : max{gt.size()},
-        mBegin{GroupSlicerIterator(gt, at)}
+        mBegin{GroupSlicerIterator(gt, at, cache)}
     {
     }
 
@@ -429,31 +430,32 @@ struct AnalysisDataProcessorBuilder {
         }
       }
 
-      GroupSlicerIterator(G& gt, std::tuple<A...>& at)
+      GroupSlicerIterator(G& gt, std::tuple<A...>& at, ArrowTableSlicingCache* cache)
         : mAt{&at},
           mGroupingElement{gt.begin()},
           position{0}
       {
         auto indexColumnName = getLabelFromType();
         arrow::compute::FunctionContext ctx;
-        /// prepare slices and offsets for all associated tables that have index
-        /// to grouping table
+        /// prepare the groups of all associated tables that have index
+        /// to grouping table. Tables which are not sorted by the index are
+        /// reordered, so that each group is a contiguous range of rows
         ///
         auto splitter = [&](auto&& x) {
           using xt = std::decay_t<decltype(x)>;
           constexpr auto index = framework::has_type_at<std::decay_t<decltype(x)>>(associated_pack_t{});
           if (hasIndexTo<std::decay_t<G>>(typename xt::persistent_columns_t{})) {
-            auto result = o2::framework::sliceByColumn(&ctx, indexColumnName,
-                                                       static_cast<int32_t>(gt.size()),
-                                                       x.asArrowTable(),
-                                                       &groups[index],
-                                                       &offsets[index]);
+            auto table = x.asArrowTable();
+            auto column = table->GetColumnByName(indexColumnName);
+            if (!column) {
+              throw std::runtime_error("Cannot split collection: missing index column " + indexColumnName);
+            }
+            auto size = static_cast<int32_t>(gt.size());
+            slices[index] = cache ? cache->getSlices(column, size) : groupByIndex(column, size);
+            auto result = groupTable(&ctx, table, *slices[index], &tables[index]);
             if (result.ok() == false) {
               throw std::runtime_error("Cannot split collection");
             }
-            if (groups[index].size() != gt.size()) {
-              throw std::runtime_error("Splitting collection resulted in different group number than there is rows in the grouping table.");
-            };
           }
         };
 
@@ -467,9 +469,14 @@ struct AnalysisDataProcessorBuilder {
           using xt = std::decay_t<decltype(x)>;
           if constexpr (soa::is_soa_filtered_t<xt>::value) {
             constexpr auto index = framework::has_type_at<std::decay_t<decltype(x)>>(associated_pack_t{});
+            if (slices[index] == nullptr) {
+              return;
+            }
             selections[index] = &x.getSelectedRows();
             starts[index] = selections[index]->begin();
-            offsets[index].push_back(std::get<xt>(at).tableSize());
+            if (slices[index]->sorted() == false) {
+              groupSelections[index] = groupSelection(*selections[index], *slices[index], x.tableSize());
+            }
           }
         };
         std::apply(
@@ -479,6 +486,28 @@ struct AnalysisDataProcessorBuilder {
           at);
       }
 
+      /// the selected rows of each group, relative to the start of the group
+      /// in the grouped order, for a table which was reordered
+      static std::vector<soa::SelectionVector> groupSelection(soa::SelectionVector const& selection, GroupSlices const& slices, int64_t tableSize)
+      {
+        std::vector<int64_t> groupedRow(tableSize, -1);
+        for (size_t i = 0; i < slices.permutation.size(); ++i) {
+          groupedRow[slices.permutation[i]] = i;
+        }
+        std::vector<soa::SelectionVector> result(slices.starts.size());
+        // rows of the same group are in the same order in the grouped table
+        for (auto row : selection) {
+          auto grouped = groupedRow[row];
+          if (grouped < 0) {
+            continue;
+          }
+          // the last group starting before the row, empty groups start where the next one does
+          auto group = std::upper_bound(slices.starts.begin(), slices.starts.end(), grouped) - slices.starts.begin() - 1;
+          result[group].push_back(grouped - slices.starts[group]);
+        }
+        return result;
+      }
+
       template <typename B, typename... C>
       constexpr bool hasIndexTo(framework::pack<C...>&&)
       {
@@ -537,24 +566,38 @@ struct AnalysisDataProcessorBuilder {
       {
         constexpr auto index = framework::has_type_at<A1>(associated_pack_t{});
         if (hasIndexTo<G>(typename std::decay_t<A1>::persistent_columns_t{})) {
+          uint64_t start = slices[index]->starts[position];
+          uint64_t count = slices[index]->counts[position];
+          auto groupedElementsTable = sliceTable(tables[index], start, count);
+          if (slices[index]->sorted() == false) {
+            // the rows of the group were taken out of order: globalIndex()
+            // and the selection refer to the rows of the original table
+            auto originalRows = slices[index]->permutation.data() + start;
+            if constexpr (soa::is_soa_filtered_t<std::decay_t<A1>>::value) {
+              std::decay_t<A1> typedTable{{groupedElementsTable}, soa::SelectionVector{groupSelections[index][position]}};
+              typedTable.setOriginalRows(originalRows);
+              return typedTable;
+            } else {
+              std::decay_t<A1> typedTable{{groupedElementsTable}};
+              typedTable.setOriginalRows(originalRows);
+              return typedTable;
+            }
+          }
           if constexpr (soa::is_soa_filtered_t<std::decay_t<A1>>::value) {
-            auto groupedElementsTable = arrow::util::get<std::shared_ptr<arrow::Table>>(((groups[index])[position]).value);
-
             // for each grouping element we need to slice the selection vector
-            auto start_iterator = std::lower_bound(starts[index], selections[index]->end(), (offsets[index])[position]);
-            auto stop_iterator = std::lower_bound(start_iterator, selections[index]->end(), (offsets[index])[position + 1]);
+            auto start_iterator = std::lower_bound(starts[index], selections[index]->end(), start);
+            auto stop_iterator = std::lower_bound(start_iterator, selections[index]->end(), start + count);
             starts[index] = stop_iterator;
             soa::SelectionVector slicedSelection{start_iterator, stop_iterator};
             std::transform(slicedSelection.begin(), slicedSelection.end(), slicedSelection.begin(),
                            [&](int64_t idx) {
-                             return idx - static_cast<int64_t>((offsets[index])[position]);
+                             return idx - static_cast<int64_t>(start);
                            });
 
-            std::decay_t<A1> typedTable{{groupedElementsTable}, std::move(slicedSelection), (offsets[index])[position]};
+            std::decay_t<A1> typedTable{{groupedElementsTable}, std::move(slicedSelection), start};
             return typedTable;
           } else {
-            auto groupedElementsTable = arrow::util::get<std::shared_ptr<arrow::Table>>(((groups[index])[position]).value);
-            std::decay_t<A1> typedTable{{groupedElementsTable}, (offsets[index])[position]};
+            std::decay_t<A1> typedTable{{groupedElementsTable}, start};
             return typedTable;
           }
         } else {
@@ -567,10 +610,12 @@ struct AnalysisDataProcessorBuilder {
       typename grouping_t::iterator mGroupingElement;
       uint64_t position = 0;
 
-      std::array<std::vector<arrow::compute::Datum>, sizeof...(A)> groups;
-      std::array<std::vector<uint64_t>, sizeof...(A)> offsets;
+      /// the associated tables, in the grouped order
+      std::array<std::shared_ptr<arrow::Table>, sizeof...(A)> tables;
+      std::array<std::shared_ptr<GroupSlices const>, sizeof...(A)> slices;
       std::array<soa::SelectionVector const*, sizeof...(A)> selections;
       std::array<soa::SelectionVector::const_iterator, sizeof...(A)> starts;
+      std::array<std::vector<soa::SelectionVector>, sizeof...(A)> groupSelections;
     };
 
     GroupSlicerIterator& begin()
@@ -587,7 +632,7 @@ struct AnalysisDataProcessorBuilder {
   };
 
   template <typename Task, typename R, typename C, typename Grouping, typename... Associated>
-  static void invokeProcess(Task& task, InputRecord& inputs, R (C::*)(Grouping, Associated...), std::vector<ExpressionInfo> const& infos)
+  static void invokeProcess(Task& task, InputRecord& inputs, R (C::*)(Grouping, Associated...), std::vector<ExpressionInfo> const& infos, ArrowTableSlicingCache* cache = nullptr)
   {
     using G = std::decay_t<Grouping>;
     auto groupingTable = AnalysisDataProcessorBuilder::bindGroupingTable(inputs, &C::process, infos);
@@ -614,7 +659,7 @@ struct AnalysisDataProcessorBuilder {
 
       if constexpr (soa::is_soa_iterator_t<std::decay_t<G>>::value) {
         // grouping case
-        auto slicer = GroupSlicer(groupingTable, associatedTables);
+        auto slicer = GroupSlicer(groupingTable, associatedTables, cache);
         for (auto& slice : slicer) {
           auto associatedSlices = slice.associatedTables();
           std::apply(
@@ -730,8 +775,9 @@ struct OutputManager<HistogramRegistry> {
     return true;
   }
 
-  static bool postRun(EndOfStreamContext&, HistogramRegistry&)
+  static bool postRun(EndOfStreamContext&, HistogramRegistry& what)
   {
+    what.merge();
     return true;
   }
 };
@@ -787,6 +833,18 @@ struct ServiceManager {
   }
 };
 
+/// ROOT is made thread safe at the device setup if a registry is filled from several threads
+template <>
+struct ServiceManager<HistogramRegistry> {
+  static bool prepare(InitContext&, HistogramRegistry& registry)
+  {
+    if (registry.concurrentFilling()) {
+      HistogramRegistry::enableThreadSafety();
+    }
+    return true;
+  }
+};
+
 template <typename T>
 struct ServiceManager<Service<T>> {
   static bool prepare(InitContext& context, Service<T>& service)
@@ -943,13 +1001,16 @@ DataProcessorSpec adaptAnalysisTask(char const* name, Args&&... args)
       task->init(ic);
     }
     return [task, expressionInfos](ProcessingContext& pc) {
+      // also for the helpers used in process(), e.g. the block combinations
+      auto& slicingCache = pc.services().get<ArrowTableSlicingCache>();
+      ArrowTableSlicingCache::Scope slicingCacheScope{&slicingCache};
       auto tupledTask = o2::framework::to_tuple_refs(*task.get());
       std::apply([&pc](auto&&... x) { return (OutputManager<std::decay_t<decltype(x)>>::prepare(pc, x), ...); }, tupledTask);
       if constexpr (has_run<T>::value) {
         task->run(pc);
       }
       if constexpr (has_process<T>::value) {
-        AnalysisDataProcessorBuilder::invokeProcess(*(task.get()), pc.inputs(), &T::process, expressionInfos);
+        AnalysisDataProcessorBuilder::invokeProcess(*(task.get()), pc.inputs(), &T::process, expressionInfos, &slicingCache);
       }
       std::apply([&pc](auto&&... x) { return (OutputManager<std::decay_t<decltype(x)>>::finalize(pc, x), ...); }, tupledTask);
     };
@@ -0,0 +1,98 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_ARROWTABLESLICINGCACHE_H_
+#define O2_FRAMEWORK_ARROWTABLESLICINGCACHE_H_
+
+#include "Framework/Kernels.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace arrow
+{
+class Buffer;
+class ChunkedArray;
+} // namespace arrow
+
+namespace o2::framework
+{
+
+/// Service which keeps the groups of the rows of the tables of the current
+/// dataframes by their index columns, so that they are computed only once
+/// for all the tables sharing the same index column, e.g. tracks and their
+/// joins grouped by collision, and by all the threads processing the same
+/// dataframe. The block combinations keep here the rows sorted by their
+/// category column in the same way.
+///
+/// Entries are identified by the memory of the index column, they are
+/// dropped once the dataframe they come from is gone.
+class ArrowTableSlicingCache
+{
+ public:
+  /// pairs of (category, row) sorted by category, see o2::soa::groupTable
+  using GroupedIndices = std::vector<std::pair<uint64_t, uint64_t>>;
+
+  /// @return the groups of the rows of @a column, see groupByIndex
+  std::shared_ptr<GroupSlices const> getSlices(std::shared_ptr<arrow::ChunkedArray> const& column, int32_t size);
+
+  /// @return the rows of @a column grouped by category with the options
+  /// identified by @a key, invoking @a compute if they are not known yet
+  std::shared_ptr<GroupedIndices const> getGroupedIndices(std::shared_ptr<arrow::ChunkedArray> const& column, std::string const& key,
+                                                          std::function<GroupedIndices()> const& compute);
+
+  /// @return the number of entries which are still in use
+  size_t size();
+
+  /// @return the cache of the task being processed by the calling thread,
+  /// for the helpers invoked from process() which have no access to the
+  /// services, nullptr if none
+  static ArrowTableSlicingCache* current();
+
+  /// Makes a cache the current one of the calling thread while in scope
+  class Scope
+  {
+   public:
+    explicit Scope(ArrowTableSlicingCache* cache);
+    ~Scope();
+
+   private:
+    ArrowTableSlicingCache* mPrevious;
+  };
+
+ private:
+  struct Entry {
+    uint8_t const* data;
+    int64_t offset;
+    int64_t length;
+    int32_t size;    /// number of groups, for the slices
+    std::string key; /// grouping options, for the grouped indices
+    /// the buffer of the first chunk of the column, as long as it is alive
+    /// data refers to the same values
+    std::weak_ptr<arrow::Buffer> buffer;
+    std::shared_ptr<GroupSlices const> slices;
+    std::shared_ptr<GroupedIndices const> groupedIndices;
+  };
+
+  /// @return the entry of @a column for the given @a size and @a key, creating
+  /// it with @a fill if needed
+  template <typename F>
+  Entry find(std::shared_ptr<arrow::ChunkedArray> const& column, int32_t size, std::string const& key, F&& fill);
+
+  std::mutex mMutex;
+  std::vector<Entry> mEntries;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_ARROWTABLESLICINGCACHE_H_
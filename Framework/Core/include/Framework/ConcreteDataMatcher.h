@@ -81,4 +81,24 @@ struct ConcreteDataMatcher {
 };
 
 } // namespace o2::framework
+
+namespace std
+{
+/// Hash of the fully qualified data, e.g. to dispatch incoming messages
+/// without going through the generic matchers.
+template <>
+struct hash<o2::framework::ConcreteDataMatcher> {
+  size_t operator()(o2::framework::ConcreteDataMatcher const& matcher) const noexcept
+  {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&h](uint64_t v) { h = (h ^ v) * 0x100000001b3ULL; };
+    mix(matcher.origin.itg[0]);
+    mix(matcher.description.itg[0]);
+    mix(matcher.description.itg[1]);
+    mix(matcher.subSpec);
+    return h;
+  }
+};
+} // namespace std
+
 #endif
@@ -15,6 +15,8 @@
 
 #include "Framework/DataDescriptorMatcher.h"
 
+#include <arrow/type_fwd.h>
+#include <future>
 #include <regex>
 #include "rapidjson/fwd.h"
 
@@ -57,6 +59,11 @@ struct DataInputDescriptor {
   TFile* getInputFile(int counter);
   void closeInputFile();
   std::string getInputFilename(int counter);
+  // open the input file in the background, so that it is ready when
+  // getInputFile(counter) is called. ROOT thread safety must be enabled,
+  // which the DataInputDirector does on construction
+  void prefetchInputFile(int counter);
+  void closePrefetchedFile();
 
  private:
   std::string minputfilesFile = "";
@@ -66,6 +73,8 @@ struct DataInputDescriptor {
   std::vector<std::string> mfilenames;
   std::vector<std::string>* mdefaultFilenamesPtr = nullptr;
   TFile* mcurrentFile = nullptr;
+  std::future<TFile*> mnextFile;
+  int mnextCounter = -1;
 };
 
 struct DataInputDirector {
@@ -86,14 +95,35 @@ struct DataInputDirector {
   void setFilenamesRegex(std::string dfn) { mFilenameRegex = dfn; }
   bool readJson(std::string const& fnjson);
   void closeInputFiles();
+  // read the next input files and the baskets of the trees in background
+  // threads, makes ROOT thread safe
+  void enablePrefetching();
+  // open the input files for the given counter in the background, if enabled
+  void prefetchInputFiles(int counter);
 
   // getters
   DataInputDescriptor* getDataInputDescriptor(header::DataHeader dh);
-  std::unique_ptr<TTreeReader> getTreeReader(header::DataHeader dh, int counter, std::string treeName);
+  // only the given branches are read, through a TTreeCache, all of them
+  // if none is given. The branches of a tree are shared by all the readers,
+  // so they must include the columns of all the tables read from it
+  std::unique_ptr<TTreeReader> getTreeReader(header::DataHeader dh, int counter, std::string treeName,
+                                             std::vector<std::string> const& branches = {});
   std::string getInputFilename(header::DataHeader dh, int counter);
   TTree* getDataTree(header::DataHeader dh, int counter);
+
+  // AODs in the Arrow IPC format: the input "file" is a directory with
+  // extension .arrow, containing one IPC file <treename>.arrow per table
+  bool isArrowInput(header::DataHeader dh, int counter);
+  // get the table from the memory-mapped IPC file, reading only the given
+  // columns (all if none is given) in the given order
+  std::shared_ptr<arrow::Table> getArrowTable(header::DataHeader dh, int counter, std::string treeName, std::vector<std::string> const& columns);
+  // equivalent of getDataTree for the Arrow IPC format
+  std::shared_ptr<arrow::Table> getDataTable(header::DataHeader dh, int counter);
   int getNumberInputDescriptors() { return mdataInputDescriptors.size(); }
 
+  /// size of the TTreeCache of the trees read with a list of branches
+  static constexpr int64_t TreeCacheSize = 50 * 1024 * 1024;
+
  private:
   std::string minputfilesFile;
   std::string* const minputfilesFilePtr = &minputfilesFile;
@@ -104,6 +134,7 @@ struct DataInputDirector {
   std::vector<DataInputDescriptor*> mdataInputDescriptors;
 
   bool mdebugmode = false;
+  bool mprefetching = false;
 
   bool readJsonDocument(Document* doc);
   bool isValid();
@@ -19,6 +19,21 @@
 
 #include "rapidjson/fwd.h"
 
+#include <map>
+
+namespace arrow
+{
+class Schema;
+namespace io
+{
+class OutputStream;
+}
+namespace ipc
+{
+class RecordBatchWriter;
+}
+} // namespace arrow
+
 namespace o2
 {
 namespace framework
@@ -77,6 +92,13 @@ struct DataOutputDirector {
   // get the matching TFile
   TFile* getDataOutputFile(DataOutputDescriptor* dod,
                            int ntf, int ntfmerge, std::string filemode);
+
+  // get the matching writer of Arrow IPC file. The tables written to
+  // a given file are stored in a directory <filename>_<n>.arrow, with one
+  // IPC file <treename>.arrow per table
+  std::shared_ptr<arrow::ipc::RecordBatchWriter> getDataOutputWriter(DataOutputDescriptor* dod,
+                                                                     int ntf, int ntfmerge,
+                                                                     std::shared_ptr<arrow::Schema> const& schema);
   void closeDataFiles();
 
   void setFilenameBase(std::string dfn);
@@ -91,10 +113,17 @@ struct DataOutputDirector {
   std::vector<std::string> mfilenameBases;
   std::vector<int> mfileCounts;
   std::vector<TFile*> mfilePtrs;
+  struct ArrowFileWriter {
+    std::shared_ptr<arrow::io::OutputStream> stream;
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+  };
+  // Arrow IPC writers by tree name, for each file name base
+  std::vector<std::map<std::string, ArrowFileWriter>> mfileWriters;
   bool mdebugmode = false;
 
   std::tuple<std::string, std::string, int> readJsonDocument(Document* doc);
   const std::tuple<std::string, std::string, int> memptyanswer = std::make_tuple(std::string(""), std::string(""), -1);
+  void closeDataWriters(int ind);
 };
 
 } // namespace framework
@@ -31,7 +31,12 @@
 #include <fairmq/FairMQDevice.h>
 #include <fairmq/FairMQParts.h>
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 
 namespace o2::framework
 {
@@ -41,10 +46,20 @@ struct DeviceState;
 
 /// A device actually carrying out all the DPL
 /// Data Processing needs.
+///
+/// If the data processor declares the "dpl-worker-threads" option with a
+/// value larger than 0, the completed timeslices are processed by a pool of
+/// worker threads, each timeslice with its own DataAllocator. The messages
+/// are still only sent (and the inputs forwarded) by the main thread, in the
+/// same order in which the timeslices were dispatched. This requires the
+/// processing callback to be reentrant. Each worker has its own Monitoring
+/// instance, and the requests to the ControlService are issued by the main
+/// thread once the timeslice is finalised.
 class DataProcessingDevice : public FairMQDevice
 {
  public:
   DataProcessingDevice(DeviceSpec const& spec, ServiceRegistry&, DeviceState& state);
+  ~DataProcessingDevice() override;
   void Init() final;
   void InitTask() final;
   void PreRun() final;
@@ -60,6 +75,13 @@ class DataProcessingDevice : public FairMQDevice
   void error(const char* msg);
 
  private:
+  /// A completed timeslice processed by the worker threads, together with
+  /// the contextes where its outputs are created.
+  struct WorkerTask;
+  void startWorkers(size_t nWorkers);
+  void stopWorkers();
+  void runWorker();
+
   /// The specification used to create the initial state of this device
   DeviceSpec const& mSpec;
   /// The current internal state of this device.
@@ -90,6 +112,17 @@ class DataProcessingDevice : public FairMQDevice
   int mCurrentBackoff = 0;                           /// The current exponential backoff value.
   std::vector<FairMQRegionInfo> mPendingRegionInfos; /// A list of the region infos not yet notified.
   enum TerminationPolicy mErrorPolicy = TerminationPolicy::WAIT; /// What to do when an error arises
+
+  std::vector<std::thread> mWorkers;                      /// The threads processing the timeslices, if any
+  std::mutex mWorkersMutex;                               /// Protects the queue and the state of the tasks
+  std::condition_variable mTaskAvailable;                 /// Notified when a task is queued or the workers should stop
+  std::condition_variable mTaskDone;                      /// Notified when a task has been processed
+  std::deque<WorkerTask*> mQueuedTasks;                   /// Tasks waiting for a worker
+  std::deque<std::unique_ptr<WorkerTask>> mInFlightTasks; /// Dispatched tasks, in dispatch order
+  std::vector<std::unique_ptr<WorkerTask>> mFreeTasks;    /// Tasks which can be reused
+  size_t mMaxInFlightTasks = 0;                           /// Do not take more timeslices from the relayer beyond this
+  std::string mMonitoringUrl;                             /// Backend of the monitoring instances of the workers
+  bool mStopWorkers = false;
 };
 
 } // namespace o2::framework
@@ -18,7 +18,11 @@
 #include "Framework/MessageSet.h"
 #include "Framework/TimesliceIndex.h"
 
+#include <atomic>
 #include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 class FairMQMessage;
@@ -40,6 +44,10 @@ struct DataRelayerStats {
   uint64_t relayedMessages = 0;         /// How many messages have been successfully relayed
 };
 
+/// The DataRelayer can be fed concurrently, i.e. relay() can be invoked
+/// from different threads (e.g. one per input channel) while the owner
+/// of the relayer checks for completed timeslices. Only the resizing of the
+/// pipeline (setPipelineLength) must happen while nothing is being relayed.
 class DataRelayer
 {
  public:
@@ -89,8 +97,8 @@ class DataRelayer
   /// Tune the maximum number of in flight timeslices this can handle.
   void setPipelineLength(size_t s);
 
-  /// @return the current stats about the data relaying process
-  DataRelayerStats const& getStats() const;
+  /// @return a snapshot of the current stats about the data relaying process
+  DataRelayerStats getStats() const;
 
   /// Send metrics with the VariableContext information
   void sendContextState();
@@ -118,11 +126,33 @@ class DataRelayer
   std::vector<data_matcher::VariableContext> mVariableContextes;
   std::vector<int> mCachedStateMetrics;
 
+  /// Dispatch table from fully specified (origin, description, subspec)
+  /// to the index of the input, so that ConcreteDataMatcher routes do not
+  /// need to be matched one by one.
+  std::unordered_map<ConcreteDataMatcher, int> mConcreteDispatch;
+
+  /// Per slot state, used to relay concurrently. The timeslice held by the
+  /// slot is mirrored in an atomic, so that an input for a timeslice which
+  /// already has a slot only needs the lock of that slot, which protects its
+  /// cachelines. Any change in the association between slots and timeslices
+  /// is done while holding mMutex first.
+  struct SlotState {
+    std::atomic<uint64_t> timeslice{TimesliceId::INVALID};
+    std::mutex mutex;
+  };
+  std::vector<std::unique_ptr<SlotState>> mSlotStates;
+  std::mutex mMutex;
+
   static std::vector<std::string> sMetricsNames;
   static std::vector<std::string> sVariablesMetricsNames;
   static std::vector<std::string> sQueriesMetricsNames;
 
-  DataRelayerStats mStats;
+  struct {
+    std::atomic<uint64_t> malformedInputs{0};
+    std::atomic<uint64_t> droppedComputations{0};
+    std::atomic<uint64_t> droppedIncomingMessages{0};
+    std::atomic<uint64_t> relayedMessages{0};
+  } mStats;
 };
 
 } // namespace framework
@@ -336,10 +336,12 @@ bool isSchemaCompatible(gandiva::SchemaPtr const& Schema, Operations const& opSp
 /// Function to create gandiva expression tree from operation sequence
 gandiva::NodePtr createExpressionTree(Operations const& opSpecs,
                                       gandiva::SchemaPtr const& Schema);
-/// Function to create gandiva filter from gandiva condition
+/// Function to create gandiva filter from gandiva condition. Compiled filters
+/// are cached by schema and condition, so that the filter applied to each new
+/// table with the same schema is compiled only once.
 std::shared_ptr<gandiva::Filter> createFilter(gandiva::SchemaPtr const& Schema,
                                               gandiva::ConditionPtr condition);
-/// Function to create gandiva filter from operation sequence
+/// Function to create gandiva filter from operation sequence (cached as well)
 std::shared_ptr<gandiva::Filter> createFilter(gandiva::SchemaPtr const& Schema,
                                               Operations const& opSpecs);
 /// Function to create gandiva projector from operation sequence
@@ -350,6 +352,15 @@ std::shared_ptr<gandiva::Projector> createProjector(gandiva::SchemaPtr const& Sc
 std::shared_ptr<gandiva::Projector> createProjector(gandiva::SchemaPtr const& Schema,
                                                     Projector&& p,
                                                     gandiva::FieldPtr result);
+/// Tables with up to this number of rows are filtered by the native evaluator,
+/// when it supports the operations, avoiding the compilation of a gandiva filter
+constexpr int64_t NativeEvaluationMaxRows = 1 << 16;
+/// Function to check if the operations can be evaluated natively on the table:
+/// comparisons between non-nullable numeric or boolean columns and literals,
+/// combined with logical 'and' and 'or'
+bool isNativelyEvaluable(std::shared_ptr<arrow::Table> const& table, Operations const& opSpecs);
+/// Function for creating gandiva selection evaluating the operations directly on the table columns
+Selection createSelectionNative(std::shared_ptr<arrow::Table> const& table, Operations const& opSpecs);
 /// Function for attaching gandiva filters to to compatible task inputs
 void updateExpressionInfos(expressions::Filter const& filter, std::vector<ExpressionInfo>& eInfos);
 /// Function to create gandiva condition expression from generic gandiva expression tree
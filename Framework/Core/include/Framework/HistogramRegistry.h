@@ -24,39 +24,57 @@
 #include "TH3.h"
 #include "THn.h"
 #include "THnSparse.h"
+#include "TProfile.h"
+#include "TProfile2D.h"
+#include "TProfile3D.h"
 
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
 #include <variant>
+#include <vector>
 namespace o2
 {
 
 namespace framework
 {
+/// Binning of a single axis of a histogram
+struct AxisSpec {
+  int nBins;
+  double min;
+  double max;
+};
+
 /// Data sctructure that will allow to construct a fully qualified TH* histogram
-/// Currently only supports TH1F
+/// The kind can be one of TH1{F,D,I}, TH2{F,D,I}, TH3{F,D,I}, TProfile,
+/// TProfile2D, TProfile3D, THn{F,D,I} and THnSparse{F,D,I}, with one axis
+/// per dimension
 struct HistogramConfigSpec {
   HistogramConfigSpec(char const* const kind_, unsigned int nBins_, double xmin_, double xmax_)
     : kind(kind_),
-      nBins(nBins_),
-      xmin(xmin_),
-      xmax(xmax_)
+      axes{{static_cast<int>(nBins_), xmin_, xmax_}}
+  {
+  }
+
+  HistogramConfigSpec(char const* const kind_, std::vector<AxisSpec> axes_)
+    : kind(kind_),
+      axes(std::move(axes_))
   {
   }
 
   HistogramConfigSpec()
     : kind(""),
-      nBins(1),
-      xmin(0),
-      xmax(1)
+      axes{{1, 0, 1}}
   {
   }
   HistogramConfigSpec(HistogramConfigSpec const& other) = default;
   HistogramConfigSpec(HistogramConfigSpec&& other) = default;
 
   std::string kind;
-  unsigned int nBins;
-  double xmin;
-  double xmax;
+  std::vector<AxisSpec> axes;
 };
 
 /// Data structure containing histogram specification for the HistogramRegistry
@@ -86,16 +104,45 @@ struct HistogramSpec {
   HistogramConfigSpec config;
 };
 
+/// Name of a histogram in the registry, i.e. the hash of its name. It is
+/// implicitly created from a string, use HIST("name") to have the hash
+/// computed at compile time.
+struct HistName {
+  constexpr HistName(char const* const name) : id(compile_time_hash(name)) {}
+  template <uint32_t ID>
+  constexpr HistName(std::integral_constant<uint32_t, ID>) : id(ID)
+  {
+  }
+  uint32_t id;
+};
+
+#define HIST(name) std::integral_constant<uint32_t, compile_time_hash(name)>()
+
 /// Histogram registry for an analysis task that allows to define needed histograms
 /// and serves as the container/wrapper to fill them
+///
+/// Histograms of a registry created with concurrent filling enabled can be
+/// filled from different threads: the thread which created the registry
+/// fills the histograms directly, any other thread fills its own copy of
+/// them (shard), created at its first fill without locking the others. The
+/// shards are added to the histograms by merge(), which must not run
+/// concurrently with the filling and is invoked at the end of the stream
+/// for the registries of the analysis tasks. As the shards are created
+/// while other threads fill, enableThreadSafety() has to be called before
+/// the filling starts; the analysis tasks do it at the device setup.
 class HistogramRegistry
 {
  public:
-  HistogramRegistry(char const* const name_, bool enable, std::vector<HistogramSpec> specs)
+  using HistPtr = std::variant<std::unique_ptr<TH1>, std::unique_ptr<THnBase>>;
+
+  HistogramRegistry(char const* const name_, bool enable, std::vector<HistogramSpec> specs, bool concurrentFilling = false)
     : name(name_),
       enabled(enable),
       mRegistryKey(),
-      mRegistryValue()
+      mRegistryValue(),
+      mOwnerSlot(threadSlot()),
+      mConcurrentFilling(concurrentFilling),
+      mShards(std::make_unique<Shards>())
   {
     mRegistryKey.fill(0u);
     for (auto& spec : specs) {
@@ -103,21 +150,60 @@ class HistogramRegistry
     }
   }
 
-  auto& get(char const* const name) const
+  /// @return the TH1 (or derived) histogram with the given name
+  auto& get(HistName const name) const
   {
-    const uint32_t id = compile_time_hash(name);
-    const uint32_t i = imask(id);
-    if (O2_BUILTIN_LIKELY(id == mRegistryKey[i])) {
-      return mRegistryValue[i];
+    auto& hist = mRegistryValue[index(name.id)];
+    if (O2_BUILTIN_UNLIKELY(hist.index() != 0)) {
+      throw std::runtime_error("Histogram is not a TH1, use get<T>()");
     }
-    for (auto j = 1u; j < MAX_REGISTRY_SIZE; ++j) {
-      if (id == mRegistryKey[imask(j + i)]) {
-        return mRegistryValue[imask(j + i)];
-      }
+    return std::get<0>(hist);
+  }
+
+  /// @return the histogram with the given name as a T, nullptr if it is of a different type
+  template <typename T>
+  T* get(HistName const name) const
+  {
+    auto& hist = mRegistryValue[index(name.id)];
+    if constexpr (std::is_base_of_v<THnBase, T>) {
+      return hist.index() == 1 ? dynamic_cast<T*>(std::get<1>(hist).get()) : nullptr;
+    } else {
+      return hist.index() == 0 ? dynamic_cast<T*>(std::get<0>(hist).get()) : nullptr;
     }
-    throw std::runtime_error("No match found!");
   }
 
+  /// Fill the histogram with the given name with a single entry: the
+  /// coordinates, followed by the weight if needed (for profiles, the
+  /// value comes after the coordinates)
+  template <typename... Ts>
+  void fill(HistName const name, Ts&&... positionAndWeight)
+  {
+    fillHistogram(histogramToFill(index(name.id)), static_cast<double>(positionAndWeight)...);
+  }
+
+  /// Fill the histogram with the given name with the values of the
+  /// columns Cs of all the rows of a table (or of the selected ones, for
+  /// a Filtered table)
+  template <typename... Cs, typename T, typename = std::enable_if_t<(sizeof...(Cs) > 0)>>
+  void fill(HistName const name, T const& table)
+  {
+    auto& hist = histogramToFill(index(name.id));
+    for (auto& row : table) {
+      fillHistogram(hist, static_cast<double>(*(static_cast<Cs const&>(row).getIterator()))...);
+    }
+  }
+
+  /// Add the histograms filled by the other threads to the ones of the
+  /// registry and reset them
+  void merge();
+
+  /// @return true if the histograms can be filled from several threads
+  bool concurrentFilling() const { return mConcurrentFilling; }
+
+  /// Make ROOT usable from the threads filling the shards, once per process,
+  /// before any of them runs
+  static void enableThreadSafety();
+
   // @return the associated OutputSpec
   OutputSpec const spec()
   {
@@ -134,14 +220,46 @@ class HistogramRegistry
   /// lookup distance counter for benchmarking
   mutable uint32_t lookup = 0;
 
+  /// The maximum number of threads which can fill a registry at the same time
+  static constexpr int MAX_THREADS = 128;
+
  private:
+  /// The maximum number of histograms in buffer is currently set to 512
+  /// which seems to be both reasonably large and allowing for very fast lookup
+  static constexpr uint32_t mask = 0x1FF;
+  static constexpr uint32_t MAX_REGISTRY_SIZE = mask + 1;
+  using HistArray = std::array<HistPtr, MAX_REGISTRY_SIZE>;
+
+  /// The histograms filled by the threads other than the owner one
+  struct Shards {
+    std::mutex mutex;
+    std::array<std::atomic<HistArray*>, MAX_THREADS> bySlot{};
+    std::vector<std::unique_ptr<HistArray>> owned;
+  };
+
+  /// Index of the current thread, reused once the thread is over
+  struct ThreadSlot {
+    ThreadSlot();
+    ~ThreadSlot();
+    int id;
+  };
+
+  static int threadSlot()
+  {
+    static thread_local ThreadSlot slot;
+    return slot.id;
+  }
+
+  static HistPtr createHistogram(HistogramSpec const& spec);
+
   void insert(HistogramSpec& spec)
   {
     uint32_t i = imask(spec.id);
     for (auto j = 0u; j < MAX_REGISTRY_SIZE; ++j) {
-      if (mRegistryValue[imask(j + i)].get() == nullptr) {
+      if (mRegistryKey[imask(j + i)] == 0u) {
         mRegistryKey[imask(j + i)] = spec.id;
-        mRegistryValue[imask(j + i)] = {std::make_unique<TH1F>(spec.name.data(), spec.readableName.data(), spec.config.nBins, spec.config.xmin, spec.config.xmax)};
+        mRegistryValue[imask(j + i)] = createHistogram(spec);
+        mSpecs.emplace_back(imask(j + i), spec);
         lookup += j;
         return;
       }
@@ -149,6 +267,91 @@ class HistogramRegistry
     throw std::runtime_error("Internal array is full.");
   }
 
+  uint32_t index(uint32_t id) const
+  {
+    const uint32_t i = imask(id);
+    if (O2_BUILTIN_LIKELY(id == mRegistryKey[i])) {
+      return i;
+    }
+    for (auto j = 1u; j < MAX_REGISTRY_SIZE; ++j) {
+      if (id == mRegistryKey[imask(j + i)]) {
+        return imask(j + i);
+      }
+    }
+    throw std::runtime_error("No match found!");
+  }
+
+  /// @return the histogram at index @a i to be filled by the current thread
+  HistPtr& histogramToFill(uint32_t i)
+  {
+    auto slot = threadSlot();
+    if (O2_BUILTIN_LIKELY(slot == mOwnerSlot)) {
+      return mRegistryValue[i];
+    }
+    auto shard = mShards->bySlot[slot].load(std::memory_order_acquire);
+    if (O2_BUILTIN_UNLIKELY(shard == nullptr)) {
+      shard = createShard(slot);
+    }
+    return (*shard)[i];
+  }
+
+  HistArray* createShard(int slot);
+
+  template <typename... Ts>
+  static void fillHistogram(HistPtr& hist, Ts... values)
+  {
+    constexpr int n = sizeof...(Ts);
+    static_assert(n > 0, "No values to fill");
+    double x[n] = {values...};
+    if (hist.index() == 1) {
+      auto h = std::get<1>(hist).get();
+      if (n == h->GetNdimensions()) {
+        h->Fill(x);
+      } else if (n == h->GetNdimensions() + 1) {
+        h->Fill(x, x[n - 1]);
+      } else {
+        throw std::runtime_error("Wrong number of values to fill the histogram");
+      }
+      return;
+    }
+    auto h = std::get<0>(hist).get();
+    if constexpr (n == 1) {
+      h->Fill(x[0]);
+      return;
+    } else if constexpr (n == 2) {
+      // the weight for 1D histograms, the value for profiles, y for 2D
+      h->Fill(x[0], x[1]);
+      return;
+    } else {
+      auto dimension = h->GetDimension();
+      if (n == 3 && dimension == 2) {
+        static_cast<TH2*>(h)->Fill(x[0], x[1], x[2]);
+        return;
+      }
+      if (n == 3 && dimension == 3) {
+        static_cast<TH3*>(h)->Fill(x[0], x[1], x[2]);
+        return;
+      }
+      if (n == 4 && dimension == 3) {
+        static_cast<TH3*>(h)->Fill(x[0], x[1], x[2], x[n - 1]);
+        return;
+      }
+      if (n == 3 && dimension == 1 && dynamic_cast<TProfile*>(h) != nullptr) {
+        static_cast<TProfile*>(h)->Fill(x[0], x[1], x[2]);
+        return;
+      }
+      if (n == 4 && dimension == 2 && dynamic_cast<TProfile2D*>(h) != nullptr) {
+        static_cast<TProfile2D*>(h)->Fill(x[0], x[1], x[2], x[n - 1]);
+        return;
+      }
+      if (n == 5 && dimension == 3 && dynamic_cast<TProfile3D*>(h) != nullptr) {
+        static_cast<TProfile3D*>(h)->Fill(x[0], x[1], x[2], x[3], x[n - 1]);
+        return;
+      }
+      throw std::runtime_error("Wrong number of values to fill the histogram");
+    }
+  }
+
   inline constexpr uint32_t imask(uint32_t i) const
   {
     return i & mask;
@@ -156,12 +359,13 @@ class HistogramRegistry
   std::string name;
   bool enabled;
 
-  /// The maximum number of histograms in buffer is currently set to 512
-  /// which seems to be both reasonably large and allowing for very fast lookup
-  static constexpr uint32_t mask = 0x1FF;
-  static constexpr uint32_t MAX_REGISTRY_SIZE = mask + 1;
   std::array<uint32_t, MAX_REGISTRY_SIZE> mRegistryKey;
-  std::array<std::unique_ptr<TH1>, MAX_REGISTRY_SIZE> mRegistryValue;
+  HistArray mRegistryValue;
+  /// the specs of the histograms, with their index, to create the shards
+  std::vector<std::pair<uint32_t, HistogramSpec>> mSpecs;
+  int mOwnerSlot;
+  bool mConcurrentFilling;
+  std::unique_ptr<Shards> mShards;
 };
 
 } // namespace framework
@@ -19,12 +19,16 @@
 #include <arrow/util/visibility.h>
 #include <arrow/util/variant.h>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace arrow
 {
 class Array;
+class ChunkedArray;
 class DataType;
+class Table;
 
 namespace compute
 {
@@ -199,6 +203,36 @@ arrow::Status sliceByColumn(arrow::compute::FunctionContext* context,
   return arrow::Status::OK();
 }
 
+/// The groups of rows of a table which share the same value of an index
+/// column, for the values in [0, size). Rows whose index is out of range,
+/// e.g. the unassigned ones (-1), do not belong to any group.
+struct GroupSlices {
+  /// first row of each group, in the grouped order
+  std::vector<int64_t> starts;
+  /// number of rows of each group
+  std::vector<int64_t> counts;
+  /// rows of the table in the grouped order, rows of the same group keep
+  /// their relative order. Empty if each group already is a contiguous
+  /// range of rows of the table.
+  std::vector<int64_t> permutation;
+
+  bool sorted() const { return permutation.empty(); }
+};
+
+/// Compute the groups of the rows of an int32 index @a column in a single
+/// pass if the column is sorted, with a counting sort otherwise.
+std::shared_ptr<GroupSlices> groupByIndex(std::shared_ptr<arrow::ChunkedArray> const& column, int32_t size);
+
+/// Reorder the rows of @a table in the grouped order of @a slices, so that
+/// each group is a contiguous range of rows.
+arrow::Status groupTable(arrow::compute::FunctionContext* context,
+                         std::shared_ptr<arrow::Table> const& table,
+                         GroupSlices const& slices,
+                         std::shared_ptr<arrow::Table>* output);
+
+/// The rows [start, start + count) of @a table, without copying them
+std::shared_ptr<arrow::Table> sliceTable(std::shared_ptr<arrow::Table> const& table, int64_t start, int64_t count);
+
 } // namespace o2::framework
 
 #endif // O2_FRAMEWORK_KERNELS_H_
@@ -91,6 +91,27 @@ class ServiceRegistry
     O2_BUILTIN_UNREACHABLE();
   }
 
+  // Replace the instance registered for the interface I, e.g. to give
+  // a thread of the device its own copy of a service which is not
+  // thread safe. The service must have been registered already.
+  template <class I, class C>
+  void overrideService(C* service)
+  {
+    static_assert(std::is_base_of<I, C>::value == true,
+                  "Registered service is not derived from declared interface");
+    auto typeHash = TypeIdHelpers::uniqueId<std::decay_t<I>>();
+    auto serviceId = typeHash & MAX_SERVICES_MASK;
+    for (uint8_t i = 0; i < MAX_DISTANCE; ++i) {
+      if (mServices[i + serviceId].first == typeHash) {
+        mServices[i + serviceId].second = reinterpret_cast<ServicePtr>(service);
+        return;
+      }
+    }
+    throw std::runtime_error(std::string("Unable to override service of kind ") +
+                             typeid(I).name() +
+                             " which was not registered");
+  }
+
   /// Get a service for the given interface T. The returned reference exposed to
   /// the user is actually of the last concrete type C registered, however this
   /// should not be a problem.
@@ -13,6 +13,7 @@
 
 #include "Framework/DataDescriptorMatcher.h"
 
+#include <atomic>
 #include <cstdint>
 #include <tuple>
 #include <vector>
@@ -100,8 +101,9 @@ class TimesliceIndex
   std::vector<data_matcher::VariableContext> mPublishedVariables;
 
   /// This keeps track whether or not something was relayed
-  /// since last time we called getReadyToProcess()
-  std::vector<bool> mDirty;
+  /// since last time we called getReadyToProcess(). Different slots
+  /// can be marked concurrently.
+  std::vector<std::atomic<bool>> mDirty;
 };
 
 } // namespace framework
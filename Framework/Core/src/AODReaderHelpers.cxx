@@ -37,7 +37,9 @@
 #include <arrow/table.h>
 #include <arrow/util/key_value_metadata.h>
 
+#include <algorithm>
 #include <thread>
+#include <unordered_map>
 
 namespace o2::framework::readers
 {
@@ -58,6 +60,12 @@ auto tableTypeFromInput(InputSpec const& spec)
     throw std::runtime_error("Not an extended table");
   }
 }
+
+template <typename... C>
+std::vector<std::string> columnLabels(framework::pack<C...>)
+{
+  return {C::columnLabel()...};
+}
 } // namespace
 
 enum AODTypeMask : uint64_t {
@@ -85,6 +93,33 @@ enum AODTypeMask : uint64_t {
   Unknown = 1 << 20
 };
 
+/// Invoke @a f with the metadata, the mask and the name of the tree of
+/// each of the tables of the data model which can be read from file
+template <typename F>
+void forEachAODTable(F&& f)
+{
+  f(o2::aod::CollisionsMetadata{}, AODTypeMask::Collision, "O2collision");
+  f(o2::aod::StoredTracksMetadata{}, AODTypeMask::Track, "O2track");
+  f(o2::aod::TracksCovMetadata{}, AODTypeMask::TrackCov, "O2track");
+  f(o2::aod::TracksExtraMetadata{}, AODTypeMask::TrackExtra, "O2track");
+  f(o2::aod::CalosMetadata{}, AODTypeMask::Calo, "O2calo");
+  f(o2::aod::CaloTriggersMetadata{}, AODTypeMask::Calo, "O2calotrigger");
+  f(o2::aod::MuonsMetadata{}, AODTypeMask::Muon, "O2muon");
+  f(o2::aod::MuonClustersMetadata{}, AODTypeMask::Muon, "O2muoncluster");
+  f(o2::aod::ZdcsMetadata{}, AODTypeMask::Zdc, "O2zdc");
+  f(o2::aod::BCsMetadata{}, AODTypeMask::BC, "O2bc");
+  f(o2::aod::FT0sMetadata{}, AODTypeMask::FT0, "O2ft0");
+  f(o2::aod::FV0sMetadata{}, AODTypeMask::FV0, "O2fv0");
+  f(o2::aod::FDDsMetadata{}, AODTypeMask::FDD, "O2fdd");
+  f(o2::aod::UnassignedTracksMetadata{}, AODTypeMask::UnassignedTrack, "O2unassignedtrack");
+  f(o2::aod::Run2V0sMetadata{}, AODTypeMask::Run2V0, "Run2v0");
+  f(o2::aod::McCollisionsMetadata{}, AODTypeMask::McCollision, "O2mccollision");
+  f(o2::aod::McTrackLabelsMetadata{}, AODTypeMask::McTrackLabel, "O2mctracklabel");
+  f(o2::aod::McCaloLabelsMetadata{}, AODTypeMask::McCaloLabel, "O2mccalolabel");
+  f(o2::aod::McCollisionLabelsMetadata{}, AODTypeMask::McCollisionLabel, "O2mccollisionlabel");
+  f(o2::aod::McParticlesMetadata{}, AODTypeMask::McParticle, "O2mcparticle");
+}
+
 uint64_t getMask(header::DataDescription description)
 {
 
@@ -252,6 +287,9 @@ AlgorithmSpec AODReaderHelpers::rootFileReaderCallback()
         LOGP(ERROR, "Check the JSON document! Can not be properly parsed!");
       }
     }
+    if (options.get<bool>("aod-prefetch")) {
+      didir->enablePrefetching();
+    }
 
     // analyze type of requested tables
     uint64_t readMask = calculateReadMask(spec.outputs, header::DataOrigin{"AOD"});
@@ -260,9 +298,26 @@ AlgorithmSpec AODReaderHelpers::rootFileReaderCallback()
       unknowns = getListOfUnknown(spec.outputs);
     }
 
+    // only the branches of the requested tables are read. As the tree is
+    // shared by the tables coming from it, the branches of all of them are
+    // enabled at once
+    auto branches = std::make_shared<std::unordered_map<std::string, std::vector<std::string>>>();
+    forEachAODTable([&readMask, &branches](auto metadata, AODTypeMask mask, char const* treeName) {
+      if (readMask & mask) {
+        using table_t = typename decltype(metadata)::table_t;
+        auto& treeBranches = (*branches)[treeName];
+        for (auto& label : columnLabels(typename table_t::persistent_columns_t{})) {
+          if (std::find(treeBranches.begin(), treeBranches.end(), label) == treeBranches.end()) {
+            treeBranches.emplace_back(label);
+          }
+        }
+      }
+    });
+
     auto counter = std::make_shared<int>(0);
     return adaptStateless([readMask,
                            unknowns,
+                           branches,
                            counter,
                            didir](DataAllocator& outputs, ControlService& control, DeviceSpec const& device) {
       // Each parallel reader reads the files whose index is associated to
@@ -279,13 +334,25 @@ AlgorithmSpec AODReaderHelpers::rootFileReaderCallback()
         return;
       }
 
-      auto tableMaker = [&readMask, &outputs, fi, didir](auto metadata, AODTypeMask mask, char const* treeName) {
+      auto tableMaker = [&readMask, &outputs, &branches, fi, didir](auto metadata, AODTypeMask mask, char const* treeName) {
         if (readMask & mask) {
 
           auto dh = header::DataHeader(decltype(metadata)::description(), decltype(metadata)::origin(), 0);
-          auto reader = didir->getTreeReader(dh, fi, treeName);
-
           using table_t = typename decltype(metadata)::table_t;
+
+          // only the columns of the table are read from the IPC files,
+          // which are shared by the tables coming from the same tree
+          if (didir->isArrowInput(dh, fi)) {
+            auto table = didir->getArrowTable(dh, fi, treeName, columnLabels(typename table_t::persistent_columns_t{}));
+            if (!table) {
+              LOGP(ERROR, "Requested \"{}\" table not found in input \"{}\"", treeName, didir->getInputFilename(dh, fi));
+            } else {
+              outputs.adopt(Output{decltype(metadata)::origin(), decltype(metadata)::description()}, table);
+            }
+            return;
+          }
+
+          auto reader = didir->getTreeReader(dh, fi, treeName, (*branches)[treeName]);
           if (!reader || (reader->IsInvalid())) {
             LOGP(ERROR, "Requested \"{}\" tree not found in input file \"{}\"", treeName, didir->getInputFilename(dh, fi));
           } else {
@@ -294,26 +361,7 @@ AlgorithmSpec AODReaderHelpers::rootFileReaderCallback()
           }
         }
       };
-      tableMaker(o2::aod::CollisionsMetadata{}, AODTypeMask::Collision, "O2collision");
-      tableMaker(o2::aod::StoredTracksMetadata{}, AODTypeMask::Track, "O2track");
-      tableMaker(o2::aod::TracksCovMetadata{}, AODTypeMask::TrackCov, "O2track");
-      tableMaker(o2::aod::TracksExtraMetadata{}, AODTypeMask::TrackExtra, "O2track");
-      tableMaker(o2::aod::CalosMetadata{}, AODTypeMask::Calo, "O2calo");
-      tableMaker(o2::aod::CaloTriggersMetadata{}, AODTypeMask::Calo, "O2calotrigger");
-      tableMaker(o2::aod::MuonsMetadata{}, AODTypeMask::Muon, "O2muon");
-      tableMaker(o2::aod::MuonClustersMetadata{}, AODTypeMask::Muon, "O2muoncluster");
-      tableMaker(o2::aod::ZdcsMetadata{}, AODTypeMask::Zdc, "O2zdc");
-      tableMaker(o2::aod::BCsMetadata{}, AODTypeMask::BC, "O2bc");
-      tableMaker(o2::aod::FT0sMetadata{}, AODTypeMask::FT0, "O2ft0");
-      tableMaker(o2::aod::FV0sMetadata{}, AODTypeMask::FV0, "O2fv0");
-      tableMaker(o2::aod::FDDsMetadata{}, AODTypeMask::FDD, "O2fdd");
-      tableMaker(o2::aod::UnassignedTracksMetadata{}, AODTypeMask::UnassignedTrack, "O2unassignedtrack");
-      tableMaker(o2::aod::Run2V0sMetadata{}, AODTypeMask::Run2V0, "Run2v0");
-      tableMaker(o2::aod::McCollisionsMetadata{}, AODTypeMask::McCollision, "O2mccollision");
-      tableMaker(o2::aod::McTrackLabelsMetadata{}, AODTypeMask::McTrackLabel, "O2mctracklabel");
-      tableMaker(o2::aod::McCaloLabelsMetadata{}, AODTypeMask::McCaloLabel, "O2mccalolabel");
-      tableMaker(o2::aod::McCollisionLabelsMetadata{}, AODTypeMask::McCollisionLabel, "O2mccollisionlabel");
-      tableMaker(o2::aod::McParticlesMetadata{}, AODTypeMask::McParticle, "O2mcparticle");
+      forEachAODTable(tableMaker);
 
       // tables not included in the DataModel
       if (readMask & AODTypeMask::Unknown) {
@@ -325,6 +373,16 @@ AlgorithmSpec AODReaderHelpers::rootFileReaderCallback()
           auto concrete = DataSpecUtils::asConcreteDataMatcher(route.matcher);
           auto dh = header::DataHeader(concrete.description, concrete.origin, concrete.subSpec);
 
+          if (didir->isArrowInput(dh, fi)) {
+            auto table = didir->getDataTable(dh, fi);
+            if (!table) {
+              LOGP(ERROR, "Error while retrieving the table for \"{}/{}/{}\"!", concrete.origin.as<std::string>(), concrete.description.as<std::string>(), concrete.subSpec);
+              return;
+            }
+            outputs.adopt(Output(dh), table);
+            continue;
+          }
+
           auto tr = didir->getDataTree(dh, fi);
           if (!tr) {
             char* table;
@@ -340,6 +398,10 @@ AlgorithmSpec AODReaderHelpers::rootFileReaderCallback()
           t2t.fill();
         }
       }
+
+      // open the file of the next timeframe of this reader while this one
+      // is processed
+      didir->prefetchInputFiles(fi + device.maxInputTimeslices);
     });
   })};
 
@@ -0,0 +1,99 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/ArrowTableSlicingCache.h"
+
+#include <arrow/array.h>
+#include <arrow/buffer.h>
+#include <arrow/table.h>
+
+#include <algorithm>
+
+namespace o2::framework
+{
+
+namespace
+{
+thread_local ArrowTableSlicingCache* sCurrent = nullptr;
+}
+
+template <typename F>
+ArrowTableSlicingCache::Entry ArrowTableSlicingCache::find(std::shared_ptr<arrow::ChunkedArray> const& column, int32_t size, std::string const& key, F&& fill)
+{
+  auto chunk = column->chunk(0);
+  auto buffer = chunk->data()->buffers[1];
+  auto data = buffer->data();
+  auto offset = chunk->offset();
+  auto length = column->length();
+
+  auto matches = [&](Entry const& entry) {
+    return entry.data == data && entry.offset == offset && entry.length == length && entry.size == size && entry.key == key && entry.buffer.expired() == false;
+  };
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto entry = std::find_if(mEntries.begin(), mEntries.end(), matches);
+    if (entry != mEntries.end()) {
+      return *entry;
+    }
+  }
+
+  // concurrent requests for the same column may compute it more than once,
+  // but they do not wait for each other
+  Entry result{data, offset, length, size, key, buffer, nullptr, nullptr};
+  fill(result);
+  std::lock_guard<std::mutex> lock(mMutex);
+  mEntries.erase(std::remove_if(mEntries.begin(), mEntries.end(),
+                                [](Entry const& entry) { return entry.buffer.expired(); }),
+                 mEntries.end());
+  if (std::find_if(mEntries.begin(), mEntries.end(), matches) == mEntries.end()) {
+    mEntries.push_back(result);
+  }
+  return result;
+}
+
+std::shared_ptr<GroupSlices const> ArrowTableSlicingCache::getSlices(std::shared_ptr<arrow::ChunkedArray> const& column, int32_t size)
+{
+  if (column->num_chunks() == 0 || column->length() == 0) {
+    return groupByIndex(column, size);
+  }
+  return find(column, size, "", [&](Entry& entry) { entry.slices = groupByIndex(column, size); }).slices;
+}
+
+std::shared_ptr<ArrowTableSlicingCache::GroupedIndices const> ArrowTableSlicingCache::getGroupedIndices(std::shared_ptr<arrow::ChunkedArray> const& column, std::string const& key,
+                                                                                                        std::function<GroupedIndices()> const& compute)
+{
+  if (column->num_chunks() == 0 || column->length() == 0) {
+    return std::make_shared<GroupedIndices const>(compute());
+  }
+  return find(column, -1, key, [&](Entry& entry) { entry.groupedIndices = std::make_shared<GroupedIndices const>(compute()); }).groupedIndices;
+}
+
+size_t ArrowTableSlicingCache::size()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return std::count_if(mEntries.begin(), mEntries.end(), [](Entry const& entry) { return entry.buffer.expired() == false; });
+}
+
+ArrowTableSlicingCache* ArrowTableSlicingCache::current()
+{
+  return sCurrent;
+}
+
+ArrowTableSlicingCache::Scope::Scope(ArrowTableSlicingCache* cache) : mPrevious{sCurrent}
+{
+  sCurrent = cache;
+}
+
+ArrowTableSlicingCache::Scope::~Scope()
+{
+  sCurrent = mPrevious;
+}
+
+} // namespace o2::framework
@@ -37,6 +37,8 @@
 #include <ROOT/RDataFrame.hxx>
 #include <ROOT/RArrowDS.hxx>
 #include <ROOT/RVec.hxx>
+#include <arrow/ipc/writer.h>
+#include <arrow/table.h>
 #include <chrono>
 #include <exception>
 #include <fstream>
@@ -239,6 +241,15 @@ DataProcessorSpec
     if (ic.options().isSet("res-mode")) {
       filemode = ic.options().get<std::string>("res-mode");
     }
+    bool arrowFormat = false;
+    if (ic.options().isSet("res-format")) {
+      auto format = ic.options().get<std::string>("res-format");
+      if (format == "arrow") {
+        arrowFormat = true;
+      } else if (format != "root") {
+        throw std::runtime_error("Unsupported format of the result files: " + format);
+      }
+    }
     if (ic.options().isSet("ntfmerge")) {
       auto ntfm = ic.options().get<int>("ntfmerge");
       if (ntfm > 0) {
@@ -303,7 +314,7 @@ DataProcessorSpec
 
     // this functor is called once per time frame
     Int_t ntf = -1;
-    return std::move([ntf, ntfmerge, filemode, dod](ProcessingContext& pc) mutable -> void {
+    return std::move([ntf, ntfmerge, filemode, arrowFormat, dod](ProcessingContext& pc) mutable -> void {
       LOG(DEBUG) << "======== getGlobalAODSink::processing ==========";
       LOG(DEBUG) << " processing data set with " << pc.inputs().size() << " entries";
 
@@ -334,6 +345,29 @@ DataProcessorSpec
           // a table can be saved in multiple ways
           // e.g. different selections of columns to different files
           for (auto d : ds) {
+            if (arrowFormat) {
+              auto selected = table;
+              if (d->colnames.size() > 0) {
+                std::vector<std::shared_ptr<arrow::Field>> fields;
+                std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+                for (auto cn : d->colnames) {
+                  auto idx = table->schema()->GetFieldIndex(cn);
+                  if (idx != -1) {
+                    fields.emplace_back(table->schema()->field(idx));
+                    columns.emplace_back(table->column(idx));
+                  }
+                }
+                selected = arrow::Table::Make(std::make_shared<arrow::Schema>(fields), columns, table->num_rows());
+              }
+              auto writer = dod->getDataOutputWriter(d, ntf, ntfmerge, selected->schema());
+              if (writer) {
+                auto status = writer->WriteTable(*selected);
+                if (!status.ok()) {
+                  LOGP(ERROR, "Couldn't write table \"{}\": {}", d->treename, status.ToString());
+                }
+              }
+              continue;
+            }
             TableToTree ta2tr(table,
                               dod->getDataOutputFile(d, ntf, ntfmerge, filemode),
                               d->treename.c_str());
@@ -365,6 +399,7 @@ DataProcessorSpec
     {{"json-file", VariantType::String, {"Name of the json configuration file"}},
      {"res-file", VariantType::String, {"Default name of the output file"}},
      {"res-mode", VariantType::String, {"Creation mode of the result files: NEW, CREATE, RECREATE, UPDATE"}},
+     {"res-format", VariantType::String, {"Format of the result files: root (default) or arrow (a directory of Arrow IPC files)"}},
      {"ntfmerge", VariantType::Int, {"Number of time frames to merge into one file"}},
      {"keep", VariantType::String, {"Comma separated list of ORIGIN/DESCRIPTION/SUBSPECIFICATION:treename:col1/col2/..:filename"}}}};
 
@@ -15,6 +15,16 @@
 #include "rapidjson/prettywriter.h"
 #include "rapidjson/filereadstream.h"
 
+#include <TROOT.h>
+#include <TTree.h>
+#include <TTreeCache.h>
+
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/table.h>
+
+#include <algorithm>
+
 namespace o2
 {
 namespace framework
@@ -45,26 +55,65 @@ TFile* DataInputDescriptor::getInputFile(int counter)
 {
 
   if (counter < getNumberInputfiles()) {
-    if (mcurrentFile) {
-      if (mcurrentFile->GetName() != mfilenames[counter]) {
-        closeInputFile();
-        mcurrentFile = new TFile(mfilenames[counter].c_str());
-      }
+    if (mcurrentFile && mcurrentFile->GetName() == mfilenames[counter]) {
+      return mcurrentFile;
+    }
+    closeInputFile();
+    if (mnextFile.valid() && mnextCounter == counter) {
+      mcurrentFile = mnextFile.get();
+      mnextCounter = -1;
     } else {
+      closePrefetchedFile();
       mcurrentFile = new TFile(mfilenames[counter].c_str());
     }
   } else {
     closeInputFile();
+    closePrefetchedFile();
   }
 
   return mcurrentFile;
 }
 
+void DataInputDescriptor::prefetchInputFile(int counter)
+{
+  if (counter < 0 || counter >= getNumberInputfiles() || (mnextFile.valid() && mnextCounter == counter)) {
+    return;
+  }
+  auto& filename = mfilenames[counter];
+  if (mcurrentFile && mcurrentFile->GetName() == filename) {
+    return;
+  }
+  // arrow inputs are directories, memory mapped when read
+  static const std::string arrowExtension = ".arrow";
+  if (filename.size() > arrowExtension.size() &&
+      filename.compare(filename.size() - arrowExtension.size(), arrowExtension.size(), arrowExtension) == 0) {
+    return;
+  }
+  closePrefetchedFile();
+  // files are opened while others are read, ROOT thread safety was
+  // enabled with the prefetching by the DataInputDirector
+  mnextCounter = counter;
+  mnextFile = std::async(std::launch::async, [filename]() {
+    return new TFile(filename.c_str());
+  });
+}
+
+void DataInputDescriptor::closePrefetchedFile()
+{
+  if (mnextFile.valid()) {
+    auto file = mnextFile.get();
+    file->Close();
+    delete file;
+  }
+  mnextCounter = -1;
+}
+
 void DataInputDescriptor::closeInputFile()
 {
   if (mcurrentFile) {
     mcurrentFile->Close();
     delete mcurrentFile;
+    mcurrentFile = nullptr;
   }
 }
 
@@ -397,7 +446,8 @@ DataInputDescriptor* DataInputDirector::getDataInputDescriptor(header::DataHeade
   return result;
 }
 
-std::unique_ptr<TTreeReader> DataInputDirector::getTreeReader(header::DataHeader dh, int counter, std::string treename)
+std::unique_ptr<TTreeReader> DataInputDirector::getTreeReader(header::DataHeader dh, int counter, std::string treename,
+                                                              std::vector<std::string> const& branches)
 {
   std::unique_ptr<TTreeReader> reader = nullptr;
   auto didesc = getDataInputDescriptor(dh);
@@ -406,7 +456,26 @@ std::unique_ptr<TTreeReader> DataInputDirector::getTreeReader(header::DataHeader
     didesc = mdefaultDataInputDescriptor;
   }
   auto file = didesc->getInputFile(counter);
+  if (file == nullptr) {
+    LOGP(ERROR, "No input file {} for tree \"{}\"", counter, treename);
+    return reader;
+  }
   if (file->IsOpen()) {
+    auto tree = (TTree*)file->Get(treename.c_str());
+    if (tree && branches.empty() == false) {
+      // read only the requested branches, in large blocks
+      tree->SetBranchStatus("*", false);
+      tree->SetCacheSize(TreeCacheSize);
+      for (auto& branch : branches) {
+        tree->SetBranchStatus(branch.c_str(), true);
+        tree->AddBranchToCache(branch.c_str(), true);
+      }
+      tree->StopCacheLearningPhase();
+      auto cache = dynamic_cast<TTreeCache*>(file->GetCacheRead(tree));
+      if (cache && mprefetching) {
+        cache->SetEnablePrefetching(true);
+      }
+    }
     reader = std::make_unique<TTreeReader>(treename.c_str(), file);
     if (!reader) {
       LOGP(ERROR, "Couldn't create TTreeReader for tree \"{}\" in file \"{}\"", treename, file->GetName());
@@ -460,11 +529,124 @@ TTree* DataInputDirector::getDataTree(header::DataHeader dh, int counter)
   return tree;
 }
 
+namespace
+{
+/// Read the table in the IPC file @a filename, which is memory-mapped: the
+/// buffers of the table point to the mapped pages, which are only read
+/// from disk when accessed, and only the requested columns are loaded
+std::shared_ptr<arrow::Table> readArrowFile(std::string const& filename, std::vector<std::string> const& columns)
+{
+  auto file = arrow::io::MemoryMappedFile::Open(filename, arrow::io::FileMode::READ);
+  if (!file.ok()) {
+    LOGP(ERROR, "Couldn't open file \"{}\": {}", filename, file.status().ToString());
+    return nullptr;
+  }
+  auto options = arrow::ipc::IpcReadOptions::Defaults();
+  if (columns.empty() == false) {
+    auto fullReader = arrow::ipc::RecordBatchFileReader::Open(file.ValueOrDie(), options);
+    if (!fullReader.ok()) {
+      LOGP(ERROR, "Couldn't read \"{}\": {}", filename, fullReader.status().ToString());
+      return nullptr;
+    }
+    auto schema = fullReader.ValueOrDie()->schema();
+    for (auto& column : columns) {
+      auto idx = schema->GetFieldIndex(column);
+      if (idx < 0) {
+        LOGP(ERROR, "Column \"{}\" not found in \"{}\"", column, filename);
+        return nullptr;
+      }
+      options.included_fields.push_back(idx);
+    }
+    std::sort(options.included_fields.begin(), options.included_fields.end());
+  }
+  auto reader = arrow::ipc::RecordBatchFileReader::Open(file.ValueOrDie(), options);
+  if (!reader.ok()) {
+    LOGP(ERROR, "Couldn't read \"{}\": {}", filename, reader.status().ToString());
+    return nullptr;
+  }
+  auto batchReader = reader.ValueOrDie();
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (int i = 0; i < batchReader->num_record_batches(); ++i) {
+    auto batch = batchReader->ReadRecordBatch(i);
+    if (!batch.ok()) {
+      LOGP(ERROR, "Couldn't read batch {} of \"{}\": {}", i, filename, batch.status().ToString());
+      return nullptr;
+    }
+    batches.emplace_back(batch.ValueOrDie());
+  }
+  auto table = arrow::Table::FromRecordBatches(batchReader->schema(), batches);
+  if (!table.ok()) {
+    LOGP(ERROR, "Couldn't create table from \"{}\": {}", filename, table.status().ToString());
+    return nullptr;
+  }
+  if (columns.empty()) {
+    return table.ValueOrDie();
+  }
+
+  // the projected columns come in the order of the file
+  auto projected = table.ValueOrDie();
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> arrays;
+  for (auto& column : columns) {
+    auto idx = projected->schema()->GetFieldIndex(column);
+    fields.emplace_back(projected->schema()->field(idx));
+    arrays.emplace_back(projected->column(idx));
+  }
+  return arrow::Table::Make(std::make_shared<arrow::Schema>(fields), arrays, projected->num_rows());
+}
+} // namespace
+
+bool DataInputDirector::isArrowInput(header::DataHeader dh, int counter)
+{
+  static const std::string extension = ".arrow";
+  auto filename = getInputFilename(dh, counter);
+  return filename.size() > extension.size() &&
+         filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+std::shared_ptr<arrow::Table> DataInputDirector::getArrowTable(header::DataHeader dh, int counter, std::string treename, std::vector<std::string> const& columns)
+{
+  return readArrowFile(getInputFilename(dh, counter) + "/" + treename + ".arrow", columns);
+}
+
+std::shared_ptr<arrow::Table> DataInputDirector::getDataTable(header::DataHeader dh, int counter)
+{
+  std::string treename;
+  auto didesc = getDataInputDescriptor(dh);
+  if (didesc) {
+    treename = didesc->treename;
+  } else {
+    treename = dh.dataDescription.str;
+  }
+  return getArrowTable(dh, counter, treename, {});
+}
+
 void DataInputDirector::closeInputFiles()
 {
   mdefaultDataInputDescriptor->closeInputFile();
+  mdefaultDataInputDescriptor->closePrefetchedFile();
   for (auto didesc : mdataInputDescriptors) {
     didesc->closeInputFile();
+    didesc->closePrefetchedFile();
+  }
+}
+
+void DataInputDirector::enablePrefetching()
+{
+  // the input files and baskets are read in background threads: ROOT must
+  // be made thread safe before any of them exists
+  ROOT::EnableThreadSafety();
+  mprefetching = true;
+}
+
+void DataInputDirector::prefetchInputFiles(int counter)
+{
+  if (mprefetching == false) {
+    return;
+  }
+  mdefaultDataInputDescriptor->prefetchInputFile(counter);
+  for (auto didesc : mdataInputDescriptors) {
+    didesc->prefetchInputFile(counter);
   }
 }
 
@@ -14,6 +14,12 @@
 #include "rapidjson/prettywriter.h"
 #include "rapidjson/filereadstream.h"
 
+#include <arrow/io/file.h>
+#include <arrow/ipc/writer.h>
+
+#include <cerrno>
+#include <sys/stat.h>
+
 namespace o2
 {
 namespace framework
@@ -140,6 +146,7 @@ void DataOutputDirector::reset()
   closeDataFiles();
   mfilePtrs.clear();
   mfileCounts.clear();
+  mfileWriters.clear();
   mfilenameBase = std::string("");
 };
 
@@ -185,6 +192,7 @@ void DataOutputDirector::readString(std::string const& keepString)
   for (auto fn : mfilenameBases) {
     mfilePtrs.emplace_back(new TFile());
     mfileCounts.emplace_back(-1);
+    mfileWriters.emplace_back();
   }
 }
 
@@ -455,12 +463,74 @@ TFile* DataOutputDirector::getDataOutputFile(DataOutputDescriptor* dodesc,
   return filePtr;
 }
 
+std::shared_ptr<arrow::ipc::RecordBatchWriter>
+  DataOutputDirector::getDataOutputWriter(DataOutputDescriptor* dodesc,
+                                          int ntf, int ntfmerge,
+                                          std::shared_ptr<arrow::Schema> const& schema)
+{
+  auto it = std::find(mfilenameBases.begin(), mfilenameBases.end(), dodesc->getFilenameBase());
+  if (it == mfilenameBases.end()) {
+    return nullptr;
+  }
+  int ind = std::distance(mfilenameBases.begin(), it);
+
+  // check if new version of file needs to be opened
+  int fcnt = (int)(ntf / ntfmerge);
+  if ((ntf % ntfmerge) == 0 && fcnt > mfileCounts[ind]) {
+    closeDataWriters(ind);
+    mfileCounts[ind] = fcnt;
+  }
+
+  auto& writers = mfileWriters[ind];
+  auto found = writers.find(dodesc->treename);
+  if (found != writers.end()) {
+    return found->second.writer;
+  }
+
+  auto dirname = mfilenameBases[ind] + "_" + std::to_string(mfileCounts[ind]) + ".arrow";
+  if (mkdir(dirname.c_str(), 0755) != 0 && errno != EEXIST) {
+    LOGP(ERROR, "Couldn't create directory \"{}\"", dirname);
+    return nullptr;
+  }
+  auto filename = dirname + "/" + dodesc->treename + ".arrow";
+  auto stream = arrow::io::FileOutputStream::Open(filename);
+  if (!stream.ok()) {
+    LOGP(ERROR, "Couldn't open file \"{}\": {}", filename, stream.status().ToString());
+    return nullptr;
+  }
+  auto writer = arrow::ipc::NewFileWriter(stream.ValueOrDie().get(), schema);
+  if (!writer.ok()) {
+    LOGP(ERROR, "Couldn't create writer for \"{}\": {}", filename, writer.status().ToString());
+    return nullptr;
+  }
+  writers.emplace(dodesc->treename, ArrowFileWriter{stream.ValueOrDie(), writer.ValueOrDie()});
+  return writer.ValueOrDie();
+}
+
+void DataOutputDirector::closeDataWriters(int ind)
+{
+  for (auto& [treename, w] : mfileWriters[ind]) {
+    // the footer of the IPC file is written when closing
+    auto status = w.writer->Close();
+    if (status.ok()) {
+      status = w.stream->Close();
+    }
+    if (!status.ok()) {
+      LOGP(ERROR, "Couldn't close Arrow file for \"{}\": {}", treename, status.ToString());
+    }
+  }
+  mfileWriters[ind].clear();
+}
+
 void DataOutputDirector::closeDataFiles()
 {
   for (auto filePtr : mfilePtrs)
     if (filePtr) {
       filePtr->Close();
     }
+  for (auto ind = 0u; ind < mfileWriters.size(); ++ind) {
+    closeDataWriters(ind);
+  }
 }
 
 void DataOutputDirector::printOut()
@@ -488,6 +558,7 @@ void DataOutputDirector::setFilenameBase(std::string dfn)
   closeDataFiles();
   mfilePtrs.clear();
   mfileCounts.clear();
+  mfileWriters.clear();
 
   // loop over DataOutputDescritors
   for (auto dodesc : mDataOutputDescriptors) {
@@ -512,6 +583,7 @@ void DataOutputDirector::setFilenameBase(std::string dfn)
   for (auto fn : mfilenameBases) {
     mfilePtrs.emplace_back(new TFile());
     mfileCounts.emplace_back(-1);
+    mfileWriters.emplace_back();
   }
 }
 
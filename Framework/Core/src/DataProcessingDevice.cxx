@@ -38,10 +38,13 @@
 #include <Configuration/ConfigurationInterface.h>
 #include <Configuration/ConfigurationFactory.h>
 #include <Monitoring/Monitoring.h>
+#include <Monitoring/MonitoringFactory.h>
 #include <TMessage.h>
 #include <TClonesArray.h>
 
 #include <algorithm>
+#include <exception>
+#include <functional>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -51,6 +54,7 @@ using Key = o2::monitoring::tags::Key;
 using Value = o2::monitoring::tags::Value;
 using Metric = o2::monitoring::Metric;
 using Monitoring = o2::monitoring::Monitoring;
+using MonitoringFactory = o2::monitoring::MonitoringFactory;
 using ConfigurationInterface = o2::configuration::ConfigurationInterface;
 using DataHeader = o2::header::DataHeader;
 
@@ -67,6 +71,103 @@ constexpr int BACKOFF_DELAY_STEP = 100;
 namespace o2::framework
 {
 
+namespace
+{
+/// Create the InputRecord which gives access to the given set of inputs.
+/// The inputs must outlive the record.
+InputRecord makeInputRecord(std::vector<InputRoute> const& schema, std::vector<MessageSet>& inputs)
+{
+  auto getter = [&inputs](size_t i, size_t partindex) -> DataRef {
+    if (inputs[i].size() > partindex) {
+      return DataRef{nullptr,
+                     static_cast<char const*>(inputs[i].at(partindex).header->GetData()),
+                     static_cast<char const*>(inputs[i].at(partindex).payload->GetData())};
+    }
+    return DataRef{nullptr, nullptr, nullptr};
+  };
+  auto nofPartsGetter = [&inputs](size_t i) -> size_t {
+    return inputs[i].size();
+  };
+  InputSpan span{getter, nofPartsGetter, inputs.size()};
+  return InputRecord{schema, std::move(span)};
+}
+
+/// The ControlService used by the processing callbacks running on a worker
+/// thread. The requests are only recorded, and issued to the actual service
+/// by the main thread when the timeslice is finalised.
+class DeferredControlService : public ControlService
+{
+ public:
+  using Request = std::function<void(ControlService&)>;
+
+  void readyToQuit(QuitRequest kind) final
+  {
+    mRequests.emplace_back([kind](ControlService& control) { control.readyToQuit(kind); });
+  }
+
+  void endOfStream() final
+  {
+    mRequests.emplace_back([](ControlService& control) { control.endOfStream(); });
+  }
+
+  void notifyStreamingState(StreamingState state) final
+  {
+    mRequests.emplace_back([state](ControlService& control) { control.notifyStreamingState(state); });
+  }
+
+  std::vector<Request>& requests() { return mRequests; }
+
+ private:
+  std::vector<Request> mRequests;
+};
+} // namespace
+
+/// The state of a timeslice processed by one of the worker threads. Each
+/// task has its own contextes, so that the outputs of different timeslices
+/// can be created concurrently and sent afterwards, in order.
+struct DataProcessingDevice::WorkerTask {
+  WorkerTask(DataProcessingDevice* device, DataAllocator::AllowedOutputRoutes const& outputs)
+    : messageContext{FairMQDeviceProxy{device}},
+      stringContext{FairMQDeviceProxy{device}},
+      arrowContext{FairMQDeviceProxy{device}},
+      rawContext{FairMQDeviceProxy{device}},
+      contextRegistry{&messageContext, &stringContext, &arrowContext, &rawContext},
+      allocator{&timingInfo, &contextRegistry, outputs}
+  {
+  }
+
+  void clear()
+  {
+    messageContext.clear();
+    stringContext.clear();
+    arrowContext.clear();
+    rawContext.clear();
+    inputs.clear();
+    controlRequests.clear();
+    error = nullptr;
+    processingCount = 0;
+  }
+
+  TimingInfo timingInfo;
+  MessageContext messageContext;
+  StringContext stringContext;
+  ArrowContext arrowContext;
+  RawBufferContext rawContext;
+  ContextRegistry contextRegistry;
+  DataAllocator allocator;
+
+  DataRelayer::RecordAction action;
+  std::vector<MessageSet> inputs;
+  std::vector<DeferredControlService::Request> controlRequests; /// Issued by the callbacks, replayed by the main thread
+  bool forwardOnly = false; /// The inputs are discarded and only need to be forwarded
+  bool process = false;     /// Whether the processing callbacks have to be invoked
+  bool done = false;        /// Set by the worker, protected by mWorkersMutex
+  int processingCount = 0;
+  std::exception_ptr error;
+  std::chrono::high_resolution_clock::time_point start;
+  std::chrono::high_resolution_clock::time_point end;
+};
+
 DataProcessingDevice::DataProcessingDevice(DeviceSpec const& spec, ServiceRegistry& registry, DeviceState& state)
   : mSpec{spec},
     mState{state},
@@ -105,6 +206,93 @@ DataProcessingDevice::DataProcessingDevice(DeviceSpec const& spec, ServiceRegist
   }
 }
 
+DataProcessingDevice::~DataProcessingDevice()
+{
+  stopWorkers();
+}
+
+void DataProcessingDevice::startWorkers(size_t nWorkers)
+{
+  stopWorkers();
+  mStopWorkers = false;
+  // Allow for a new set of timeslices to be ready while the previous one
+  // is being sent.
+  mMaxInFlightTasks = 2 * nWorkers;
+  for (size_t wi = 0; wi < nWorkers; ++wi) {
+    mWorkers.emplace_back([this]() { runWorker(); });
+  }
+}
+
+/// The workers exit once all the queued tasks have been processed.
+void DataProcessingDevice::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(mWorkersMutex);
+    mStopWorkers = true;
+  }
+  mTaskAvailable.notify_all();
+  for (auto& worker : mWorkers) {
+    worker.join();
+  }
+  mWorkers.clear();
+}
+
+/// The loop of a worker thread. Only the processing callbacks are invoked
+/// here, anything which requires the transport (sending, forwarding) or
+/// touches the state of the device is done by the main thread.
+void DataProcessingDevice::runWorker()
+{
+  // The ControlService and the Monitoring are not thread safe: each worker
+  // has its own monitoring instance, and its control requests are handed
+  // over to the main thread together with the timeslice.
+  DeferredControlService control;
+  std::unique_ptr<Monitoring> monitoring = MonitoringFactory::Get(mMonitoringUrl);
+  monitoring->addGlobalTag("dataprocessor_id", mSpec.name);
+  ServiceRegistry services = mServiceRegistry;
+  services.overrideService<ControlService>(&control);
+  services.overrideService<Monitoring>(monitoring.get());
+
+  while (true) {
+    WorkerTask* task = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mWorkersMutex);
+      mTaskAvailable.wait(lock, [this]() { return mStopWorkers || mQueuedTasks.empty() == false; });
+      if (mQueuedTasks.empty()) {
+        return;
+      }
+      task = mQueuedTasks.front();
+      mQueuedTasks.pop_front();
+    }
+
+    InputRecord record = makeInputRecord(mSpec.inputs, task->inputs);
+    O2_SIGNPOST_START(DataProcessingStatus::ID, task->timingInfo.timeslice, 0, 0, O2_SIGNPOST_GREEN);
+    task->start = std::chrono::high_resolution_clock::now();
+    try {
+      if (mStatefulProcess) {
+        ProcessingContext processContext{record, services, task->allocator};
+        mStatefulProcess(processContext);
+        task->processingCount++;
+      }
+      if (mStatelessProcess) {
+        ProcessingContext processContext{record, services, task->allocator};
+        mStatelessProcess(processContext);
+        task->processingCount++;
+      }
+    } catch (...) {
+      task->error = std::current_exception();
+    }
+    task->end = std::chrono::high_resolution_clock::now();
+    task->controlRequests.swap(control.requests());
+    O2_SIGNPOST_END(DataProcessingStatus::ID, task->timingInfo.timeslice, 0, 0, O2_SIGNPOST_GREEN);
+
+    {
+      std::lock_guard<std::mutex> lock(mWorkersMutex);
+      task->done = true;
+    }
+    mTaskDone.notify_all();
+  }
+}
+
 /// This  takes care  of initialising  the device  from its  specification. In
 /// particular it needs to:
 ///
@@ -184,6 +372,19 @@ void DataProcessingDevice::Init()
     InitContext initContext{*mConfigRegistry, mServiceRegistry};
     mStatefulProcess = mInit(initContext);
   }
+
+  // Data processors whose callback is reentrant can opt in for processing
+  // timeslices in parallel within the same device.
+  int nWorkers = mConfigRegistry->isSet("dpl-worker-threads") ? mConfigRegistry->get<int>("dpl-worker-threads") : 0;
+  if (nWorkers > 0 && mSpec.dispatchPolicy.action == DispatchPolicy::DispatchOp::WhenReady) {
+    LOG(WARNING) << "dpl-worker-threads is not supported together with the WhenReady dispatch policy, processing in the main thread";
+    nWorkers = 0;
+  }
+  if (nWorkers > 0) {
+    LOG(INFO) << "Processing timeslices with " << nWorkers << " worker threads";
+    mMonitoringUrl = GetConfig()->GetStringValue("monitoring-backend");
+  }
+  startWorkers(std::max(nWorkers, 0));
   mState.inputChannelInfos.resize(mSpec.inputChannels.size());
   /// Internal channels which will never create an actual message
   /// should be considered as in "Pull" mode, since we do not
@@ -403,6 +604,19 @@ bool DataProcessingDevice::ConditionalRun()
 
 void DataProcessingDevice::ResetTask()
 {
+  // The timeslices being processed hold messages which need to be released
+  // before the transport goes away.
+  {
+    std::unique_lock<std::mutex> lock(mWorkersMutex);
+    mTaskDone.wait(lock, [this]() {
+      return std::all_of(mInFlightTasks.begin(), mInFlightTasks.end(), [](auto const& task) { return task->done; });
+    });
+  }
+  for (auto& task : mInFlightTasks) {
+    task->clear();
+    mFreeTasks.push_back(std::move(task));
+  }
+  mInFlightTasks.clear();
   mRelayer.clear();
 }
 
@@ -586,19 +800,7 @@ bool DataProcessingDevice::tryDispatchComputation(std::vector<DataRelayer::Recor
   // the execution.
   auto fillInputs = [&relayer, &inputsSchema, &currentSetOfInputs](TimesliceSlot slot) -> InputRecord {
     currentSetOfInputs = std::move(relayer.getInputsForTimeslice(slot));
-    auto getter = [&currentSetOfInputs](size_t i, size_t partindex) -> DataRef {
-      if (currentSetOfInputs[i].size() > partindex) {
-        return DataRef{nullptr,
-                       static_cast<char const*>(currentSetOfInputs[i].at(partindex).header->GetData()),
-                       static_cast<char const*>(currentSetOfInputs[i].at(partindex).payload->GetData())};
-      }
-      return DataRef{nullptr, nullptr, nullptr};
-    };
-    auto nofPartsGetter = [&currentSetOfInputs](size_t i) -> size_t {
-      return currentSetOfInputs[i].size();
-    };
-    InputSpan span{getter, nofPartsGetter, currentSetOfInputs.size()};
-    return InputRecord{inputsSchema, std::move(span)};
+    return makeInputRecord(inputsSchema, currentSetOfInputs);
   };
 
   // This is the thing which does the actual computation. No particular reason
@@ -622,10 +824,12 @@ bool DataProcessingDevice::tryDispatchComputation(std::vector<DataRelayer::Recor
       processingCount++;
     }
 
+    O2_SIGNPOST_START(SendingStatus::ID, slot.index, 0, 0, O2_SIGNPOST_BLUE);
     DataProcessor::doSend(device, context);
     DataProcessor::doSend(device, stringContext);
     DataProcessor::doSend(device, rdfContext);
     DataProcessor::doSend(device, rawContext);
+    O2_SIGNPOST_END(SendingStatus::ID, slot.index, 0, 0, O2_SIGNPOST_BLUE);
   };
 
   // Error handling means printing the error and updating the metric
@@ -796,6 +1000,140 @@ bool DataProcessingDevice::tryDispatchComputation(std::vector<DataRelayer::Recor
     control.notifyStreamingState(state);
   };
 
+  // Update the state of the cachelines shown in the GUI.
+  auto updateRelayerState = [&stats = mStats](TimesliceSlot slot, InputRecord const& record, int validState) {
+    for (size_t ai = 0; ai != record.size(); ai++) {
+      auto cacheId = slot.index * record.size() + ai;
+      auto state = record.isValid(ai) ? validState : 0;
+      stats.relayerState.resize(std::max(cacheId + 1, stats.relayerState.size()), 0);
+      stats.relayerState[cacheId] = state;
+    }
+  };
+
+  // When using worker threads, the inputs of the completed timeslices are
+  // taken out of the relayer and queued for the workers, each one with
+  // its own allocator.
+  auto dispatchToWorkers = [this, &relayer, &timesliceIndex, &forwards, &inputsSchema, &updateRelayerState](std::vector<DataRelayer::RecordAction> const& actions) -> size_t {
+    size_t nDispatched = 0;
+    for (auto action : actions) {
+      if (action.op == CompletionPolicy::CompletionOp::Wait) {
+        continue;
+      }
+      std::unique_ptr<WorkerTask> task;
+      if (mFreeTasks.empty()) {
+        task = std::make_unique<WorkerTask>(this, mSpec.outputs);
+      } else {
+        task = std::move(mFreeTasks.back());
+        mFreeTasks.pop_back();
+      }
+      task->action = action;
+      task->timingInfo.timeslice = timesliceIndex.getTimesliceForSlot(action.slot).value;
+      task->inputs = relayer.getInputsForTimeslice(action.slot);
+      task->forwardOnly = action.op == CompletionPolicy::CompletionOp::Discard && forwards.empty() == false;
+      task->process = task->forwardOnly == false && mState.quitRequested == false;
+      task->done = task->process == false;
+      if (task->forwardOnly == false) {
+        updateRelayerState(action.slot, makeInputRecord(inputsSchema, task->inputs), 2);
+      }
+      std::lock_guard<std::mutex> lock(mWorkersMutex);
+      if (task->process) {
+        mQueuedTasks.push_back(task.get());
+        mTaskAvailable.notify_one();
+      }
+      mInFlightTasks.push_back(std::move(task));
+      nDispatched++;
+    }
+    return nDispatched;
+  };
+
+  // The timeslices processed by the workers are finalised here, in the
+  // same order in which they were dispatched: the outputs are sent, the
+  // inputs forwarded and the stats updated, like in the serial case.
+  auto collectFromWorkers = [this, &currentSetOfInputs, &inputsSchema, &forwards, &processingCount,
+                             &errorHandling, &forwardInputs, &cleanTimers, &updateRelayerState,
+                             &calculateTotalInputRecordSize, &calculateInputRecordLatency](bool wait) -> bool {
+    bool didWork = false;
+    while (mInFlightTasks.empty() == false) {
+      auto& task = mInFlightTasks.front();
+      {
+        std::unique_lock<std::mutex> lock(mWorkersMutex);
+        if (wait) {
+          mTaskDone.wait(lock, [&task]() { return task->done; });
+        } else if (task->done == false) {
+          break;
+        }
+      }
+      auto slot = task->action.slot;
+      currentSetOfInputs = std::move(task->inputs);
+      InputRecord record = makeInputRecord(inputsSchema, currentSetOfInputs);
+      if (task->error) {
+        try {
+          std::rethrow_exception(task->error);
+        } catch (std::exception& e) {
+          errorHandling(e, record);
+        }
+      }
+      processingCount += task->processingCount;
+      for (auto& request : task->controlRequests) {
+        request(mServiceRegistry.get<ControlService>());
+      }
+      if (task->process && !task->error) {
+        O2_SIGNPOST_START(SendingStatus::ID, slot.index, 0, 0, O2_SIGNPOST_BLUE);
+        DataProcessor::doSend(*this, task->messageContext);
+        DataProcessor::doSend(*this, task->stringContext);
+        DataProcessor::doSend(*this, task->arrowContext);
+        DataProcessor::doSend(*this, task->rawContext);
+        O2_SIGNPOST_END(SendingStatus::ID, slot.index, 0, 0, O2_SIGNPOST_BLUE);
+      }
+      if (task->forwardOnly == false) {
+        updateRelayerState(slot, record, 3);
+        mStats.lastElapsedTimeMs = std::chrono::duration<double, std::milli>(task->end - task->start).count();
+        mStats.lastTotalProcessedSize = calculateTotalInputRecordSize(record);
+        mStats.lastLatency = calculateInputRecordLatency(record, task->start);
+      }
+      if (task->action.op == CompletionPolicy::CompletionOp::Consume || task->forwardOnly) {
+        if (forwards.empty() == false) {
+          forwardInputs(slot, record);
+        }
+      } else if (task->action.op == CompletionPolicy::CompletionOp::Process) {
+        cleanTimers(slot, record);
+      }
+      currentSetOfInputs.clear();
+      task->clear();
+      mFreeTasks.push_back(std::move(task));
+      mInFlightTasks.pop_front();
+      didWork = true;
+    }
+    return didWork;
+  };
+
+  if (mWorkers.empty() == false) {
+    // Finalise first what is already processed, then keep the workers busy,
+    // unless too many timeslices are waiting to be sent already.
+    bool didWork = collectFromWorkers(false);
+    if (mState.streaming == StreamingState::EndOfStreaming) {
+      // Nothing can be left behind once we are asked to stop: whatever is
+      // still in the relayer is processed, regardless of the limit of tasks
+      // in flight, and waited for. The end of stream is then sent only once,
+      // by the caller, after the EndOfStream callback.
+      while (true) {
+        completed.clear();
+        size_t nDispatched = canDispatchSomeComputation() ? dispatchToWorkers(getReadyActions()) : 0;
+        if (nDispatched == 0 && mInFlightTasks.empty()) {
+          break;
+        }
+        collectFromWorkers(true);
+        didWork = true;
+      }
+      return didWork;
+    }
+    completed.clear();
+    if (mInFlightTasks.size() < mMaxInFlightTasks && canDispatchSomeComputation()) {
+      didWork |= dispatchToWorkers(getReadyActions()) > 0;
+    }
+    return didWork;
+  }
+
   if (canDispatchSomeComputation() == false) {
     return false;
     }
@@ -814,12 +1152,7 @@ bool DataProcessingDevice::tryDispatchComputation(std::vector<DataRelayer::Recor
         }
       }
       auto tStart = std::chrono::high_resolution_clock::now();
-      for (size_t ai = 0; ai != record.size(); ai++) {
-        auto cacheId = action.slot.index * record.size() + ai;
-        auto state = record.isValid(ai) ? 2 : 0;
-        mStats.relayerState.resize(std::max(cacheId + 1, mStats.relayerState.size()), 0);
-        mStats.relayerState[cacheId] = state;
-      }
+      updateRelayerState(action.slot, record, 2);
       try {
         if (mState.quitRequested == false) {
           dispatchProcessing(action.slot, record);
@@ -827,12 +1160,7 @@ bool DataProcessingDevice::tryDispatchComputation(std::vector<DataRelayer::Recor
       } catch (std::exception& e) {
         errorHandling(e, record);
       }
-      for (size_t ai = 0; ai != record.size(); ai++) {
-        auto cacheId = action.slot.index * record.size() + ai;
-        auto state = record.isValid(ai) ? 3 : 0;
-        mStats.relayerState.resize(std::max(cacheId + 1, mStats.relayerState.size()), 0);
-        mStats.relayerState[cacheId] = state;
-      }
+      updateRelayerState(action.slot, record, 3);
       auto tEnd = std::chrono::high_resolution_clock::now();
       mStats.lastElapsedTimeMs = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
       mStats.lastTotalProcessedSize = calculateTotalInputRecordSize(record);
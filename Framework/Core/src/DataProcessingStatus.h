@@ -43,6 +43,12 @@ enum struct DriverStatus : uint32_t {
   BUFFER_OVERFLOWS = 2
 };
 
+/// Describe the sending of the outputs of a computation
+enum struct SendingStatus : uint32_t {
+  ID = 4,
+  SEND = 0
+};
+
 } // namespace framework
 } // namespace o2
 
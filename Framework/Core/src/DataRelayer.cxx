@@ -52,7 +52,8 @@ DataRelayer::DataRelayer(const CompletionPolicy& policy,
     mMetrics{metrics},
     mCompletionPolicy{policy},
     mDistinctRoutesIndex{DataRelayerHelpers::createDistinctRouteIndex(routes)},
-    mInputMatchers{DataRelayerHelpers::createInputMatchers(routes)}
+    mInputMatchers{DataRelayerHelpers::createInputMatchers(routes)},
+    mConcreteDispatch{DataRelayerHelpers::createConcreteDispatchTable(routes, mDistinctRoutesIndex)}
 {
   setPipelineLength(DEFAULT_PIPELINE_LENGTH);
 
@@ -78,11 +79,21 @@ bool DataRelayer::processDanglingInputs(std::vector<ExpirationHandler> const& ex
   if (expirationHandlers.empty()) {
     return false;
   }
+  std::lock_guard<std::mutex> lock(mMutex);
   // Create any slot for the time based fields
   std::vector<TimesliceSlot> slotsCreatedByHandlers;
   for (auto& handler : expirationHandlers) {
     slotsCreatedByHandlers.push_back(handler.creator(mTimesliceIndex));
   }
+  // The creators might have reassigned slots, so the timeslices seen by
+  // the lock free lookup in relay need to be updated.
+  for (size_t ti = 0; ti < mTimesliceIndex.size(); ++ti) {
+    TimesliceSlot slot{ti};
+    auto& state = *mSlotStates[ti];
+    std::lock_guard<std::mutex> slotLock(state.mutex);
+    state.timeslice.store(mTimesliceIndex.isValid(slot) ? mTimesliceIndex.getTimesliceForSlot(slot).value : TimesliceId::INVALID,
+                          std::memory_order_release);
+  }
   bool didWork = slotsCreatedByHandlers.empty() == false;
   // Outer loop, we process all the records because the fact that the record
   // expires is independent from having received data for it.
@@ -93,6 +104,7 @@ bool DataRelayer::processDanglingInputs(std::vector<ExpirationHandler> const& ex
     }
     assert(mDistinctRoutesIndex.empty() == false);
     auto timestamp = mTimesliceIndex.getTimesliceForSlot(slot);
+    std::lock_guard<std::mutex> slotLock(mSlotStates[ti]->mutex);
     // We iterate on all the hanlders checking if they need to be expired.
     for (size_t ei = 0; ei < expirationHandlers.size(); ++ei) {
       auto& expirator = expirationHandlers[ei];
@@ -176,13 +188,15 @@ DataRelayer::RelayChoice
                      std::unique_ptr<FairMQMessage>&& payload)
 {
   // STATE HOLDING VARIABLES
-  // This is the class level state of the relaying. If we start supporting
-  // multithreading this will have to be made thread safe before we can invoke
-  // relay concurrently.
+  // This is the class level state of the relaying. relay can be invoked
+  // concurrently: the common case, i.e. a fully specified input for a
+  // timeslice which already has a slot, only takes the lock of that slot.
+  // Everything which changes the association between slots and timeslices
+  // (i.e. the TimesliceIndex) is done while holding mMutex.
   auto& index = mTimesliceIndex;
 
   auto& cache = mCache;
-  auto const& readonlyCache = mCache;
+  auto& slotStates = mSlotStates;
   auto& metrics = mMetrics;
   auto numInputTypes = mDistinctRoutesIndex.size();
 
@@ -219,9 +233,26 @@ DataRelayer::RelayChoice
     };
   };
 
+  // Fully specified inputs are looked up in the dispatch table. Their only
+  // variable is the start time, so that we do not need to go through the
+  // matchers and the VariableContext at all.
+  auto getConcreteInputTimeslice = [& dispatch = mConcreteDispatch,
+                                    &header]() -> std::tuple<int, TimesliceId> {
+    auto dh = o2::header::get<DataHeader*>(header->GetData());
+    auto dph = o2::header::get<DataProcessingHeader*>(header->GetData());
+    if (dh == nullptr || dph == nullptr) {
+      return {INVALID_INPUT, TimesliceId{TimesliceId::INVALID}};
+    }
+    auto it = dispatch.find(ConcreteDataMatcher{dh->dataOrigin, dh->dataDescription, dh->subSpecification});
+    if (it == dispatch.end()) {
+      return {INVALID_INPUT, TimesliceId{TimesliceId::INVALID}};
+    }
+    return {it->second, TimesliceId{dph->startTime}};
+  };
+
   // We need to prune the cache from the old stuff, if any. Otherwise we
   // simply store the payload in the cache and we mark relevant bit in the
-  // hence the first if.
+  // hence the first if. The lock of the slot must be held.
   auto pruneCache = [&cache,
                      &cachedStateMetrics = mCachedStateMetrics,
                      &numInputTypes,
@@ -239,7 +270,8 @@ DataRelayer::RelayChoice
     }
   };
 
-  // Actually save the header / payload in the slot
+  // Actually save the header / payload in the slot. The lock of the slot
+  // must be held.
   auto saveInSlot = [&header,
                      &cachedStateMetrics = mCachedStateMetrics,
                      &payload,
@@ -256,6 +288,18 @@ DataRelayer::RelayChoice
     assert(header.get() == nullptr && payload.get() == nullptr);
   };
 
+  // Save in a slot, while holding mMutex, and publish the timeslice it is
+  // now associated to.
+  auto saveInPublishedSlot = [&saveInSlot, &slotStates, &index](TimesliceId timeslice, int input, TimesliceSlot slot, auto&& prepare) {
+    auto& state = *slotStates[slot.index];
+    std::lock_guard<std::mutex> slotLock(state.mutex);
+    prepare(slot);
+    saveInSlot(timeslice, input, slot);
+    state.timeslice.store(index.getTimesliceForSlot(slot).value, std::memory_order_release);
+    index.publishSlot(slot);
+    index.markAsDirty(slot, true);
+  };
+
   auto updateStatistics = [& stats = mStats](TimesliceIndex::ActionTaken action) {
     // Update statistics for what happened
     switch (action) {
@@ -284,25 +328,59 @@ DataRelayer::RelayChoice
   auto timeslice = TimesliceId{TimesliceId::INVALID};
   auto slot = TimesliceSlot{TimesliceSlot::INVALID};
 
-  // First look for matching slots which already have some
-  // partial match.
-  for (size_t ci = 0; ci < index.size(); ++ci) {
-    slot = TimesliceSlot{ci};
-    if (index.isValid(slot) == false) {
-      continue;
-    }
-    std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(slot));
-    if (input != INVALID_INPUT) {
-      break;
+  // Lock free lookup of the slot already holding the timeslice of a
+  // fully specified input. Once we hold the lock of the slot, we check
+  // that it was not reassigned in the meanwhile.
+  std::tie(input, timeslice) = getConcreteInputTimeslice();
+  bool isConcrete = input != INVALID_INPUT && TimesliceId::isValid(timeslice);
+  if (isConcrete) {
+    for (size_t ci = 0; ci < slotStates.size(); ++ci) {
+      auto& state = *slotStates[ci];
+      if (state.timeslice.load(std::memory_order_acquire) != timeslice.value) {
+        continue;
+      }
+      std::lock_guard<std::mutex> slotLock(state.mutex);
+      if (state.timeslice.load(std::memory_order_relaxed) != timeslice.value) {
+        continue;
+      }
+      slot = TimesliceSlot{ci};
+      O2_SIGNPOST(O2_PROBE_DATARELAYER, timeslice.value, 0, 0, 0);
+      saveInSlot(timeslice, input, slot);
+      index.markAsDirty(slot, true);
+      mStats.relayedMessages++;
+      return WillRelay;
     }
   }
 
-  // If we did not find anything, look for slots which
-  // are invalid.
-  if (input == INVALID_INPUT) {
+  // Anything else requires to look at the whole index.
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto noPrepare = [](TimesliceSlot) {};
+
+  if (isConcrete) {
+    // The slot might have been created while we were waiting for the lock,
+    // otherwise we take the first invalid one.
+    for (size_t ci = 0; ci < index.size(); ++ci) {
+      if (index.isValid(TimesliceSlot{ci}) && index.getTimesliceForSlot(TimesliceSlot{ci}).value == timeslice.value) {
+        slot = TimesliceSlot{ci};
+        break;
+      }
+    }
+    if (TimesliceSlot::isValid(slot) == false) {
+      for (size_t ci = 0; ci < index.size(); ++ci) {
+        if (index.isValid(TimesliceSlot{ci}) == false) {
+          slot = TimesliceSlot{ci};
+          index.associate(timeslice, slot);
+          break;
+        }
+      }
+    }
+  } else {
+    input = INVALID_INPUT;
+    // First look for matching slots which already have some
+    // partial match.
     for (size_t ci = 0; ci < index.size(); ++ci) {
       slot = TimesliceSlot{ci};
-      if (index.isValid(slot) == true) {
+      if (index.isValid(slot) == false) {
         continue;
       }
       std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(slot));
@@ -310,14 +388,30 @@ DataRelayer::RelayChoice
         break;
       }
     }
+
+    // If we did not find anything, look for slots which
+    // are invalid.
+    if (input == INVALID_INPUT) {
+      for (size_t ci = 0; ci < index.size(); ++ci) {
+        slot = TimesliceSlot{ci};
+        if (index.isValid(slot) == true) {
+          continue;
+        }
+        std::tie(input, timeslice) = getInputTimeslice(index.getVariablesForSlot(slot));
+        if (input != INVALID_INPUT) {
+          break;
+        }
+      }
+    }
+    if (input == INVALID_INPUT) {
+      slot = TimesliceSlot{TimesliceSlot::INVALID};
+    }
   }
 
   /// If we get a valid result, we can store the message in cache.
   if (input != INVALID_INPUT && TimesliceId::isValid(timeslice) && TimesliceSlot::isValid(slot)) {
     O2_SIGNPOST(O2_PROBE_DATARELAYER, timeslice.value, 0, 0, 0);
-    saveInSlot(timeslice, input, slot);
-    index.publishSlot(slot);
-    index.markAsDirty(slot, true);
+    saveInPublishedSlot(timeslice, input, slot, noPrepare);
     mStats.relayedMessages++;
     return WillRelay;
   }
@@ -325,7 +419,12 @@ DataRelayer::RelayChoice
   /// If not, we find which timeslice we really were looking at
   /// and see if we can prune something from the cache.
   VariableContext pristineContext;
-  std::tie(input, timeslice) = getInputTimeslice(pristineContext);
+  if (isConcrete) {
+    pristineContext.put({0, static_cast<uint64_t>(timeslice.value)});
+    pristineContext.commit();
+  } else {
+    std::tie(input, timeslice) = getInputTimeslice(pristineContext);
+  }
 
   auto DataHeaderInfo = [&header]() {
     std::string error;
@@ -369,10 +468,7 @@ DataRelayer::RelayChoice
 
   // At this point the variables match the new input but the
   // cache still holds the old data, so we prune it.
-  pruneCache(slot);
-  saveInSlot(timeslice, input, slot);
-  index.publishSlot(slot);
-  index.markAsDirty(slot, true);
+  saveInPublishedSlot(timeslice, input, slot, pruneCache);
 
   return WillRelay;
 }
@@ -416,6 +512,7 @@ void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& comp
   if (numInputTypes == 0) {
     return;
   }
+  std::lock_guard<std::mutex> lock(mMutex);
   size_t cacheLines = cache.size() / numInputTypes;
   assert(cacheLines * numInputTypes == cache.size());
 
@@ -426,6 +523,8 @@ void DataRelayer::getReadyToProcess(std::vector<DataRelayer::RecordAction>& comp
     if (mTimesliceIndex.isDirty(slot) == false) {
       continue;
     }
+    // Messages for this slot might still be arriving from other threads.
+    std::lock_guard<std::mutex> slotLock(mSlotStates[li]->mutex);
     auto partial = getPartialRecord(li);
     auto getter = [&partial](size_t idx, size_t part) {
       if (partial[idx].size() > 0 && partial[idx].at(part).header && partial[idx].at(part).payload) {
@@ -498,22 +597,31 @@ std::vector<o2::framework::MessageSet> DataRelayer::getInputsForTimeslice(Timesl
   };
 
   // Outer loop here.
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto& state = *mSlotStates[slot.index];
+  std::lock_guard<std::mutex> slotLock(state.mutex);
   jumpToCacheEntryAssociatedWith(slot);
   for (size_t ai = 0, ae = numInputTypes; ai != ae; ++ai) {
     moveHeaderPayloadToOutput(slot, ai);
   }
   invalidateCacheFor(slot);
+  state.timeslice.store(TimesliceId::INVALID, std::memory_order_release);
 
   return std::move(messages);
 }
 
 void DataRelayer::clear()
 {
-  for (auto& cache : mCache) {
-    cache.clear();
-  }
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto numInputTypes = mDistinctRoutesIndex.size();
   for (size_t s = 0; s < mTimesliceIndex.size(); ++s) {
+    auto& state = *mSlotStates[s];
+    std::lock_guard<std::mutex> slotLock(state.mutex);
+    for (size_t ai = s * numInputTypes, ae = ai + numInputTypes; ai != ae; ++ai) {
+      mCache[ai].clear();
+    }
     mTimesliceIndex.markAsInvalid(TimesliceSlot{s});
+    state.timeslice.store(TimesliceId::INVALID, std::memory_order_release);
   }
 }
 
@@ -527,9 +635,15 @@ size_t
 /// Notice that in case we have time pipelining we need to count
 /// the actual number of different types, without taking into account
 /// the time pipelining.
+/// Must not be invoked while other threads are relaying.
 void DataRelayer::setPipelineLength(size_t s)
 {
+  std::lock_guard<std::mutex> lock(mMutex);
   mTimesliceIndex.resize(s);
+  mSlotStates.resize(s);
+  for (auto& state : mSlotStates) {
+    state = std::make_unique<SlotState>();
+  }
   mVariableContextes.resize(s);
   publishMetrics();
 }
@@ -566,19 +680,26 @@ void DataRelayer::publishMetrics()
   }
 }
 
-DataRelayerStats const& DataRelayer::getStats() const
+DataRelayerStats DataRelayer::getStats() const
 {
-  return mStats;
+  return DataRelayerStats{
+    mStats.malformedInputs.load(),
+    mStats.droppedComputations.load(),
+    mStats.droppedIncomingMessages.load(),
+    mStats.relayedMessages.load()};
 }
 
 void DataRelayer::sendContextState()
 {
+  std::lock_guard<std::mutex> lock(mMutex);
   for (size_t ci = 0; ci < mTimesliceIndex.size(); ++ci) {
     auto slot = TimesliceSlot{ci};
     sendVariableContextMetrics(mTimesliceIndex.getPublishedVariablesForSlot(slot), slot,
                                mMetrics, sVariablesMetricsNames);
   }
+  auto numInputTypes = mDistinctRoutesIndex.size();
   for (size_t si = 0; si < mCachedStateMetrics.size(); ++si) {
+    std::lock_guard<std::mutex> slotLock(mSlotStates[si / numInputTypes]->mutex);
     mMetrics.send({mCachedStateMetrics[si], sMetricsNames[si]});
   }
 }
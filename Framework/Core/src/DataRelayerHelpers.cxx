@@ -68,4 +68,20 @@ std::vector<DataDescriptorMatcher>
   return result;
 }
 
+std::unordered_map<ConcreteDataMatcher, int>
+  DataRelayerHelpers::createConcreteDispatchTable(std::vector<InputRoute> const& routes, std::vector<size_t> const& distinctRoutes)
+{
+  std::unordered_map<ConcreteDataMatcher, int> result;
+  for (size_t ri = 0; ri < distinctRoutes.size(); ++ri) {
+    auto pval = std::get_if<ConcreteDataMatcher>(&routes[distinctRoutes[ri]].matcher.matcher);
+    if (pval == nullptr) {
+      // anything after a generic matcher might be shadowed by it.
+      break;
+    }
+    // the first route wins, like in the linear matching
+    result.emplace(*pval, ri);
+  }
+  return result;
+}
+
 } // namespace o2::framework
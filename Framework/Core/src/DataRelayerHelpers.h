@@ -11,6 +11,7 @@
 #define O2_FRAMEWORK_DATARELAYERHELPERS_H_
 
 #include "Framework/InputRoute.h"
+#include <unordered_map>
 #include <vector>
 
 namespace o2::framework
@@ -22,6 +23,11 @@ struct DataRelayerHelpers {
   static std::vector<size_t> createDistinctRouteIndex(std::vector<InputRoute> const&);
   /// This converts from InputRoute to the associated DataDescriptorMatcher.
   static std::vector<data_matcher::DataDescriptorMatcher> createInputMatchers(std::vector<InputRoute> const&);
+  /// This maps every fully specified input to the index of its distinct route.
+  /// Only the routes which the linear matching would pick anyway, i.e. which
+  /// are not preceded by a generic matcher, are included.
+  static std::unordered_map<ConcreteDataMatcher, int> createConcreteDispatchTable(std::vector<InputRoute> const&,
+                                                                                  std::vector<size_t> const& distinctRoutes);
 };
 
 } // namespace o2::framework
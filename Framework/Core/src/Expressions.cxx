@@ -13,12 +13,15 @@
 #include "Framework/Logger.h"
 #include "gandiva/tree_expr_builder.h"
 #include "arrow/table.h"
+#include "arrow/array.h"
 #include "fmt/format.h"
 #include <stack>
 #include <iostream>
 #include <unordered_map>
 #include <set>
 #include <algorithm>
+#include <functional>
+#include <mutex>
 
 using namespace o2::framework;
 
@@ -242,32 +245,54 @@ gandiva::ExpressionPtr makeExpression(gandiva::NodePtr node, gandiva::FieldPtr r
   return gandiva::TreeExprBuilder::MakeExpression(node, result);
 }
 
+namespace
+{
+/// compiled gandiva filters, keyed by the textual form of schema and condition
+/// (literals are printed with their raw bits, so the key is exact)
+struct FilterCache {
+  static constexpr size_t MaxSize = 512;
+  std::mutex mutex;
+  std::unordered_map<std::string, std::shared_ptr<gandiva::Filter>> filters;
+};
+
+FilterCache& filterCache()
+{
+  static FilterCache cache;
+  return cache;
+}
+} // namespace
+
 std::shared_ptr<gandiva::Filter>
   createFilter(gandiva::SchemaPtr const& Schema, Operations const& opSpecs)
 {
-  std::shared_ptr<gandiva::Filter> filter;
-  auto s = gandiva::Filter::Make(Schema,
-                                 makeCondition(createExpressionTree(opSpecs, Schema)),
-                                 &filter);
-  if (s.ok()) {
-    return filter;
-  } else {
-    throw std::runtime_error(fmt::format("Failed to create filter: {}", s.ToString()));
-  }
+  return createFilter(Schema, makeCondition(createExpressionTree(opSpecs, Schema)));
 }
 
 std::shared_ptr<gandiva::Filter>
   createFilter(gandiva::SchemaPtr const& Schema, gandiva::ConditionPtr condition)
 {
+  auto key = Schema->ToString() + "\n" + condition->ToString();
+  auto& cache = filterCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto found = cache.filters.find(key);
+    if (found != cache.filters.end()) {
+      return found->second;
+    }
+  }
+  // compile outside of the lock, at worst the same filter is compiled twice
   std::shared_ptr<gandiva::Filter> filter;
   auto s = gandiva::Filter::Make(Schema,
                                  condition,
                                  &filter);
-  if (s.ok()) {
-    return filter;
-  } else {
+  if (!s.ok()) {
     throw std::runtime_error(fmt::format("Failed to create filter: {}", s.ToString()));
   }
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (cache.filters.size() >= FilterCache::MaxSize) {
+    cache.filters.clear();
+  }
+  return cache.filters.emplace(std::move(key), filter).first->second;
 }
 
 std::shared_ptr<gandiva::Projector>
@@ -321,7 +346,227 @@ Selection createSelection(std::shared_ptr<arrow::Table> table, std::shared_ptr<g
 Selection createSelection(std::shared_ptr<arrow::Table> table,
                           const Filter& expression)
 {
-  return createSelection(table, createFilter(table->schema(), createOperations(std::move(expression))));
+  auto opSpecs = createOperations(std::move(expression));
+  if (table->num_rows() <= NativeEvaluationMaxRows && isNativelyEvaluable(table, opSpecs)) {
+    return createSelectionNative(table, opSpecs);
+  }
+  return createSelection(table, createFilter(table->schema(), opSpecs));
+}
+
+namespace
+{
+bool isComparison(BasicOp op)
+{
+  return op >= BasicOp::LessThan && op <= BasicOp::NotEqual;
+}
+
+/// operand of a comparison: either a literal or the values of a column in
+/// the current batch, converted to double so that all the combinations of
+/// types are compared with the same loops
+struct NativeOperand {
+  bool isScalar = false;
+  double scalar = 0;
+  std::vector<double> values;
+};
+
+template <typename T>
+void convertColumn(arrow::Array const& array, std::vector<double>& values)
+{
+  auto raw = static_cast<arrow::NumericArray<T> const&>(array).raw_values();
+  auto out = values.data();
+  for (int64_t i = 0; i < array.length(); ++i) {
+    out[i] = raw[i];
+  }
+}
+
+void fillOperand(DatumSpec const& spec, arrow::RecordBatch const& batch, NativeOperand& operand)
+{
+  if (spec.datum.index() == 2) {
+    operand.isScalar = true;
+    operand.scalar = std::visit([](auto value) { return static_cast<double>(value); },
+                                std::get<LiteralNode::var_t>(spec.datum));
+    return;
+  }
+  auto array = batch.GetColumnByName(std::get<std::string>(spec.datum));
+  operand.isScalar = false;
+  operand.values.resize(array->length());
+  switch (array->type_id()) {
+    case arrow::Type::INT8:
+      convertColumn<arrow::Int8Type>(*array, operand.values);
+      break;
+    case arrow::Type::INT16:
+      convertColumn<arrow::Int16Type>(*array, operand.values);
+      break;
+    case arrow::Type::INT32:
+      convertColumn<arrow::Int32Type>(*array, operand.values);
+      break;
+    case arrow::Type::FLOAT:
+      convertColumn<arrow::FloatType>(*array, operand.values);
+      break;
+    case arrow::Type::DOUBLE:
+      convertColumn<arrow::DoubleType>(*array, operand.values);
+      break;
+    case arrow::Type::BOOL: {
+      auto& bools = static_cast<arrow::BooleanArray const&>(*array);
+      for (int64_t i = 0; i < bools.length(); ++i) {
+        operand.values[i] = bools.Value(i);
+      }
+      break;
+    }
+    default:
+      throw std::runtime_error(fmt::format("Column {} cannot be evaluated natively", array->type()->ToString()));
+  }
+}
+
+/// branch-free loops over the rows, which the compiler vectorizes
+template <typename CMP>
+void compare(NativeOperand const& left, NativeOperand const& right, uint8_t* result, int64_t size, CMP cmp)
+{
+  if (left.isScalar && right.isScalar) {
+    std::fill(result, result + size, cmp(left.scalar, right.scalar));
+  } else if (left.isScalar) {
+    auto r = right.values.data();
+    for (int64_t i = 0; i < size; ++i) {
+      result[i] = cmp(left.scalar, r[i]);
+    }
+  } else if (right.isScalar) {
+    auto l = left.values.data();
+    for (int64_t i = 0; i < size; ++i) {
+      result[i] = cmp(l[i], right.scalar);
+    }
+  } else {
+    auto l = left.values.data();
+    auto r = right.values.data();
+    for (int64_t i = 0; i < size; ++i) {
+      result[i] = cmp(l[i], r[i]);
+    }
+  }
+}
+} // namespace
+
+bool isNativelyEvaluable(std::shared_ptr<arrow::Table> const& table, Operations const& opSpecs)
+{
+  auto isSupportedOperand = [&table](DatumSpec const& spec) {
+    if (spec.datum.index() == 2) {
+      return true;
+    }
+    if (spec.datum.index() != 3) {
+      return false;
+    }
+    auto column = table->GetColumnByName(std::get<std::string>(spec.datum));
+    if (column == nullptr || column->null_count() != 0) {
+      return false;
+    }
+    switch (column->type()->id()) {
+      case arrow::Type::INT8:
+      case arrow::Type::INT16:
+      case arrow::Type::INT32:
+      case arrow::Type::FLOAT:
+      case arrow::Type::DOUBLE:
+      case arrow::Type::BOOL:
+        return true;
+      default:
+        return false;
+    }
+  };
+
+  for (auto& spec : opSpecs) {
+    if (spec.op == BasicOp::LogicalAnd || spec.op == BasicOp::LogicalOr) {
+      if (spec.left.datum.index() != 1 || spec.right.datum.index() != 1) {
+        return false;
+      }
+    } else if (isComparison(spec.op)) {
+      if (!isSupportedOperand(spec.left) || !isSupportedOperand(spec.right)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+  return opSpecs.empty() == false;
+}
+
+Selection createSelectionNative(std::shared_ptr<arrow::Table> const& table, Operations const& opSpecs)
+{
+  Selection selection;
+  auto s = gandiva::SelectionVector::MakeInt64(table->num_rows(),
+                                               arrow::default_memory_pool(),
+                                               &selection);
+  if (!s.ok()) {
+    throw std::runtime_error(fmt::format("Cannot allocate selection vector {}", s.ToString()));
+  }
+
+  // one mask per operation, indexed as the results of the operations
+  std::vector<std::vector<uint8_t>> masks(opSpecs.size());
+  NativeOperand left;
+  NativeOperand right;
+  int64_t offset = 0;
+  int64_t selected = 0;
+
+  arrow::TableBatchReader reader(*table);
+  std::shared_ptr<arrow::RecordBatch> batch;
+  while (true) {
+    s = reader.ReadNext(&batch);
+    if (!s.ok()) {
+      throw std::runtime_error(fmt::format("Cannot read batches from table {}", s.ToString()));
+    }
+    if (batch == nullptr) {
+      break;
+    }
+    auto size = batch->num_rows();
+    for (auto it = opSpecs.rbegin(); it != opSpecs.rend(); ++it) {
+      auto& result = masks[std::get<size_t>(it->result.datum)];
+      result.resize(size);
+      auto out = result.data();
+      if (it->op == BasicOp::LogicalAnd || it->op == BasicOp::LogicalOr) {
+        auto l = masks[std::get<size_t>(it->left.datum)].data();
+        auto r = masks[std::get<size_t>(it->right.datum)].data();
+        if (it->op == BasicOp::LogicalAnd) {
+          for (int64_t i = 0; i < size; ++i) {
+            out[i] = l[i] & r[i];
+          }
+        } else {
+          for (int64_t i = 0; i < size; ++i) {
+            out[i] = l[i] | r[i];
+          }
+        }
+        continue;
+      }
+      fillOperand(it->left, *batch, left);
+      fillOperand(it->right, *batch, right);
+      switch (it->op) {
+        case BasicOp::LessThan:
+          compare(left, right, out, size, std::less<double>{});
+          break;
+        case BasicOp::LessThanOrEqual:
+          compare(left, right, out, size, std::less_equal<double>{});
+          break;
+        case BasicOp::GreaterThan:
+          compare(left, right, out, size, std::greater<double>{});
+          break;
+        case BasicOp::GreaterThanOrEqual:
+          compare(left, right, out, size, std::greater_equal<double>{});
+          break;
+        case BasicOp::Equal:
+          compare(left, right, out, size, std::equal_to<double>{});
+          break;
+        case BasicOp::NotEqual:
+          compare(left, right, out, size, std::not_equal_to<double>{});
+          break;
+        default:
+          throw std::runtime_error(fmt::format("Operation {} cannot be evaluated natively", binaryOperationsMap[it->op]));
+      }
+    }
+    auto root = masks[0].data();
+    for (int64_t i = 0; i < size; ++i) {
+      if (root[i]) {
+        selection->SetIndex(selected++, offset + i);
+      }
+    }
+    offset += size;
+  }
+  selection->SetNumSlots(selected);
+  return selection;
 }
 
 auto createProjection(std::shared_ptr<arrow::Table> table, std::shared_ptr<gandiva::Projector> gprojector)
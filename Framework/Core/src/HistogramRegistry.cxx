@@ -0,0 +1,218 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Framework/HistogramRegistry.h"
+
+#include <TROOT.h>
+#include <fmt/format.h>
+
+namespace o2::framework
+{
+
+namespace
+{
+/// thread slots which are not in use
+struct FreeThreadSlots {
+  std::mutex mutex;
+  std::vector<int> slots;
+  int next = 0;
+};
+
+FreeThreadSlots& freeThreadSlots()
+{
+  static FreeThreadSlots freeSlots;
+  return freeSlots;
+}
+
+void checkAxes(HistogramSpec const& spec, size_t dimension)
+{
+  if (spec.config.axes.size() != dimension) {
+    throw std::runtime_error(fmt::format("Histogram {} of kind {} needs {} axes, {} given",
+                                         spec.name, spec.config.kind, dimension, spec.config.axes.size()));
+  }
+}
+
+template <typename T>
+std::unique_ptr<TH1> create1D(HistogramSpec const& spec)
+{
+  checkAxes(spec, 1);
+  auto& x = spec.config.axes[0];
+  return std::make_unique<T>(spec.name.data(), spec.readableName.data(), x.nBins, x.min, x.max);
+}
+
+template <typename T>
+std::unique_ptr<TH1> create2D(HistogramSpec const& spec)
+{
+  checkAxes(spec, 2);
+  auto& x = spec.config.axes[0];
+  auto& y = spec.config.axes[1];
+  return std::make_unique<T>(spec.name.data(), spec.readableName.data(), x.nBins, x.min, x.max, y.nBins, y.min, y.max);
+}
+
+template <typename T>
+std::unique_ptr<TH1> create3D(HistogramSpec const& spec)
+{
+  checkAxes(spec, 3);
+  auto& x = spec.config.axes[0];
+  auto& y = spec.config.axes[1];
+  auto& z = spec.config.axes[2];
+  return std::make_unique<T>(spec.name.data(), spec.readableName.data(), x.nBins, x.min, x.max, y.nBins, y.min, y.max, z.nBins, z.min, z.max);
+}
+
+template <typename T>
+std::unique_ptr<THnBase> createND(HistogramSpec const& spec)
+{
+  auto& axes = spec.config.axes;
+  if (axes.empty()) {
+    throw std::runtime_error(fmt::format("Histogram {} has no axes", spec.name));
+  }
+  std::vector<int> nBins;
+  std::vector<double> min;
+  std::vector<double> max;
+  for (auto& axis : axes) {
+    nBins.push_back(axis.nBins);
+    min.push_back(axis.min);
+    max.push_back(axis.max);
+  }
+  return std::make_unique<T>(spec.name.data(), spec.readableName.data(), axes.size(), nBins.data(), min.data(), max.data());
+}
+
+void reset(HistogramRegistry::HistPtr& hist)
+{
+  std::visit([](auto& h) {
+    if (h) {
+      h->Reset();
+    }
+  },
+             hist);
+}
+} // namespace
+
+HistogramRegistry::ThreadSlot::ThreadSlot()
+{
+  auto& freeSlots = freeThreadSlots();
+  std::lock_guard<std::mutex> lock(freeSlots.mutex);
+  if (freeSlots.slots.empty() == false) {
+    id = freeSlots.slots.back();
+    freeSlots.slots.pop_back();
+  } else {
+    id = freeSlots.next++;
+  }
+}
+
+HistogramRegistry::ThreadSlot::~ThreadSlot()
+{
+  auto& freeSlots = freeThreadSlots();
+  std::lock_guard<std::mutex> lock(freeSlots.mutex);
+  freeSlots.slots.push_back(id);
+}
+
+HistogramRegistry::HistPtr HistogramRegistry::createHistogram(HistogramSpec const& spec)
+{
+  auto& kind = spec.config.kind;
+  HistPtr hist;
+  if (kind == "TH1F") {
+    hist = create1D<TH1F>(spec);
+  } else if (kind == "TH1D") {
+    hist = create1D<TH1D>(spec);
+  } else if (kind == "TH1I") {
+    hist = create1D<TH1I>(spec);
+  } else if (kind == "TProfile") {
+    hist = create1D<TProfile>(spec);
+  } else if (kind == "TH2F") {
+    hist = create2D<TH2F>(spec);
+  } else if (kind == "TH2D") {
+    hist = create2D<TH2D>(spec);
+  } else if (kind == "TH2I") {
+    hist = create2D<TH2I>(spec);
+  } else if (kind == "TProfile2D") {
+    hist = create2D<TProfile2D>(spec);
+  } else if (kind == "TH3F") {
+    hist = create3D<TH3F>(spec);
+  } else if (kind == "TH3D") {
+    hist = create3D<TH3D>(spec);
+  } else if (kind == "TH3I") {
+    hist = create3D<TH3I>(spec);
+  } else if (kind == "TProfile3D") {
+    hist = create3D<TProfile3D>(spec);
+  } else if (kind == "THnF") {
+    hist = createND<THnF>(spec);
+  } else if (kind == "THnD") {
+    hist = createND<THnD>(spec);
+  } else if (kind == "THnI") {
+    hist = createND<THnI>(spec);
+  } else if (kind == "THnSparseF") {
+    hist = createND<THnSparseF>(spec);
+  } else if (kind == "THnSparseD") {
+    hist = createND<THnSparseD>(spec);
+  } else if (kind == "THnSparseI") {
+    hist = createND<THnSparseI>(spec);
+  } else {
+    throw std::runtime_error(fmt::format("Histogram {} of unsupported kind {}", spec.name, kind));
+  }
+  // the registry owns the histograms, they must not be deleted with the current directory
+  if (hist.index() == 0) {
+    std::get<0>(hist)->SetDirectory(nullptr);
+  }
+  return hist;
+}
+
+namespace
+{
+std::once_flag threadSafetyFlag;
+std::atomic<bool> threadSafetyEnabled{false};
+} // namespace
+
+void HistogramRegistry::enableThreadSafety()
+{
+  std::call_once(threadSafetyFlag, []() {
+    ROOT::EnableThreadSafety();
+    threadSafetyEnabled = true;
+  });
+}
+
+HistogramRegistry::HistArray* HistogramRegistry::createShard(int slot)
+{
+  if (mConcurrentFilling == false || threadSafetyEnabled == false) {
+    throw std::runtime_error(fmt::format("Registry {} is filled from several threads, it has to be created with concurrent filling "
+                                         "and the thread safety has to be enabled before",
+                                         name));
+  }
+  if (slot >= MAX_THREADS) {
+    throw std::runtime_error(fmt::format("Too many threads filling registry {}", name));
+  }
+  // histograms are created concurrently to the filling by other threads
+  auto shard = std::make_unique<HistArray>();
+  for (auto& [i, spec] : mSpecs) {
+    (*shard)[i] = createHistogram(spec);
+  }
+  std::lock_guard<std::mutex> lock(mShards->mutex);
+  mShards->bySlot[slot].store(shard.get(), std::memory_order_release);
+  mShards->owned.emplace_back(std::move(shard));
+  return mShards->owned.back().get();
+}
+
+void HistogramRegistry::merge()
+{
+  std::lock_guard<std::mutex> lock(mShards->mutex);
+  for (auto& shard : mShards->owned) {
+    for (auto& [i, spec] : mSpecs) {
+      auto& hist = (*shard)[i];
+      if (hist.index() == 0) {
+        std::get<0>(mRegistryValue[i])->Add(std::get<0>(hist).get());
+      } else {
+        std::get<1>(mRegistryValue[i])->Add(std::get<1>(hist).get());
+      }
+      reset(hist);
+    }
+  }
+}
+
+} // namespace o2::framework
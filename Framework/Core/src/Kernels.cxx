@@ -13,11 +13,14 @@
 #include "ArrowDebugHelpers.h"
 
 #include <arrow/builder.h>
+#include <arrow/compute/kernels/take.h>
 #include <arrow/status.h>
+#include <arrow/table.h>
 #include <arrow/type.h>
 #include <arrow/util/variant.h>
-#include <memory>
 #include <iostream>
+#include <limits>
+#include <memory>
 
 using namespace arrow;
 using namespace arrow::compute;
@@ -44,5 +47,86 @@ Status HashByColumnKernel::Call(FunctionContext* ctx, Datum const& inputTable, D
   return Status::Invalid("Input Datum was not a table");
 }
 
+std::shared_ptr<GroupSlices> groupByIndex(std::shared_ptr<arrow::ChunkedArray> const& column, int32_t size)
+{
+  auto slices = std::make_shared<GroupSlices>();
+  slices->starts.resize(size, 0);
+  slices->counts.resize(size, 0);
+  auto& counts = slices->counts;
+
+  // count the rows of each group, checking if the groups are contiguous:
+  // the rows out of range are only allowed before or after all the groups
+  bool sorted = true;
+  int64_t before = 0;
+  int32_t previous = std::numeric_limits<int32_t>::min();
+  for (auto ci = 0; ci < column->num_chunks(); ++ci) {
+    auto chunk = std::static_pointer_cast<arrow::Int32Array>(column->chunk(ci));
+    auto data = chunk->raw_values();
+    for (auto ai = 0; ai < chunk->length(); ++ai) {
+      auto value = data[ai];
+      sorted &= value >= previous;
+      previous = value;
+      if (value >= 0 && value < size) {
+        counts[value]++;
+      } else if (value < 0) {
+        before++;
+      }
+    }
+  }
+
+  int64_t offset = sorted ? before : 0;
+  for (auto gi = 0; gi < size; ++gi) {
+    slices->starts[gi] = offset;
+    offset += counts[gi];
+  }
+  if (sorted) {
+    return slices;
+  }
+
+  // rows of each group at the position following the ones already placed
+  auto& permutation = slices->permutation;
+  permutation.resize(offset);
+  std::vector<int64_t> next = slices->starts;
+  int64_t row = 0;
+  for (auto ci = 0; ci < column->num_chunks(); ++ci) {
+    auto chunk = std::static_pointer_cast<arrow::Int32Array>(column->chunk(ci));
+    auto data = chunk->raw_values();
+    for (auto ai = 0; ai < chunk->length(); ++ai, ++row) {
+      auto value = data[ai];
+      if (value >= 0 && value < size) {
+        permutation[next[value]++] = row;
+      }
+    }
+  }
+  return slices;
+}
+
+arrow::Status groupTable(FunctionContext* context,
+                         std::shared_ptr<arrow::Table> const& table,
+                         GroupSlices const& slices,
+                         std::shared_ptr<arrow::Table>* output)
+{
+  if (slices.sorted()) {
+    *output = table;
+    return arrow::Status::OK();
+  }
+  arrow::Int64Builder builder;
+  std::shared_ptr<arrow::Array> indices;
+  ARROW_RETURN_NOT_OK(builder.AppendValues(slices.permutation));
+  ARROW_RETURN_NOT_OK(builder.Finish(&indices));
+  return arrow::compute::Take(context, *table, *indices, arrow::compute::TakeOptions{}, output);
+}
+
+std::shared_ptr<arrow::Table> sliceTable(std::shared_ptr<arrow::Table> const& table, int64_t start, int64_t count)
+{
+  auto schema = table->schema();
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> slicedColumns;
+  slicedColumns.reserve(schema->num_fields());
+  for (auto ci = 0; ci < schema->num_fields(); ++ci) {
+    slicedColumns.emplace_back(table->column(ci)->Slice(start, count));
+  }
+  return arrow::Table::Make(schema, slicedColumns);
+}
+
 } // namespace framework
 } // namespace o2
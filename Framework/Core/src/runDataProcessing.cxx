@@ -7,6 +7,7 @@
 // In applying this license CERN does not waive the privileges and immunities
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
+#include "Framework/ArrowTableSlicingCache.h"
 #include "Framework/BoostOptionsRetriever.h"
 #include "Framework/ChannelConfigurationPolicy.h"
 #include "Framework/ChannelMatching.h"
@@ -699,6 +700,7 @@ int doChild(int argc, char** argv, const o2::framework::DeviceSpec& spec, Termin
     std::unique_ptr<InfoLogger> infoLoggerService;
     std::unique_ptr<InfoLoggerContext> infoLoggerContext;
     std::unique_ptr<TimesliceIndex> timesliceIndex;
+    std::unique_ptr<ArrowTableSlicingCache> slicingCache;
     std::unique_ptr<DeviceState> deviceState;
 
     auto afterConfigParsingCallback = [&localRootFileService,
@@ -714,6 +716,7 @@ int doChild(int argc, char** argv, const o2::framework::DeviceSpec& spec, Termin
                                        &infoLoggerContext,
                                        &deviceState,
                                        &timesliceIndex,
+                                       &slicingCache,
                                        &errorPolicy](fair::mq::DeviceRunner& r) {
       localRootFileService = std::make_unique<LocalRootFileService>();
       deviceState = std::make_unique<DeviceState>();
@@ -737,6 +740,7 @@ int doChild(int argc, char** argv, const o2::framework::DeviceSpec& spec, Termin
         fair::Logger::AddCustomSink("infologger", infoLoggerSeverity, createInfoLoggerSinkHelper(infoLoggerService, infoLoggerContext));
       }
       timesliceIndex = std::make_unique<TimesliceIndex>();
+      slicingCache = std::make_unique<ArrowTableSlicingCache>();
 
       serviceRegistry.registerService<Monitoring>(monitoringService.get());
       serviceRegistry.registerService<ConfigurationInterface>(configurationService.get());
@@ -747,6 +751,7 @@ int doChild(int argc, char** argv, const o2::framework::DeviceSpec& spec, Termin
       serviceRegistry.registerService<RawDeviceService>(simpleRawDeviceService.get());
       serviceRegistry.registerService<CallbackService>(callbackService.get());
       serviceRegistry.registerService<TimesliceIndex>(timesliceIndex.get());
+      serviceRegistry.registerService<ArrowTableSlicingCache>(slicingCache.get());
       serviceRegistry.registerService<DeviceSpec>(&spec);
 
       // The decltype stuff is to be able to compile with both new and old
@@ -1414,6 +1419,11 @@ int doMain(int argc, char** argv, o2::framework::WorkflowSpec const& workflow,
            o2::framework::ConfigContext& configContext)
 {
   O2_SIGNPOST_INIT();
+  O2_SIGNPOST_NAME(DataProcessingStatus::ID, "DataProcessingStatus");
+  O2_SIGNPOST_NAME(MonitoringStatus::ID, "MonitoringStatus");
+  O2_SIGNPOST_NAME(DriverStatus::ID, "DriverStatus");
+  O2_SIGNPOST_NAME(O2_PROBE_DATARELAYER, "DataRelayer");
+  O2_SIGNPOST_NAME(SendingStatus::ID, "SendingStatus");
   std::vector<std::string> currentArgs;
   for (size_t ai = 1; ai < argc; ++ai) {
     currentArgs.push_back(argv[ai]);
@@ -12,6 +12,8 @@
 #include "Framework/TableBuilder.h"
 #include "Framework/AnalysisDataModel.h"
 #include <benchmark/benchmark.h>
+#include <array>
+#include <numeric>
 #include <random>
 #include <vector>
 
@@ -473,6 +475,40 @@ static void BM_ASoAHelpersCombGenSimplePairsSameCategories(benchmark::State& sta
 
 BENCHMARK(BM_ASoAHelpersCombGenSimplePairsSameCategories)->Range(8, 8 << maxPairsRange);
 
+static void BM_ASoAHelpersParallelSimplePairsSameCategories(benchmark::State& state)
+{
+  // Seed with a real random value, if available
+  std::default_random_engine e1(1234567891);
+  std::uniform_real_distribution<float> uniform_dist(0, 1);
+  std::uniform_int_distribution<int> uniform_dist_int(0, 10);
+
+  TableBuilder builder;
+  auto rowWriter = builder.persist<int, float, float>({"x", "y", "z"});
+  for (auto i = 0; i < state.range(0); ++i) {
+    rowWriter(0, uniform_dist_int(e1), uniform_dist(e1), uniform_dist(e1));
+  }
+  auto table = builder.finalize();
+
+  using Test = o2::soa::Table<test::X>;
+  Test tests{table};
+
+  constexpr int nThreads = 4;
+  int64_t count = 0;
+
+  for (auto _ : state) {
+    std::array<int64_t, nThreads> counts{};
+    parallelCombinations(CombinationsBlockUpperSameIndexPolicy("x", 2, -1, tests, tests), nThreads, [&counts](int slot, auto&) {
+      counts[slot]++;
+    });
+    count = std::accumulate(counts.begin(), counts.end(), int64_t{0});
+    benchmark::DoNotOptimize(count);
+  }
+  state.counters["Combinations"] = count;
+  state.SetBytesProcessed(state.iterations() * sizeof(float) * count);
+}
+
+BENCHMARK(BM_ASoAHelpersParallelSimplePairsSameCategories)->Range(8, 8 << maxPairsRange)->UseRealTime();
+
 static void BM_ASoAHelpersCombGenSimpleFivesSameCategories(benchmark::State& state)
 {
   // Seed with a real random value, if available
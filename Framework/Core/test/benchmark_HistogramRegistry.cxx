@@ -61,7 +61,26 @@ static void BM_StandardNameLookup(benchmark::State& state)
     }
   }
 }
+/// Fill a histogram looked up by its name, hashed at compile time
+static void BM_HashedNameFill(benchmark::State& state)
+{
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<HistogramSpec> specs;
+    for (auto i = 0; i < state.range(0); ++i) {
+      specs.push_back({(boost::format("histo%1%") % (i + 1)).str().c_str(), (boost::format("Histo %1%") % (i + 1)).str().c_str(), {"TH2F", {{100, 0, 1}, {100, 0, 1}}}});
+    }
+    HistogramRegistry registry{"registry", true, specs};
+    state.ResumeTiming();
+
+    for (auto i = 0; i < nLookups; ++i) {
+      registry.fill(HIST("histo4"), 0.5, 0.5);
+    }
+  }
+}
+
 BENCHMARK(BM_HashedNameLookup)->Arg(4)->Arg(8)->Arg(16)->Arg(64)->Arg(128)->Arg(256)->Arg(512);
+BENCHMARK(BM_HashedNameFill)->Arg(4)->Arg(64)->Arg(512);
 BENCHMARK(BM_StandardNameLookup)->Arg(4)->Arg(8)->Arg(16)->Arg(64)->Arg(128)->Arg(256)->Arg(512);
 
 BENCHMARK_MAIN();
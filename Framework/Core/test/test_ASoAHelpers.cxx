@@ -16,6 +16,8 @@
 #include "Framework/TableBuilder.h"
 #include "Framework/AnalysisDataModel.h"
 #include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <stdexcept>
 
 using namespace o2::framework;
 using namespace o2::soa;
@@ -1228,3 +1230,97 @@ BOOST_AUTO_TEST_CASE(BlockCombinations)
   }
   BOOST_CHECK_EQUAL(count, 0);
 }
+
+BOOST_AUTO_TEST_CASE(ParallelBlockCombinations)
+{
+  TableBuilder builderAux;
+  auto rowWriterAux = builderAux.persist<int32_t, int32_t>({"x", "y"});
+  // categories of different sizes, some rows outside all categories
+  for (auto i = 0; i < 200; ++i) {
+    rowWriterAux(0, i, (i * i) % 7 == 3 ? -1 : (i * 13) % 11);
+  }
+  auto tableAux = builderAux.finalize();
+  using TestsAux = o2::soa::Table<o2::soa::Index<>, test::X, test::Y>;
+  TestsAux testAux{tableAux};
+
+  constexpr int nThreads = 3;
+  auto check = [](auto const& policy, int expectedSlots) {
+    std::vector<std::vector<std::tuple<int32_t, int32_t>>> expected(1);
+    for (auto& [c0, c1] : combinations(policy)) {
+      expected[0].emplace_back(c0.x(), c1.x());
+    }
+    BOOST_REQUIRE(expected[0].empty() == false);
+
+    std::vector<std::vector<std::tuple<int32_t, int32_t>>> perSlot(nThreads);
+    parallelCombinations(policy, nThreads, [&perSlot](int slot, auto& combination) {
+      auto& [c0, c1] = combination;
+      perSlot[slot].emplace_back(c0.x(), c1.x());
+    });
+    std::vector<std::tuple<int32_t, int32_t>> result;
+    int usedSlots = 0;
+    for (auto& slot : perSlot) {
+      usedSlots += slot.empty() ? 0 : 1;
+      result.insert(result.end(), slot.begin(), slot.end());
+    }
+    BOOST_CHECK(usedSlots <= expectedSlots);
+    std::sort(result.begin(), result.end());
+    std::sort(expected[0].begin(), expected[0].end());
+    BOOST_CHECK(result == expected[0]);
+  };
+
+  check(CombinationsBlockStrictlyUpperSameIndexPolicy("y", 3, -1, testAux, testAux), nThreads);
+  check(CombinationsBlockUpperSameIndexPolicy("y", 3, -1, testAux, testAux), nThreads);
+  check(CombinationsBlockFullSameIndexPolicy("y", 3, -1, testAux, testAux), nThreads);
+  check(CombinationsBlockUpperIndexPolicy("y", 3, -1, testAux, testAux), nThreads);
+  check(CombinationsBlockFullIndexPolicy("y", 3, -1, testAux, testAux), nThreads);
+  // policies without categories are not split
+  check(CombinationsStrictlyUpperIndexPolicy(testAux, testAux), 1);
+
+  // a failure in one of the threads is passed to the caller
+  std::atomic<int> nCalls{0};
+  BOOST_CHECK_THROW(parallelCombinations(CombinationsBlockFullIndexPolicy("y", 3, -1, testAux, testAux), nThreads, [&nCalls](int, auto&) {
+                      if (nCalls++ == 10) {
+                        throw std::runtime_error("failed combination");
+                      }
+                    }),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(CachedCategoryGrouping)
+{
+  TableBuilder builderAux;
+  auto rowWriterAux = builderAux.persist<int32_t, int32_t>({"x", "y"});
+  for (auto i = 0; i < 100; ++i) {
+    rowWriterAux(0, i, i % 10);
+  }
+  auto tableAux = builderAux.finalize();
+  using TestsAux = o2::soa::Table<o2::soa::Index<>, test::X, test::Y>;
+  TestsAux testAux{tableAux};
+
+  // w/o a current cache the table is grouped every time
+  auto grouped = groupTable(testAux, "y", 1, -1);
+  BOOST_CHECK_EQUAL(grouped.size(), 100);
+
+  ArrowTableSlicingCache cache;
+  ArrowTableSlicingCache::Scope scope{&cache};
+  BOOST_CHECK_EQUAL(ArrowTableSlicingCache::current(), &cache);
+  BOOST_CHECK(groupTable(testAux, "y", 1, -1) == grouped);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  // the second grouping of the same table with the same options hits the cache
+  BOOST_CHECK(groupTable(testAux, "y", 1, -1) == grouped);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  int nComputed = 0;
+  auto column = tableAux->column(tableAux->schema()->GetFieldIndex("y"));
+  auto cached = cache.getGroupedIndices(column, "y/1/-1", [&nComputed]() {
+    nComputed++;
+    return ArrowTableSlicingCache::GroupedIndices{};
+  });
+  BOOST_CHECK_EQUAL(nComputed, 0);
+  BOOST_CHECK(*cached == grouped);
+  // other options are a different entry
+  groupTable(testAux, "y", 11, -1);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  // the strictly upper pairs need categories of at least 2 rows
+  auto policy = CombinationsBlockStrictlyUpperSameIndexPolicy("y", 2, -1, testAux, testAux);
+  BOOST_CHECK_EQUAL(cache.size(), 3);
+}
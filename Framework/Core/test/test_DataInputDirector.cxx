@@ -15,6 +15,14 @@
 
 #include "Headers/DataHeader.h"
 #include "Framework/DataInputDirector.h"
+#include "Framework/DataOutputDirector.h"
+#include "Framework/TableBuilder.h"
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TTreeReaderValue.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/table.h>
 
 BOOST_AUTO_TEST_CASE(TestDatainputDirector)
 {
@@ -63,3 +71,162 @@ BOOST_AUTO_TEST_CASE(TestDatainputDirector)
   BOOST_CHECK(didesc);
   BOOST_CHECK_EQUAL(didesc->getNumberInputfiles(), 2);
 }
+
+BOOST_AUTO_TEST_CASE(TestArrowInput)
+{
+  using namespace o2::header;
+  using namespace o2::framework;
+
+  // write two time frames to the same IPC file
+  TableBuilder builder;
+  auto rowWriter = builder.persist<int, float, double>({"fX", "fY", "fZ"});
+  for (auto i = 0; i < 100; ++i) {
+    rowWriter(0, i, 2.f * i, 3. * i);
+  }
+  auto table = builder.finalize();
+
+  DataOutputDirector dod;
+  dod.readString("AOD/UNO/0:uno::arrowresults");
+  dod.setFilenameBase("arrowresults");
+  auto dh = DataHeader(DataDescription{"UNO"},
+                       DataOrigin{"AOD"},
+                       DataHeader::SubSpecificationType{0});
+  auto ds = dod.getDataOutputDescriptors(dh);
+  BOOST_REQUIRE_EQUAL(ds.size(), 1);
+  for (auto ntf = 0; ntf < 2; ++ntf) {
+    auto writer = dod.getDataOutputWriter(ds[0], ntf, 2, table->schema());
+    BOOST_REQUIRE(writer != nullptr);
+    BOOST_REQUIRE(writer->WriteTable(*table).ok());
+  }
+  dod.closeDataFiles();
+
+  DataInputDirector didir("arrowresults_0.arrow");
+  BOOST_REQUIRE(didir.isArrowInput(dh, 0));
+  auto all = didir.getArrowTable(dh, 0, "uno", {});
+  BOOST_REQUIRE(all != nullptr);
+  BOOST_CHECK_EQUAL(all->num_columns(), 3);
+  BOOST_CHECK_EQUAL(all->num_rows(), 200);
+
+  // only the requested columns are read, in the requested order
+  auto projected = didir.getArrowTable(dh, 0, "uno", {"fZ", "fX"});
+  BOOST_REQUIRE(projected != nullptr);
+  BOOST_REQUIRE_EQUAL(projected->num_columns(), 2);
+  BOOST_CHECK_EQUAL(projected->schema()->field(0)->name(), "fZ");
+  BOOST_CHECK_EQUAL(projected->schema()->field(1)->name(), "fX");
+  BOOST_CHECK_EQUAL(projected->num_rows(), 200);
+  BOOST_CHECK(projected->column(1)->Equals(all->column(0)));
+
+  BOOST_CHECK(didir.getArrowTable(dh, 0, "uno", {"fW"}) == nullptr);
+  BOOST_CHECK(didir.getArrowTable(dh, 0, "due", {}) == nullptr);
+}
+
+namespace
+{
+// file with the tree "uno" of 10 * (i + 1) entries
+std::string writePrefetchFile(int i)
+{
+  auto name = "prefetch_" + std::to_string(i) + ".root";
+  TFile file(name.c_str(), "recreate");
+  TTree tree("uno", "uno");
+  int x;
+  float y;
+  double z;
+  tree.Branch("fX", &x);
+  tree.Branch("fY", &y);
+  tree.Branch("fZ", &z);
+  for (x = 0; x < 10 * (i + 1); x++) {
+    y = 2.f * x;
+    z = 3. * x;
+    tree.Fill();
+  }
+  tree.Write();
+  file.Close();
+  return name;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestPrefetch)
+{
+  using namespace o2::framework;
+
+  DataInputDirector didir;
+  didir.enablePrefetching(); // makes ROOT thread safe
+  DataInputDescriptor didesc;
+  for (int i = 0; i < 3; i++) {
+    didesc.addFilename(writePrefetchFile(i));
+  }
+  auto checkFile = [](TFile* file, int i) {
+    BOOST_REQUIRE(file != nullptr);
+    BOOST_CHECK(file->IsOpen());
+    BOOST_CHECK_EQUAL(std::string(file->GetName()), "prefetch_" + std::to_string(i) + ".root");
+    auto tree = (TTree*)file->Get("uno");
+    BOOST_REQUIRE(tree != nullptr);
+    BOOST_CHECK_EQUAL(tree->GetEntries(), 10 * (i + 1));
+  };
+
+  // the prefetched file is handed over
+  didesc.prefetchInputFile(1);
+  auto file = didesc.getInputFile(1);
+  checkFile(file, 1);
+  // the current file is neither prefetched nor reopened
+  didesc.prefetchInputFile(1);
+  BOOST_CHECK_EQUAL(didesc.getInputFile(1), file);
+
+  // another file is requested than the prefetched one
+  didesc.prefetchInputFile(2);
+  checkFile(didesc.getInputFile(0), 0);
+  checkFile(didesc.getInputFile(2), 2);
+
+  // a prefetch beyond the list is ignored, as is asking for such a file
+  didesc.prefetchInputFile(3);
+  didesc.prefetchInputFile(0);
+  BOOST_CHECK(didesc.getInputFile(3) == nullptr);
+  checkFile(didesc.getInputFile(0), 0);
+  didesc.closeInputFile();
+  didesc.closePrefetchedFile();
+}
+
+BOOST_AUTO_TEST_CASE(TestTreeReaderBranches)
+{
+  using namespace o2::header;
+  using namespace o2::framework;
+
+  writePrefetchFile(0);
+  writePrefetchFile(1);
+  {
+    std::ofstream list("prefetchfiles.txt");
+    list << "prefetch_0.root" << std::endl
+         << "prefetch_1.root" << std::endl;
+  }
+  DataInputDirector didir("@prefetchfiles.txt");
+  auto dh = DataHeader(DataDescription{"UNO"},
+                       DataOrigin{"AOD"},
+                       DataHeader::SubSpecificationType{0});
+
+  // only the requested branches are enabled
+  auto reader = didir.getTreeReader(dh, 0, "uno", {"fX", "fZ"});
+  BOOST_REQUIRE(reader != nullptr);
+  BOOST_REQUIRE(!reader->IsInvalid());
+  auto tree = reader->GetTree();
+  BOOST_CHECK(tree->GetBranchStatus("fX"));
+  BOOST_CHECK(!tree->GetBranchStatus("fY"));
+  BOOST_CHECK(tree->GetBranchStatus("fZ"));
+  BOOST_CHECK_EQUAL(tree->GetCacheSize(), DataInputDirector::TreeCacheSize);
+  TTreeReaderValue<int> x(*reader, "fX");
+  TTreeReaderValue<double> z(*reader, "fZ");
+  int n = 0;
+  while (reader->Next()) {
+    BOOST_CHECK_EQUAL(*x, n);
+    BOOST_CHECK_EQUAL(*z, 3. * n);
+    n++;
+  }
+  BOOST_CHECK_EQUAL(n, 10);
+
+  // w/o list all branches are read
+  auto readerAll = didir.getTreeReader(dh, 1, "uno");
+  BOOST_REQUIRE(readerAll != nullptr);
+  BOOST_REQUIRE(!readerAll->IsInvalid());
+  BOOST_CHECK(readerAll->GetTree()->GetBranchStatus("fY"));
+  BOOST_CHECK_EQUAL(readerAll->GetEntries(true), 20);
+  didir.closeInputFiles();
+}
@@ -22,7 +22,10 @@
 #include "Framework/WorkflowSpec.h"
 #include <Monitoring/Monitoring.h>
 #include <fairmq/FairMQTransportFactory.h>
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <thread>
 
 using Monitoring = o2::monitoring::Monitoring;
 using namespace o2::framework;
@@ -447,3 +450,71 @@ BOOST_AUTO_TEST_CASE(TestClear)
   relayer.getReadyToProcess(ready);
   BOOST_REQUIRE_EQUAL(ready.size(), 0);
 }
+
+/// Test that inputs relayed concurrently from different threads end up
+/// in the same slots.
+BOOST_AUTO_TEST_CASE(TestConcurrentRelay)
+{
+  Monitoring metrics;
+  std::vector<o2::header::DataOrigin> origins = {"TPC", "ITS", "TOF", "MFT"};
+  std::vector<InputRoute> inputs;
+  for (size_t i = 0; i < origins.size(); ++i) {
+    auto binding = "clusters" + origins[i].as<std::string>();
+    inputs.emplace_back(InputRoute{InputSpec{binding, origins[i], "CLUSTERS"}, i, "Fake" + std::to_string(i), 0});
+  }
+
+  TimesliceIndex index;
+  auto policy = CompletionPolicyHelpers::consumeWhenAll();
+  DataRelayer relayer(policy, inputs, metrics, index);
+  const size_t nTimeslices = 8;
+  relayer.setPipelineLength(nTimeslices);
+
+  auto transport = FairMQTransportFactory::CreateTransportFactory("zeromq");
+  auto createMessage = [&transport, &relayer](DataHeader const& dh, DataProcessingHeader const& h) {
+    Stack stack{dh, h};
+    FairMQMessagePtr header = transport->CreateMessage(stack.size());
+    FairMQMessagePtr payload = transport->CreateMessage(1000);
+    memcpy(header->GetData(), stack.data(), stack.size());
+    return relayer.relay(std::move(header), std::move(payload));
+  };
+
+  // One thread per input, each of them relaying all the timeslices.
+  // Boost.Test assertions are not thread safe, so we only count the failures.
+  std::atomic<int> notRelayed{0};
+  std::vector<std::thread> threads;
+  for (auto& origin : origins) {
+    threads.emplace_back([&createMessage, &notRelayed, origin, nTimeslices]() {
+      DataHeader dh;
+      dh.dataDescription = "CLUSTERS";
+      dh.dataOrigin = origin;
+      dh.subSpecification = 0;
+      for (size_t ti = 0; ti < nTimeslices; ++ti) {
+        if (createMessage(dh, DataProcessingHeader{ti, 1}) != DataRelayer::WillRelay) {
+          notRelayed++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK_EQUAL(notRelayed.load(), 0);
+
+  std::vector<RecordAction> ready;
+  relayer.getReadyToProcess(ready);
+  BOOST_REQUIRE_EQUAL(ready.size(), nTimeslices);
+  std::vector<bool> seen(nTimeslices, false);
+  for (auto& action : ready) {
+    BOOST_CHECK_EQUAL(action.op, CompletionPolicy::CompletionOp::Consume);
+    auto timeslice = index.getTimesliceForSlot(action.slot);
+    BOOST_REQUIRE(timeslice.value < nTimeslices);
+    seen[timeslice.value] = true;
+    auto result = relayer.getInputsForTimeslice(action.slot);
+    BOOST_REQUIRE_EQUAL(result.size(), origins.size());
+    for (auto& parts : result) {
+      BOOST_CHECK_EQUAL(parts.size(), 1);
+    }
+  }
+  BOOST_CHECK(std::all_of(seen.begin(), seen.end(), [](bool s) { return s; }));
+  BOOST_CHECK_EQUAL(relayer.getStats().relayedMessages, nTimeslices * origins.size());
+}
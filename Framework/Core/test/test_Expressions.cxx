@@ -15,6 +15,7 @@
 #include "../src/ExpressionHelpers.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AODReaderHelpers.h"
+#include "Framework/TableBuilder.h"
 #include <boost/test/unit_test.hpp>
 
 using namespace o2::framework;
@@ -170,3 +171,48 @@ BOOST_AUTO_TEST_CASE(TestGandivaTreeCreation)
   auto schema_p = o2::soa::createSchemaFromColumns(o2::aod::Tracks::persistent_columns_t{});
   auto projector_alt = o2::framework::expressions::createProjectors(o2::framework::pack<o2::aod::track::Pt2>{}, schema_p);
 }
+
+BOOST_AUTO_TEST_CASE(TestNativeEvaluation)
+{
+  TableBuilder builder;
+  auto rowWriter = builder.persist<float, float, int32_t, bool>({"pt", "eta", "n", "b"});
+  for (auto i = 0; i < 100; ++i) {
+    rowWriter(0, 0.1f * i, -2.f + 0.04f * i, i % 7, i % 2 == 0);
+  }
+  auto table = builder.finalize();
+
+  BindingNode n{"n", atype::INT32};
+  BindingNode b{"b", atype::BOOL};
+  expressions::Filter f = ((nodes::pt > 1.5f) && (nabs(nodes::eta) < 0.8f)) || (n == 3);
+  BOOST_CHECK(isNativelyEvaluable(table, createOperations(f)) == false);
+
+  expressions::Filter g = ((nodes::pt > 1.5f) && (nodes::eta < 0.8f) && (nodes::eta > -0.8f)) || ((n == 3) && (b != false)) || (nodes::eta >= 1.5f);
+  auto gspecs = createOperations(g);
+  BOOST_REQUIRE(isNativelyEvaluable(table, gspecs));
+
+  auto nativeSelection = createSelectionNative(table, gspecs);
+  auto gandivaSelection = createSelection(table, createFilter(table->schema(), gspecs));
+  BOOST_REQUIRE_EQUAL(nativeSelection->GetNumSlots(), gandivaSelection->GetNumSlots());
+  for (auto i = 0; i < nativeSelection->GetNumSlots(); ++i) {
+    BOOST_CHECK_EQUAL(nativeSelection->GetIndex(i), gandivaSelection->GetIndex(i));
+  }
+  BOOST_CHECK_EQUAL(createSelection(table, g)->GetNumSlots(), nativeSelection->GetNumSlots());
+
+  // a column missing from the table is left to gandiva, which reports the error
+  expressions::Filter h = nodes::phi > 1.f;
+  BOOST_CHECK(isNativelyEvaluable(table, createOperations(h)) == false);
+}
+
+BOOST_AUTO_TEST_CASE(TestFilterCache)
+{
+  auto schema = std::make_shared<arrow::Schema>(std::vector{arrow::field("eta", arrow::float32()), arrow::field("phi", arrow::float32())});
+  expressions::Filter f = (nodes::eta < 1.f) && (nodes::phi > 0.5f);
+  expressions::Filter g = (nodes::eta < 1.f) && (nodes::phi > 0.5f);
+  expressions::Filter h = (nodes::eta < 1.f) && (nodes::phi > 0.6f);
+  auto filter = createFilter(schema, createOperations(f));
+  BOOST_CHECK_EQUAL(filter.get(), createFilter(schema, createOperations(g)).get());
+  BOOST_CHECK(filter.get() != createFilter(schema, createOperations(h)).get());
+
+  auto otherSchema = std::make_shared<arrow::Schema>(std::vector{arrow::field("phi", arrow::float32()), arrow::field("eta", arrow::float32())});
+  BOOST_CHECK(filter.get() != createFilter(otherSchema, createOperations(f)).get());
+}
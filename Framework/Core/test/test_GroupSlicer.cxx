@@ -52,6 +52,10 @@ DECLARE_SOA_TABLE(TrksY, "AOD", "TRKSY",
 DECLARE_SOA_TABLE(TrksZ, "AOD", "TRKSZ",
                   test::EventId,
                   test::Z);
+DECLARE_SOA_TABLE(TrksXI, "AOD", "TRKSXI",
+                  o2::soa::Index<>,
+                  test::EventId,
+                  test::X);
 DECLARE_SOA_TABLE(TrksU, "AOD", "TRKSU",
                   test::X,
                   test::Y,
@@ -229,3 +233,89 @@ BOOST_AUTO_TEST_CASE(GroupSlicerMismatchedGroups)
     ++count;
   }
 }
+
+BOOST_AUTO_TEST_CASE(GroupSlicerUnsortedIndex)
+{
+  TableBuilder builderE;
+  auto evtsWriter = builderE.cursor<aod::Events>();
+  for (auto i = 0; i < 20; ++i) {
+    evtsWriter(0, 0.5f * i, 2.f * i, 3.f * i);
+  }
+  auto evtTable = builderE.finalize();
+
+  // events in a scrambled order, group 5 is empty and some tracks are unassigned
+  TableBuilder builderT;
+  auto trksWriter = builderT.cursor<aod::TrksXI>();
+  for (auto j = 0; j < 10; ++j) {
+    for (auto i = 0; i < 20; ++i) {
+      auto event = (i * 7) % 20;
+      trksWriter(0, event == 5 ? -1 : event, 100.f * event + j);
+    }
+  }
+  auto trkTable = builderT.finalize();
+  aod::Events e{evtTable};
+  aod::TrksXI t{trkTable};
+  BOOST_CHECK_EQUAL(t.size(), 10 * 20);
+
+  soa::SelectionVector selection;
+  for (auto i = 0; i < t.size(); ++i) {
+    if ((i / 20) % 2 == 0) {
+      selection.push_back(i);
+    }
+  }
+  soa::Filtered<aod::TrksXI> ft{{trkTable}, std::move(selection)};
+
+  // what grouping the tables in their original order gives: the rows of
+  // each event, by their index in the full table
+  std::vector<std::vector<int64_t>> expected(20);
+  std::vector<std::vector<int64_t>> expectedFiltered(20);
+  for (auto& trk : t) {
+    if (trk.eventId() >= 0) {
+      expected[trk.eventId()].push_back(trk.globalIndex());
+    }
+  }
+  for (auto& trk : ft) {
+    if (trk.eventId() >= 0) {
+      expectedFiltered[trk.eventId()].push_back(trk.globalIndex());
+    }
+  }
+
+  auto tt = std::make_tuple(t, ft);
+  ArrowTableSlicingCache cache;
+  o2::framework::AnalysisDataProcessorBuilder::GroupSlicer g(e, tt, &cache);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+
+  unsigned int count = 0;
+  for (auto& slice : g) {
+    auto as = slice.associatedTables();
+    auto gg = slice.groupingElement();
+    BOOST_CHECK_EQUAL(gg.globalIndex(), count);
+    auto trks = std::get<aod::TrksXI>(as);
+    auto ftrks = std::get<soa::Filtered<aod::TrksXI>>(as);
+    BOOST_CHECK_EQUAL(trks.size(), count == 5 ? 0 : 10);
+    BOOST_CHECK_EQUAL(ftrks.size(), count == 5 ? 0 : 5);
+    std::vector<int64_t> rows;
+    auto j = 0;
+    for (auto& trk : trks) {
+      BOOST_CHECK_EQUAL(trk.eventId(), count);
+      // tracks of the same event keep their order
+      BOOST_CHECK_EQUAL(trk.x(), 100.f * count + j++);
+      // and refer to the rows of the original table
+      BOOST_CHECK_EQUAL((t.begin() + trk.globalIndex()).x(), trk.x());
+      rows.push_back(trk.globalIndex());
+    }
+    BOOST_CHECK(rows == expected[count]);
+    rows.clear();
+    j = 0;
+    for (auto& trk : ftrks) {
+      BOOST_CHECK_EQUAL(trk.eventId(), count);
+      // only the tracks with an even j are selected
+      BOOST_CHECK_EQUAL(trk.x(), 100.f * count + 2 * j++);
+      BOOST_CHECK_EQUAL((t.begin() + trk.globalIndex()).x(), trk.x());
+      rows.push_back(trk.globalIndex());
+    }
+    BOOST_CHECK(rows == expectedFiltered[count]);
+    ++count;
+  }
+  BOOST_CHECK_EQUAL(count, 20);
+}
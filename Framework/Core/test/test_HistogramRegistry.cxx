@@ -13,10 +13,18 @@
 
 #include "Framework/HistogramRegistry.h"
 #include <boost/test/unit_test.hpp>
+#include <thread>
 
 using namespace o2;
 using namespace o2::framework;
 
+namespace test
+{
+DECLARE_SOA_COLUMN_FULL(X, x, float, "x");
+DECLARE_SOA_COLUMN_FULL(Y, y, float, "y");
+} // namespace test
+DECLARE_SOA_TABLE(XY, "AOD", "XY", test::X, test::Y);
+
 HistogramRegistry foo()
 {
   return {"r", true, {{"histo", "histo", {"TH1F", 100, 0, 1}}}};
@@ -41,3 +49,79 @@ BOOST_AUTO_TEST_CASE(HistogramRegistryLookup)
   auto histo2 = r.get("histo").get();
   BOOST_REQUIRE_EQUAL(histo2->GetNbinsX(), 100);
 }
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryKinds)
+{
+  HistogramRegistry registry{"registry", true, {{"eta", "#Eta", {"TH1F", 100, -2.0, 2.0}}, {"etaPhi", "#Eta #Phi", {"TH2D", {{100, -2.0, 2.0}, {102, 0, 2 * M_PI}}}}, {"xyz", "xyz", {"TH3F", {{10, 0, 1}, {20, 0, 1}, {30, 0, 1}}}}, {"meanPt", "<p_{T}>", {"TProfile", 100, -2.0, 2.0}}, {"ptEtaPhiCharge", "n-dim", {"THnSparseF", {{50, 0, 10}, {100, -2.0, 2.0}, {102, 0, 2 * M_PI}, {2, -2, 2}}}}}};
+
+  BOOST_REQUIRE_EQUAL(registry.get<TH2>("etaPhi")->GetNbinsY(), 102);
+  BOOST_REQUIRE_EQUAL(registry.get<TH3>("xyz")->GetNbinsZ(), 30);
+  BOOST_REQUIRE_EQUAL(registry.get<THnBase>("ptEtaPhiCharge")->GetNdimensions(), 4);
+  BOOST_REQUIRE(registry.get<TH2>("eta") == nullptr);
+  BOOST_REQUIRE_THROW(registry.get("ptEtaPhiCharge"), std::runtime_error);
+
+  registry.fill(HIST("eta"), 0.5);
+  registry.fill(HIST("eta"), 0.5, 2.);
+  registry.fill(HIST("etaPhi"), 0.5, 1.);
+  registry.fill(HIST("xyz"), 0.5, 0.5, 0.5);
+  registry.fill(HIST("meanPt"), 0.5, 2.);
+  registry.fill(HIST("meanPt"), 0.5, 4.);
+  registry.fill(HIST("ptEtaPhiCharge"), 1., 0.5, 1., 1.);
+  BOOST_CHECK_EQUAL(registry.get("eta")->GetBinContent(registry.get("eta")->FindBin(0.5)), 3.);
+  BOOST_CHECK_EQUAL(registry.get<TH2>("etaPhi")->GetEntries(), 1.);
+  BOOST_CHECK_EQUAL(registry.get<TH3>("xyz")->GetEntries(), 1.);
+  BOOST_CHECK_EQUAL(registry.get<TProfile>("meanPt")->GetBinContent(registry.get("meanPt")->FindBin(0.5)), 3.);
+  BOOST_CHECK_EQUAL(registry.get<THnBase>("ptEtaPhiCharge")->GetEntries(), 1.);
+  BOOST_CHECK_THROW(registry.fill(HIST("xyz"), 0.5, 0.5, 0.5, 1., 1.), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryThreads)
+{
+  // filling from another thread needs the registry to be created for it
+  HistogramRegistry single{"single", true, {{"x", "x", {"TH1D", 10, 0, 10}}}};
+  std::thread([&single]() { BOOST_CHECK_THROW(single.fill(HIST("x"), 1), std::runtime_error); }).join();
+
+  HistogramRegistry::enableThreadSafety();
+  HistogramRegistry registry{"registry", true, {{"x", "x", {"TH1D", 10, 0, 10}}, {"xy", "xy", {"THnD", {{10, 0, 10}, {10, 0, 10}}}}}, true};
+  BOOST_CHECK(registry.concurrentFilling());
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < 4; ++t) {
+    threads.emplace_back([&registry, t]() {
+      for (auto i = 0; i < 1000; ++i) {
+        registry.fill(HIST("x"), t);
+        registry.fill(HIST("xy"), t, i % 10);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // only the entries filled by the owning thread are visible before merging
+  BOOST_CHECK_EQUAL(registry.get("x")->GetEntries(), 0);
+  registry.merge();
+  BOOST_CHECK_EQUAL(registry.get("x")->GetEntries(), 4000);
+  BOOST_CHECK_EQUAL(registry.get<THnBase>("xy")->GetEntries(), 4000);
+  for (auto t = 0; t < 4; ++t) {
+    BOOST_CHECK_EQUAL(registry.get("x")->GetBinContent(t + 1), 1000);
+  }
+  // shards are reset after merging
+  registry.merge();
+  BOOST_CHECK_EQUAL(registry.get("x")->GetEntries(), 4000);
+}
+
+BOOST_AUTO_TEST_CASE(HistogramRegistryBulkFill)
+{
+  TableBuilder builder;
+  auto rowWriter = builder.persist<float, float>({"x", "y"});
+  for (auto i = 0; i < 100; ++i) {
+    rowWriter(0, 0.01f * i, 1.f);
+  }
+  XY table{builder.finalize()};
+
+  HistogramRegistry registry{"registry", true, {{"x", "x", {"TH1F", 10, 0, 1}}, {"xy", "xy", {"TH2F", {{10, 0, 1}, {10, 0, 2}}}}}};
+  registry.fill<test::X>(HIST("x"), table);
+  registry.fill<test::X, test::Y>(HIST("xy"), table);
+  BOOST_CHECK_EQUAL(registry.get("x")->GetEntries(), 100);
+  BOOST_CHECK_EQUAL(registry.get("x")->GetBinContent(1), 10);
+  BOOST_CHECK_EQUAL(registry.get<TH2>("xy")->GetEntries(), 100);
+}
@@ -100,3 +100,45 @@ BOOST_AUTO_TEST_CASE(TestWithSOATables)
   BOOST_CHECK_EQUAL(offsets[1], 2);
   BOOST_CHECK_EQUAL(offsets[2], 6);
 }
+
+BOOST_AUTO_TEST_CASE(TestGroupByIndex)
+{
+  TableBuilder builder;
+  auto rowWriter = builder.persist<int32_t, int32_t>({"fIndex", "y"});
+  auto sortedValues = {-1, 0, 0, 2, 2, 2, 3};
+  for (auto value : sortedValues) {
+    rowWriter(0, value, 0);
+  }
+  auto sorted = builder.finalize();
+
+  auto slices = groupByIndex(sorted->GetColumnByName("fIndex"), 4);
+  BOOST_CHECK(slices->sorted());
+  BOOST_CHECK(slices->starts == (std::vector<int64_t>{1, 3, 3, 6}));
+  BOOST_CHECK(slices->counts == (std::vector<int64_t>{2, 0, 3, 1}));
+
+  TableBuilder builder2;
+  auto rowWriter2 = builder2.persist<int32_t, int32_t>({"fIndex", "y"});
+  auto unsortedValues = {2, 0, -1, 2, 3, 0, 2};
+  auto row = 0;
+  for (auto value : unsortedValues) {
+    rowWriter2(0, value, row++);
+  }
+  auto unsorted = builder2.finalize();
+
+  slices = groupByIndex(unsorted->GetColumnByName("fIndex"), 4);
+  BOOST_CHECK(slices->sorted() == false);
+  BOOST_CHECK(slices->starts == (std::vector<int64_t>{0, 2, 2, 5}));
+  BOOST_CHECK(slices->counts == (std::vector<int64_t>{2, 0, 3, 1}));
+  BOOST_CHECK(slices->permutation == (std::vector<int64_t>{1, 5, 0, 3, 6, 4}));
+
+  arrow::compute::FunctionContext ctx;
+  std::shared_ptr<arrow::Table> grouped;
+  BOOST_REQUIRE(groupTable(&ctx, unsorted, *slices, &grouped).ok());
+  BOOST_REQUIRE_EQUAL(grouped->num_rows(), 6);
+  auto y = std::static_pointer_cast<arrow::Int32Array>(grouped->GetColumnByName("y")->chunk(0));
+  for (auto i = 0; i < 6; ++i) {
+    BOOST_CHECK_EQUAL(y->Value(i), slices->permutation[i]);
+  }
+  auto slice = sliceTable(grouped, slices->starts[2], slices->counts[2]);
+  BOOST_CHECK_EQUAL(slice->num_rows(), 3);
+}
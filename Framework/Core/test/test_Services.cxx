@@ -56,6 +56,20 @@ BOOST_AUTO_TEST_CASE(TestServiceRegistry)
   BOOST_CHECK(registry.get<InterfaceC const>().method() == false);
   BOOST_CHECK_THROW(registry.get<InterfaceA const>(), std::runtime_error);
   BOOST_CHECK_THROW(registry.get<InterfaceC>(), std::runtime_error);
+
+  // a copy of the registry can use a different instance of a service,
+  // without affecting the original one
+  struct OtherA : InterfaceA {
+    bool method() final { return false; }
+  };
+  OtherA otherA;
+  ServiceRegistry copy = registry;
+  copy.overrideService<InterfaceA>(&otherA);
+  BOOST_CHECK(copy.get<InterfaceA>().method() == false);
+  BOOST_CHECK(copy.get<InterfaceB>().method() == false);
+  BOOST_CHECK(registry.get<InterfaceA>().method() == true);
+  ServiceRegistry empty;
+  BOOST_CHECK_THROW(empty.overrideService<InterfaceA>(&otherA), std::runtime_error);
 }
 
 BOOST_AUTO_TEST_CASE(TestCallbackService)
@@ -0,0 +1,87 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/AlgorithmSpec.h"
+#include "Framework/CallbackService.h"
+#include "Framework/ControlService.h"
+#include "Framework/EndOfStreamContext.h"
+#include "Framework/ConfigParamSpec.h"
+#include "Framework/DataProcessorSpec.h"
+#include "Framework/Logger.h"
+#include "Framework/runDataProcessing.h"
+
+#include <Monitoring/Monitoring.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace o2::framework;
+
+#define ASSERT_ERROR(condition)                                   \
+  if ((condition) == false) {                                     \
+    LOG(ERROR) << R"(Test condition ")" #condition R"(" failed)"; \
+  }
+
+constexpr int nTimeslices = 20;
+
+// The processor in the middle uses worker threads, taking a different
+// time for each timeslice. The sink checks that the outputs still arrive
+// in the order in which the timeslices were produced. The producer is
+// faster than the processor, so that at the end of stream more timeslices
+// are waiting than the workers take at once: all of them must have been
+// processed before the EndOfStream callback.
+std::vector<DataProcessorSpec> defineDataProcessing(ConfigContext const&)
+{
+  return WorkflowSpec{
+    DataProcessorSpec{
+      "producer",
+      Inputs{},
+      {OutputSpec{"TST", "COUNTER", 0, Lifetime::Timeframe}},
+      AlgorithmSpec{[counter = std::make_shared<int>(0)](ProcessingContext& ctx) {
+        if (*counter < nTimeslices) {
+          ctx.outputs().make<int>(Output{"TST", "COUNTER", 0, Lifetime::Timeframe}) = (*counter)++;
+        }
+        if (*counter == nTimeslices) {
+          ctx.services().get<ControlService>().endOfStream();
+          ctx.services().get<ControlService>().readyToQuit(QuitRequest::Me);
+        }
+      }}},
+    DataProcessorSpec{
+      "processor",
+      {InputSpec{"counter", "TST", "COUNTER", 0, Lifetime::Timeframe}},
+      {OutputSpec{"TST", "PROCESSED", 0, Lifetime::Timeframe}},
+      AlgorithmSpec{[](InitContext& ic) {
+        auto processed = std::make_shared<std::atomic<int>>(0);
+        ic.services().get<CallbackService>().set(CallbackService::Id::EndOfStream, [processed](EndOfStreamContext&) {
+          ASSERT_ERROR(*processed == nTimeslices);
+        });
+        return [processed](ProcessingContext& ctx) {
+          auto value = ctx.inputs().get<int>("counter");
+          // earlier timeslices take longer
+          std::this_thread::sleep_for(std::chrono::milliseconds(5 * (nTimeslices - value) % 40));
+          ctx.outputs().make<int>(Output{"TST", "PROCESSED", 0, Lifetime::Timeframe}) = value;
+          ctx.services().get<o2::monitoring::Monitoring>().send({value, "processed_value"});
+          (*processed)++;
+        };
+      }},
+      Options{{"dpl-worker-threads", VariantType::Int, 4, {"number of threads processing the timeslices"}}}},
+    DataProcessorSpec{
+      "sink",
+      {InputSpec{"processed", "TST", "PROCESSED", 0, Lifetime::Timeframe}},
+      Outputs{},
+      AlgorithmSpec{[expected = std::make_shared<int>(0)](ProcessingContext& ctx) {
+        auto value = ctx.inputs().get<int>("processed");
+        ASSERT_ERROR(value == *expected);
+        (*expected)++;
+        if (*expected == nTimeslices) {
+          ctx.services().get<ControlService>().readyToQuit(QuitRequest::All);
+        }
+      }}}};
+}
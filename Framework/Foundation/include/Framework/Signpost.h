@@ -16,12 +16,16 @@
 ///
 /// * macOS 10.15 onwards os_signpost
 /// * macOS 10.14 and below (either kdebug_signpost or kdebug)
-/// * linux SystemTap
+/// * linux in memory per thread ring buffers, dumped as Chrome trace (see SignpostRecorder.h),
+///   plus SystemTap / USDT probes when <sys/sdt.h> is available
+/// * other systems with SystemTap
 ///
 /// Supported systems will have O2_SIGNPOST_API_AVAILABLE defined.
 ///
 /// In order to use it, one must define O2_SIGNPOST_DEFINE_CONTEXT in at least one cxx file,
 /// include "Framework/Signpost.h" and invoke O2_SIGNPOST_INIT().
+/// O2_SIGNPOST_NAME(code, name) gives a name to the events with a given code,
+/// for the backends which support it.
 #if defined(__APPLE__) && __has_include(<os/signpost.h>) && (__MAC_OS_X_VERSION_MAX_ALLOWED >= __MAC_10_15)
 #include <os/signpost.h>
 #include <os/log.h>
@@ -36,6 +40,7 @@ os_log_t gDPLLog = 0;
 static os_log_t gDPLLog;
 #endif
 #define O2_SIGNPOST_INIT() gDPLLog = os_log_create("ch.cern.alice.dpl", O2_SIGNPOST_TYPE);
+#define O2_SIGNPOST_NAME(code, name)
 #define O2_SIGNPOST(code, arg1, arg2, arg3, color) os_signpost_event_emit(gDPLLog, OS_SIGNPOST_ID_EXCLUSIVE, "##code", "%lu %lu %lu %lu", (uintptr_t)arg1, (uintptr_t)arg2, (uintptr_t)arg3, (uintptr_t)color)
 #define O2_SIGNPOST_START(code, interval_id, arg2, arg3, color) os_signpost_interval_begin(gDPLLog, (os_signpost_id_t)interval_id, "##code", "%lu %lu %lu", (uintptr_t)arg2, (uintptr_t)arg3, (uintptr_t)color)
 #define O2_SIGNPOST_END(code, interval_id, arg2, arg3, color) os_signpost_interval_end(gDPLLog, (os_signpost_id_t)interval_id, "##code", "%lu %lu %lu", (uintptr_t)arg2, (uintptr_t)arg3, (uintptr_t)color)
@@ -43,6 +48,7 @@ static os_log_t gDPLLog;
 #elif defined(__APPLE__) && __has_include(<sys/kdebug_signpost.h>) && (__MAC_OS_X_VERSION_MAX_ALLOWED < __MAC_10_15) // Deprecated in Catalina
 #include <sys/kdebug_signpost.h>
 #define O2_SIGNPOST_INIT()
+#define O2_SIGNPOST_NAME(code, name)
 #define O2_SIGNPOST(code, arg1, arg2, arg3, color) kdebug_signpost((uint32_t)code, (uintptr_t)arg1, (uintptr_t)arg2, (uintptr_t)arg3, (uintptr_t)color)
 #define O2_SIGNPOST_START(code, interval_id, arg2, arg3, color) kdebug_signpost_start((uint32_t)code, (uintptr_t)interval_id, (uintptr_t)arg2, (uintptr_t)arg3, (uintptr_t)color)
 #define O2_SIGNPOST_END(code, interval_id, arg2, arg3, color) kdebug_signpost_end((uint32_t)code, (uintptr_t)interval_id, (uintptr_t)arg2, (uintptr_t)arg3, (uintptr_t)color)
@@ -55,19 +61,52 @@ static os_log_t gDPLLog;
 #define SYS_kdebug_trace 180
 #endif
 #define O2_SIGNPOST_INIT()
+#define O2_SIGNPOST_NAME(code, name)
 #define O2_SIGNPOST(code, arg1, arg2, arg3, arg4) syscall(SYS_kdebug_trace, APPSDBG_CODE(DBG_MACH_CHUD, (uint32_t)code) | DBG_FUNC_NONE, (uintptr_t)arg1, (uintptr_t)arg2, (uintptr_t)arg3, (uintptr_t)arg4);
 #define O2_SIGNPOST_START(code, arg1, arg2, arg3, arg4) syscall(SYS_kdebug_trace, APPSDBG_CODE(DBG_MACH_CHUD, (uint32_t)code) | DBG_FUNC_START, (uintptr_t)arg1, (uintptr_t)arg2, (uintptr_t)arg3, (uintptr_t)arg4);
 #define O2_SIGNPOST_END(code, arg1, arg2, arg3, arg4) syscall(SYS_kdebug_trace, APPSDBG_CODE(DBG_MACH_CHUD, (uintptr_t)code) | DBG_FUNC_END, (uintptr_t)arg1, (uintptr_t)arg2, (uintptr_t)arg3, (uintptr_t)arg4);
 #define O2_SIGNPOST_API_AVAILABLE
+#elif defined(__linux__)
+#include "Framework/SignpostRecorder.h"
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define O2_SIGNPOST_PROBE(name, arg1, arg2, arg3, arg4) STAP_PROBE4(dpl, name, arg1, arg2, arg3, arg4)
+#else
+#define O2_SIGNPOST_PROBE(name, arg1, arg2, arg3, arg4)
+#endif
+#define O2_SIGNPOST_INIT() o2::framework::SignpostRecorder::instance().initFromEnvironment()
+#define O2_SIGNPOST_NAME(code, name) o2::framework::SignpostRecorder::instance().setName((uint32_t)(code), name)
+// The code is stringified here, before it is expanded, to be used as name of the event
+#define O2_SIGNPOST_RECORD(type, code, name, arg1, arg2, arg3, arg4)                                         \
+  o2::framework::SignpostRecorder::record(o2::framework::SignpostEventType::type, (uint32_t)(code), name, \
+                                          (uint64_t)(arg1), (uint64_t)(arg2), (uint64_t)(arg3), (uint64_t)(arg4))
+#define O2_SIGNPOST(code, arg1, arg2, arg3, arg4)                     \
+  do {                                                                \
+    O2_SIGNPOST_PROBE(probe##code, arg1, arg2, arg3, arg4);           \
+    O2_SIGNPOST_RECORD(Instant, code, #code, arg1, arg2, arg3, arg4); \
+  } while (0)
+#define O2_SIGNPOST_START(code, arg1, arg2, arg3, arg4)             \
+  do {                                                              \
+    O2_SIGNPOST_PROBE(start_probe##code, arg1, arg2, arg3, arg4);   \
+    O2_SIGNPOST_RECORD(Begin, code, #code, arg1, arg2, arg3, arg4); \
+  } while (0)
+#define O2_SIGNPOST_END(code, arg1, arg2, arg3, arg4)             \
+  do {                                                            \
+    O2_SIGNPOST_PROBE(stop_probe##code, arg1, arg2, arg3, arg4);  \
+    O2_SIGNPOST_RECORD(End, code, #code, arg1, arg2, arg3, arg4); \
+  } while (0)
+#define O2_SIGNPOST_API_AVAILABLE
 #elif (!defined(__APPLE__)) && __has_include(<sys/sdt.h>) // Dtrace support is being dropped by Apple
 #include <sys/sdt.h>
 #define O2_SIGNPOST_INIT()
+#define O2_SIGNPOST_NAME(code, name)
 #define O2_SIGNPOST(code, arg1, arg2, arg3, arg4) STAP_PROBE4(dpl, probe##code, arg1, arg2, arg3, arg4)
 #define O2_SIGNPOST_START(code, arg1, arg2, arg3, arg4) STAP_PROBE4(dpl, start_probe##code, arg1, arg2, arg3, arg4)
 #define O2_SIGNPOST_END(code, arg1, arg2, arg3, arg4) STAP_PROBE4(dpl, stop_probe##code, arg1, arg2, arg3, arg4)
 #define O2_SIGNPOST_API_AVAILABLE
 #else // by default we do not do anything
 #define O2_SIGNPOST_INIT()
+#define O2_SIGNPOST_NAME(code, name)
 #define O2_SIGNPOST(code, arg1, arg2, arg3, arg4)
 #define O2_SIGNPOST_START(code, arg1, arg2, arg3, arg4)
 #define O2_SIGNPOST_END(code, arg1, arg2, arg3, arg4)
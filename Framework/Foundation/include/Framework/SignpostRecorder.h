@@ -0,0 +1,263 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef O2_FRAMEWORK_SIGNPOSTRECORDER_H_
+#define O2_FRAMEWORK_SIGNPOSTRECORDER_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+namespace o2::framework
+{
+
+enum struct SignpostEventType : uint8_t {
+  Instant,
+  Begin,
+  End
+};
+
+/// A single event as recorded by the O2_SIGNPOST macros.
+struct SignpostEvent {
+  uint64_t timestamp; /// ns, from the steady clock
+  char const* name;   /// the code, as written in the macro invocation
+  uint64_t arg1;      /// the interval id for Begin / End
+  uint64_t arg2;
+  uint64_t arg3;
+  uint64_t color;
+  uint32_t code;
+  SignpostEventType type;
+};
+
+/// Fixed size ring buffer of the events of a single thread. Only the owning
+/// thread writes, the oldest events are overwritten once the buffer is full.
+/// Events can be read from a different thread at any time: every slot has a
+/// sequence number (odd while the slot is being written), which is checked
+/// before and after copying the event, so that events overwritten or still
+/// being written while they are read are skipped.
+class SignpostRingBuffer
+{
+ public:
+  static constexpr size_t Size = 1 << 14;
+
+  explicit SignpostRingBuffer(uint64_t threadId) : mThreadId{threadId} {}
+
+  void push(SignpostEvent const& event)
+  {
+    auto head = mHead.load(std::memory_order_relaxed);
+    auto& slot = mSlots[head & (Size - 1)];
+    uint64_t words[Slot::NWords];
+    std::memcpy(words, &event, sizeof(SignpostEvent));
+    slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < Slot::NWords; ++i) {
+      slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * head + 2, std::memory_order_release);
+    mHead.store(head + 1, std::memory_order_release);
+  }
+
+  /// Invoke @a callback on a copy of each of the events still in the buffer,
+  /// from the oldest to the newest.
+  void forEach(std::function<void(SignpostEvent const&)> const& callback) const
+  {
+    auto head = mHead.load(std::memory_order_acquire);
+    for (uint64_t i = head > Size ? head - Size : 0; i < head; ++i) {
+      auto const& slot = mSlots[i & (Size - 1)];
+      const uint64_t sequence = 2 * i + 2; // the slot holds event i, completely written
+      if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+        continue;
+      }
+      uint64_t words[Slot::NWords];
+      for (size_t wi = 0; wi < Slot::NWords; ++wi) {
+        words[wi] = slot.words[wi].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+        continue;
+      }
+      SignpostEvent event;
+      std::memcpy(&event, words, sizeof(SignpostEvent));
+      callback(event);
+    }
+  }
+
+  uint64_t threadId() const { return mThreadId; }
+  /// @return the number of events recorded so far, including the overwritten ones
+  uint64_t recorded() const { return mHead.load(std::memory_order_acquire); }
+
+ private:
+  static_assert(std::is_trivially_copyable<SignpostEvent>::value && sizeof(SignpostEvent) % sizeof(uint64_t) == 0,
+                "SignpostEvent is copied as 64 bit words");
+  struct Slot {
+    static constexpr size_t NWords = sizeof(SignpostEvent) / sizeof(uint64_t);
+    std::atomic<uint64_t> sequence{0};
+    std::array<std::atomic<uint64_t>, NWords> words;
+  };
+  std::array<Slot, Size> mSlots;
+  std::atomic<uint64_t> mHead{0};
+  uint64_t mThreadId;
+};
+
+/// Backend of the signpost API which keeps the events in memory, in one
+/// ring buffer per thread, and dumps them in the Chrome trace event format,
+/// which can be opened with chrome://tracing or https://ui.perfetto.dev.
+///
+/// Recording is disabled by default. O2_SIGNPOST_INIT() enables it if the
+/// O2_SIGNPOST_TRACE environment variable is set, in which case the trace
+/// is written to $O2_SIGNPOST_TRACE_<pid>.json when the process exits.
+class SignpostRecorder
+{
+ public:
+  static SignpostRecorder& instance()
+  {
+    static SignpostRecorder recorder;
+    return recorder;
+  }
+
+  static bool enabled() { return sEnabled.load(std::memory_order_relaxed); }
+  static void enable(bool value = true) { sEnabled.store(value, std::memory_order_relaxed); }
+
+  static void record(SignpostEventType type, uint32_t code, char const* name, uint64_t arg1, uint64_t arg2, uint64_t arg3, uint64_t color)
+  {
+    if (enabled() == false) {
+      return;
+    }
+    thread_local SignpostRingBuffer* buffer = instance().createBuffer();
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    buffer->push(SignpostEvent{(uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(),
+                               name, arg1, arg2, arg3, color, code, type});
+  }
+
+  /// Use @a name for the events with the given @a code, rather than the
+  /// expression used in the macro invocation.
+  void setName(uint32_t code, char const* name)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mNames[code] = name;
+  }
+
+  void initFromEnvironment()
+  {
+    auto prefix = getenv("O2_SIGNPOST_TRACE");
+    if (prefix == nullptr || *prefix == '\0') {
+      return;
+    }
+    mOutputFile = std::string(prefix) + "_" + std::to_string(getpid()) + ".json";
+    if (enabled() == false) {
+      enable();
+      atexit([]() {
+        // threads which are still running stop recording, their events being written are skipped
+        enable(false);
+        instance().dumpToFile(instance().mOutputFile);
+      });
+    }
+  }
+
+  /// Write all the events in memory as a Chrome trace. Intervals are
+  /// written as duration events, so they need to begin and end on the same
+  /// thread. The signpost arguments are kept as event arguments.
+  void dumpChromeTrace(std::ostream& out) const
+  {
+    auto typeToPhase = [](SignpostEventType type) {
+      switch (type) {
+        case SignpostEventType::Begin:
+          return "B";
+        case SignpostEventType::End:
+          return "E";
+        default:
+          return "i";
+      }
+    };
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto pid = getpid();
+    bool first = true;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (auto& buffer : mBuffers) {
+      buffer->forEach([&](SignpostEvent const& event) {
+        auto name = mNames.find(event.code);
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"" << (name != mNames.end() ? name->second : event.name)
+            << "\",\"cat\":\"dpl\",\"ph\":\"" << typeToPhase(event.type)
+            << "\",\"ts\":" << event.timestamp / 1000 << "." << event.timestamp % 1000 / 100 << event.timestamp % 100 / 10 << event.timestamp % 10
+            << ",\"pid\":" << pid << ",\"tid\":" << buffer->threadId();
+        if (event.type == SignpostEventType::Instant) {
+          out << ",\"s\":\"t\"";
+        }
+        out << ",\"args\":{\"code\":" << event.code << ",\"arg1\":" << event.arg1 << ",\"arg2\":" << event.arg2
+            << ",\"arg3\":" << event.arg3 << ",\"color\":" << event.color << "}}";
+      });
+    }
+    out << "\n]}\n";
+  }
+
+  void dumpToFile(std::string const& fileName) const
+  {
+    std::ofstream out(fileName);
+    if (out) {
+      dumpChromeTrace(out);
+    }
+  }
+
+  /// @return the number of events recorded so far by all the threads
+  uint64_t recorded() const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    uint64_t result = 0;
+    for (auto& buffer : mBuffers) {
+      result += buffer->recorded();
+    }
+    return result;
+  }
+
+ private:
+  SignpostRecorder() = default;
+
+  /// Buffers are created once per thread and never deleted, so that the
+  /// events of threads which are already gone can still be dumped.
+  SignpostRingBuffer* createBuffer()
+  {
+#if defined(__linux__)
+    uint64_t threadId = syscall(SYS_gettid);
+#else
+    uint64_t threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+#endif
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBuffers.emplace_back(std::make_unique<SignpostRingBuffer>(threadId));
+    return mBuffers.back().get();
+  }
+
+  inline static std::atomic<bool> sEnabled{false};
+  mutable std::mutex mMutex;
+  std::vector<std::unique_ptr<SignpostRingBuffer>> mBuffers;
+  std::unordered_map<uint32_t, char const*> mNames;
+  std::string mOutputFile;
+};
+
+} // namespace o2::framework
+
+#endif // O2_FRAMEWORK_SIGNPOSTRECORDER_H_
@@ -17,7 +17,7 @@ int main(int argc, char** argv)
   // To be run inside some profiler (e.g. instruments) to make sure it actually
   // works.
   O2_SIGNPOST_INIT();
-  O2_SIGNPOST(dpl, 1000, 0, 0, 0);
-  O2_SIGNPOST_START(dpl, 1, 0, 0, 0);
-  O2_SIGNPOST_END(dpl, 1, 0, 0, 0);
+  O2_SIGNPOST(0, 1000, 0, 0, 0);
+  O2_SIGNPOST_START(0, 1, 0, 0, 0);
+  O2_SIGNPOST_END(0, 1, 0, 0, 0);
 }
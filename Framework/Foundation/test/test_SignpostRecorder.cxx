@@ -0,0 +1,120 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Framework SignpostRecorder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include "Framework/SignpostRecorder.h"
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace o2::framework;
+
+namespace
+{
+size_t countOf(std::string const& haystack, std::string const& needle)
+{
+  size_t count = 0;
+  for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TestRingBuffer)
+{
+  SignpostRingBuffer buffer{1};
+  for (uint64_t i = 0; i < SignpostRingBuffer::Size + 10; ++i) {
+    buffer.push(SignpostEvent{i, "test", i, 0, 0, 0, 1, SignpostEventType::Instant});
+  }
+  BOOST_CHECK_EQUAL(buffer.recorded(), SignpostRingBuffer::Size + 10);
+  // only the last Size events are kept, from the oldest to the newest
+  uint64_t expected = 10;
+  size_t count = 0;
+  buffer.forEach([&expected, &count](SignpostEvent const& event) {
+    BOOST_CHECK_EQUAL(event.arg1, expected++);
+    count++;
+  });
+  BOOST_CHECK_EQUAL(count, SignpostRingBuffer::Size);
+}
+
+BOOST_AUTO_TEST_CASE(TestRingBufferConcurrentRead)
+{
+  // the events read while the owning thread keeps overwriting them are either skipped or complete
+  auto buffer = std::make_unique<SignpostRingBuffer>(1);
+  const uint64_t nEvents = 50 * SignpostRingBuffer::Size;
+  std::atomic<bool> done{false};
+  std::thread writer([&buffer, &done, nEvents]() {
+    for (uint64_t i = 0; i < nEvents; ++i) {
+      buffer->push(SignpostEvent{i, "test", i, i, i, i, 1, SignpostEventType::Instant});
+    }
+    done = true;
+  });
+  size_t nRead = 0;
+  while (done == false) {
+    uint64_t previous = 0;
+    bool first = true;
+    buffer->forEach([&](SignpostEvent const& event) {
+      BOOST_REQUIRE(event.arg1 == event.timestamp && event.arg2 == event.timestamp && event.arg3 == event.timestamp && event.color == event.timestamp);
+      BOOST_REQUIRE(first || event.timestamp > previous);
+      previous = event.timestamp;
+      first = false;
+      nRead++;
+    });
+  }
+  writer.join();
+  BOOST_CHECK(nRead > 0);
+  BOOST_CHECK_EQUAL(buffer->recorded(), nEvents);
+}
+
+BOOST_AUTO_TEST_CASE(TestChromeTrace)
+{
+  auto& recorder = SignpostRecorder::instance();
+  SignpostRecorder::record(SignpostEventType::Begin, 7, "disabled", 0, 0, 0, 0);
+  BOOST_CHECK_EQUAL(recorder.recorded(), 0);
+
+  SignpostRecorder::enable();
+  recorder.setName(8, "renamed");
+  const int nThreads = 4;
+  const int nIntervals = 100;
+  std::vector<std::thread> threads;
+  for (int ti = 0; ti < nThreads; ++ti) {
+    threads.emplace_back([ti]() {
+      for (int i = 0; i < nIntervals; ++i) {
+        SignpostRecorder::record(SignpostEventType::Begin, 7, "interval", i, ti, 0, 0);
+        SignpostRecorder::record(SignpostEventType::Instant, 8, "instant", i, ti, 0, 0);
+        SignpostRecorder::record(SignpostEventType::End, 7, "interval", i, ti, 0, 0);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  SignpostRecorder::enable(false);
+  BOOST_CHECK_EQUAL(recorder.recorded(), 3 * nThreads * nIntervals);
+
+  std::ostringstream out;
+  recorder.dumpChromeTrace(out);
+  auto trace = out.str();
+  BOOST_CHECK_EQUAL(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0);
+  BOOST_CHECK_EQUAL(countOf(trace, "\"ph\":\"B\""), nThreads * nIntervals);
+  BOOST_CHECK_EQUAL(countOf(trace, "\"ph\":\"E\""), nThreads * nIntervals);
+  BOOST_CHECK_EQUAL(countOf(trace, "\"ph\":\"i\""), nThreads * nIntervals);
+  BOOST_CHECK_EQUAL(countOf(trace, "\"name\":\"renamed\""), nThreads * nIntervals);
+  BOOST_CHECK_EQUAL(countOf(trace, "\"name\":\"instant\""), 0);
+  BOOST_CHECK_EQUAL(countOf(trace, "\"name\":\"disabled\""), 0);
+}
@@ -244,6 +244,7 @@ class ITSDPLDigitizerTask : public ITSMFTDPLDigitizerTask
     digipar.setNoisePerPixel(dopt.noisePerPixel);     // noise level
     digipar.setTimeOffset(dopt.timeOffset);
     digipar.setNSimSteps(dopt.nSimSteps);
+    digipar.setNThreads(dopt.nThreads);
   }
 };
 
@@ -287,6 +288,7 @@ class MFTDPLDigitizerTask : public ITSMFTDPLDigitizerTask
     digipar.setNoisePerPixel(dopt.noisePerPixel);     // noise level
     digipar.setTimeOffset(dopt.timeOffset);
     digipar.setNSimSteps(dopt.nSimSteps);
+    digipar.setNThreads(dopt.nThreads);
   }
 };
 
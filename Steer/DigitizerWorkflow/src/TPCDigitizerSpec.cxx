@@ -33,7 +33,12 @@
 #include "DetectorsBase/BaseDPLDigitizer.h"
 #include "CommonDataFormat/RangeReference.h"
 #include "TPCSimulation/SAMPAProcessing.h"
+#include "TPCSimulation/GEMAmplification.h"
 #include "SimConfig/DigiParams.h"
+#include "CommonUtils/ThreadPool.h"
+#include "TROOT.h"
+#include <atomic>
+#include <functional>
 
 using namespace o2::framework;
 using SubSpecificationType = o2::framework::DataAllocator::SubSpecificationType;
@@ -64,6 +69,7 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
  public:
   TPCDPLDigitizerTask() : BaseDPLDigitizer(InitServices::FIELD | InitServices::GEOM)
   {
+    mWorkers.emplace_back(std::make_unique<SectorWorker>());
   }
 
   void initDigitizerTask(framework::InitContext& ic) override
@@ -98,7 +104,7 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
         }
         if (spaceCharge.get() != nullptr) {
           LOG(INFO) << "Using pre-calculated space-charge object: " << readSpaceCharge[1].data();
-          mDigitizer.setUseSCDistortions(spaceCharge.release());
+          mWorkers[0]->digitizer.setUseSCDistortions(spaceCharge.release());
         } else {
           LOG(ERROR) << "Space-charge object or file not found!";
         }
@@ -130,7 +136,7 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
         }
         if (hisSCDensity.get() != nullptr) {
           LOG(INFO) << "TPC: Providing initial space-charge density histogram: " << hisSCDensity->GetName();
-          mDigitizer.setUseSCDistortions(distortionType, hisSCDensity.get(), gridSize[0], gridSize[1], gridSize[2]);
+          mWorkers[0]->digitizer.setUseSCDistortions(distortionType, hisSCDensity.get(), gridSize[0], gridSize[1], gridSize[2]);
         } else {
           if (distortionType == SpaceCharge::SCDistortionType::SCDistortionsConstant) {
             LOG(ERROR) << "Input space-charge density histogram or file not found!";
@@ -138,7 +144,24 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
         }
       }
     }
-    mDigitizer.setContinuousReadout(!triggeredMode);
+    Digitizer::setContinuousReadout(!triggeredMode);
+
+    // the sectors of this device can be digitized on parallel threads, each with its own digitizer
+    auto nThreads = std::max(1, ic.options().get<int>("TPCsectorThreads"));
+    if (nThreads > 1 && useDistortions > 0) {
+      LOG(WARNING) << "TPC: Space-charge distortions are only supported with one sector thread";
+      nThreads = 1;
+    }
+    if (nThreads > 1) {
+      LOG(INFO) << "TPC: Digitizing sectors with " << nThreads << " threads";
+      ROOT::EnableThreadSafety();
+    }
+    for (int i = 1; i < nThreads; ++i) {
+      mWorkers.emplace_back(std::make_unique<SectorWorker>());
+    }
+    if (nThreads > 1) {
+      mThreadPool = std::make_unique<o2::utils::ThreadPool>(nThreads);
+    }
 
     // we send the GRP data once if the corresponding output channel is available
     // and set the flag to false after
@@ -157,19 +180,52 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
       cdb.setGainMapFromFile("GainMap.root");
     }
 
+    using ContextPtr = decltype(pc.inputs().get<o2::steer::DigitizationContext*>(std::declval<framework::DataRef const&>()));
+    std::vector<ContextPtr> contexts;
+    std::vector<SectorJob> jobs;
     for (auto it = pc.inputs().begin(), end = pc.inputs().end(); it != end; ++it) {
       for (auto const& inputref : it) {
-        process(pc, inputref);
+        contexts.emplace_back(pc.inputs().get<o2::steer::DigitizationContext*>(inputref));
+        prepareSector(pc, inputref, contexts.back().get(), jobs);
       }
     }
+
+    if (mWorkers.size() > 1) {
+      // the calibration objects are created on first use, make sure this happens before the threads start
+      GEMAmplification::instance().updateParameters();
+      SAMPAProcessing::instance().updateParameters();
+    }
+    runSectorJobs(jobs);
+
+    for (auto& job : jobs) {
+      sendSector(pc, job);
+    }
   }
 
-  // process one sector
-  void process(framework::ProcessingContext& pc, framework::DataRef const& inputref)
+ private:
+  // everything needed to digitize sectors independently on one thread
+  struct SectorWorker {
+    o2::tpc::Digitizer digitizer;
+    std::vector<TChain*> simChains;
+  };
+
+  // input and output of the digitization of one sector
+  struct SectorJob {
+    o2::steer::DigitizationContext const* context = nullptr;
+    o2::header::DataHeader const* dh = nullptr;
+    int sector = -1;
+    uint64_t activeSectors = 0;
+    std::vector<o2::tpc::Digit> digits;                        // accumulator for digits
+    o2::dataformats::MCTruthContainer<o2::MCCompLabel> labels; // timeframe accumulator for labels
+    std::vector<CommonMode> commonMode;
+    std::vector<DigiGroupRef> events;
+  };
+
+  // checks the input of one sector and adds the sector to the list of jobs if there is something to digitize
+  void prepareSector(framework::ProcessingContext& pc, framework::DataRef const& inputref,
+                     o2::steer::DigitizationContext const* context, std::vector<SectorJob>& jobs)
   {
     // read collision context from input
-    auto context = pc.inputs().get<o2::steer::DigitizationContext*>(inputref);
-    context->initSimChains(o2::detectors::DetID::TPC, mSimChains);
     auto& irecords = context->getEventRecords();
     LOG(INFO) << "TPC: Processing " << irecords.size() << " collisions";
     if (irecords.size() == 0) {
@@ -177,11 +233,11 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
     }
     auto const* dh = DataRefUtils::getHeader<o2::header::DataHeader*>(inputref);
 
-    bool isContinuous = mDigitizer.isContinuousReadout();
+    bool isContinuous = Digitizer::isContinuousReadout();
     // we publish the GRP data once if the output channel is there
     if (mWriteGRP && pc.outputs().isAllowed({"TPC", "ROMode", 0})) {
       auto roMode = isContinuous ? o2::parameters::GRPObject::CONTINUOUS : o2::parameters::GRPObject::PRESENT;
-      LOG(INFO) << "TPC: Sending ROMode= " << (mDigitizer.isContinuousReadout() ? "Continuous" : "Triggered")
+      LOG(INFO) << "TPC: Sending ROMode= " << (isContinuous ? "Continuous" : "Triggered")
                 << " to GRPUpdater from channel " << dh->subSpecification;
       pc.outputs().snapshot(Output{"TPC", "ROMode", 0, Lifetime::Timeframe}, roMode);
     }
@@ -195,52 +251,6 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
     }
     auto sector = sectorHeader->sector();
     LOG(INFO) << "TPC: Processing sector " << sector;
-    // the active sectors need to be propagated
-    uint64_t activeSectors = 0;
-    activeSectors = sectorHeader->activeSectors;
-
-    // lambda that snapshots digits to be sent out; prepares and attaches header with sector information
-    auto snapshotDigits = [this, sector, &pc, activeSectors, &dh](std::vector<o2::tpc::Digit> const& digits) {
-      o2::tpc::TPCSectorHeader header{sector};
-      header.activeSectors = activeSectors;
-      // note that snapshoting only works with non-const references (to be fixed?)
-      pc.outputs().snapshot(Output{"TPC", "DIGITS", static_cast<SubSpecificationType>(dh->subSpecification), Lifetime::Timeframe,
-                                   header},
-                            const_cast<std::vector<o2::tpc::Digit>&>(digits));
-    };
-    // lambda that snapshots the common mode vector to be sent out; prepares and attaches header with sector information
-    auto snapshotCommonMode = [this, sector, &pc, activeSectors, &dh](std::vector<o2::tpc::CommonMode> const& commonMode) {
-      o2::tpc::TPCSectorHeader header{sector};
-      header.activeSectors = activeSectors;
-      // note that snapshoting only works with non-const references (to be fixed?)
-      pc.outputs().snapshot(Output{"TPC", "COMMONMODE", static_cast<SubSpecificationType>(dh->subSpecification), Lifetime::Timeframe,
-                                   header},
-                            const_cast<std::vector<o2::tpc::CommonMode>&>(commonMode));
-    };
-    // lambda that snapshots labels to be sent out; prepares and attaches header with sector information
-    auto snapshotLabels = [this, &sector, &pc, activeSectors, &dh](o2::dataformats::MCTruthContainer<o2::MCCompLabel> const& labels) {
-      o2::tpc::TPCSectorHeader header{sector};
-      header.activeSectors = activeSectors;
-      if (mWithMCTruth) {
-        pc.outputs().snapshot(Output{"TPC", "DIGITSMCTR", static_cast<SubSpecificationType>(dh->subSpecification),
-                                     Lifetime::Timeframe, header},
-                              const_cast<o2::dataformats::MCTruthContainer<o2::MCCompLabel>&>(labels));
-      }
-    };
-    // lambda that snapshots digits grouping (triggers) to be sent out; prepares and attaches header with sector information
-    auto snapshotEvents = [this, sector, &pc, activeSectors, &dh](const std::vector<DigiGroupRef>& events) {
-      o2::tpc::TPCSectorHeader header{sector};
-      header.activeSectors = activeSectors;
-      LOG(INFO) << "TPC: Send TRIGGERS for sector " << sector << " channel " << dh->subSpecification << " | size " << events.size();
-      pc.outputs().snapshot(Output{"TPC", "DIGTRIGGERS", static_cast<SubSpecificationType>(dh->subSpecification), Lifetime::Timeframe,
-                                   header},
-                            const_cast<std::vector<DigiGroupRef>&>(events));
-    };
-
-    std::vector<o2::tpc::Digit> digitsAccum;                       // accumulator for digits
-    o2::dataformats::MCTruthContainer<o2::MCCompLabel> labelAccum; // timeframe accumulator for labels
-    std::vector<CommonMode> commonModeAccum;
-    std::vector<DigiGroupRef> eventAccum;
 
     // this should not happen any more, legacy condition when the sector variable was used
     // to transport control information
@@ -255,27 +265,48 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
       throw std::runtime_error("Digitizer can only work on single sectors");
     }
 
-    mDigitizer.setSector(sector);
-    mDigitizer.init();
+    auto& job = jobs.emplace_back();
+    job.context = context;
+    job.dh = dh;
+    job.sector = sector;
+    // the active sectors need to be propagated
+    job.activeSectors = sectorHeader->activeSectors;
+  }
+
+  // digitize one sector, this may run concurrently for different sectors
+  void digitizeSector(SectorJob& job, SectorWorker& worker)
+  {
+    auto& digitizer = worker.digitizer;
+    auto context = job.context;
+    auto sector = job.sector;
+    context->initSimChains(o2::detectors::DetID::TPC, worker.simChains);
+    auto& irecords = context->getEventRecords();
+    bool isContinuous = digitizer.isContinuousReadout();
+
+    digitizer.setSector(sector);
+    digitizer.init();
 
     auto& eventParts = context->getEventParts();
 
-    auto flushDigitsAndLabels = [this, &digitsAccum, &labelAccum, &commonModeAccum](bool finalFlush = false) {
+    std::vector<o2::tpc::Digit> digits;
+    o2::dataformats::MCTruthContainer<o2::MCCompLabel> labels;
+    std::vector<o2::tpc::CommonMode> commonMode;
+    auto flushDigitsAndLabels = [this, &job, &digitizer, &digits, &labels, &commonMode](bool finalFlush = false) {
       // flush previous buffer
-      mDigits.clear();
-      mLabels.clear();
-      mCommonMode.clear();
-      mDigitizer.flush(mDigits, mLabels, mCommonMode, finalFlush);
-      LOG(INFO) << "TPC: Flushed " << mDigits.size() << " digits, " << mLabels.getNElements() << " labels and " << mCommonMode.size() << " common mode entries";
-      std::copy(mDigits.begin(), mDigits.end(), std::back_inserter(digitsAccum));
+      digits.clear();
+      labels.clear();
+      commonMode.clear();
+      digitizer.flush(digits, labels, commonMode, finalFlush);
+      LOG(INFO) << "TPC: Flushed " << digits.size() << " digits, " << labels.getNElements() << " labels and " << commonMode.size() << " common mode entries";
+      std::copy(digits.begin(), digits.end(), std::back_inserter(job.digits));
       if (mWithMCTruth) {
-        labelAccum.mergeAtBack(mLabels);
+        job.labels.mergeAtBack(labels);
       }
-      std::copy(mCommonMode.begin(), mCommonMode.end(), std::back_inserter(commonModeAccum));
+      std::copy(commonMode.begin(), commonMode.end(), std::back_inserter(job.commonMode));
     };
 
-    static SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
-    mDigitizer.setStartTime(sampaProcessing.getTimeBinFromTime(irecords[0].getTimeNS() / 1000.f));
+    static thread_local SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
+    digitizer.setStartTime(sampaProcessing.getTimeBinFromTime(irecords[0].getTimeNS() / 1000.f));
 
     TStopwatch timer;
     timer.Start();
@@ -285,11 +316,11 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
     for (int collID = 0; collID < irecords.size(); ++collID) {
       const float eventTime = irecords[collID].getTimeNS() / 1000.f;
       LOG(INFO) << "TPC: Event time " << eventTime << " us";
-      mDigitizer.setEventTime(eventTime);
+      digitizer.setEventTime(eventTime);
       if (!isContinuous) {
-        mDigitizer.setStartTime(sampaProcessing.getTimeBinFromTime(eventTime));
+        digitizer.setStartTime(sampaProcessing.getTimeBinFromTime(eventTime));
       }
-      int startSize = digitsAccum.size();
+      int startSize = job.digits.size();
 
       // for each collision, loop over the constituents event and source IDs
       // (background signal merging is basically taking place here)
@@ -300,17 +331,17 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
         // get the hits for this event and this source
         std::vector<o2::tpc::HitGroup> hitsLeft;
         std::vector<o2::tpc::HitGroup> hitsRight;
-        context->retrieveHits(mSimChains, getBranchNameLeft(sector).c_str(), part.sourceID, part.entryID, &hitsLeft);
-        context->retrieveHits(mSimChains, getBranchNameRight(sector).c_str(), part.sourceID, part.entryID, &hitsRight);
+        context->retrieveHits(worker.simChains, getBranchNameLeft(sector).c_str(), part.sourceID, part.entryID, &hitsLeft);
+        context->retrieveHits(worker.simChains, getBranchNameRight(sector).c_str(), part.sourceID, part.entryID, &hitsRight);
         LOG(DEBUG) << "TPC: Found " << hitsLeft.size() << " hit groups left and " << hitsRight.size() << " hit groups right in collision " << collID << " eventID " << part.entryID;
 
-        mDigitizer.process(hitsLeft, eventID, sourceID);
-        mDigitizer.process(hitsRight, eventID, sourceID);
+        digitizer.process(hitsLeft, eventID, sourceID);
+        digitizer.process(hitsRight, eventID, sourceID);
 
         flushDigitsAndLabels();
 
         if (!isContinuous) {
-          eventAccum.emplace_back(startSize, digitsAccum.size() - startSize);
+          job.events.emplace_back(startSize, job.digits.size() - startSize);
         }
       }
     }
@@ -319,25 +350,47 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
     if (isContinuous) {
       LOG(INFO) << "TPC: Final flush";
       flushDigitsAndLabels(true);
-      eventAccum.emplace_back(0, digitsAccum.size()); // all digits are grouped to 1 super-event pseudo-triggered mode
+      job.events.emplace_back(0, job.digits.size()); // all digits are grouped to 1 super-event pseudo-triggered mode
     }
 
-    // send out to next stage
-    snapshotEvents(eventAccum);
-    snapshotDigits(digitsAccum);
-    snapshotCommonMode(commonModeAccum);
-    snapshotLabels(labelAccum);
-
     timer.Stop();
-    LOG(INFO) << "TPC: Digitization took " << timer.CpuTime() << "s";
+    LOG(INFO) << "TPC: Digitization of sector " << sector << " took " << timer.CpuTime() << "s";
   }
 
- private:
-  o2::tpc::Digitizer mDigitizer;
-  std::vector<TChain*> mSimChains;
-  std::vector<o2::tpc::Digit> mDigits;
-  o2::dataformats::MCTruthContainer<o2::MCCompLabel> mLabels;
-  std::vector<o2::tpc::CommonMode> mCommonMode;
+  // send out the digitization result of one sector to the next stage
+  void sendSector(framework::ProcessingContext& pc, SectorJob& job)
+  {
+    o2::tpc::TPCSectorHeader header{job.sector};
+    header.activeSectors = job.activeSectors;
+    auto subSpec = static_cast<SubSpecificationType>(job.dh->subSpecification);
+
+    LOG(INFO) << "TPC: Send TRIGGERS for sector " << job.sector << " channel " << job.dh->subSpecification << " | size " << job.events.size();
+    pc.outputs().snapshot(Output{"TPC", "DIGTRIGGERS", subSpec, Lifetime::Timeframe, header}, job.events);
+    pc.outputs().snapshot(Output{"TPC", "DIGITS", subSpec, Lifetime::Timeframe, header}, job.digits);
+    pc.outputs().snapshot(Output{"TPC", "COMMONMODE", subSpec, Lifetime::Timeframe, header}, job.commonMode);
+    if (mWithMCTruth) {
+      pc.outputs().snapshot(Output{"TPC", "DIGITSMCTR", subSpec, Lifetime::Timeframe, header}, job.labels);
+    }
+  }
+
+  // process the sector jobs on the calling thread and on the worker threads, each slot with its own worker
+  void runSectorJobs(std::vector<SectorJob>& jobs)
+  {
+    std::atomic<size_t> nextJob{0};
+    std::function<void(int)> processJobs = [&](int slot) {
+      for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+        digitizeSector(jobs[i], *mWorkers[slot]);
+      }
+    };
+    if (mThreadPool) {
+      mThreadPool->run(processJobs); // rethrows the exceptions of the worker threads
+    } else {
+      processJobs(0);
+    }
+  }
+
+  std::vector<std::unique_ptr<SectorWorker>> mWorkers; // one per thread, the first one is used by the device thread
+  std::unique_ptr<o2::utils::ThreadPool> mThreadPool;  // kept for the lifetime of the device, as the workers
   bool mWriteGRP = false;
   bool mWithMCTruth = true;
 };
@@ -374,7 +427,8 @@ o2::framework::DataProcessorSpec getTPCDigitizerSpec(int channel, bool writeGRP,
             {"gridSize", VariantType::String, "129,144,129", {"Comma separated list of number of bins in (r,phi,z) for distortion lookup tables (r and z can only be 2**N + 1, N=1,2,3,...)"}},
             {"initialSpaceChargeDensity", VariantType::String, "", {"Path to root file containing TH3 with initial space-charge density and name of the TH3 (comma separated)"}},
             {"readSpaceCharge", VariantType::String, "", {"Path to root file containing pre-calculated space-charge object and name of the object (comma separated)"}},
-            {"TPCtriggered", VariantType::Bool, false, {"Impose triggered RO mode (default: continuous)"}}}};
+            {"TPCtriggered", VariantType::Bool, false, {"Impose triggered RO mode (default: continuous)"}},
+            {"TPCsectorThreads", VariantType::Int, 1, {"Number of threads digitizing the sectors of this processor in parallel"}}}};
 }
 
 o2::framework::WorkflowSpec getTPCDigitizerSpec(int nLanes, std::vector<int> const& sectors, bool mctruth)
@@ -58,7 +58,17 @@
 #include <ZDCSimulation/Detector.h>
 
 #include "CommonUtils/ShmManager.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <csignal>
 
@@ -86,6 +96,17 @@ class O2HitMerger : public FairMQDevice
     ~TMessageWrapper() override = default;
   };
 
+  // flat hit messages per detector ID, indexed by the entry of the subevent in the per event tree
+  using EventFlatHits = std::unordered_map<int, std::vector<FairMQMessagePtr>>;
+
+  // a complete event waiting to be merged and flushed
+  struct MergeJob {
+    int eventID = -1;
+    TTree* tree = nullptr;       // in memory tree with the subevents
+    TMemFile* memfile = nullptr; // file associated to the tree
+    EventFlatHits flathits;
+  };
+
  public:
   /// Default constructor
   O2HitMerger()
@@ -96,6 +117,7 @@ class O2HitMerger : public FairMQDevice
   /// Default destructor
   ~O2HitMerger() override
   {
+    stopMergePipeline();
     FairSystemInfo sysinfo;
     LOG(INFO) << "TIME-STAMP " << mTimer.RealTime() << "\t";
     mTimer.Continue();
@@ -125,6 +147,16 @@ class O2HitMerger : public FairMQDevice
     // has to be after init of Detectors
     o2::utils::ShmManager::Instance().attachToGlobalSegment();
 
+    // the threads merging the detectors of an event in parallel: by default as many as sim workers feeding us
+    mNMergerThreads = GetConfig()->GetValue<int>("merger-threads");
+    if (mNMergerThreads <= 0) {
+      auto nworkersenv = getenv("ALICE_NSIMWORKERS");
+      mNMergerThreads = nworkersenv ? std::max(1, atoi(nworkersenv)) : 1;
+    }
+    mMaxQueuedEvents = std::max(1, GetConfig()->GetValue<int>("merger-queue-size"));
+    LOG(INFO) << "MERGING WITH " << mNMergerThreads << " THREADS AND UP TO " << mMaxQueuedEvents << " QUEUED EVENTS";
+    mMergerIOThread = std::thread([this]() { mergePipeline(); });
+
     // init pipe
     auto pipeenv = getenv("ALICE_O2SIMMERGERTODRIVER_PIPE");
     if (pipeenv) {
@@ -163,7 +195,7 @@ class O2HitMerger : public FairMQDevice
     return checksum == nparts * (nparts + 1) / 2;
   }
 
-  void consumeHits(int eventID, FairMQParts& data, int& index)
+  void consumeHits(int eventID, int entry, FairMQParts& data, int& index)
   {
     auto detIDmessage = std::move(data.At(index++));
     // this should be a detector ID
@@ -178,7 +210,27 @@ class O2HitMerger : public FairMQDevice
       // get the detector that can interpret it
       auto detector = mDetectorInstances[id].get();
       if (detector) {
-        detector->fillHitBranch(*tree, data, index);
+        // the format is given by the sending worker, which may differ in its shared memory setup
+        o2::base::FlatHitsBuffer buffer{static_cast<const char*>(data.At(index)->GetData()), data.At(index)->GetSize()};
+        const bool flat = o2::base::isFlatHitsBuffer(buffer);
+        // the subevents of a detector are merged either from the flat buffers or from the in memory tree,
+        // so all of them have to come in the same format
+        auto& formats = mEventToFlatHitsFormat[eventID];
+        auto format = formats.emplace(id, flat).first;
+        if (format->second != flat) {
+          throw std::runtime_error("event " + std::to_string(eventID) + ": detector " + id.getName() +
+                                   " sent hits of some subevents in flat and of others in TMessage format, cannot merge them");
+        }
+        if (flat) {
+          // keep the flat buffer as it is until the event is complete
+          auto& buffers = mEventToFlatHitsMap[eventID][id];
+          if ((int)buffers.size() <= entry) {
+            buffers.resize(entry + 1);
+          }
+          buffers[entry] = std::move(data.At(index++));
+        } else {
+          detector->fillHitBranch(*tree, data, index);
+        }
       }
     }
   }
@@ -257,26 +309,32 @@ class O2HitMerger : public FairMQDevice
     consumeData<std::vector<o2::MCTrack>>(info.eventID, "MCTrack", data, index);
     consumeData<std::vector<o2::TrackReference>>(info.eventID, "TrackRefs", data, index);
     consumeData<o2::dataformats::MCTruthContainer<o2::TrackReference>>(info.eventID, "IndexedTrackRefs", data, index);
+    // the entry of this subevent in the per event tree
+    auto tree = mEventToTTreeMap[info.eventID];
+    const int entry = tree->GetEntries();
     while (index < data.Size()) {
-      consumeHits(info.eventID, data, index);
+      consumeHits(info.eventID, entry, data, index);
     }
     // set the number of entries in the tree
-    auto tree = mEventToTTreeMap[info.eventID];
-    auto memfile = mEventToTMemFileMap[info.eventID];
-    tree->SetEntries(tree->GetEntries() + 1);
+    tree->SetEntries(entry + 1);
     LOG(INFO) << "tree has file " << tree->GetDirectory()->GetFile()->GetName();
     mEntries++;
 
     if (isDataComplete<uint32_t>(accum, info.nparts)) {
       LOG(INFO) << "EVERYTHING IS HERE FOR EVENT " << info.eventID << "\n";
 
-      // check if previous flush finished
-      if (mMergerIOThread.joinable()) {
-        mMergerIOThread.join();
-      }
-
-      // start hit merging and flushing in a separate thread in order not to block
-      mMergerIOThread = std::thread([info, this]() { mergeAndFlushData(info.eventID); });
+      // hand the event over to the merging pipeline, which owns its data from now on;
+      // this only blocks if too many complete events are already waiting
+      MergeJob job;
+      job.eventID = info.eventID;
+      job.tree = tree;
+      job.memfile = mEventToTMemFileMap[info.eventID];
+      job.flathits = std::move(mEventToFlatHitsMap[info.eventID]);
+      mEventToTTreeMap.erase(info.eventID);
+      mEventToTMemFileMap.erase(info.eventID);
+      mEventToFlatHitsMap.erase(info.eventID);
+      mEventToFlatHitsFormat.erase(info.eventID);
+      queueMergeJob(std::move(job));
 
       mEventChecksum += info.eventID;
       // we also need to check if we have all events
@@ -284,9 +342,8 @@ class O2HitMerger : public FairMQDevice
         LOG(INFO) << "ALL EVENTS HERE; CHECKSUM " << mEventChecksum;
 
         // flush remaining data and close file
-        if (mMergerIOThread.joinable()) {
-          mMergerIOThread.join();
-        }
+        stopMergePipeline();
+        checkMergePipeline();
 
         expectmore = false;
       }
@@ -514,11 +571,10 @@ class O2HitMerger : public FairMQDevice
   // This method goes over the tree containing data for a given event; potentially merges
   // it and flushes it into the actual output file.
   // The method can be called asynchronously to data collection
-  bool mergeAndFlushData(int eventID)
+  bool mergeAndFlushData(int eventID, TTree* tree, EventFlatHits const& flathits)
   {
     LOG(INFO) << "ENTERING MERGING/FLUSHING HITS STAGE FOR EVENT " << eventID;
 
-    auto tree = mEventToTTreeMap[eventID];
     if (!tree) {
       LOG(INFO) << "NO TTREE FOUND FOR EVENT " << eventID;
       return false;
@@ -589,39 +645,158 @@ class O2HitMerger : public FairMQDevice
       printf("HitMerger entry: %lld nprimry: %5d trackoffset: %5d \n", entry, nprimaries[entry], trackoffsets[entry]);
     }
 
-    reorderAndMergeMCTRacks(*tree, *mOutTree, nprimaries, subevOrdered);
-    Int_t ioffset = 0;
-    remapTrackIdsAndMerge<std::vector<o2::TrackReference>>("TrackRefs", *tree, *mOutTree, trackoffsets, nprimaries, subevOrdered);
-    merge<o2::dataformats::MCTruthContainer<o2::TrackReference>>("IndexedTrackRefs", *tree, *mOutTree);
-
-    // c) do the merge procedure for all hits ... delegate this to detector specific functions
-    // since they know about types; number of branches; etc.
-    // this will also fix the trackIDs inside the hits
+    // the kinematics and each of the detectors are merged and written concurrently, they go to
+    // different output files; only the reading from the in memory tree has to be serialized
+    std::mutex treemutex;
+    std::vector<int> tasks{-1}; // -1 for the kinematics, otherwise the detector ID
     for (int id = 0; id < mDetectorInstances.size(); ++id) {
+      if (mDetectorInstances[id]) {
+        tasks.push_back(id);
+      }
+    }
+    runInParallel(tasks.size(), [&](int itask) {
+      const int id = tasks[itask];
+      if (id < 0) {
+        {
+          std::lock_guard<std::mutex> lock(treemutex);
+          reorderAndMergeMCTRacks(*tree, *mOutTree, nprimaries, subevOrdered);
+          remapTrackIdsAndMerge<std::vector<o2::TrackReference>>("TrackRefs", *tree, *mOutTree, trackoffsets, nprimaries, subevOrdered);
+          merge<o2::dataformats::MCTruthContainer<o2::TrackReference>>("IndexedTrackRefs", *tree, *mOutTree);
+        }
+        // increase the entry count in the tree
+        mOutTree->SetEntries(mOutTree->GetEntries() + 1);
+        LOG(INFO) << "outtree has file " << mOutTree->GetDirectory()->GetFile()->GetName();
+        mOutFile->Write("", TObject::kOverwrite);
+        return;
+      }
+
+      // c) do the merge procedure for all hits ... delegate this to detector specific functions
+      // since they know about types; number of branches; etc.
+      // this will also fix the trackIDs inside the hits
       auto& det = mDetectorInstances[id];
-      if (det) {
-        auto hittree = mDetectorToTTreeMap[id];
+      auto hittree = mDetectorToTTreeMap.at(id);
+      auto iter = flathits.find(id);
+      if (iter != flathits.end()) {
+        // the buffers in the order of arrival of the subevents, missing ones are treated as empty
+        std::vector<o2::base::FlatHitsBuffer> buffers(entries);
+        for (int entry = 0; entry < std::min<int>(entries, iter->second.size()); ++entry) {
+          if (auto& msg = iter->second[entry]) {
+            buffers[entry] = {static_cast<const char*>(msg->GetData()), msg->GetSize()};
+          }
+        }
+        det->mergeFlatHitEntries(buffers, *hittree, trackoffsets, nprimaries, subevOrdered);
+      } else {
+        std::lock_guard<std::mutex> lock(treemutex);
         det->mergeHitEntries(*tree, *hittree, trackoffsets, nprimaries, subevOrdered);
-        hittree->SetEntries(hittree->GetEntries() + 1);
-        LOG(INFO) << "flushing tree to file " << hittree->GetDirectory()->GetFile()->GetName();
-        mDetectorOutFiles[id]->Write("", TObject::kOverwrite);
+      }
+      hittree->SetEntries(hittree->GetEntries() + 1);
+      LOG(INFO) << "flushing tree to file " << hittree->GetDirectory()->GetFile()->GetName();
+      mDetectorOutFiles.at(id)->Write("", TObject::kOverwrite);
+    });
+
+    LOG(INFO) << "MERGING HITS TOOK " << timer.RealTime();
+    return true;
+  }
+
+  // runs task(0) ... task(ntasks-1) on up to mNMergerThreads threads;
+  // the first exception thrown by a task is rethrown once all threads are joined
+  void runInParallel(int ntasks, std::function<void(int)> const& task)
+  {
+    const int nthreads = std::max(1, std::min(mNMergerThreads, ntasks));
+    std::vector<std::exception_ptr> errors(nthreads);
+    std::atomic<int> next{0};
+    auto worker = [&](int slot) {
+      try {
+        for (int itask = next++; itask < ntasks; itask = next++) {
+          task(itask);
+        }
+      } catch (...) {
+        errors[slot] = std::current_exception();
+        next = ntasks; // the other threads do not start new tasks
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < nthreads; ++i) {
+      threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& t : threads) {
+      t.join();
+    }
+    for (auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
       }
     }
+  }
 
-    // increase the entry count in the tree
-    mOutTree->SetEntries(mOutTree->GetEntries() + 1);
-    LOG(INFO) << "outtree has file " << mOutTree->GetDirectory()->GetFile()->GetName();
-    mOutFile->Write("", TObject::kOverwrite);
+  // adds a complete event to the merging queue, waits if the queue is full;
+  // rethrows on the device thread the failure of the merging of a previous event
+  void queueMergeJob(MergeJob&& job)
+  {
+    std::unique_lock<std::mutex> lock(mMergeQueueMutex);
+    mMergeQueueCond.wait(lock, [this]() { return mMergeQueue.size() < mMaxQueuedEvents || mMergeError; });
+    if (mMergeError) {
+      delete job.tree;
+      delete job.memfile;
+      std::rethrow_exception(mMergeError);
+    }
+    mMergeQueue.emplace_back(std::move(job));
+    mMergeQueueCond.notify_all();
+  }
 
-    // remove tree for that eventID
-    delete mEventToTTreeMap[eventID];
-    mEventToTTreeMap.erase(eventID);
-    // remove memfile
-    delete mEventToTMemFileMap[eventID];
-    mEventToTMemFileMap.erase(eventID);
+  // merges and flushes the queued events in the order of their completion
+  void mergePipeline()
+  {
+    while (true) {
+      MergeJob job;
+      {
+        std::unique_lock<std::mutex> lock(mMergeQueueMutex);
+        mMergeQueueCond.wait(lock, [this]() { return !mMergeQueue.empty() || mMergeQueueClosed; });
+        if (mMergeQueue.empty()) {
+          return; // closed and nothing left to do
+        }
+        job = std::move(mMergeQueue.front());
+        mMergeQueue.pop_front();
+        mMergeQueueCond.notify_all();
+      }
+      // after a failure the remaining events are discarded, the error is reported on the device thread
+      if (!mMergeError) {
+        try {
+          mergeAndFlushData(job.eventID, job.tree, job.flathits);
+        } catch (std::exception const& e) {
+          LOG(ERROR) << "MERGING OF EVENT " << job.eventID << " FAILED: " << e.what();
+          std::lock_guard<std::mutex> lock(mMergeQueueMutex);
+          mMergeError = std::current_exception();
+          mMergeQueueCond.notify_all();
+        }
+      }
+      // remove tree and memfile for that eventID
+      delete job.tree;
+      delete job.memfile;
+    }
+  }
 
-    LOG(INFO) << "MERGING HITS TOOK " << timer.RealTime();
-    return true;
+  // lets the pipeline finish the queued events and waits for it
+  void stopMergePipeline()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMergeQueueMutex);
+      mMergeQueueClosed = true;
+    }
+    mMergeQueueCond.notify_all();
+    if (mMergerIOThread.joinable()) {
+      mMergerIOThread.join();
+    }
+  }
+
+  // rethrows the failure of the merging pipeline, if any (to be called on the device thread)
+  void checkMergePipeline()
+  {
+    std::lock_guard<std::mutex> lock(mMergeQueueMutex);
+    if (mMergeError) {
+      std::rethrow_exception(mMergeError);
+    }
   }
 
   std::map<uint32_t, uint32_t> mPartsCheckSum; //! mapping event id -> part checksum used to detect when all info
@@ -639,6 +814,16 @@ class O2HitMerger : public FairMQDevice
   std::unordered_map<int, TMemFile*> mEventToTMemFileMap; //! files associated to the TTrees
   std::thread mMergerIOThread;                            //! a thread used to do hit merging and IO flushing asynchronously
 
+  std::deque<MergeJob> mMergeQueue;         //! complete events waiting for the merging
+  std::mutex mMergeQueueMutex;              //! protects mMergeQueue and mMergeQueueClosed
+  std::condition_variable mMergeQueueCond;  //! signals a new event or a free slot in the queue
+  bool mMergeQueueClosed = false;           //! no more events will be queued
+  std::exception_ptr mMergeError;           //! failure of the merging pipeline, rethrown on the device thread
+  size_t mMaxQueuedEvents = 4;              //! max number of complete events waiting for the merging
+  int mNMergerThreads = 1;                  //! number of threads merging the detectors of an event
+  std::unordered_map<int, EventFlatHits> mEventToFlatHitsMap; //! flat hits collected per event, bypassing the in memory trees
+  std::unordered_map<int, std::unordered_map<int, bool>> mEventToFlatHitsFormat; //! per event and detector ID: true if the hits come as flat buffers
+
   int mEntries = 0;         //! counts the number of entries in the branches
   int mEventChecksum = 0;   //! checksum for events
   int mNExpectedEvents = 0; //! number of events that we expect to receive
@@ -16,6 +16,9 @@
 namespace bpo = boost::program_options;
 void addCustomOptions(bpo::options_description& options)
 {
+  options.add_options()(
+    "merger-threads", bpo::value<int>()->default_value(0), "number of threads merging the detectors of an event (<=0: number of sim workers)")(
+    "merger-queue-size", bpo::value<int>()->default_value(4), "max number of complete events waiting to be merged");
 }
 
 FairMQDevice* getDevice(const FairMQProgOptions& config)
@@ -17,6 +17,7 @@
 #include <FairPrimaryGenerator.h>
 #include <Generators/GeneratorFactory.h>
 #include <FairMQMessage.h>
+#include <FairMQParts.h>
 #include <SimulationDataFormat/Stack.h>
 #include <SimulationDataFormat/MCEventHeader.h>
 #include <TMessage.h>
@@ -29,6 +30,10 @@
 #include <CommonUtils/RngHelper.h>
 #include <typeinfo>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <new>
 #include <TROOT.h>
 #include <TStopwatch.h>
 
@@ -49,12 +54,23 @@ class O2PrimaryServerDevice : public FairMQDevice
   /// Default destructor
   ~O2PrimaryServerDevice() final
   {
+    {
+      std::lock_guard<std::mutex> lock(mEventQueueMutex);
+      mStopGeneration = true;
+    }
+    mEventQueueCondition.notify_all();
     if (mGeneratorThread.joinable()) {
       mGeneratorThread.join();
     }
   }
 
  protected:
+  // an event ready to be distributed to the workers
+  struct GeneratedEvent {
+    o2::dataformats::MCEventHeader header;
+    std::vector<TParticle> primaries;
+  };
+
   void initGenerator()
   {
     TStopwatch timer;
@@ -70,18 +86,52 @@ class O2PrimaryServerDevice : public FairMQDevice
     }
     mPrimGen.Init();
     LOG(INFO) << "Generator initialization took " << timer.CpuTime() << "s";
-    generateEvent(); // generate a first event
+
+    generateEvents();
   }
 
-  // function generating one event
-  void generateEvent()
+  // generation loop: fills the event queue until all events of the run are produced.
+  // The events are generated by this single thread only: the generators (and the vertex
+  // smearing of FairPrimaryGenerator) draw from gRandom, so that they can not run
+  // concurrently, and the event sequence stays the one given by the seed.
+  void generateEvents()
   {
-    TStopwatch timer;
-    timer.Start();
-    mStack.Reset();
-    mPrimGen.GenerateEvent(&mStack);
-    timer.Stop();
-    LOG(INFO) << "Event generation took " << timer.CpuTime() << "s";
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mEventQueueMutex);
+        mEventQueueCondition.wait(lock, [this] { return mStopGeneration || mNEventsScheduled - mNEventsTaken < mMaxQueuedEvents; });
+        if (mStopGeneration || mNEventsScheduled >= mMaxEvents) {
+          return;
+        }
+        mNEventsScheduled++;
+      }
+
+      TStopwatch timer;
+      timer.Start();
+      mStack.Reset();
+      mPrimGen.GenerateEvent(&mStack);
+      GeneratedEvent event{mEventHeader, mStack.getPrimaries()};
+      timer.Stop();
+      LOG(INFO) << "Event generation took " << timer.CpuTime() << "s";
+
+      {
+        std::lock_guard<std::mutex> lock(mEventQueueMutex);
+        mEventQueue.emplace_back(std::move(event));
+      }
+      mEventQueueCondition.notify_all();
+    }
+  }
+
+  // takes the next generated event from the queue, waiting for it if needed
+  void takeEvent()
+  {
+    std::unique_lock<std::mutex> lock(mEventQueueMutex);
+    mEventQueueCondition.wait(lock, [this] { return !mEventQueue.empty(); });
+    mCurrentEvent = std::move(mEventQueue.front());
+    mEventQueue.pop_front();
+    mNEventsTaken++;
+    lock.unlock();
+    mEventQueueCondition.notify_all();
   }
 
   void InitTask() final
@@ -114,7 +164,7 @@ class O2PrimaryServerDevice : public FairMQDevice
 
     // lunch initialization of particle generator asynchronously
     // so that we reach the RUNNING state of the server quickly
-    // and do not block here
+    // and do not block here; this thread then keeps generating events
     mGeneratorThread = std::thread(&O2PrimaryServerDevice::initGenerator, this);
 
     // init pipe
@@ -186,29 +236,25 @@ class O2PrimaryServerDevice : public FairMQDevice
     LOG(INFO) << "Received request for work ";
     if (mNeedNewEvent) {
       // we need a newly generated event now
-      if (mGeneratorThread.joinable()) {
-        mGeneratorThread.join();
-      }
+      takeEvent();
       mNeedNewEvent = false;
       mPartCounter = 0;
       counter++;
     }
 
-    auto& prims = mStack.getPrimaries();
+    auto& prims = mCurrentEvent.primaries;
     auto numberofparts = (int)std::ceil(prims.size() / (1. * mChunkGranularity));
     // number of parts should be at least 1 (even if empty)
     numberofparts = std::max(1, numberofparts);
 
-    o2::data::PrimaryChunk m;
     o2::data::SubEventInfo i;
     i.eventID = counter;
     i.maxEvents = mMaxEvents;
     i.part = mPartCounter + 1;
     i.nparts = numberofparts;
     i.seed = counter + mInitialSeed;
-    i.index = m.mParticles.size();
-    i.mMCEventHeader = mEventHeader;
-    m.mSubEventInfo = i;
+    i.index = 0;
+    i.mMCEventHeader = mCurrentEvent.header;
 
     int endindex = prims.size() - mPartCounter * mChunkGranularity;
     int startindex = prims.size() - (mPartCounter + 1) * mChunkGranularity;
@@ -219,11 +265,14 @@ class O2PrimaryServerDevice : public FairMQDevice
       endindex = 0;
     }
 
+    // the primaries travel as a flat array, written directly into the message buffer
+    FairMQMessagePtr primmessage(fTransportFactory->CreateMessage((endindex - startindex) * sizeof(o2::data::FlatParticle)));
+    auto flatprims = static_cast<o2::data::FlatParticle*>(primmessage->GetData());
     for (int index = startindex; index < endindex; ++index) {
-      m.mParticles.emplace_back(prims[index]);
+      new (flatprims + index - startindex) o2::data::FlatParticle(prims[index]);
     }
 
-    LOG(INFO) << "Sending " << m.mParticles.size() << " particles";
+    LOG(INFO) << "Sending " << endindex - startindex << " particles";
     LOG(INFO) << "treating ev " << counter << " part " << i.part << " out of " << i.nparts;
 
     // feedback to driver if new event started
@@ -235,22 +284,21 @@ class O2PrimaryServerDevice : public FairMQDevice
     mPartCounter++;
     if (mPartCounter == numberofparts) {
       mNeedNewEvent = true;
-      // start generation of a new event
-      mGeneratorThread = std::thread(&O2PrimaryServerDevice::generateEvent, this);
     }
 
     TMessage* tmsg = new TMessage(kMESS_OBJECT);
-    tmsg->WriteObjectAny((void*)&m, TClass::GetClass("o2::data::PrimaryChunk"));
+    tmsg->WriteObjectAny((void*)&i, TClass::GetClass("o2::data::SubEventInfo"));
 
     auto free_tmessage = [](void* data, void* hint) { delete static_cast<TMessage*>(hint); };
 
-    std::unique_ptr<FairMQMessage> message(
-      fTransportFactory->CreateMessage(tmsg->Buffer(), tmsg->BufferSize(), free_tmessage, tmsg));
+    FairMQParts parts;
+    parts.AddPart(FairMQMessagePtr(fTransportFactory->CreateMessage(tmsg->Buffer(), tmsg->BufferSize(), free_tmessage, tmsg)));
+    parts.AddPart(std::move(primmessage));
 
     // send answer
     TStopwatch timer;
     timer.Start();
-    auto code = Send(message, "primary-get", 0, 5000); // we introduce timeout in order not to block other requests
+    auto code = Send(parts, "primary-get", 0, 5000); // we introduce timeout in order not to block other requests
     timer.Stop();
     auto time = timer.CpuTime();
     if (code > 0) {
@@ -267,6 +315,7 @@ class O2PrimaryServerDevice : public FairMQDevice
   o2::eventgen::PrimaryGenerator mPrimGen;
   o2::dataformats::MCEventHeader mEventHeader;
   o2::data::Stack mStack;      // the stack which is filled
+  GeneratedEvent mCurrentEvent; // the event which is being distributed
   int mChunkGranularity = 500; // how many primaries to send to a worker
   int mLastPosition = 0;       // last position in stack vector
   int mPartCounter = 0;
@@ -276,7 +325,14 @@ class O2PrimaryServerDevice : public FairMQDevice
   int mPipeToDriver = -1; // handle for direct piper to driver (to communicate meta info)
 
   std::thread mGeneratorThread; //! a thread used to concurrently init the particle generator
-                                //  or to generate events
+                                //  and to generate events
+  std::deque<GeneratedEvent> mEventQueue; // events generated ahead of the requests
+  std::mutex mEventQueueMutex;
+  std::condition_variable mEventQueueCondition;
+  int mMaxQueuedEvents = 2;   // bound on the events generated but not yet taken
+  int mNEventsScheduled = 0;  // events generated or being generated
+  int mNEventsTaken = 0;      // events taken from the queue
+  bool mStopGeneration = false;
 };
 
 } // namespace devices
@@ -15,6 +15,7 @@
 
 #include <memory>
 #include "FairMQMessage.h"
+#include <FairMQParts.h>
 #include <FairMQDevice.h>
 #include <FairLogger.h>
 #include "../macro/o2sim.C"
@@ -154,7 +155,7 @@ class O2SimDevice : public FairMQDevice
                                                        text->length(),                   // size
                                                        CustomCleanup,
                                                        text));
-    FairMQMessagePtr reply(dataoutchannel.NewMessage());
+    FairMQParts reply;
 
     mVMCApp->setSimDataChannel(&dataoutchannel);
 
@@ -172,21 +173,28 @@ class O2SimDevice : public FairMQDevice
         code = requestchannel.Receive(reply, timeoutinMS);
         trial++;
         if (code > 0) {
-          LOG(INFO) << "Answer received, containing " << reply->GetSize() << " bytes ";
+          LOG(INFO) << "Answer received, containing " << code << " bytes ";
 
           // wrap incoming bytes as a TMessageWrapper which offers "adoption" of a buffer
-          auto message = new TMessageWrapper(reply->GetData(), reply->GetSize());
-          auto chunk = static_cast<o2::data::PrimaryChunk*>(message->ReadObjectAny(message->GetClass()));
-
-          mVMCApp->setPrimaries(chunk->mParticles);
-
-          auto info = chunk->mSubEventInfo;
+          auto message = new TMessageWrapper(reply.At(0)->GetData(), reply.At(0)->GetSize());
+          auto subevent = static_cast<o2::data::SubEventInfo*>(message->ReadObjectAny(message->GetClass()));
+          auto info = *subevent;
+
+          // the primaries come as a flat array of trivially copyable particles
+          auto nprims = reply.At(1)->GetSize() / sizeof(o2::data::FlatParticle);
+          auto flatprims = static_cast<const o2::data::FlatParticle*>(reply.At(1)->GetData());
+          std::vector<TParticle> primaries;
+          primaries.reserve(nprims);
+          for (size_t k = 0; k < nprims; ++k) {
+            primaries.emplace_back(flatprims[k].toTParticle());
+          }
+          mVMCApp->setPrimaries(primaries);
           mVMCApp->setSubEventInfo(&info);
 
-          LOG(INFO) << "Processing " << chunk->mParticles.size() << " primary particles "
+          LOG(INFO) << "Processing " << primaries.size() << " primary particles "
                     << "for event " << info.eventID << "/" << info.maxEvents << " "
                     << "part " << info.part << "/" << info.nparts;
-          gRandom->SetSeed(chunk->mSubEventInfo.seed);
+          gRandom->SetSeed(info.seed);
 
           auto& conf = o2::conf::SimConfig::Instance();
           if (strcmp(conf.getMCEngine().c_str(), "TGeant4") == 0) {
@@ -203,7 +211,7 @@ class O2SimDevice : public FairMQDevice
           LOG(INFO) << "MEM-STAMP " << sysinfo.GetCurrentMemory() / (1024. * 1024) << " "
                     << sysinfo.GetMaxMemory() << " MB\n";
           delete message;
-          delete chunk;
+          delete subevent;
         } else {
           LOG(INFO) << " No answer reveived from server. Return code " << code;
         }